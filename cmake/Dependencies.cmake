@@ -50,6 +50,11 @@ if(NOT dlib_FOUND)
   endif()
 endif()
 
+if(HR_ENABLE_ONNXRUNTIME)
+  find_package(onnxruntime CONFIG REQUIRED)
+  message(STATUS "Found ONNX Runtime for the onnx_cpu HumanRecognition backend")
+endif()
+
 if(BUILD_MQTT_CLIENT)
   find_package(PahoMqttCpp CONFIG)
   if(PahoMqttCpp_FOUND)
@@ -49,6 +49,20 @@ else()
   message(STATUS " * feature BUILD_SHARED_MODULES: OFF - Modules will be linked statically into the main executable.")
 endif()
 
+option(HR_ENABLE_AVX2 "Compile HumanRecognition vector kernels with AVX2/FMA/F16C" OFF)
+if(HR_ENABLE_AVX2)
+  message(STATUS " * feature HR_ENABLE_AVX2: ON - Quantized gallery search uses AVX2/FMA/F16C kernels. The resulting binary requires a Haswell-or-newer CPU.")
+else()
+  message(STATUS " * feature HR_ENABLE_AVX2: OFF - Quantized gallery search uses portable scalar kernels. Enable with -DHR_ENABLE_AVX2=ON on AVX2-capable targets.")
+endif()
+
+option(HR_ENABLE_ONNXRUNTIME "Build the ONNX Runtime (CPU) HumanRecognition backend" OFF)
+if(HR_ENABLE_ONNXRUNTIME)
+  message(STATUS " * feature HR_ENABLE_ONNXRUNTIME: ON - The onnx_cpu backend (SCRFD + ArcFace) is registered next to opencv_dlib. Requires onnxruntime.")
+else()
+  message(STATUS " * feature HR_ENABLE_ONNXRUNTIME: OFF - Only the opencv_dlib backend is available. Enable with -DHR_ENABLE_ONNXRUNTIME=ON.")
+endif()
+
 # 启用编译缓存以加速重编译
 if(NOT MSVC)
   find_program(SCCACHE_PROGRAM sccache)
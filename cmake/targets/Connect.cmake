@@ -6,10 +6,12 @@ set(CONNECT_SOURCES
     src/modules/Connect/mqtt_connect.cpp
     src/modules/Connect/serial_connect.cpp
     src/modules/Connect/connect_factory.cpp
+    src/modules/Connect/timer_wheel.cpp
     include/modules/Connect/iface_connect.h
     include/modules/Connect/tcp_connect.h
     include/modules/Connect/connect_factory.h
     include/modules/Connect/connect_wrapper.h
+    include/modules/Connect/timer_wheel.h
     include/widgets/connectwidget.h
     src/widgets/connectwidget.cpp)
 
@@ -2,7 +2,9 @@
 set(DEVICE_GATEWAY_SOURCES
     src/modules/DeviceGateway/device_gateway.cpp
     include/modules/DeviceGateway/device_gateway.h
-    src/modules/DeviceGateway/device_registry.cpp)
+    src/modules/DeviceGateway/device_registry.cpp
+    src/modules/DeviceGateway/heartbeat_tracker.cpp
+    include/modules/DeviceGateway/heartbeat_tracker.h)
 
 # REST server implementation for remote device registration
 list(APPEND DEVICE_GATEWAY_SOURCES src/modules/DeviceGateway/rest_server.cpp
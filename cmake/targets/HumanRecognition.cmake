@@ -4,12 +4,38 @@ set(HUMAN_RECOGNITION_SOURCES
     include/modules/HumanRecognition/factory.h
     include/modules/HumanRecognition/ihumanrecognitionbackend.h
     include/modules/HumanRecognition/types.h
+    include/modules/HumanRecognition/motion_gate.h
+    include/modules/HumanRecognition/face_tracker.h
   include/modules/HumanRecognition/impl/opencv_dlib/backend.h
+  include/modules/HumanRecognition/impl/onnx/backend.h
     src/modules/HumanRecognition/humanrecognition.cpp
   src/modules/HumanRecognition/factory.cpp
+  src/modules/HumanRecognition/internal/detection_tiles.h
+  src/modules/HumanRecognition/detection_tiles.cpp
+  src/modules/HumanRecognition/internal/enrollment.h
+  src/modules/HumanRecognition/enrollment.cpp
+  src/modules/HumanRecognition/internal/latency_stats.h
+  src/modules/HumanRecognition/latency_stats.cpp
+  src/modules/HumanRecognition/motion_gate.cpp
+  src/modules/HumanRecognition/face_tracker.cpp
+  src/modules/HumanRecognition/internal/model_cache.h
+  src/modules/HumanRecognition/model_cache.cpp
+  src/modules/HumanRecognition/internal/quantized_gallery.h
+  src/modules/HumanRecognition/quantized_gallery.cpp
+  src/modules/HumanRecognition/internal/recognition_cache.h
+  src/modules/HumanRecognition/recognition_cache.cpp
+  src/modules/HumanRecognition/internal/request_queue.h
+  src/modules/HumanRecognition/request_queue.cpp
   src/modules/HumanRecognition/impl/opencv_dlib/backend.cpp
   src/modules/HumanRecognition/impl/opencv_dlib/backend_impl_core.cpp
-  src/modules/HumanRecognition/impl/opencv_dlib/backend_impl_recognition.cpp)
+  src/modules/HumanRecognition/impl/opencv_dlib/backend_impl_enroll.cpp
+  src/modules/HumanRecognition/impl/opencv_dlib/backend_impl_recognition.cpp
+  src/modules/HumanRecognition/impl/opencv_dlib/dnn_detector.cpp
+  src/modules/HumanRecognition/impl/opencv_dlib/image_view.cpp
+  src/modules/HumanRecognition/impl/onnx/backend.cpp
+  src/modules/HumanRecognition/impl/onnx/backend_impl_core.cpp
+  src/modules/HumanRecognition/impl/onnx/backend_impl_inference.cpp
+  src/modules/HumanRecognition/impl/onnx/postprocess.cpp)
 if(BUILD_SHARED_MODULES)
   add_library(HumanRecognition SHARED ${HUMAN_RECOGNITION_SOURCES})
   # Ensure exported symbols on MSVC builds when no explicit export macro
@@ -35,6 +61,14 @@ target_link_libraries(HumanRecognition PRIVATE Qt6::Widgets Qt6::Network
                                                Qt6::Sql)
 target_link_libraries(HumanRecognition PRIVATE Storage config logging)
 
+if(HR_ENABLE_AVX2)
+  if(MSVC)
+    target_compile_options(HumanRecognition PRIVATE /arch:AVX2)
+  else()
+    target_compile_options(HumanRecognition PRIVATE -mavx2 -mfma -mf16c)
+  endif()
+endif()
+
 if(TARGET dlib::dlib)
   target_link_libraries(HumanRecognition PRIVATE dlib::dlib)
   target_compile_definitions(HumanRecognition PRIVATE HAS_DLIB=1)
@@ -50,12 +84,22 @@ elseif(TARGET opencv::opencv)
   target_compile_definitions(HumanRecognition PRIVATE HAS_OPENCV=1)
 elseif(TARGET opencv_core)
   target_link_libraries(HumanRecognition PRIVATE opencv_core opencv_imgproc opencv_imgcodecs)
+  # DNN 人脸检测器（cv::FaceDetectorYN）依赖 objdetect 与 dnn 模块，缺失时回退为 HOG
+  if(TARGET opencv_objdetect AND TARGET opencv_dnn)
+    target_link_libraries(HumanRecognition PRIVATE opencv_objdetect opencv_dnn)
+  endif()
   target_compile_definitions(HumanRecognition PRIVATE HAS_OPENCV=1)
 else()
   message(
     FATAL_ERROR
       "OpenCV targets not found. Expected opencv_world / opencv::opencv / opencv_core. Ensure OpenCV is available")
 endif()
+
+# ONNX Runtime 后端为可选项；未启用时 impl/onnx/backend.cpp 编译为空实现且不注册工厂
+if(HR_ENABLE_ONNXRUNTIME)
+  target_link_libraries(HumanRecognition PRIVATE onnxruntime::onnxruntime)
+  target_compile_definitions(HumanRecognition PRIVATE HAS_ONNXRUNTIME=1)
+endif()
 target_link_libraries(CrossControl PRIVATE HumanRecognition)
 
 # Register installation as part of the Core component so the module is installed
@@ -4,7 +4,15 @@ set(STORAGE_SOURCES
   src/modules/Storage/storage.cpp
   include/modules/Storage/storage.h
   src/modules/Storage/dbmanager.cpp
-  include/modules/Storage/dbmanager.h)
+  include/modules/Storage/dbmanager.h
+  src/modules/Storage/column_segment.cpp
+  include/modules/Storage/column_segment.h
+  src/modules/Storage/schema.cpp
+  include/modules/Storage/schema.h
+  src/modules/Storage/telemetry_store.cpp
+  include/modules/Storage/telemetry_store.h
+  src/modules/Storage/write_behind.cpp
+  include/modules/Storage/write_behind.h)
 
 cc_create_module(Storage ${STORAGE_SOURCES})
 
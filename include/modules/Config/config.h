@@ -1,9 +1,17 @@
 ﻿#ifndef CROSSCONTROL_CONFIG_H
 #define CROSSCONTROL_CONFIG_H
 
+#include <QHash>
+#include <QMap>
 #include <QSettings>
 #include <QString>
+#include <QStringList>
 #include <QVariant>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
 
 // Export macro for config library when built as shared
 #ifdef config_EXPORTS
@@ -14,9 +22,45 @@
 
 namespace config {
 
+// 某一时刻全部配置的不可变副本。发布后不再修改，可在任意线程无锁读取、长期持有
+class CONFIG_EXPORT ConfigSnapshot {
+   public:
+    ConfigSnapshot() = default;
+    ConfigSnapshot(QHash<QString, QVariant> values, quint64 version);
+
+    // 单调递增的版本号，每次发布新快照加一
+    quint64 version() const { return version_; }
+
+    bool contains(const QString& key) const { return values_.contains(key); }
+    QVariant value(const QString& key, const QVariant& defaultValue = QVariant()) const;
+    bool getBool(const QString& key, bool defaultValue = false) const;
+    int getInt(const QString& key, int defaultValue = 0) const;
+    double getDouble(const QString& key, double defaultValue = 0.0) const;
+    QString getString(const QString& key, const QString& defaultValue = QString()) const;
+
+    QStringList keys() const { return values_.keys(); }
+    const QHash<QString, QVariant>& values() const { return values_; }
+
+    // 与 other 相比新增、删除或取值不同的键（已排序）；类型不同但文本相同的值视为未变化
+    QStringList diff(const ConfigSnapshot& other) const;
+
+   private:
+    QHash<QString, QVariant> values_;
+    quint64 version_ = 0;
+};
+
 // 简单的全局配置管理器，封装 QSettings，用于模块间统一配置访问
+//
+// QSettings 仍是持久化的权威来源，但读取不再经过它：每次写入后发布一个新的 ConfigSnapshot，
+// getValue/getInt/getString 等只读当前快照（稳定状态下只有一次原子读，不加锁、不查 INI），
+// 写入方串行地复制旧快照、修改并整体替换。模块可以 subscribe() 感兴趣的键，变化时收到回调，
+// 不必反复轮询。enableHotReload() 监视 JSON 配置文件，修改后无需重启即可生效。
 class CONFIG_EXPORT ConfigManager {
    public:
+    // 配置变化回调：snapshot 为已发布的新快照，changedKeys 为其中与订阅前缀匹配的变化键
+    using ChangeCallback =
+        std::function<void(const ConfigSnapshot& snapshot, const QStringList& changedKeys)>;
+
     static ConfigManager& instance();
 
     // 初始化（可选指定组织与应用名）
@@ -55,16 +99,72 @@ class CONFIG_EXPORT ConfigManager {
     // Return all keys currently present in the underlying QSettings
     QStringList allKeys() const;
 
+    // 当前配置快照；持有期间内容不变，适合一次读取多个相关键得到一致的视图
+    std::shared_ptr<const ConfigSnapshot> snapshot() const;
+
+    // 订阅 prefix 下键的变化（"Storage" 匹配 "Storage/..."，空串匹配全部），返回订阅标识。
+    // 回调在执行写入的线程上、新快照发布之后调用，可以在回调中读写配置
+    quint64 subscribe(const QString& prefix, ChangeCallback callback);
+    // 取消订阅；返回后回调不会再被调用（正在其它线程执行时等待其结束）
+    void unsubscribe(quint64 id);
+
+    // 热加载：监视 JSON 配置文件（默认为已加载的 CrossControlConfig.json）。文件变化后在后台
+    // 线程解析并与当前快照比较，只写入变化的键并通知订阅者，回调因此在监视线程上执行。
+    // 文件不完整（例如编辑器正在写入）时保持现有配置，等待下一次变化
+    bool enableHotReload(const QString& path = QString(), int debounceMs = 250);
+    // 停止监视；不要在变更回调中调用
+    void disableHotReload();
+    bool hotReloadEnabled() const;
+
    private:
     ConfigManager();
     ~ConfigManager();
 
+    struct Subscriber {
+        QString prefix;
+        ChangeCallback callback;
+        int running = 0;  // 正在执行的回调数，受 subscribersMutex_ 保护
+        bool active = true;
+    };
+
+    class HotReloader;
+
+    // 读取 JSON 文件写入 QSettings，不发布快照；调用方持有 writeMutex_
+    bool loadJsonFileLocked(const QString& path, bool rememberPath);
+    // 当前线程缓存的快照；版本号未变时不触碰共享的引用计数
+    const ConfigSnapshot& current() const;
+    // 以 values 发布新快照并返回变化的键；调用方持有 writeMutex_
+    QStringList publishLocked(QHash<QString, QVariant> values);
+    // 从 QSettings 重建快照（批量写入或外部修改之后）；调用方持有 writeMutex_
+    QStringList republishLocked();
+    // JSON 配置文件路径（已加载的文件，否则为应用目录下的默认文件）；调用方持有 writeMutex_
+    QString jsonFilePathLocked() const;
+    // setValue 后写回 JSON 文件；热加载监视该文件且有未应用的外部编辑时跳过，调用方持有 writeMutex_
+    void writeBackLocked();
+    // 通知订阅者；调用方不得持有 writeMutex_
+    void notify(const QStringList& changedKeys);
+    // 写入热加载得到的变化（无效值表示删除该键）并通知订阅者
+    void applyReloaded(const QHash<QString, QVariant>& changes);
+
     QSettings* settings_ = nullptr;
     // If a JSON file was loaded, remember its path to enable writing back
     QString jsonFilePath_;
 
     // Embedded default JSON content (fallback when no external config present)
     static const char* kEmbeddedDefaultJson;
+
+    // 写入方互斥（QSettings 修改与快照发布）；读取方不使用
+    mutable std::recursive_mutex writeMutex_;
+    std::atomic<std::shared_ptr<const ConfigSnapshot>> snapshot_;
+    std::atomic<quint64> snapshotVersion_{0};
+
+    std::mutex subscribersMutex_;
+    std::condition_variable subscribersCv_;  // 某个回调执行结束
+    QMap<quint64, std::shared_ptr<Subscriber>> subscribers_;
+    quint64 nextSubscriberId_ = 0;
+
+    mutable std::mutex hotReloadMutex_;
+    std::unique_ptr<HotReloader> hotReloader_;
 };
 
 // 方便别名
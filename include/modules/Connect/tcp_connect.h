@@ -14,17 +14,32 @@
  */
 class TcpConnect : public IConnect {
    public:
+    /**
+     * @brief 阻塞等待的超时配置，默认值与历史行为一致
+     */
+    struct Options {
+        int connectTimeoutMs;
+        int writeTimeoutMs;
+        int readTimeoutMs;  ///< receive() 等待数据的时长，0 表示只读取已到达的数据
+
+        Options() : connectTimeoutMs(3000), writeTimeoutMs(3000), readTimeoutMs(100) {}
+    };
+
     /**
      * @brief 构造函数，未打开套接字
      */
     TcpConnect();
+    explicit TcpConnect(const Options& options);
 
     /**
      * @brief 构造并可选择直接根据 endpoint 打开连接
      * @param endpoint host:port 格式
      * @param autoOpen 若为 true 则在构造时尝试 open(endpoint)
+     * @param options 超时配置
      */
-    explicit TcpConnect(const QString& endpoint, bool autoOpen = true);
+    explicit TcpConnect(const QString& endpoint,
+                        bool autoOpen = true,
+                        const Options& options = Options());
 
     /**
      * @brief 析构函数，会自动关闭套接字并释放资源
@@ -71,4 +86,5 @@ class TcpConnect : public IConnect {
 
    private:
     QTcpSocket m_socket;
+    Options m_options;
 };
@@ -0,0 +1,155 @@
+﻿#pragma once
+
+#include <QtGlobal>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @file timer_wheel.h
+ * @brief 分层哈希时间轮：进程内共享的大量定时器服务
+ *
+ * 面向离线检测、周期性刷新等"数量多、精度要求低"的定时器（目前由 DeviceGateway 的
+ * HeartbeatTracker 使用）。插入与取消都是 O(1)，所有到期回调由唯一的驱动线程执行。
+ */
+
+/**
+ * @brief 定时器标识；0 表示无效。低 32 位为节点下标，高 32 位为代数，节点复用后旧标识失效
+ */
+using TimerId = quint64;
+
+/**
+ * @brief 时间轮参数
+ */
+struct TimerWheelOptions {
+    std::chrono::milliseconds tick{10};  ///< 分辨率：到期时间向上取整到 tick
+    int slotBits = 8;                    ///< 每层 2^slotBits 个格子
+    int levels = 4;  ///< 层数；可表示的最远延迟为 tick * 2^(slotBits*levels)，更远的会分段等待
+};
+
+/**
+ * @brief 分层哈希时间轮
+ *
+ * 第 0 层每格一个 tick，第 k 层每格覆盖 2^(slotBits*k) 个 tick。定时器按剩余 tick 数放入能
+ * 容纳它的最低层；高层格子在轮到时整体下放（cascade）到低层，因此每个定时器最多被搬动
+ * levels-1 次。定时器节点放在数组中并以下标串成双向链表，插入、取消都只是链表操作。
+ *
+ * 回调在驱动线程上、不持有内部锁时执行，可以在回调中再调度或取消定时器；回调应当很短，
+ * 耗时操作请转交其它线程。start() 之后由内部线程按真实时间推进，线程只在下一个非空格子
+ * （到期或需要下放）时醒来；未启动时可以用 advance() 手动推进（测试或由调用方自己的循环驱动）。
+ */
+class TimerWheel {
+   public:
+    using Callback = std::function<void()>;
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief 进程共享的时间轮（10ms 分辨率），首次使用时启动驱动线程
+     */
+    static TimerWheel& instance();
+
+    explicit TimerWheel(TimerWheelOptions options = {});
+    ~TimerWheel();
+
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+
+    /**
+     * @brief 调度一次性定时器
+     * @param delay 延迟，至少按一个 tick 计
+     * @param callback 到期时在驱动线程上执行
+     * @return 定时器标识，可用于 cancel()
+     */
+    TimerId schedule(std::chrono::milliseconds delay, Callback callback);
+
+    /**
+     * @brief 调度周期定时器（保活、周期性刷新），首次在 period 后触发，直到被取消
+     */
+    TimerId scheduleRepeating(std::chrono::milliseconds period, Callback callback);
+
+    /**
+     * @brief 取消定时器
+     *
+     * 返回后回调不会再开始执行；若回调正在驱动线程上执行，会等待其结束（在该回调内部取消
+     * 自身时不等待）。
+     * @return 定时器仍在等待或正在执行时返回 true；已触发或标识无效返回 false
+     */
+    bool cancel(TimerId id);
+
+    /**
+     * @brief 启动驱动线程（按真实时间推进）；重复调用无副作用
+     */
+    void start();
+
+    /**
+     * @brief 停止驱动线程；未到期的定时器保留，再次 start() 后继续
+     */
+    void stop();
+
+    /**
+     * @brief 手动推进 elapsed（按 tick 截断）并在调用线程上执行到期回调；仅用于未 start() 时
+     * @return 执行的回调数
+     */
+    int advance(std::chrono::milliseconds elapsed);
+
+    /**
+     * @brief 等待中的定时器数量
+     */
+    std::size_t pending() const;
+
+    TimerWheelOptions options() const { return m_options; }
+
+   private:
+    struct Node {
+        qint64 expireTick = 0;
+        qint64 periodTicks = 0;  // 0 表示一次性
+        Callback callback;
+        int prev = -1;
+        int next = -1;    // 同时用作空闲链表
+        int bucket = -1;  // 所在格子的全局下标，-1 表示未挂在轮上（空闲或等待执行）
+        quint32 generation = 0;
+        bool active = false;
+    };
+
+    TimerId insertLocked(qint64 ticks, qint64 periodTicks, Callback callback);
+    // 标识对应的活动节点下标；已失效返回 -1
+    int indexOf(TimerId id) const;
+    void linkLocked(int index);
+    void unlinkLocked(int index);
+    void releaseLocked(int index);
+    // 推进一个 tick，把到期定时器追加到 due
+    void stepLocked(std::vector<TimerId>& due);
+    // 推进到 targetTick 并执行到期回调，返回执行数
+    int runUntil(qint64 targetTick);
+    // 执行一个到期定时器的回调；已被取消返回 false
+    bool fire(TimerId id);
+    qint64 ticksFor(std::chrono::milliseconds delay) const;
+    // 驱动线程下次需要醒来的 tick：各层最近一个非空格子的到期或下放时刻
+    qint64 nextWakeTickLocked() const;
+    void run();
+
+    const TimerWheelOptions m_options;
+    const int m_slots;        // 每层格子数
+    const qint64 m_slotMask;  // m_slots - 1
+
+    mutable std::mutex m_mutex;
+    std::vector<Node> m_nodes;
+    std::vector<int> m_buckets;  // levels * m_slots 个链表头
+    int m_freeHead = -1;
+    std::size_t m_pending = 0;  // 活动节点数
+    qint64 m_currentTick = 0;
+
+    // 正在执行的回调，cancel() 据此等待
+    TimerId m_running = 0;
+    std::thread::id m_runningThread;
+    std::condition_variable m_runningCv;
+
+    Clock::time_point m_origin;  // tick 0 对应的时刻，start() 时对齐到当前 tick
+    std::condition_variable m_wakeCv;
+    qint64 m_wakeTick = 0;  // 驱动线程睡到的 tick；0 表示未在等待（或需要重新计算）
+    bool m_stopping = false;
+    std::thread m_thread;
+};
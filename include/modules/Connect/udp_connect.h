@@ -15,13 +15,26 @@
  */
 class UdpConnect : public IConnect {
    public:
+    /**
+     * @brief 阻塞等待的超时配置，默认值与历史行为一致
+     */
+    struct Options {
+        int readTimeoutMs;  ///< receive() 等待数据报的时长，0 表示只读取已到达的数据报
+
+        Options() : readTimeoutMs(100) {}
+    };
+
     UdpConnect();
+    explicit UdpConnect(const Options& options);
     /**
      * @brief 构造并可选择根据 endpoint 自动打开 UDP（bind 或指定远端）
      * @param endpoint 形如 "host:port" 或 "*:port" 或 ":port"
      * @param autoOpen 若为 true 则在构造时尝试 open(endpoint)
+     * @param options 超时配置
      */
-    explicit UdpConnect(const QString& endpoint, bool autoOpen = true);
+    explicit UdpConnect(const QString& endpoint,
+                        bool autoOpen = true,
+                        const Options& options = Options());
     ~UdpConnect() override;
 
     bool open(const QString& endpoint) override;
@@ -37,4 +50,5 @@ class UdpConnect : public IConnect {
     quint16 m_remotePort{0};
     bool m_hasRemote{false};
     bool m_bound{false};
+    Options m_options;
 };
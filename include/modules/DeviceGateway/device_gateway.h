@@ -1,6 +1,11 @@
 ﻿#pragma once
 
+#include <QJsonObject>
+#include <future>
+
 #include "modules/DeviceGateway/device_registry.h"
+#include "modules/DeviceGateway/heartbeat_tracker.h"
+#include "modules/Storage/telemetry_store.h"
 
 // reuse Connect interfaces for device endpoint connections
 #include "modules/Connect/connect_factory.h"
@@ -14,6 +19,10 @@ class DeviceGateway {
     ~DeviceGateway();
 
     DeviceRegistry& registry();
+    // Liveness tracking: persisted devices are registered at init(), new ones on add/import, and
+    // any inbound traffic (REST heartbeat, telemetry, data received on a managed connection)
+    // touches them
+    HeartbeatTracker& heartbeats();
 
     // Initialize internal services (e.g. REST server). Returns true when
     // successfully initialized.
@@ -28,27 +37,47 @@ class DeviceGateway {
     bool addDeviceWithConnect(const DeviceInfo& dev);
     bool removeDeviceAndClose(const QString& id);
 
-    // Persistence: store device metadata into Storage (SQLite)
-    bool persistDevice(const DeviceInfo& dev);
+    // Persistence: store device metadata into Storage (SQLite). Existing rows keep their
+    // status/last_seen, which belong to the HeartbeatTracker
+    static bool persistDevice(const DeviceInfo& dev);
+    // Queue persistDevice on the Storage write-behind thread; the future becomes true once the
+    // write has been committed
+    std::future<bool> persistDeviceAsync(const DeviceInfo& dev);
     QVector<DeviceInfo> loadDevicesFromStorage() const;
 
+    // Record a heartbeat for a known device; returns false when the device is not registered
+    bool heartbeat(const QString& deviceId);
+
+    // Telemetry: numeric fields of `metrics` become points at timestampMs (now when <= 0).
+    // Points are written in batches by storage::TelemetryStore; the future becomes true once the
+    // batch has been committed
+    std::future<bool> ingestTelemetry(const QString& deviceId,
+                                      const QJsonObject& metrics,
+                                      qint64 timestampMs = 0);
+    std::future<bool> ingestTelemetry(QVector<storage::TelemetryPoint> points);
+    QVector<storage::TelemetrySample> queryTelemetry(
+        const QString& deviceId,
+        const QString& metric,
+        qint64 fromMs,
+        qint64 toMs,
+        storage::TelemetryResolution resolution = storage::TelemetryResolution::Raw,
+        int limit = 0) const;
+
     // Export helpers
     bool exportDevicesCsv(const QString& path) const;
     bool exportDevicesJsonND(const QString& path) const;
-    // Import helpers
+    // Import helpers: return false if the file cannot be read or any row fails to persist
     bool importDevicesCsv(const QString& path, bool createConnections = false);
     bool importDevicesJsonND(const QString& path, bool createConnections = false);
 
    private:
     DeviceRegistry m_registry;
+    HeartbeatTracker m_heartbeats;
     // REST 服务器是可选的，如果 Drogon 不可用，可以为 null
     void* m_restServer{nullptr};
 
     // 从设备ID映射到创建的连接实例
     QMap<QString, IConnectPtr> m_connections;
-
-    // 确保在配置的存储数据库中存在设备表
-    bool ensureDevicesTable();
 };
 
 }  // namespace DeviceGateway
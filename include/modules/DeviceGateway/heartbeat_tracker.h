@@ -0,0 +1,118 @@
+﻿#pragma once
+
+#include <QHash>
+#include <QString>
+#include <QVector>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <vector>
+
+#include "modules/Connect/timer_wheel.h"
+
+namespace DeviceGateway {
+
+// Liveness derived from live traffic; Unknown until the first heartbeat after registration
+enum class DeviceLiveness : quint8 { Unknown = 0, Online = 1, Offline = 2 };
+
+// Stable reference to a tracker slot. The generation guards against a slot being reused by
+// another device after unregisterDevice()
+struct HeartbeatHandle {
+    int slot = -1;
+    quint32 generation = 0;
+
+    bool isValid() const { return slot >= 0; }
+};
+
+struct HeartbeatOptions {
+    int capacity = 65536;                           // max tracked devices
+    std::chrono::milliseconds timeout{30000};       // no traffic for this long -> offline
+    std::chrono::milliseconds flushInterval{2000};  // period of batched devices table updates
+};
+
+struct HeartbeatState {
+    QString id;
+    DeviceLiveness liveness = DeviceLiveness::Unknown;
+    qint64 lastSeenMs = 0;  // 0 when never seen
+};
+
+// Tracks lastSeen and online/offline for every registered device.
+//
+// State lives in a fixed array of slots. touch() from I/O threads is a handful of relaxed
+// atomic operations and never takes a lock once the device is online. Each online slot has one
+// timer on the shared TimerWheel that re-checks it when its deadline passes and reschedules it
+// lazily from the latest lastSeen, so heartbeats never touch the wheel. Changed slots are marked
+// dirty and written to the devices table in one batched transaction per flushInterval (a
+// repeating timer on the same wheel) through the Storage write-behind queue.
+class HeartbeatTracker {
+   public:
+    explicit HeartbeatTracker(HeartbeatOptions options = {},
+                              TimerWheel& timers = TimerWheel::instance());
+    ~HeartbeatTracker();
+
+    HeartbeatTracker(const HeartbeatTracker&) = delete;
+    HeartbeatTracker& operator=(const HeartbeatTracker&) = delete;
+
+    // Register a device (idempotent). Returns an invalid handle when the tracker is full
+    HeartbeatHandle registerDevice(const QString& id);
+    void unregisterDevice(const QString& id);
+    HeartbeatHandle handle(const QString& id) const;
+
+    // Record traffic from a device. nowMs <= 0 means the current time. The handle overload is
+    // lock-free; the id overload does one shared-lock lookup and returns false if unknown
+    void touch(HeartbeatHandle handle, qint64 nowMs = 0);
+    bool touch(const QString& id, qint64 nowMs = 0);
+
+    std::optional<HeartbeatState> state(const QString& id) const;
+    QVector<HeartbeatState> snapshot() const;
+
+    // Start/stop offline detection and periodic flushing. Devices that come online while
+    // stopped are armed by start(). stop() cancels all timers and flushes dirty entries
+    void start();
+    void stop();
+
+    // Take (and clear) all dirty entries
+    QVector<HeartbeatState> takeDirty();
+
+    // Queue dirty entries as one batched UPDATE of the devices table. The future becomes true
+    // once the batch has been committed (immediately when nothing is dirty)
+    std::future<bool> flush();
+
+    HeartbeatOptions options() const { return m_options; }
+
+   private:
+    struct Slot {
+        std::atomic<qint64> lastSeenMs{0};
+        std::atomic<quint8> liveness{static_cast<quint8>(DeviceLiveness::Unknown)};
+        std::atomic<bool> dirty{false};
+        std::atomic<quint32> generation{0};
+        QString id;         // guarded by m_registryMutex
+        TimerId timer = 0;  // pending expiry check, guarded by m_timerMutex
+    };
+
+    // Schedule the expiry check of a slot that just came online (no-op if already scheduled)
+    void arm(int slot);
+    // Expiry check on the wheel thread: reschedule from lastSeen or mark the slot offline
+    void expire(int slot, quint32 generation);
+    // Caller holds m_timerMutex
+    void scheduleLocked(int slot, qint64 nowMs);
+
+    const HeartbeatOptions m_options;
+    TimerWheel& m_timers;
+    std::unique_ptr<Slot[]> m_slots;
+
+    mutable std::shared_mutex m_registryMutex;
+    QHash<QString, int> m_index;
+    std::vector<int> m_freeSlots;
+    int m_slotCount = 0;  // high-water mark of used slots
+
+    std::mutex m_timerMutex;
+    bool m_stopping = true;  // no timers are scheduled while stopped
+    TimerId m_flushTimer = 0;
+};
+
+}  // namespace DeviceGateway
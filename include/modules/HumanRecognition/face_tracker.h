@@ -0,0 +1,110 @@
+﻿/**
+ * @file face_tracker.h
+ * @brief 跨帧人脸跟踪：为检测框分配稳定的 trackId，只对新出现或需要复核的轨迹做特征提取与匹配
+ */
+#pragma once
+
+#include <QPointF>
+#include <QRect>
+#include <QVector>
+#include <optional>
+
+#include "types.h"
+
+namespace HumanRecognition {
+
+/**
+ * @struct FaceTrackerOptions
+ * @brief 跟踪参数
+ */
+struct FaceTrackerOptions {
+    double iouThreshold = 0.3;       ///< 预测框与检测框的 IoU 低于该值时不关联
+    int maxMissedFrames = 15;        ///< 轨迹连续未被检测到的帧数上限，超过后删除
+    int reverifyEveryNFrames = 60;   ///< 已识别轨迹每隔 N 帧重新提取特征复核（0 表示不复核）
+    double velocitySmoothing = 0.5;  ///< 速度估计的平滑系数（0-1），越大越信任最新位移
+};
+
+/**
+ * @struct FaceTrack
+ * @brief 单条跟踪轨迹
+ */
+struct FaceTrack {
+    int id = -1;                            ///< 轨迹编号，从 1 开始递增
+    QRect rect;                             ///< 最近一次的位置（检测到时为检测框，否则为预测框）
+    QPointF velocity;                       ///< 每帧中心点位移（像素）
+    int hits = 0;                           ///< 累计被检测到的帧数
+    int missed = 0;                         ///< 连续未被检测到的帧数
+    int framesSinceRecognition = 0;         ///< 距离上次特征提取/匹配的帧数
+    bool recognized = false;                ///< 是否已完成至少一次特征提取与匹配
+    std::optional<RecognitionMatch> match;  ///< 最近一次匹配结果（未命中人员库时为空）
+};
+
+/**
+ * @class FaceTracker
+ * @brief 基于 IoU 关联与匀速运动模型的多目标人脸跟踪
+ *
+ * 每帧将已有轨迹按速度外推得到预测框，与新的检测框按 IoU 从大到小贪心关联；
+ * 关联成功的检测框继承轨迹编号，其余检测框开启新轨迹。调用方只需对
+ * needsRecognition() 为 true 的轨迹提取特征并匹配，再通过 setRecognition() 回填结果，
+ * 稳定跟踪时特征网络的调用次数与人脸数量无关、仅与新轨迹和复核周期有关。
+ *
+ * 该类不是线程安全的，通常每路视频流持有一个实例。
+ */
+class FaceTracker {
+   public:
+    /**
+     * @struct Stats
+     * @brief 累计计数
+     */
+    struct Stats {
+        quint64 framesProcessed = 0;        ///< 调用 update() 的次数
+        quint64 tracksCreated = 0;          ///< 新建的轨迹数
+        quint64 recognitionsRequested = 0;  ///< 需要提取特征的次数（新轨迹 + 复核）
+        quint64 recognitionsReused = 0;     ///< 直接沿用轨迹已有结果的次数
+    };
+
+    explicit FaceTracker(const FaceTrackerOptions& options = {});
+
+    const FaceTrackerOptions& options() const { return m_options; }
+    void setOptions(const FaceTrackerOptions& options) { m_options = options; }
+
+    /**
+     * @brief 用当前帧的检测结果更新轨迹，并把轨迹编号写回 boxes[i].trackId
+     */
+    void update(QVector<FaceBox>& boxes);
+
+    /**
+     * @brief 该轨迹是否需要（重新）提取特征并匹配：新轨迹或到达复核周期
+     */
+    bool needsRecognition(int trackId) const;
+
+    /**
+     * @brief 回填轨迹的识别结果；match 为空表示未命中人员库
+     */
+    void setRecognition(int trackId, const std::optional<RecognitionMatch>& match);
+
+    /**
+     * @brief 查找轨迹；不存在时返回 nullptr
+     */
+    const FaceTrack* track(int trackId) const;
+
+    const QVector<FaceTrack>& tracks() const { return m_tracks; }
+
+    /**
+     * @brief 清空全部轨迹（例如切换视频源时）；编号不会复用
+     */
+    void reset() { m_tracks.clear(); }
+
+    Stats stats() const { return m_stats; }
+    void resetStats() { m_stats = {}; }
+
+   private:
+    FaceTrack* findTrack(int trackId);
+
+    FaceTrackerOptions m_options;
+    QVector<FaceTrack> m_tracks;
+    int m_nextId = 1;
+    Stats m_stats;
+};
+
+}  // namespace HumanRecognition
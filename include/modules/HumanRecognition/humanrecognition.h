@@ -25,6 +25,8 @@
 #include <QString>
 #include <QVector>
 #include <filesystem>
+#include <functional>
+#include <future>
 #include <memory>
 
 #include "factory.h"
@@ -137,6 +139,165 @@ class HumanRecognition {
      */
     HRCode extractFeature(const QImage& image, const FaceBox& box, FaceFeature& outFeature);
 
+    /**
+     * @brief 执行人脸检测并返回帧上下文，供随后的 extractFeature 复用预处理结果
+     * @param image 输入图像
+     * @param opts 检测参数
+     * @param outBoxes 输出检测到的人脸列表
+     * @param outContext 输出帧上下文（后端不支持时为空）
+     * @return HRCode 操作结果
+     */
+    HRCode detect(const QImage& image,
+                  const DetectOptions& opts,
+                  QVector<FaceBox>& outBoxes,
+                  FrameContextPtr& outContext);
+
+    /**
+     * @brief 使用帧上下文提取特征；上下文无效时等价于不带上下文的版本
+     * @param context detect 返回的帧上下文
+     * @param image 原始图像（与 detect 时相同）
+     * @param box 要提取特征的人脸框
+     * @param outFeature 输出特征
+     * @return HRCode 操作结果
+     */
+    HRCode extractFeature(const FrameContextPtr& context,
+                          const QImage& image,
+                          const FaceBox& box,
+                          FaceFeature& outFeature);
+
+    /**
+     * @brief 批量提取同一帧中多张人脸的特征；支持批量推理的后端只做一次前向计算
+     * @param context detect 返回的帧上下文（可为空）
+     * @param image 原始图像
+     * @param boxes 人脸框列表
+     * @param outFeatures 输出特征，与 boxes 一一对应，失败的条目 values 为空
+     * @return HRCode 全部失败时返回错误码，否则返回 Ok
+     */
+    HRCode extractFeatures(const FrameContextPtr& context,
+                           const QImage& image,
+                           const QVector<FaceBox>& boxes,
+                           QVector<FaceFeature>& outFeatures);
+
+    /**
+     * @brief 一站式识别：检测人脸，并对每张人脸提取特征、在人员库中检索最近邻
+     *
+     * 检测阶段的帧上下文会传给批量特征提取，避免重复预处理。某张人脸特征提取或检索失败时，
+     * 对应结果的 feat/match 为空，不影响其它人脸。开启结果缓存后，近似相同的重复帧在缓存
+     * 有效期内直接返回缓存结果（见 setRecognitionCacheOptions，默认关闭）。
+     * @param image 输入图像
+     * @param opts 检测参数
+     * @param outResults 输出每张人脸的识别结果
+     * @return HRCode 检测阶段的结果（未检测到人脸时为 DetectFailed）
+     */
+    HRCode recognize(const QImage& image,
+                     const DetectOptions& opts,
+                     QVector<RecognitionResult>& outResults);
+
+    /**
+     * @brief 异步检测，立即返回 future
+     *
+     * 请求进入有界优先级队列，由后台工作线程执行；队列已满返回 QueueFull，
+     * 超过截止时间仍未开始处理返回 DeadlineExceeded。设置了截止时间且允许降级时，
+     * 开始处理前按剩余预算与历史耗时依次尝试缩小图像、跳过关键点，仍来不及则丢弃该帧
+     * （DeadlineExceeded），实际档位见 timing.degradation。
+     * @param image 输入图像（隐式共享，提交后调用方可继续修改自己的副本）
+     * @param opts 检测参数
+     * @param request 调度参数（优先级、截止时间）
+     */
+    std::future<DetectResponse> submitDetect(const QImage& image,
+                                             const DetectOptions& opts,
+                                             const RequestOptions& request = {});
+
+    /**
+     * @brief 异步检测，完成后在工作线程上调用 callback（UI 调用方需自行切回主线程）
+     */
+    void submitDetect(const QImage& image,
+                      const DetectOptions& opts,
+                      const RequestOptions& request,
+                      std::function<void(DetectResponse)> callback);
+
+    /**
+     * @brief 异步一站式识别（见 recognize），立即返回 future
+     */
+    std::future<RecognizeResponse> submitRecognize(const QImage& image,
+                                                   const DetectOptions& opts,
+                                                   const RequestOptions& request = {});
+
+    /**
+     * @brief 异步一站式识别，完成后在工作线程上调用 callback
+     */
+    void submitRecognize(const QImage& image,
+                         const DetectOptions& opts,
+                         const RequestOptions& request,
+                         std::function<void(RecognizeResponse)> callback);
+
+    /**
+     * @brief 异步识别已检测到的人脸：批量提取特征并检索最近邻，立即返回 future
+     *
+     * 用于检测与识别分开调度的场景（例如实时预览只对新轨迹识别），context 为检测返回的
+     * 帧上下文，可复用预处理。结果与 boxes 一一对应；没有 boxes 时直接返回 Ok。
+     */
+    std::future<RecognizeResponse> submitMatchFaces(const FrameContextPtr& context,
+                                                    const QImage& image,
+                                                    const QVector<FaceBox>& boxes,
+                                                    const RequestOptions& request = {});
+
+    /**
+     * @brief 异步识别已检测到的人脸，完成后在工作线程上调用 callback
+     */
+    void submitMatchFaces(const FrameContextPtr& context,
+                          const QImage& image,
+                          const QVector<FaceBox>& boxes,
+                          const RequestOptions& request,
+                          std::function<void(RecognizeResponse)> callback);
+
+    /**
+     * @brief 调整异步队列参数；正在排队的请求会以 UnknownError 结束
+     */
+    void setRequestQueueOptions(const RequestQueueOptions& options);
+
+    /**
+     * @brief 当前异步队列参数
+     */
+    RequestQueueOptions requestQueueOptions() const;
+
+    /**
+     * @brief 调整 recognize() 结果缓存参数（capacity 为 0 时关闭，默认关闭），并清空现有条目
+     *
+     * 缓存以帧的感知哈希与检测参数为键，注册/删除人员、加载模型、切换后端时自动失效；
+     * 通过 backend() 直接修改后端状态后需调用 invalidateRecognitionCache()。
+     */
+    void setRecognitionCacheOptions(const RecognitionCacheOptions& options);
+
+    /**
+     * @brief 当前 recognize() 结果缓存参数
+     */
+    RecognitionCacheOptions recognitionCacheOptions() const;
+
+    /**
+     * @brief recognize() 结果缓存的命中/未命中等统计
+     */
+    RecognitionCacheStats recognitionCacheStats() const;
+
+    /**
+     * @brief 手动清空 recognize() 结果缓存
+     */
+    void invalidateRecognitionCache();
+
+    /**
+     * @brief 识别链路各阶段延迟直方图
+     *
+     * 包含 queue（异步排队）、lock（等待门面锁）、detect、extract、match、total 六个阶段的
+     * 计数/均值/最大值/p50/p95/p99 与分桶计数，各降级档位的请求数，以及降级策略当前的
+     * 每百万像素耗时估计。
+     */
+    QJsonObject latencyStats() const;
+
+    /**
+     * @brief 清空延迟直方图与降级计数（保留降级策略的耗时估计）
+     */
+    void resetLatencyStats();
+
     /**
      * @brief 比较两个特征向量并返回距离/相似度
      * @param a 特征 A
@@ -161,6 +322,14 @@ class HumanRecognition {
      */
     HRCode registerPerson(const PersonInfo& person);
 
+    /**
+     * @brief 批量注册人员记录（后端支持时在同一事务中写入）
+     * @param persons 要注册的人员列表（均应包含唯一 id）
+     * @param replaceExisting 为 true 时覆盖已存在的同 id 记录
+     * @return HRCode 操作结果（例如 PersonExists）
+     */
+    HRCode registerPersons(const QVector<PersonInfo>& persons, bool replaceExisting = false);
+
     /**
      * @brief 从人员库移除指定 id 的记录
      * @param personId 要移除的人员 id
@@ -184,10 +353,22 @@ class HumanRecognition {
     HRCode listPersons(QVector<PersonInfo>& outPersons);
 
     /**
-     * @brief 触发后端的训练流程（如果后端实现了 train）
+     * @brief 触发后端的训练流程（如果后端实现了 train），等价于以默认参数调用 enrollDataset
      */
     HRCode train(const QString& datasetPath);
 
+    /**
+     * @brief 从 <根目录>/<person_id>/<图片> 结构的数据集批量入库
+     *
+     * 特征提取期间不持有门面锁，识别等同步调用照常进行，进度回调中也可以调用本对象；
+     * 只有最终写入人员库时短暂持有门面锁并使识别结果缓存失效。opts.commit 由门面设置，
+     * 调用方传入的值会被覆盖。
+     * @param datasetPath 数据集根目录
+     * @param opts 并行度、批大小、覆盖策略与进度回调
+     * @return HRCode 操作结果
+     */
+    HRCode enrollDataset(const QString& datasetPath, const EnrollOptions& opts = EnrollOptions());
+
     ~HumanRecognition();
 
    private:
@@ -66,6 +66,74 @@ class IHumanRecognitionBackend {
                                   const FaceBox& box,
                                   FaceFeature& outFeature) = 0;
 
+    /**
+     * @brief 执行人脸检测并返回可复用的帧上下文
+     *
+     * 默认实现调用 detect() 且不产生上下文；支持预处理复用的后端应覆盖此方法。
+     * @param image 输入图像
+     * @param opts 检测参数
+     * @param outBoxes 输出检测到的人脸列表
+     * @param outContext 输出帧上下文（可能为空）
+     * @return HRCode 表示操作结果
+     */
+    virtual HRCode detectWithContext(const QImage& image,
+                                     const DetectOptions& opts,
+                                     QVector<FaceBox>& outBoxes,
+                                     FrameContextPtr& outContext) {
+        outContext.reset();
+        return detect(image, opts, outBoxes);
+    }
+
+    /**
+     * @brief 借助 detectWithContext() 产生的帧上下文提取特征
+     *
+     * 默认实现忽略上下文并调用 extractFeature()。上下文为空、来自其他后端或与 image 不对应时，
+     * 后端应退回常规路径，因此调用方始终需要传入原始图像。
+     * @param context 帧上下文（可为空）
+     * @param image 原始图像
+     * @param box 人脸框
+     * @param outFeature 输出特征
+     * @return HRCode 表示操作结果
+     */
+    virtual HRCode extractFeatureWithContext(const FrameContextPtr& context,
+                                             const QImage& image,
+                                             const FaceBox& box,
+                                             FaceFeature& outFeature) {
+        Q_UNUSED(context);
+        return extractFeature(image, box, outFeature);
+    }
+
+    /**
+     * @brief 批量提取同一帧中多张人脸的特征
+     *
+     * 默认实现逐个调用 extractFeatureWithContext()；支持批量推理的后端应覆盖此方法，
+     * 把多张人脸合并为一次前向计算。outFeatures 与 boxes 一一对应，提取失败的条目 values 为空。
+     * @param context 帧上下文（可为空）
+     * @param image 原始图像
+     * @param boxes 人脸框列表
+     * @param outFeatures 输出特征列表
+     * @return HRCode 全部失败时返回错误码，否则返回 Ok
+     */
+    virtual HRCode extractFeatures(const FrameContextPtr& context,
+                                   const QImage& image,
+                                   const QVector<FaceBox>& boxes,
+                                   QVector<FaceFeature>& outFeatures) {
+        outFeatures.clear();
+        outFeatures.resize(boxes.size());
+        HRCode last = HRCode::Ok;
+        int succeeded = 0;
+        for (int i = 0; i < boxes.size(); ++i) {
+            const HRCode code = extractFeatureWithContext(context, image, boxes[i], outFeatures[i]);
+            if (code == HRCode::Ok) {
+                ++succeeded;
+            } else {
+                outFeatures[i] = FaceFeature();
+                last = code;
+            }
+        }
+        return boxes.isEmpty() || succeeded > 0 ? HRCode::Ok : last;
+    }
+
     /**
      * @brief 比较两个特征向量并返回距离/相似度
      * @param a 特征 A
@@ -92,6 +160,28 @@ class IHumanRecognitionBackend {
      */
     virtual HRCode registerPerson(const PersonInfo& person) = 0;
 
+    /**
+     * @brief 批量注册人员
+     *
+     * 默认实现逐条调用 registerPerson()（replaceExisting 时先 removePerson() 再注册），
+     * 不具备原子性；支持事务的后端应覆盖此方法，把整批写入合并为一次提交。
+     * @param persons 人员记录列表（均应包含 id）
+     * @param replaceExisting 为 true 时覆盖已存在的同 id 记录，否则遇到重复 id 返回 PersonExists
+     * @return HRCode 表示操作结果；默认实现返回第一个失败条目的错误码
+     */
+    virtual HRCode registerPersons(const QVector<PersonInfo>& persons,
+                                   bool replaceExisting = false) {
+        for (const PersonInfo& person : persons) {
+            HRCode code = registerPerson(person);
+            if (code == HRCode::PersonExists && replaceExisting) {
+                code = removePerson(person.id);
+                if (code == HRCode::Ok) code = registerPerson(person);
+            }
+            if (code != HRCode::Ok) return code;
+        }
+        return HRCode::Ok;
+    }
+
     /**
      * @brief 从数据库移除指定人员
      * @param personId 人员唯一 ID
@@ -123,6 +213,27 @@ class IHumanRecognitionBackend {
      */
     virtual HRCode train(const QString& datasetPath) { return HRCode::UnknownError; }
 
+    /**
+     * @brief 从 <根目录>/<person_id>/<图片> 结构的数据集批量入库
+     *
+     * 默认实现忽略参数并调用 train()；支持并行批量入库的后端应覆盖此方法。
+     * @param datasetPath 数据集根目录
+     * @param opts 并行度、批大小与进度回调等参数
+     * @return HRCode 表示操作结果
+     */
+    virtual HRCode enrollDataset(const QString& datasetPath, const EnrollOptions& opts) {
+        Q_UNUSED(opts);
+        return train(datasetPath);
+    }
+
+    /**
+     * @brief 设置识别结果变化通知（可选实现）
+     *
+     * 匹配阈值、检索编码等影响识别结果的参数在运行时变化后，后端在修改参数的线程上、
+     * 释放自身锁之后调用该回调，门面据此使识别结果缓存失效。传入空函数表示取消。
+     */
+    virtual void setResultsChangedCallback(std::function<void()> callback) { Q_UNUSED(callback); }
+
     /**
      * @brief 返回后端名称（用于显示或调试）
      */
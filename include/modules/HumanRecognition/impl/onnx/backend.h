@@ -0,0 +1,124 @@
+﻿#pragma once
+
+#include <memory>
+
+#include "modules/HumanRecognition/ihumanrecognitionbackend.h"
+
+namespace HumanRecognition {
+
+/**
+ * @class OnnxRuntimeBackend
+ * @brief 基于 ONNX Runtime（CPU 执行提供程序）的人脸识别后端。
+ *
+ * 使用 SCRFD 检测人脸与 5 点关键点，按关键点做相似变换对齐到 112×112 后，
+ * 由 ArcFace 网络输出 512 维 L2 归一化特征，特征距离为余弦距离（1 - cos）。
+ * 同一帧的多张人脸在 extractFeatures() 中合并为一次批量推理。
+ *
+ * 与 OpenCVDlibBackend 一样仅承担门面角色，实现细节位于内部的 `Impl`。
+ */
+class OnnxRuntimeBackend : public IHumanRecognitionBackend {
+   public:
+    OnnxRuntimeBackend();
+    ~OnnxRuntimeBackend() override;
+
+    /**
+     * @brief 按照配置初始化后端（线程数、人员表、阈值、模型目录等）。
+     */
+    HRCode initialize(const QJsonObject& config) override;
+    /**
+     * @brief 释放推理会话与人员缓存。
+     */
+    HRCode shutdown() override;
+
+    /**
+     * @brief 加载 SCRFD 检测模型与 ArcFace 特征模型。
+     *
+     * @param modelPath 包含两个 .onnx 文件的目录，或其中任一文件路径。
+     */
+    HRCode loadModel(const QString& modelPath) override;
+    /**
+     * @brief 将当前人员库导出为 JSON 文件。
+     */
+    HRCode saveModel(const QString& modelPath) override;
+
+    /**
+     * @brief 使用 SCRFD 检测人脸并输出 5 点关键点。
+     */
+    HRCode detect(const QImage& image,
+                  const DetectOptions& opts,
+                  QVector<FaceBox>& outBoxes) override;
+
+    /**
+     * @brief 对指定人脸提取 512 维 ArcFace 特征。
+     */
+    HRCode extractFeature(const QImage& image,
+                          const FaceBox& box,
+                          FaceFeature& outFeature) override;
+
+    /**
+     * @brief 检测人脸并返回帧上下文（保存转换后的 RGB 图像）。
+     */
+    HRCode detectWithContext(const QImage& image,
+                             const DetectOptions& opts,
+                             QVector<FaceBox>& outBoxes,
+                             FrameContextPtr& outContext) override;
+
+    /**
+     * @brief 复用帧上下文提取特征，避免重复的图像转换。
+     */
+    HRCode extractFeatureWithContext(const FrameContextPtr& context,
+                                     const QImage& image,
+                                     const FaceBox& box,
+                                     FaceFeature& outFeature) override;
+
+    /**
+     * @brief 将同一帧的多张人脸合并为一次批量推理。
+     */
+    HRCode extractFeatures(const FrameContextPtr& context,
+                           const QImage& image,
+                           const QVector<FaceBox>& boxes,
+                           QVector<FaceFeature>& outFeatures) override;
+
+    /**
+     * @brief 计算两个特征之间的余弦距离。
+     */
+    HRCode compare(const FaceFeature& a, const FaceFeature& b, float& outDistance) override;
+
+    /**
+     * @brief 在人员库中查找余弦距离最小的人员。
+     */
+    HRCode findNearest(const FaceFeature& feature, RecognitionMatch& outMatch) override;
+
+    /**
+     * @brief 将人员信息写入数据库并刷新缓存。
+     */
+    HRCode registerPerson(const PersonInfo& person) override;
+    /**
+     * @brief 从数据库和缓存中删除指定人员。
+     */
+    HRCode removePerson(const QString& personId) override;
+    /**
+     * @brief 根据 id 查询人员信息。
+     */
+    HRCode getPerson(const QString& personId, PersonInfo& outPerson) override;
+    /**
+     * @brief 列出当前缓存中的所有人员记录。
+     */
+    HRCode listPersons(QVector<PersonInfo>& outPersons) override;
+
+    /**
+     * @brief 设置阈值或检索参数热更新后的通知回调。
+     */
+    void setResultsChangedCallback(std::function<void()> callback) override;
+
+    /**
+     * @brief 返回后端名称标识。
+     */
+    QString backendName() const override;
+
+   private:
+    class Impl;
+    std::unique_ptr<Impl> d;
+};
+
+}  // namespace HumanRecognition
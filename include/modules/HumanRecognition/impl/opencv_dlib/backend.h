@@ -77,6 +77,22 @@ class OpenCVDlibBackend : public IHumanRecognitionBackend {
                           const FaceBox& box,
                           FaceFeature& outFeature) override;
 
+    /**
+     * @brief 检测人脸并返回帧上下文（保存 RGB 图像与关键点）。
+     */
+    HRCode detectWithContext(const QImage& image,
+                             const DetectOptions& opts,
+                             QVector<FaceBox>& outBoxes,
+                             FrameContextPtr& outContext) override;
+
+    /**
+     * @brief 复用帧上下文提取特征，避免重复的图像转换与关键点预测。
+     */
+    HRCode extractFeatureWithContext(const FrameContextPtr& context,
+                                     const QImage& image,
+                                     const FaceBox& box,
+                                     FaceFeature& outFeature) override;
+
     /**
      * @brief 计算两个特征向量之间的特征距离。
      */
@@ -91,6 +107,11 @@ class OpenCVDlibBackend : public IHumanRecognitionBackend {
      * @brief 将人员信息写入数据库并刷新缓存。
      */
     HRCode registerPerson(const PersonInfo& person) override;
+    /**
+     * @brief 在同一事务中批量写入人员，任意一条失败则整体回滚。
+     */
+    HRCode registerPersons(const QVector<PersonInfo>& persons,
+                           bool replaceExisting = false) override;
     /**
      * @brief 从数据库和缓存中删除指定人员。
      */
@@ -106,9 +127,18 @@ class OpenCVDlibBackend : public IHumanRecognitionBackend {
     HRCode listPersons(QVector<PersonInfo>& outPersons) override;
 
     /**
-     * @brief 预留的训练接口，目前未实现。
+     * @brief 以默认参数对数据集目录执行批量入库，等价于 enrollDataset(datasetPath, {})。
      */
     HRCode train(const QString& datasetPath) override;
+    /**
+     * @brief 并行解码、检测并批量提取特征，按人员平均后在一个事务中入库。
+     */
+    HRCode enrollDataset(const QString& datasetPath, const EnrollOptions& opts) override;
+
+    /**
+     * @brief 设置阈值或检索参数热更新后的通知回调。
+     */
+    void setResultsChangedCallback(std::function<void()> callback) override;
 
     /**
      * @brief 返回后端名称标识。
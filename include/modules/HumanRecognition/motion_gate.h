@@ -0,0 +1,103 @@
+﻿/**
+ * @file motion_gate.h
+ * @brief 检测前的运动门控：在低分辨率灰度图上做背景差分，跳过静止帧并输出变化区域
+ */
+#pragma once
+
+#include <QImage>
+#include <QRect>
+#include <QSize>
+#include <QVector>
+#include <cstdint>
+#include <vector>
+
+namespace HumanRecognition {
+
+/**
+ * @struct MotionGateOptions
+ * @brief 运动门控参数
+ *
+ * 灵敏度由 pixelThreshold（单像素灰度差阈值）与 minChangedRatio（变化像素占比阈值）共同决定，
+ * 也可通过 MotionGate::setSensitivity() 以 0~1 的单一数值整体调节。
+ */
+struct MotionGateOptions {
+    int analysisWidth = 160;         ///< 分析用灰度图宽度（像素），高度按比例计算
+    int pixelThreshold = 25;         ///< 灰度差超过该值的像素视为变化（0-255）
+    double minChangedRatio = 0.002;  ///< 变化像素占比低于该值时判定为静止帧
+    double backgroundAlpha = 0.05;   ///< 背景滑动平均的学习率（0-1），越大越快吸收场景变化
+    int cellSize = 8;                ///< 区域聚合的网格边长（分析图像素）
+    int cellMinChanged = 4;          ///< 网格内变化像素数达到该值才视为活动网格
+    int roiPadding = 1;              ///< 输出区域向外扩展的网格数，保证人脸完整
+    int forceEveryNFrames = 0;       ///< 每 N 帧强制整帧放行一次（0 表示不强制）
+};
+
+/**
+ * @class MotionGate
+ * @brief 基于背景差分的轻量运动检测，作为 HumanRecognition::detect 之前的预处理阶段
+ *
+ * 每帧缩放为 analysisWidth 宽的灰度图，与滑动平均背景逐像素比较，得到变化掩码；
+ * 掩码按网格聚合后做连通域合并，输出原图坐标系下的感兴趣区域，可直接填入
+ * DetectOptions::regionsOfInterest。画面无变化时 shouldDetect 为 false，调用方可跳过检测。
+ *
+ * 该类不是线程安全的，通常每路视频流持有一个实例。
+ */
+class MotionGate {
+   public:
+    /**
+     * @struct Result
+     * @brief 单帧门控结果
+     */
+    struct Result {
+        bool shouldDetect = false;  ///< 是否需要对该帧执行检测
+        bool forced = false;        ///< 是否由首帧/尺寸变化/周期强制放行
+        double changedRatio = 0.0;  ///< 变化像素占比
+        QVector<QRect> regions;     ///< 原图坐标系下的变化区域；forced 时为整帧
+    };
+
+    /**
+     * @struct Stats
+     * @brief 累计计数
+     */
+    struct Stats {
+        quint64 framesProcessed = 0;   ///< 处理的总帧数
+        quint64 framesSkipped = 0;     ///< 判定为静止而跳过的帧数
+        quint64 framesWithMotion = 0;  ///< 检测到运动的帧数
+        quint64 framesForced = 0;      ///< 强制放行的帧数
+    };
+
+    explicit MotionGate(const MotionGateOptions& options = {});
+
+    const MotionGateOptions& options() const { return m_options; }
+    void setOptions(const MotionGateOptions& options);
+
+    /**
+     * @brief 以 0~1 的灵敏度整体调节阈值；越大越灵敏（默认参数约对应 0.5）
+     */
+    void setSensitivity(double sensitivity);
+
+    /**
+     * @brief 处理一帧并更新背景模型
+     */
+    Result process(const QImage& frame);
+
+    /**
+     * @brief 丢弃背景模型，下一帧将被强制放行并重新建模
+     */
+    void reset();
+
+    Stats stats() const { return m_stats; }
+    void resetStats() { m_stats = {}; }
+
+   private:
+    QVector<QRect> extractRegions(const std::vector<std::uint8_t>& mask,
+                                  const QSize& frameSize) const;
+
+    MotionGateOptions m_options;
+    QSize m_frameSize;     ///< 当前背景模型对应的原图尺寸
+    QSize m_analysisSize;  ///< 分析图尺寸
+    std::vector<float> m_background;
+    quint64 m_framesSinceForced = 0;
+    Stats m_stats;
+};
+
+}  // namespace HumanRecognition
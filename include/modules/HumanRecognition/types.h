@@ -5,11 +5,15 @@
 #pragma once
 
 #include <QImage>
+#include <QJsonArray>
 #include <QJsonObject>
 #include <QPointF>
 #include <QRect>
 #include <QString>
 #include <QVector>
+#include <chrono>
+#include <functional>
+#include <memory>
 #include <optional>
 
 namespace HumanRecognition {
@@ -31,6 +35,8 @@ enum class HRCode {
     TrainFailed,
     PersonExists,
     PersonNotFound,
+    DeadlineExceeded,  ///< 异步请求在截止时间前未能开始/完成处理，已被丢弃
+    QueueFull,         ///< 异步请求队列已满，请求被拒绝或被更高优先级的请求挤出
     UnknownError
 };
 
@@ -41,11 +47,13 @@ enum class HRCode {
  * @var FaceBox::rect 人脸所在的像素矩形
  * @var FaceBox::score 检测置信度（通常 0.0 - 1.0）
  * @var FaceBox::landmarks 可选的人脸关键点集合
+ * @var FaceBox::trackId 跨帧跟踪编号（由 FaceTracker 分配）
  */
 struct FaceBox {
     QRect rect;                  ///< 人脸所在的像素矩形（x,y,width,height）
     float score = 0.0f;          ///< 检测置信度（通常范围 0.0 - 1.0）
     QVector<QPointF> landmarks;  ///< 可选关键点集合（例如 5 点或 68 点）
+    int trackId = -1;            ///< 跟踪编号；-1 表示未参与跟踪
 };
 
 /**
@@ -62,6 +70,77 @@ struct FaceFeature {
     std::optional<float> norm;  ///< 可选的向量范数（例如 L2），如果提供可避免重复计算
 };
 
+/**
+ * @enum FeatureEncoding
+ * @brief 特征向量在人员库中的存储编码
+ *
+ * Float32 为原始精度；Float16 / Int8 为量化表示（Int8 使用逐向量缩放系数），
+ * 用于减少大规模人员库检索时扫描的数据量与常驻内存。量化模式下对外返回的特征
+ * 由量化行反量化得到，version 带编码后缀（见 featureVersionWithEncoding）。
+ */
+enum class FeatureEncoding { Float32 = 0, Float16, Int8 };
+
+/// version 标签中模型标识与编码之间的分隔符，例如 "dlib_resnet_128@int8"
+inline constexpr QChar kFeatureEncodingSeparator = QLatin1Char('@');
+
+/**
+ * @brief 返回编码的短名称（float32 / fp16 / int8）
+ */
+inline QString featureEncodingName(FeatureEncoding encoding) {
+    switch (encoding) {
+        case FeatureEncoding::Float16:
+            return QStringLiteral("fp16");
+        case FeatureEncoding::Int8:
+            return QStringLiteral("int8");
+        case FeatureEncoding::Float32:
+        default:
+            return QStringLiteral("float32");
+    }
+}
+
+/**
+ * @brief 解析编码名称（大小写不敏感），无法识别时返回 std::nullopt
+ */
+inline std::optional<FeatureEncoding> parseFeatureEncoding(const QString& name) {
+    const QString key = name.trimmed().toLower();
+    if (key.isEmpty() || key == QLatin1String("float32") || key == QLatin1String("fp32") ||
+        key == QLatin1String("float")) {
+        return FeatureEncoding::Float32;
+    }
+    if (key == QLatin1String("fp16") || key == QLatin1String("float16") ||
+        key == QLatin1String("half")) {
+        return FeatureEncoding::Float16;
+    }
+    if (key == QLatin1String("int8")) return FeatureEncoding::Int8;
+    return std::nullopt;
+}
+
+/**
+ * @brief 去掉 version 中的编码后缀，返回模型标识（例如 "dlib_resnet_128"）
+ */
+inline QString featureModelTag(const QString& version) {
+    const qsizetype sep = version.lastIndexOf(kFeatureEncodingSeparator);
+    return sep < 0 ? version : version.left(sep);
+}
+
+/**
+ * @brief 从 version 标签读取编码；没有后缀时视为 Float32
+ */
+inline FeatureEncoding featureEncodingFromVersion(const QString& version) {
+    const qsizetype sep = version.lastIndexOf(kFeatureEncodingSeparator);
+    if (sep < 0) return FeatureEncoding::Float32;
+    return parseFeatureEncoding(version.mid(sep + 1)).value_or(FeatureEncoding::Float32);
+}
+
+/**
+ * @brief 生成带编码后缀的 version 标签；Float32 不追加后缀以保持与既有数据兼容
+ */
+inline QString featureVersionWithEncoding(const QString& version, FeatureEncoding encoding) {
+    const QString model = featureModelTag(version);
+    if (encoding == FeatureEncoding::Float32) return model;
+    return model + kFeatureEncodingSeparator + featureEncodingName(encoding);
+}
+
 /**
  * @struct RecognitionMatch
  * @brief 表示一次识别/检索得到的匹配信息
@@ -104,12 +183,223 @@ struct PersonInfo {
  * @struct DetectOptions
  * @brief 人脸检测的可选参数
  *
- * detectLandmarks: 是否同时检测关键点；minScore: 置信度阈值；resizeTo: 可选缩放尺寸。
+ * detectLandmarks: 是否同时检测关键点；minScore: 置信度阈值；resizeTo: 可选缩放尺寸；
+ * minFaceSize / maxFaceSize: 关心的人脸尺寸范围（原图像素），后端据此裁剪图像金字塔层数；
+ * threads: 并行检测线程数；regionsOfInterest: 只在这些原图区域内检测（例如 MotionGate 输出的变化区域）。
  */
 struct DetectOptions {
-    bool detectLandmarks = true;   ///< 是否同时检测关键点（默认开启）
-    float minScore = 0.3f;         ///< 最低置信度阈值，低于该值的检测结果可被忽略
-    QSize resizeTo = QSize(0, 0);  ///< 可选的缩放尺寸；(0,0) 表示不缩放
+    bool detectLandmarks = true;       ///< 是否同时检测关键点（默认开启）
+    float minScore = 0.3f;             ///< 最低置信度阈值，低于该值的检测结果可被忽略
+    QSize resizeTo = QSize(0, 0);      ///< 可选的缩放尺寸；(0,0) 表示不缩放
+    int minFaceSize = 0;               ///< 最小人脸边长（像素）；0 表示不限制
+    int maxFaceSize = 0;               ///< 最大人脸边长（像素）；0 表示不限制
+    int threads = 0;                   ///< 并行检测线程数；0 使用后端配置，1 强制单线程
+    QVector<QRect> regionsOfInterest;  ///< 限定检测区域（原图坐标）；为空表示整图检测
+};
+
+/**
+ * @struct EnrollProgress
+ * @brief 数据集批量入库的进度
+ */
+struct EnrollProgress {
+    int totalImages = 0;           ///< 数据集中的图片总数
+    int processedImages = 0;       ///< 已处理（含失败）的图片数
+    int failedImages = 0;          ///< 解码失败、未检测到人脸或特征提取失败的图片数
+    int totalPersons = 0;          ///< 数据集中的人员目录数
+    int enrolledPersons = 0;       ///< 已写入人员库的人数（提交完成后更新）
+    double imagesPerSecond = 0.0;  ///< 自开始以来的平均吞吐
+};
+
+/**
+ * @struct EnrollOptions
+ * @brief 数据集批量入库参数
+ *
+ * 数据集目录结构为 <根目录>/<person_id>/<图片>：每个子目录名即人员 id，其中的图片各取最大的一张人脸，
+ * 特征取平均后作为该人员的标准特征。
+ */
+struct EnrollOptions {
+    int threads = 0;              ///< 解码/检测/特征提取线程数；0 使用硬件并发数
+    int batchSize = 16;           ///< 每个线程一次送入特征网络的人脸数
+    int maxImageSide = 1024;      ///< 检测前把图片长边缩小到该值；0 表示不缩放
+    int minImagesPerPerson = 1;   ///< 有效图片少于该数量的人员不入库
+    bool replaceExisting = true;  ///< 覆盖已存在的同 id 人员的标准特征
+
+    /// 进度回调，在工作线程上调用（同一时刻只有一个线程在调用）
+    std::function<void(const EnrollProgress&)> progress;
+
+    /// 提交入库结果（人员列表与 replaceExisting）；为空时后端直接调用自己的 registerPersons。
+    /// 门面通过它在锁内完成写入与识别缓存失效
+    std::function<HRCode(const QVector<PersonInfo>&, bool)> commit;
+};
+
+/**
+ * @class FrameContext
+ * @brief 单帧预处理结果的不透明句柄
+ *
+ * 由后端在检测时创建，保存转换后的像素、缩放后的工作图像以及已计算的关键点等中间结果。
+ * 将其传回同一后端的特征提取接口即可跳过重复的预处理；不同后端之间不可混用，
+ * 后端无法识别的句柄会被忽略并退回常规路径。
+ */
+class FrameContext {
+   public:
+    virtual ~FrameContext() = default;
+
+    /**
+     * @brief 创建该上下文的源图像 QImage::cacheKey()，用于校验上下文与图像是否对应
+     */
+    qint64 sourceCacheKey() const { return m_sourceCacheKey; }
+
+    /**
+     * @brief 源图像尺寸
+     */
+    QSize sourceSize() const { return m_sourceSize; }
+
+   protected:
+    FrameContext(qint64 sourceCacheKey, const QSize& sourceSize)
+        : m_sourceCacheKey(sourceCacheKey), m_sourceSize(sourceSize) {}
+
+   private:
+    qint64 m_sourceCacheKey = 0;
+    QSize m_sourceSize;
+};
+
+/// 帧上下文共享指针，可在检测与多次特征提取之间传递
+using FrameContextPtr = std::shared_ptr<FrameContext>;
+
+/**
+ * @enum RequestPriority
+ * @brief 异步请求优先级；队列总是先处理优先级高的请求，同优先级按提交顺序处理
+ */
+enum class RequestPriority {
+    Background = 0,  ///< 后台任务，例如重建索引、批量补录特征
+    Normal = 1,      ///< 普通请求，例如界面实时预览
+    Realtime = 2,    ///< 实时请求，例如门禁通行识别
+};
+
+/**
+ * @enum DegradationLevel
+ * @brief 截止时间不足时异步请求的降级档位，按顺序逐级加重
+ */
+enum class DegradationLevel {
+    None = 0,         ///< 按原参数完整处理
+    Downscaled = 1,   ///< 通过 DetectOptions::resizeTo 缩小后处理
+    NoLandmarks = 2,  ///< 缩小且不输出关键点
+    Skipped = 3,      ///< 剩余预算不足以处理，直接丢弃该帧（DeadlineExceeded）
+};
+
+/**
+ * @struct RequestOptions
+ * @brief 异步请求的调度参数
+ */
+struct RequestOptions {
+    RequestPriority priority = RequestPriority::Normal;  ///< 调度优先级
+    std::chrono::milliseconds deadline{0};               ///< 自提交起的截止时长；0 表示不设截止时间
+    bool allowDegradation = true;                        ///< 预计超时时允许降级处理
+};
+
+/**
+ * @struct RequestQueueOptions
+ * @brief 异步请求队列参数
+ */
+struct RequestQueueOptions {
+    int workers = 1;                  ///< 工作线程数（后端调用由门面串行化，通常 1 即可）
+    int capacity = 64;                ///< 队列中等待的请求上限，超过后按优先级拒绝
+    int degradedMaxSide = 640;        ///< 降级时图像长边缩放到的像素数
+    double budgetSafetyFactor = 1.2;  ///< 预估耗时乘以该系数后再与剩余预算比较
+};
+
+/**
+ * @struct RecognitionCacheOptions
+ * @brief 识别结果缓存参数
+ *
+ * recognize() 以缩小后帧的感知哈希（256 位 dHash）与检测参数为键缓存识别结果，
+ * 重复提交的近似相同帧直接返回缓存结果。条目自写入起 ttl 后过期（命中不续期），
+ * 人员库或模型变化时整体失效。哈希只反映整帧亮度分布，背景相同、只换了人的两帧可能得到
+ * 相同的键，因此缓存默认关闭，需由调用方按场景显式设置 capacity 开启。
+ */
+struct RecognitionCacheOptions {
+    int capacity = 0;                     ///< 缓存的帧数上限；0（默认）表示关闭缓存
+    std::chrono::milliseconds ttl{1000};  ///< 条目有效期
+    int maxHammingDistance = 0;           ///< 视为同一帧的最大哈希汉明距离；0 要求哈希完全相同
+};
+
+/**
+ * @struct RecognitionCacheStats
+ * @brief 识别结果缓存统计
+ */
+struct RecognitionCacheStats {
+    quint64 hits = 0;           ///< 命中次数
+    quint64 misses = 0;         ///< 未命中次数（含过期）
+    quint64 expirations = 0;    ///< 因超过有效期被丢弃的条目数
+    quint64 evictions = 0;      ///< 因容量上限被淘汰的条目数
+    quint64 invalidations = 0;  ///< 因人员库或模型变化整体失效的次数
+    int entries = 0;            ///< 当前条目数
+};
+
+/**
+ * @struct RequestTiming
+ * @brief 单个请求的耗时统计（毫秒）
+ */
+struct RequestTiming {
+    double queueMs = 0.0;       ///< 在队列中等待的时长
+    double processingMs = 0.0;  ///< 实际处理（检测/特征/检索）的时长
+    /// 实际采用的降级档位（仅异步请求）
+    DegradationLevel degradation = DegradationLevel::None;
+};
+
+/**
+ * @struct DetectResponse
+ * @brief 异步检测的结果
+ */
+struct DetectResponse {
+    HRCode code = HRCode::UnknownError;  ///< 操作结果
+    QVector<FaceBox> boxes;              ///< 检测到的人脸
+    FrameContextPtr context;             ///< 帧上下文，可传给 extractFeature 复用预处理
+    RequestTiming timing;                ///< 耗时统计
+};
+
+/**
+ * @struct RecognizeResponse
+ * @brief 检测 + 特征提取 + 检索一站式识别的结果
+ *
+ * toJson() 输出与模块接口契约一致的结构：
+ * {"request_id", "timestamp", "results": [{"subject_id", "confidence", ...}],
+ *  "meta": {"processing_ms", "queue_ms", "degradation", "code"}}。
+ */
+struct RecognizeResponse {
+    HRCode code = HRCode::UnknownError;  ///< 操作结果
+    QString requestId;                   ///< 请求编号（UUID）
+    qint64 timestamp = 0;                ///< 提交时间（Unix 秒）
+    QVector<RecognitionResult> results;  ///< 每张人脸的识别结果
+    RequestTiming timing;                ///< 耗时统计
+
+    QJsonObject toJson() const {
+        QJsonArray items;
+        for (const RecognitionResult& result : results) {
+            QJsonObject item;
+            item.insert(QStringLiteral("subject_id"),
+                        result.match ? result.match->personId : QString());
+            item.insert(QStringLiteral("confidence"),
+                        result.match ? static_cast<double>(result.match->score) : 0.0);
+            item.insert(QStringLiteral("distance"),
+                        result.match ? static_cast<double>(result.match->distance) : 0.0);
+            const QRect& r = result.face.rect;
+            item.insert(QStringLiteral("box"), QJsonArray{r.x(), r.y(), r.width(), r.height()});
+            items.append(item);
+        }
+        QJsonObject meta;
+        meta.insert(QStringLiteral("processing_ms"), timing.processingMs);
+        meta.insert(QStringLiteral("queue_ms"), timing.queueMs);
+        meta.insert(QStringLiteral("degradation"), static_cast<int>(timing.degradation));
+        meta.insert(QStringLiteral("code"), static_cast<int>(code));
+
+        QJsonObject json;
+        json.insert(QStringLiteral("request_id"), requestId);
+        json.insert(QStringLiteral("timestamp"), timestamp);
+        json.insert(QStringLiteral("results"), items);
+        json.insert(QStringLiteral("meta"), meta);
+        return json;
+    }
 };
 
 }  // namespace HumanRecognition
@@ -0,0 +1,163 @@
+﻿#pragma once
+
+#include <QFile>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "telemetry_store.h"
+
+namespace storage::columnar {
+
+/**
+ * @brief 扫描时需要输出的列（按位组合）
+ */
+enum ColumnMask : unsigned {
+    DeviceColumn = 1u << 0,
+    MetricColumn = 1u << 1,
+    TimestampColumn = 1u << 2,
+    ValueColumn = 1u << 3,
+    AllColumns = DeviceColumn | MetricColumn | TimestampColumn | ValueColumn,
+};
+
+/// 段内列的个数，列序号与 ColumnMask 的位序一致（设备、指标、时间戳、数值）
+constexpr int kColumnCount = 4;
+
+/**
+ * @brief 段尾稀疏索引中的一个块：各列在文件中的位置与块内取值范围
+ */
+struct BlockIndex {
+    quint32 rows = 0;
+    qint64 minTs = 0;
+    qint64 maxTs = 0;
+    double minValue = 0.0;
+    double maxValue = 0.0;
+    quint32 minDevice = 0;
+    quint32 maxDevice = 0;
+    quint32 minMetric = 0;
+    quint32 maxMetric = 0;
+    quint64 offset[kColumnCount] = {};
+    quint32 size[kColumnCount] = {};
+};
+
+/**
+ * @brief 段写入参数
+ */
+struct SegmentWriteOptions {
+    int rowsPerBlock = 1024;  ///< 每个块的行数；块是稀疏索引与按列读取的最小单位
+};
+
+/**
+ * @brief 扫描谓词；未设置的条件不参与过滤
+ */
+struct ScanPredicate {
+    QString metric;       ///< 为空表示全部指标
+    QStringList devices;  ///< 为空表示全部设备
+    qint64 fromMs = std::numeric_limits<qint64>::min();
+    qint64 toMs = std::numeric_limits<qint64>::max();
+    double minValue = -std::numeric_limits<double>::infinity();
+    double maxValue = std::numeric_limits<double>::infinity();
+};
+
+/**
+ * @brief 按列组织的扫描结果；devices/metrics 为所在段的字典，deviceIds/metricIds 是字典下标
+ *
+ * 只有扫描时请求的列会被填充，其余数组为空。
+ */
+struct ColumnRows {
+    QStringList devices;
+    QStringList metrics;
+    std::vector<quint32> deviceIds;
+    std::vector<quint32> metricIds;
+    std::vector<qint64> timestamps;
+    std::vector<double> values;
+    std::size_t rows = 0;
+
+    void clear();
+};
+
+/**
+ * @brief 单次扫描的统计
+ */
+struct ScanStats {
+    int blocksTotal = 0;
+    int blocksRead = 0;    ///< 未被稀疏索引排除、实际解码的块数
+    qint64 bytesRead = 0;  ///< 读取的列数据字节数（不含段尾索引）
+};
+
+/**
+ * @brief 将数据点写成一个只追加的列式段文件
+ *
+ * 行按 (metric, device, ts) 排序后每 rowsPerBlock 行组成一个块，块内各列独立压缩：
+ * 时间戳用 delta-of-delta 变长位编码，数值用 Gorilla 式 XOR 编码，设备与指标用排序字典的
+ * 下标做差分 + zigzag varint。段尾保存字典与每块各列的偏移及 ts/value/设备/指标的最小最大值，
+ * 扫描时据此跳过整块并只读取需要的列。文件经 QSaveFile 写入，读者不会看到写了一半的段。
+ * 无设备、无指标或数值非有限的点被丢弃。
+ * @return 成功返回 true；失败时 error（若非空）为原因
+ */
+bool writeSegment(const QString& path,
+                  const QVector<TelemetryPoint>& points,
+                  const SegmentWriteOptions& options = {},
+                  QString* error = nullptr);
+
+/**
+ * @brief 按 UTC 日期把数据点写入 root/yyyyMMdd/ 下的新段文件
+ */
+bool writeDaySegments(const QString& root,
+                      const QVector<TelemetryPoint>& points,
+                      const SegmentWriteOptions& options = {},
+                      QString* error = nullptr);
+
+/**
+ * @brief root 下与 [fromMs, toMs] 有交集的日期目录中的全部段文件，按日期升序
+ */
+QStringList segmentFiles(const QString& root, qint64 fromMs, qint64 toMs);
+
+/**
+ * @brief 删除整天早于 cutoffMs 的日期目录；返回删除的目录数
+ */
+int removeExpiredSegments(const QString& root, qint64 cutoffMs);
+
+/**
+ * @brief 列式段读取器
+ *
+ * open() 只读取段尾索引；scan() 先用块级最小最大值排除块，再只解码谓词与输出需要的列，
+ * 在解码后的列数组上以无分支循环计算选择向量。
+ */
+class SegmentReader {
+   public:
+    bool open(const QString& path);
+    void close();
+    QString errorString() const { return m_error; }
+
+    std::size_t rows() const { return m_rows; }
+    int blocks() const { return static_cast<int>(m_blocks.size()); }
+    const QStringList& devices() const { return m_devices; }
+    const QStringList& metrics() const { return m_metrics; }
+
+    /**
+     * @brief 扫描满足谓词的行，结果覆盖写入 out
+     * @param columns ColumnMask 的组合，决定输出哪些列
+     */
+    bool scan(const ScanPredicate& predicate,
+              unsigned columns,
+              ColumnRows& out,
+              ScanStats* stats = nullptr);
+
+    const std::vector<BlockIndex>& blockIndex() const { return m_blocks; }
+
+   private:
+    bool readColumn(const BlockIndex& block, int column, QByteArray& bytes, ScanStats& stats);
+
+    QFile m_file;
+    QString m_error;
+    QStringList m_devices;
+    QStringList m_metrics;
+    std::vector<BlockIndex> m_blocks;
+    std::size_t m_rows = 0;
+};
+
+}  // namespace storage::columnar
@@ -3,9 +3,17 @@
 #include <QDateTime>
 #include <QSharedPointer>
 #include <QString>
+#include <QStringList>
 #include <QTimeZone>
 #include <QVariant>
 #include <QtSql/QSqlDatabase>
+#include <QtSql/QSqlQuery>
+#include <atomic>
+#include <mutex>
+
+namespace config {
+class ConfigSnapshot;
+}  // namespace config
 
 namespace storage {
 
@@ -14,6 +22,9 @@ namespace storage {
 /**
  * @brief 基于 Qt QSql 的数据库管理类（单例）
  *
+ * Qt SQL 连接只能在创建它的线程中使用，因此每个线程在首次调用 db() 时按 init() 解析出的配置
+ * 打开自己的连接，线程退出时自动关闭。SQLite 默认以 WAL 模式打开：各线程的读连接可以并发
+ * 读取，写事务则通过 writeLock() 在进程内串行化，避免多个连接争抢写锁时返回 SQLITE_BUSY。
  */
 class DbManager {
    public:
@@ -26,24 +37,60 @@ class DbManager {
     bool init(bool force = false) noexcept;
 
     // 是否已经初始化
-    bool initialized() const noexcept { return m_initialized; }
+    bool initialized() const noexcept { return m_initialized.load(); }
 
-    // 取得底层的 QSqlDatabase (throws if not initialized)
+    // 取得当前线程的 QSqlDatabase (throws if not initialized or the connection cannot be opened)
     QSqlDatabase& db();
 
-    // 关闭连接
+    // 当前线程连接上按 SQL 文本缓存的预编译语句；首次使用时 prepare，之后直接复用
+    // 调用方用 bindValue(index, value) 按位置绑定参数后 exec()；读取完结果后应调用 finish()
+    // 释放语句持有的读快照。同一条 SQL 在当前线程只有一个实例，不要跨可能复用它的调用持有。
+    // prepare 失败时抛出 std::runtime_error
+    QSqlQuery& prepared(const QString& sql);
+
+    // 写锁（可重入）：写事务或单条写语句前持有，保证同一时刻只有一个连接在写
+    std::unique_lock<std::recursive_mutex> writeLock();
+
+    // 关闭连接：当前线程的连接立即关闭，其它线程的连接在其下次调用 db() 或线程退出时关闭
     void close();
 
    private:
+    /**
+     * @brief init() 解析出的连接参数，供各线程打开连接时使用
+     */
+    struct Settings {
+        QString driver;
+        QString database;
+        QString connectOptions;
+        bool foreignKeys = true;
+        QString journalMode;   ///< SQLite journal_mode，默认 WAL
+        QString synchronous;   ///< SQLite synchronous，默认 NORMAL
+        int busyTimeoutMs = 0;
+        int cacheSizeKiB = 0;
+        qint64 mmapSizeMiB = 0;
+    };
+
     DbManager() = default;
     ~DbManager() = default;
 
     DbManager(const DbManager&) = delete;
     DbManager& operator=(const DbManager&) = delete;
 
-    bool m_initialized{false};
-    QSqlDatabase m_db;         // 底层数据库对象（非共享指针）
-    QString m_connectionName;  // 连接名
+    // 为当前线程打开连接并应用 PRAGMA；失败时 error 为驱动返回的错误信息
+    bool openThreadConnection(QString& error);
+    void applyPragmas(QSqlDatabase& db, const Settings& settings);
+    // Storage/* 配置变化：PRAGMA 类参数更新后各线程连接在下次 db() 时重新应用
+    void onConfigChanged(const config::ConfigSnapshot& snapshot, const QStringList& keys);
+
+    std::atomic<bool> m_initialized{false};
+    std::atomic<quint64> m_generation{0};  // 每次 init/close 递增，旧连接据此失效
+    std::atomic<quint64> m_pragmaGeneration{0};  // PRAGMA 参数变化时递增，连接据此重新应用
+    quint64 m_configSubscription = 0;
+    mutable std::mutex m_mutex;            // 保护 m_settings / m_connectionPrefix
+    Settings m_settings;
+    QString m_connectionPrefix;  // 连接名前缀，各线程连接名 = 前缀 + 序号
+    std::atomic<quint64> m_connectionSerial{0};
+    std::recursive_mutex m_writeMutex;
     // 配置从 config 模块读取，不在此保存
 };
 
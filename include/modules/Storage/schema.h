@@ -0,0 +1,66 @@
+﻿#pragma once
+
+#include <QString>
+#include <QStringList>
+#include <QtSql/QSqlDatabase>
+#include <vector>
+
+namespace storage::schema {
+
+/**
+ * @brief 一次编号的结构迁移
+ *
+ * 迁移按 version 升序执行，每次迁移与其 schema_version 记录在同一个事务中提交；已发布的迁移
+ * 不再修改，结构变化一律追加新的迁移。
+ */
+struct Migration {
+    int version;              ///< 迁移编号，从 1 开始连续递增
+    const char* description;  ///< 写入 schema_version 的说明
+    bool (*apply)(QSqlDatabase& db);
+};
+
+/**
+ * @brief 按动作类型返回对应的表名（http/tcp/udp/serial）；未知类型没有对应的表，返回空字符串
+ */
+QString actionsTable(const QString& type);
+
+/**
+ * @brief 所有按类型划分的动作表
+ */
+const QStringList& actionTables();
+
+/**
+ * @brief 全部迁移，按 version 升序
+ */
+const std::vector<Migration>& migrations();
+
+/**
+ * @brief 最新迁移的编号
+ */
+int latestVersion();
+
+/**
+ * @brief 数据库已应用的最高迁移编号；尚无 schema_version 表时返回 0，查询失败返回 -1
+ */
+int currentVersion(QSqlDatabase& db);
+
+/**
+ * @brief 依次应用尚未执行的迁移
+ *
+ * 由 DbManager::init 在打开数据库后执行一次（持有写锁），读写路径不再执行 DDL。某个迁移失败时
+ * 回滚该迁移并停止，之后的迁移留待下次启动重试。数据库版本高于本程序已知的最新版本时只记录
+ * 警告，不做任何修改。
+ * @return 数据库已处于最新版本（或更新）时返回 true
+ */
+bool migrate(QSqlDatabase& db);
+
+/**
+ * @brief 将旧版 "actions" 表中的记录复制到按类型划分的表
+ *
+ * 按类型表中已存在的同名动作保持不变；未知类型的记录不复制。迁移 2 与
+ * Storage::migrateOldActions 共用此函数。
+ * @return 新复制的记录数；没有旧表时返回 0，失败返回 -1
+ */
+int importLegacyActions(QSqlDatabase& db);
+
+}  // namespace storage::schema
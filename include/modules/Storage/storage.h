@@ -2,6 +2,7 @@
 
 #include <QtGlobal>
 #include <QtSql/QSqlDatabase>
+#include <future>
 
 #ifdef Storage_EXPORTS
 #define STORAGE_EXPORT Q_DECL_EXPORT
@@ -23,22 +24,33 @@ class STORAGE_EXPORT Storage final {
     // Obtain reference to underlying QSqlDatabase (throws if not initialized)
     static QSqlDatabase& db();
 
-    // Save an action for a given type (e.g., "http", "tcp").
-    // Returns true on success. Name is used as primary key (overwrite if exists).
+    // Save an action for a given type ("http", "tcp", "udp" or "serial"; other types have no
+    // table and are rejected). Returns true on success. Name is used as primary key (overwrite
+    // if exists).
     static bool saveAction(const QString& type, const QString& name, const QByteArray& payload);
 
+    // Queue saveAction on the write-behind writer thread (group commit). The future becomes
+    // true once the transaction containing the write has committed.
+    static std::future<bool> saveActionAsync(const QString& type,
+                                             const QString& name,
+                                             const QByteArray& payload);
+
     // Load list of actions for a given type. Returns vector of (name, created_at).
     static QVector<QPair<QString, QString>> loadActions(const QString& type);
 
     // Load payload for a named action of given type. Returns empty QByteArray on failure.
     static QByteArray loadActionPayload(const QString& type, const QString& name);
 
-    // Migrate rows from legacy 'actions' table into per-type tables. Returns number migrated.
+    // Copy rows from the legacy 'actions' table into per-type tables, keeping existing
+    // per-type rows. Schema migration 2 already does this at startup. Returns number copied.
     static int migrateOldActions();
 
     // Delete a named action of given type. Returns true on success.
     static bool deleteAction(const QString& type, const QString& name);
 
+    // Queue deleteAction on the write-behind writer thread; see saveActionAsync.
+    static std::future<bool> deleteActionAsync(const QString& type, const QString& name);
+
     // Rename an action (oldName -> newName) for given type. Returns true on success.
     static bool renameAction(const QString& type, const QString& oldName, const QString& newName);
 };
@@ -0,0 +1,199 @@
+﻿#pragma once
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QtSql/QSqlDatabase>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+namespace storage {
+
+/**
+ * @brief 一个遥测数据点
+ */
+struct TelemetryPoint {
+    QString deviceId;
+    QString metric;
+    qint64 timestampMs = 0;  ///< Unix 毫秒时间戳（UTC）
+    double value = 0.0;
+};
+
+/**
+ * @brief 查询结果的时间粒度
+ */
+enum class TelemetryResolution {
+    Raw,     ///< 原始数据点
+    Minute,  ///< 1 分钟汇总
+    Hour,    ///< 1 小时汇总
+};
+
+/**
+ * @brief 查询结果中的一个样本；原始数据点的 count 为 1，min/max/sum 均为该点的值
+ */
+struct TelemetrySample {
+    QString metric;
+    qint64 timestampMs = 0;  ///< 原始点的时间戳，或汇总桶的起始时间
+    qint64 count = 0;
+    double min = 0.0;
+    double max = 0.0;
+    double sum = 0.0;
+
+    double avg() const { return count > 0 ? sum / static_cast<double>(count) : 0.0; }
+};
+
+/**
+ * @brief 遥测存储参数
+ */
+struct TelemetryOptions {
+    int batchSize = 4096;          ///< record() 缓冲多少个点后提交一次写入
+    int rawRetentionDays = 7;      ///< 原始数据保留天数
+    int minuteRetentionDays = 30;  ///< 1 分钟汇总保留天数
+    int hourRetentionDays = 365;   ///< 1 小时汇总保留天数
+    /// 列式段目录（按 UTC 日期分子目录），为空时不写列式段。默认为空；配置
+    /// Storage/telemetrySegments=true 时取 Storage/telemetrySegmentDir
+    QString segmentDirectory;
+    int segmentRows = 65536;  ///< 攒满多少个点写一个列式段
+};
+
+namespace columnar {
+struct ScanPredicate;
+struct ColumnRows;
+}  // namespace columnar
+
+namespace telemetry {
+
+/**
+ * @brief 写入一批数据点并增量更新 1m/1h 汇总
+ *
+ * 数据按 UTC 日期写入分区表 telemetry_raw_YYYYMMDD / telemetry_1m_YYYYMMDD，1h 汇总按月分区
+ * telemetry_1h_YYYYMM；分区在首次写入时创建并登记到 telemetry_partitions。原始表只追加，
+ * 汇总表按 (device_id, metric, bucket) 累加 count/sum 并合并 min/max，因此同一分钟内的多批
+ * 写入会合并到同一行。调用方负责事务与写锁。
+ * @return 全部语句执行成功时返回 true
+ */
+bool writeBatch(QSqlDatabase& db, const QVector<TelemetryPoint>& points);
+
+/**
+ * @brief 按设备查询时间区间 [fromMs, toMs] 内的数据，按 metric、时间升序返回
+ * @param metric 为空时返回该设备的全部指标
+ * @param limit 最多返回的样本数，<= 0 表示不限制
+ */
+QVector<TelemetrySample> query(QSqlDatabase& db,
+                               const QString& deviceId,
+                               const QString& metric,
+                               qint64 fromMs,
+                               qint64 toMs,
+                               TelemetryResolution resolution,
+                               int limit = 0);
+
+/**
+ * @brief 删除整体超出保留期的分区（DROP TABLE，不逐行 DELETE）
+ * @return 删除的分区数；失败返回 -1
+ */
+int dropExpiredPartitions(QSqlDatabase& db, qint64 nowMs, const TelemetryOptions& options);
+
+/**
+ * @brief 已登记的分区表名，按起始时间升序
+ */
+QStringList partitions(QSqlDatabase& db, TelemetryResolution resolution);
+
+}  // namespace telemetry
+
+/**
+ * @brief 遥测存储（单例）
+ *
+ * 写入经 WriteBehindQueue 在写线程上按批提交，调用线程不等待磁盘；查询在调用线程自己的连接上
+ * 执行。保留期清理在每个 UTC 日期的首次写入时随写入一起排队执行。
+ *
+ * 配置了 segmentDirectory 时（默认关闭），同一批数据还会攒成列式段（见 column_segment.h）写入磁盘，
+ * 供跨设备的大范围扫描使用；SQLite 分区继续服务按设备的区间查询与汇总。列式段由独立的段写
+ * 线程写出与清理，不占用数据库写线程和写锁；按日期目录整体删除，保留期与原始数据相同。
+ */
+class TelemetryStore {
+   public:
+    static TelemetryStore& instance();
+
+    /**
+     * @brief 提交一批数据点；future 在所在事务提交后置为 true
+     */
+    std::future<bool> append(QVector<TelemetryPoint> points);
+
+    /**
+     * @brief 缓冲单个数据点，攒满 batchSize 后提交
+     */
+    void record(const TelemetryPoint& point);
+
+    /**
+     * @brief 提交缓冲中的数据点并等待写入（包括列式段）完成；超时返回 false
+     */
+    bool flush(std::chrono::milliseconds timeout = std::chrono::seconds(5));
+
+    QVector<TelemetrySample> query(const QString& deviceId,
+                                   const QString& metric,
+                                   qint64 fromMs,
+                                   qint64 toMs,
+                                   TelemetryResolution resolution = TelemetryResolution::Raw,
+                                   int limit = 0);
+
+    /**
+     * @brief 扫描 [predicate.fromMs, predicate.toMs] 覆盖日期内的全部列式段
+     *
+     * 每个段调用一次 visitor，rows 中的设备/指标下标对应该段自己的字典。尚未攒满写出的点
+     * 不在扫描范围内。
+     * @param columns columnar::ColumnMask 的组合
+     * @return 扫描的段数；段目录未配置或读取失败返回 -1
+     */
+    int scanSegments(const columnar::ScanPredicate& predicate,
+                     unsigned columns,
+                     const std::function<void(const columnar::ColumnRows& rows)>& visitor);
+
+    /**
+     * @brief 立即执行保留期清理（持有写锁）；返回删除的分区数，失败返回 -1
+     */
+    int applyRetention();
+
+    void setOptions(const TelemetryOptions& options);
+    TelemetryOptions options() const;
+
+   private:
+    TelemetryStore();
+    ~TelemetryStore();
+
+    TelemetryStore(const TelemetryStore&) = delete;
+    TelemetryStore& operator=(const TelemetryStore&) = delete;
+
+    // 调用方持有 m_mutex；跨越 UTC 日期时排队一次保留期清理
+    void scheduleRetentionLocked();
+    // 调用方持有 m_mutex；取出攒好的列式段缓冲，由调用方释放锁后交给 submitSegmentBatch
+    QVector<TelemetryPoint> takeSegmentBatchLocked();
+    void submitSegmentBatch(const QString& root, QVector<TelemetryPoint> batch);
+    // 把任务交给段写线程（首次提交时启动）；积压的任务达到上限时阻塞调用线程
+    void submitSegmentJob(std::function<void()> job);
+    bool flushSegments(std::chrono::steady_clock::time_point deadline);
+    void stopSegmentWriter();
+    void segmentLoop();
+
+    mutable std::mutex m_mutex;
+    TelemetryOptions m_options;
+    QVector<TelemetryPoint> m_buffer;
+    QVector<TelemetryPoint> m_segmentBuffer;  // 等待写成列式段的点
+    std::optional<qint64> m_retentionDay;  // 最近一次排队清理时的 UTC 日序号
+
+    // 段写线程；加锁顺序 m_mutex -> m_segmentMutex，段写线程不获取 m_mutex
+    std::mutex m_segmentMutex;
+    std::condition_variable m_segmentCv;         // 有新任务或需要停止
+    std::condition_variable m_segmentDrainedCv;  // 一个任务完成
+    std::deque<std::function<void()>> m_segmentJobs;
+    bool m_segmentBusy = false;
+    bool m_segmentStopping = false;
+    std::thread m_segmentWriter;
+};
+
+}  // namespace storage
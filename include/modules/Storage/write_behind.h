@@ -0,0 +1,111 @@
+﻿#pragma once
+
+#include <QtSql/QSqlDatabase>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace storage {
+
+/**
+ * @brief 后台写入队列参数
+ */
+struct WriteBehindOptions {
+    int capacity = 4096;  ///< 等待提交的写操作上限，达到后 submit 阻塞到写线程取走一批
+    int maxBatch = 256;   ///< 单个事务最多包含的写操作数
+    /// 第一条写操作到达后最多再等待多久以攒成一批（组提交）
+    std::chrono::milliseconds commitDelay{5};
+};
+
+/**
+ * @brief 后台写入队列统计
+ */
+struct WriteBehindStats {
+    std::uint64_t submitted = 0;  ///< 成功入队的写操作数
+    std::uint64_t committed = 0;  ///< 已提交成功的写操作数
+    std::uint64_t failed = 0;     ///< 执行或提交失败的写操作数
+    std::uint64_t rejected = 0;   ///< 写线程内队列已满或正在停止时被拒绝的写操作数
+    std::uint64_t batches = 0;    ///< 已执行的事务数
+    std::size_t pending = 0;      ///< 当前排队中的写操作数
+};
+
+/**
+ * @brief 单写线程的后台写入队列（单例）
+ *
+ * 任意线程提交的写操作进入有界队列，由唯一的写线程按批在一个事务中执行：第一条写操作到达后
+ * 最多等待 commitDelay（或凑满 maxBatch）再提交，多次写入只付出一次提交开销，调用线程
+ * （界面、HTTP 处理线程）不再等待磁盘。每个写操作包在独立的 SAVEPOINT 中，单条失败只回滚
+ * 自身，不影响同批其它写操作。
+ *
+ * submit() 返回的 future 在所在事务提交后才置为 true，需要确认持久化的调用方可以等待它；
+ * 其余调用方可以直接丢弃 future。写操作在写线程上执行，通过参数或 DbManager::db()
+ * 拿到的都是写线程自己的连接。
+ */
+class WriteBehindQueue {
+   public:
+    using WriteOp = std::function<bool(QSqlDatabase& db)>;
+    using Clock = std::chrono::steady_clock;
+
+    static WriteBehindQueue& instance();
+
+    /**
+     * @brief 提交写操作；首次提交时启动写线程
+     *
+     * 队列已满时阻塞调用线程，直到写线程取走一批（背压），批量导入因此不会丢弃写入。
+     * 只有在写线程自身（写操作内部再次提交）遇到队列已满时才无法等待，此时返回的
+     * future 立即为 false 并计入 rejected。
+     */
+    std::future<bool> submit(WriteOp op);
+
+    /**
+     * @brief 等待此前提交的写操作全部提交完成；超时返回 false
+     */
+    bool flush(std::chrono::milliseconds timeout = std::chrono::seconds(5));
+
+    /**
+     * @brief 提交剩余写操作后停止写线程；之后再次 submit 会重新启动
+     *
+     * 停止过程中其他线程的 submit 被拒绝（future 立即为 false 并计入 rejected），
+     * 写线程在 shutdown 返回后才会重新启动。
+     */
+    void shutdown();
+
+    void setOptions(const WriteBehindOptions& options);
+    WriteBehindOptions options() const;
+    WriteBehindStats stats() const;
+
+   private:
+    struct Pending {
+        WriteOp op;
+        std::promise<bool> done;
+    };
+
+    WriteBehindQueue() = default;
+    ~WriteBehindQueue();
+
+    WriteBehindQueue(const WriteBehindQueue&) = delete;
+    WriteBehindQueue& operator=(const WriteBehindQueue&) = delete;
+
+    void writerLoop();
+    // 在一个事务中执行整批写操作，返回成功的写操作数
+    std::size_t commitBatch(std::vector<Pending>& batch);
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_pendingCv;  // 有新写操作或需要停止
+    std::condition_variable m_drainedCv;  // 一批提交完成
+    std::condition_variable m_spaceCv;    // 写线程取走一批，队列有空位
+    std::deque<Pending> m_pending;
+    std::size_t m_inFlight = 0;
+    bool m_stopping = false;
+    WriteBehindOptions m_options;
+    WriteBehindStats m_stats;
+    std::thread m_writer;
+};
+
+}  // namespace storage
@@ -7,6 +7,8 @@
 #include <QWidget>
 #include <optional>
 
+#include "modules/HumanRecognition/face_tracker.h"
+#include "modules/HumanRecognition/motion_gate.h"
 #include "modules/HumanRecognition/types.h"
 
 class QCamera;
@@ -69,6 +71,7 @@ class FaceRecognitionWidget : public QWidget {
     void onVideoFrame(const QVideoFrame& frame);
     void onAnimatedFrame(int frameNumber);
     void onDatabaseItemChanged(QStandardItem* item);
+    void onLiveDetectToggled(bool enabled);
 
    private:
     bool ensureBackendReady(bool warnAboutModel = true);
@@ -76,6 +79,11 @@ class FaceRecognitionWidget : public QWidget {
     void updatePreview(const QImage& image, const QVector<HumanRecognition::FaceBox>& boxes = {});
     void appendResult(std::size_t index, const DetectionEntry& entry);
     void resetDetections();
+    void runLiveDetection(const QImage& frame);
+    void applyLiveDetection(const QImage& frame,
+                            const HumanRecognition::MotionGate::Result& gate,
+                            const HumanRecognition::DetectResponse& response);
+    void applyLiveMatches(quint64 generation, const HumanRecognition::RecognizeResponse& response);
     void showError(const QString& message);
     void showInfo(const QString& message);
     bool ensureCamera();
@@ -125,11 +133,21 @@ class FaceRecognitionWidget : public QWidget {
     QLineEdit* personNameEdit_{nullptr};
     QPushButton* btnGenerateUuid_{nullptr};
     QCheckBox* autoMatchCheck_{nullptr};
+    QCheckBox* liveDetectCheck_{nullptr};
 
     QImage currentImage_;
     QVector<DetectionEntry> detections_;
     int selectedDetectionIndex_{-1};
     QVector<HumanRecognition::FaceBox> lastBoxes_;
+    /// 最近一次检测的帧上下文，供自动匹配/注册时复用预处理结果
+    HumanRecognition::FrameContextPtr lastFrameContext_;
+    /// 实时检测：运动门控跳过静止帧，仅在变化区域内检测；跟踪器避免重复识别同一人
+    HumanRecognition::MotionGate motionGate_;
+    HumanRecognition::FaceTracker faceTracker_;
+    QVector<HumanRecognition::FaceBox> liveBoxes_;
+    bool liveRequestPending_{false};  ///< 是否有实时检测请求在后台排队/执行
+    bool liveMatchPending_{false};    ///< 是否有轨迹识别请求在后台排队/执行
+    quint64 liveTrackGeneration_{0};  ///< 轨迹重置计数，用于丢弃重置前发出的识别结果
 
     FaceSourceMode currentSource_{FaceSourceMode::None};
     QString currentSourceDescription_;
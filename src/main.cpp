@@ -85,6 +85,10 @@ int main(int argc, char* argv[]) {
 
     // 初始化全局配置管理（使用组织/应用名统一存储）
     config::ConfigManager::instance().init("CrossControl", "CrossControl");
+    // 监视 CrossControlConfig.json，修改后变化的键直接推送给各模块，无需重启
+    if (config::ConfigManager::instance().setOrDefault("Config/hotReload", true).toBool()) {
+        config::ConfigManager::instance().enableHotReload();
+    }
 
     logging::useAsDefault("App");
 
@@ -134,6 +138,8 @@ int main(int argc, char* argv[]) {
     const int rc = a.exec();
 
     spdlog::info("Application exiting");
+    // 监视线程在应用对象销毁前停止
+    config::ConfigManager::instance().disableHotReload();
     // deviceGateway will be destroyed here as unique_ptr goes out of scope
     spdlog::shutdown();
     return rc;
@@ -3,12 +3,19 @@
 #include <QCoreApplication>
 #include <QDir>
 #include <QFile>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonValue>
 #include <QMetaType>
+#include <QThread>
+#include <QTimer>
+#include <algorithm>
 #include <functional>
+#include <utility>
+#include <vector>
 
 namespace config {
 
@@ -20,9 +27,23 @@ const char* ConfigManager::kEmbeddedDefaultJson = R"json({
         "foreignKeys": true
     },
     "HumanRecognition": {
+        "Backend": "opencv_dlib",
         "PersonsTable": "hr_persons",
         "MatchThreshold": 0.6,
-        "AutoCreateTable": true
+        "AutoCreateTable": true,
+        "GalleryEncoding": "float32",
+        "RerankTopK": 8,
+        "DetectThreads": 1,
+        "Detector": "hog",
+        "DnnDetectorModel": "",
+        "DnnInputSize": 320,
+        "DnnThreads": 0,
+        "ModelLoading": "prefetch",
+        "OnnxPersonsTable": "hr_persons_onnx",
+        "OnnxMatchThreshold": 0.6,
+        "OnnxIntraOpThreads": 0,
+        "OnnxDetectInputSize": 640,
+        "OnnxEmbeddingBatch": 16
     },
     "Connect": {
         "endpoint": "127.0.0.1:9000"
@@ -37,14 +58,245 @@ static void flattenJson(const QJsonValue& val,
                         const QString& prefix,
                         QMap<QString, QJsonValue>& out);
 
+namespace {
+
+// 与 setOrDefault/getOrDefault 的约定一致：无效、null 或空字符串视为未设置
+bool hasValue(const QVariant& v) {
+    if (!v.isValid() || v.isNull()) return false;
+    return !(v.canConvert<QString>() && v.toString().isEmpty());
+}
+
+// 解析 JSON 文本并扁平化为 "A/B" 形式的键
+bool parseFlatJson(const QByteArray& data, QMap<QString, QJsonValue>& flat) {
+    QJsonParseError err;
+    const QJsonDocument doc = QJsonDocument::fromJson(data, &err);
+    if (err.error != QJsonParseError::NoError) return false;
+    if (doc.isObject()) {
+        flattenJson(doc.object(), QString(), flat);
+    } else if (doc.isArray()) {
+        flattenJson(doc.array(), QString(), flat);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// JSON 值在 QSettings 中的存储形式：对象与数组存为紧凑 JSON 文本
+QVariant settingsValue(const QJsonValue& v) {
+    if (v.isString()) return v.toString();
+    if (v.isBool()) return v.toBool();
+    if (v.isDouble()) return v.toDouble();
+    if (v.isObject()) return QJsonDocument(v.toObject()).toJson(QJsonDocument::Compact);
+    if (v.isArray()) return QJsonDocument(v.toArray()).toJson(QJsonDocument::Compact);
+    return v.toVariant();
+}
+
+// 将扁平化的键值写入 QSettings（覆盖现有值）
+void applyFlatJson(QSettings* settings, const QMap<QString, QJsonValue>& flat) {
+    for (auto it = flat.constBegin(); it != flat.constEnd(); ++it) {
+        if (it.value().isNull()) {
+            settings->remove(it.key());
+        } else {
+            settings->setValue(it.key(), settingsValue(it.value()));
+        }
+    }
+    settings->sync();
+}
+
+// 从 INI 重新读出的值类型可能与 JSON 不同（例如 double 变为字符串），按文本比较兜底
+bool sameValue(const QVariant& a, const QVariant& b) {
+    if (a == b) return true;
+    if (!a.isValid() || !b.isValid()) return false;
+    return a.toString() == b.toString();
+}
+
+// 覆盖写入 JSON 配置文件
+bool writeJsonFile(const QString& path, const QByteArray& data) {
+    QFile out(path);
+    if (!out.open(QIODevice::WriteOnly | QIODevice::Text)) return false;
+    const bool ok = out.write(data) == data.size();
+    out.close();
+    return ok;
+}
+
+// 当前线程上正在执行的订阅回调，用于在回调内取消自身时不等待自己
+thread_local std::vector<quint64> t_runningSubscribers;
+
+}  // namespace
+
+/**
+ * @brief 配置文件监视器：独立线程上的 QFileSystemWatcher，防抖后解析并比较，只提交变化的键
+ *
+ * 同时监视文件与所在目录：编辑器常以"写临时文件再改名"的方式保存，原文件的监视会随之失效，
+ * 目录变化时重新加入。
+ */
+class ConfigManager::HotReloader {
+   public:
+    HotReloader(ConfigManager& owner, const QString& path, int debounceMs)
+        : owner_(owner), path_(QFileInfo(path).absoluteFilePath()), debounceMs_(debounceMs) {
+        context_ = new QObject();
+        context_->moveToThread(&thread_);
+        thread_.setObjectName(QStringLiteral("ConfigHotReload"));
+        thread_.start();
+        QMetaObject::invokeMethod(
+            context_, [this]() { setup(); }, Qt::BlockingQueuedConnection);
+    }
+
+    ~HotReloader() {
+        // 监视对象必须在所属线程上销毁
+        QMetaObject::invokeMethod(
+            context_, [this]() { delete context_; }, Qt::BlockingQueuedConnection);
+        thread_.quit();
+        thread_.wait();
+    }
+
+    const QString& path() const { return path_; }
+
+    /**
+     * @brief 把 setValue 的修改写回被监视的文件
+     *
+     * 文件内容与上次加载的不一致说明有尚未应用（防抖中或无法解析）的外部编辑，此时放弃写回，
+     * 以免覆盖用户的修改；修改仍保存在 INI 中。写回成功后以写入内容为新基线，监视线程不会
+     * 把自己的写入当作外部修改再加载一次。
+     */
+    bool writeBack(const QByteArray& data) {
+        std::lock_guard<std::mutex> lock(fileMutex_);
+        QFile current(path_);
+        if (current.open(QIODevice::ReadOnly) && current.readAll() != lastContent_) {
+            qInfo("Config hot reload: %s has pending edits, skipping write-back",
+                  qUtf8Printable(path_));
+            return false;
+        }
+        current.close();
+        if (!writeJsonFile(path_, data)) return false;
+        lastContent_ = data;
+        return true;
+    }
+
+   private:
+    void setup() {
+        watcher_ = new QFileSystemWatcher(context_);
+        debounce_ = new QTimer(context_);
+        debounce_->setSingleShot(true);
+        debounce_->setInterval(debounceMs_);
+        QObject::connect(debounce_, &QTimer::timeout, context_, [this]() { reload(); });
+        QObject::connect(watcher_, &QFileSystemWatcher::fileChanged, context_, [this]() {
+            watchFile();
+            debounce_->start();
+        });
+        QObject::connect(watcher_, &QFileSystemWatcher::directoryChanged, context_, [this]() {
+            if (watchFile()) debounce_->start();
+        });
+        watcher_->addPath(QFileInfo(path_).absolutePath());
+        watchFile();
+        // 以当前内容为基线，启动时不重复应用
+        std::lock_guard<std::mutex> lock(fileMutex_);
+        QFile f(path_);
+        if (f.open(QIODevice::ReadOnly)) lastContent_ = f.readAll();
+    }
+
+    // 文件存在但未被监视时重新加入，返回是否新加入
+    bool watchFile() {
+        if (!QFileInfo::exists(path_) || watcher_->files().contains(path_)) return false;
+        return watcher_->addPath(path_);
+    }
+
+    void reload() {
+        QMap<QString, QJsonValue> flat;
+        {
+            // 提交变化（需要写锁）前释放，writeBack 在持有写锁时获取 fileMutex_
+            std::lock_guard<std::mutex> lock(fileMutex_);
+            QFile f(path_);
+            if (!f.open(QIODevice::ReadOnly)) return;
+            const QByteArray data = f.readAll();
+            f.close();
+            if (data == lastContent_) return;
+            if (!parseFlatJson(data, flat)) {
+                qWarning("Config hot reload: %s is not valid JSON, keeping current configuration",
+                         qUtf8Printable(path_));
+                return;
+            }
+            lastContent_ = data;
+        }
+
+        // 在监视线程上比较，写锁只在提交变化时短暂持有
+        const auto current = owner_.snapshot();
+        QHash<QString, QVariant> changes;
+        for (auto it = flat.constBegin(); it != flat.constEnd(); ++it) {
+            if (it.value().isNull()) {
+                if (current->contains(it.key())) changes.insert(it.key(), QVariant());
+                continue;
+            }
+            const QVariant value = settingsValue(it.value());
+            if (!current->contains(it.key()) || !sameValue(current->value(it.key()), value)) {
+                changes.insert(it.key(), value);
+            }
+        }
+        if (changes.isEmpty()) return;
+        qInfo("Config hot reload: %d key(s) changed in %s",
+              static_cast<int>(changes.size()),
+              qUtf8Printable(path_));
+        owner_.applyReloaded(changes);
+    }
+
+    ConfigManager& owner_;
+    const QString path_;
+    const int debounceMs_;
+    QThread thread_;
+    QObject* context_ = nullptr;  // 以下对象的父对象，生存于 thread_
+    QFileSystemWatcher* watcher_ = nullptr;
+    QTimer* debounce_ = nullptr;
+    std::mutex fileMutex_;    // 保护 lastContent_ 与写回
+    QByteArray lastContent_;  // 最近一次加载或写回的文件内容
+};
+
+ConfigSnapshot::ConfigSnapshot(QHash<QString, QVariant> values, quint64 version)
+    : values_(std::move(values)), version_(version) {}
+
+QVariant ConfigSnapshot::value(const QString& key, const QVariant& defaultValue) const {
+    const auto it = values_.constFind(key);
+    return it == values_.cend() ? defaultValue : it.value();
+}
+
+bool ConfigSnapshot::getBool(const QString& key, bool defaultValue) const {
+    return value(key, defaultValue).toBool();
+}
+
+int ConfigSnapshot::getInt(const QString& key, int defaultValue) const {
+    return value(key, defaultValue).toInt();
+}
+
+double ConfigSnapshot::getDouble(const QString& key, double defaultValue) const {
+    return value(key, defaultValue).toDouble();
+}
+
+QString ConfigSnapshot::getString(const QString& key, const QString& defaultValue) const {
+    return value(key, defaultValue).toString();
+}
+
+QStringList ConfigSnapshot::diff(const ConfigSnapshot& other) const {
+    QStringList changed;
+    for (auto it = values_.cbegin(); it != values_.cend(); ++it) {
+        const auto o = other.values_.constFind(it.key());
+        // setValue 发布的是原类型，republishLocked 从 INI 读回的是字符串，只按文本比较
+        if (o == other.values_.cend() || !sameValue(o.value(), it.value())) changed << it.key();
+    }
+    for (auto it = other.values_.cbegin(); it != other.values_.cend(); ++it) {
+        if (!values_.contains(it.key())) changed << it.key();
+    }
+    changed.sort();
+    return changed;
+}
+
 ConfigManager& ConfigManager::instance() {
     static ConfigManager inst;
     return inst;
 }
 
-ConfigManager::ConfigManager() {}
+ConfigManager::ConfigManager() : snapshot_(std::make_shared<const ConfigSnapshot>()) {}
 
 ConfigManager::~ConfigManager() {
+    disableHotReload();
     if (settings_) {
         settings_->sync();
         delete settings_;
@@ -53,59 +305,38 @@ ConfigManager::~ConfigManager() {
 }
 
 void ConfigManager::init(const QString& organization, const QString& application) {
-    if (settings_) return;  // 已初始化
-
-    if (!organization.isEmpty() || !application.isEmpty()) {
-        QCoreApplication::setOrganizationName(organization);
-        QCoreApplication::setApplicationName(application);
-    }
+    QStringList changed;
+    {
+        std::lock_guard<std::recursive_mutex> lock(writeMutex_);
+        if (settings_) return;  // 已初始化
+
+        if (!organization.isEmpty() || !application.isEmpty()) {
+            QCoreApplication::setOrganizationName(organization);
+            QCoreApplication::setApplicationName(application);
+        }
 
-    settings_ = new QSettings(QSettings::IniFormat,
-                              QSettings::UserScope,
-                              QCoreApplication::organizationName(),
-                              QCoreApplication::applicationName());
+        settings_ = new QSettings(QSettings::IniFormat,
+                                  QSettings::UserScope,
+                                  QCoreApplication::organizationName(),
+                                  QCoreApplication::applicationName());
 
-    // 自动尝试在应用程序目录中发现 CrossControlConfig.json 并加载
-    const QString appDir = QCoreApplication::applicationDirPath();
-    const QString candidate = QDir(appDir).filePath("CrossControlConfig.json");
-    if (QFile::exists(candidate)) {
-        loadFromJsonFile(candidate);
-    } else {
-        // Load embedded defaults if external config not present. Do not remember path so saves will
-        // go to app dir by default.
-        QJsonParseError err;
-        const QByteArray data = QByteArray::fromStdString(std::string(kEmbeddedDefaultJson));
-        const QJsonDocument doc = QJsonDocument::fromJson(data, &err);
-        if (err.error == QJsonParseError::NoError) {
+        // 自动尝试在应用程序目录中发现 CrossControlConfig.json 并加载
+        const QString appDir = QCoreApplication::applicationDirPath();
+        const QString candidate = QDir(appDir).filePath("CrossControlConfig.json");
+        if (QFile::exists(candidate)) {
+            loadJsonFileLocked(candidate, true);
+        } else {
+            // Load embedded defaults if external config not present. Do not remember path so saves
+            // will go to app dir by default.
             QMap<QString, QJsonValue> flat;
-            if (doc.isObject())
-                flattenJson(doc.object(), QString(), flat);
-            else if (doc.isArray())
-                flattenJson(doc.array(), QString(), flat);
-
-            for (auto it = flat.constBegin(); it != flat.constEnd(); ++it) {
-                const QString key = it.key();
-                const QJsonValue v = it.value();
-                if (v.isString())
-                    settings_->setValue(key, v.toString());
-                else if (v.isBool())
-                    settings_->setValue(key, v.toBool());
-                else if (v.isDouble())
-                    settings_->setValue(key, v.toDouble());
-                else if (v.isObject())
-                    settings_->setValue(key,
-                                        QJsonDocument(v.toObject()).toJson(QJsonDocument::Compact));
-                else if (v.isArray())
-                    settings_->setValue(key,
-                                        QJsonDocument(v.toArray()).toJson(QJsonDocument::Compact));
-                else if (v.isNull())
-                    settings_->remove(key);
-                else
-                    settings_->setValue(key, v.toVariant());
+            if (parseFlatJson(QByteArray(kEmbeddedDefaultJson), flat)) {
+                applyFlatJson(settings_, flat);
             }
-            settings_->sync();
         }
+        // 首个快照包含 INI 中已有的全部键
+        changed = republishLocked();
     }
+    notify(changed);
 }
 
 /* @brief 将一个 JSON 值扁平化为一个扁平的键值映射。
@@ -139,90 +370,51 @@ static void flattenJson(const QJsonValue& val,
  * @return false
  */
 bool ConfigManager::loadFromJsonFile(const QString& path, bool rememberPath) {
+    QStringList changed;
+    bool ok = false;
+    {
+        std::lock_guard<std::recursive_mutex> lock(writeMutex_);
+        ok = loadJsonFileLocked(path, rememberPath);
+        if (ok) changed = republishLocked();
+    }
+    notify(changed);
+    return ok;
+}
+
+bool ConfigManager::loadJsonFileLocked(const QString& path, bool rememberPath) {
+    if (!settings_) return false;
     QFile f(path);
     if (!f.open(QIODevice::ReadOnly | QIODevice::Text)) return false;
     const QByteArray data = f.readAll();
     f.close();
 
-    QJsonParseError err;
-    const QJsonDocument doc = QJsonDocument::fromJson(data, &err);
-    if (err.error != QJsonParseError::NoError) return false;
-
     QMap<QString, QJsonValue> flat;
-    if (doc.isObject()) {
-        flattenJson(doc.object(), QString(), flat);
-    } else if (doc.isArray()) {
-        flattenJson(doc.array(), QString(), flat);
-    } else {
-        return false;
-    }
-
-    // 将解析出的键值写入 QSettings（覆盖现有值）
-    for (auto it = flat.constBegin(); it != flat.constEnd(); ++it) {
-        const QString key = it.key();
-        const QJsonValue v = it.value();
-        if (v.isString()) {
-            settings_->setValue(key, v.toString());
-        } else if (v.isBool()) {
-            settings_->setValue(key, v.toBool());
-        } else if (v.isDouble()) {
-            settings_->setValue(key, v.toDouble());
-        } else if (v.isObject()) {
-            settings_->setValue(key, QJsonDocument(v.toObject()).toJson(QJsonDocument::Compact));
-        } else if (v.isArray()) {
-            settings_->setValue(key, QJsonDocument(v.toArray()).toJson(QJsonDocument::Compact));
-        } else if (v.isNull()) {
-            settings_->remove(key);
-        } else {
-            settings_->setValue(key, v.toVariant());
-        }
-    }
-
-    settings_->sync();
+    if (!parseFlatJson(data, flat)) return false;
+    applyFlatJson(settings_, flat);
     // remember path for future saves (if requested)
     if (rememberPath) jsonFilePath_ = path;
     return true;
 }
 
 bool ConfigManager::loadFromJsonString(const QString& json, bool rememberPath) {
-    QJsonParseError err;
-    const QByteArray data = json.toUtf8();
-    const QJsonDocument doc = QJsonDocument::fromJson(data, &err);
-    if (err.error != QJsonParseError::NoError) return false;
-
-    QMap<QString, QJsonValue> flat;
-    if (doc.isObject())
-        flattenJson(doc.object(), QString(), flat);
-    else if (doc.isArray())
-        flattenJson(doc.array(), QString(), flat);
-    else
-        return false;
-
-    for (auto it = flat.constBegin(); it != flat.constEnd(); ++it) {
-        const QString key = it.key();
-        const QJsonValue v = it.value();
-        if (v.isString())
-            settings_->setValue(key, v.toString());
-        else if (v.isBool())
-            settings_->setValue(key, v.toBool());
-        else if (v.isDouble())
-            settings_->setValue(key, v.toDouble());
-        else if (v.isObject())
-            settings_->setValue(key, QJsonDocument(v.toObject()).toJson(QJsonDocument::Compact));
-        else if (v.isArray())
-            settings_->setValue(key, QJsonDocument(v.toArray()).toJson(QJsonDocument::Compact));
-        else if (v.isNull())
-            settings_->remove(key);
-        else
-            settings_->setValue(key, v.toVariant());
+    QStringList changed;
+    {
+        std::lock_guard<std::recursive_mutex> lock(writeMutex_);
+        if (!settings_) return false;
+        QMap<QString, QJsonValue> flat;
+        if (!parseFlatJson(json.toUtf8(), flat)) return false;
+        applyFlatJson(settings_, flat);
+        if (rememberPath && jsonFilePath_.isEmpty())
+            jsonFilePath_ = QCoreApplication::applicationDirPath() + "/CrossControlConfig.json";
+        changed = republishLocked();
     }
-    settings_->sync();
-    if (rememberPath && jsonFilePath_.isEmpty())
-        jsonFilePath_ = QCoreApplication::applicationDirPath() + "/CrossControlConfig.json";
+    notify(changed);
     return true;
 }
 
 QString ConfigManager::toJsonString() const {
+    // 热加载线程会并发写入 settings_
+    std::lock_guard<std::recursive_mutex> lock(writeMutex_);
     if (!settings_) return QString();
     const QStringList keys = settings_->allKeys();
     std::function<void(QJsonObject&, const QStringList&, int, const QJsonValue&)> setNested;
@@ -274,225 +466,99 @@ QString ConfigManager::toJsonString() const {
 // Save QSettings contents back to a JSON file. If path empty, use remembered jsonFilePath_ or app
 // dir
 bool ConfigManager::saveToJsonFile(const QString& path) const {
+    std::lock_guard<std::recursive_mutex> lock(writeMutex_);
     if (!settings_) return false;
+    return writeJsonFile(path.isEmpty() ? jsonFilePathLocked() : path, toJsonString().toUtf8());
+}
 
-    QString outPath = path;
-    if (outPath.isEmpty()) {
-        if (!jsonFilePath_.isEmpty())
-            outPath = jsonFilePath_;
-        else
-            outPath = QCoreApplication::applicationDirPath() + "/CrossControlConfig.json";
-    }
-
-    // build a JSON object from flat keys (keys may contain '/') and unflatten into nested objects
-    QJsonObject root;
-    const QStringList keys = settings_->allKeys();
-    for (const QString& fullKey : keys) {
-        QVariant v = settings_->value(fullKey);
-
-        QJsonValue jsonVal;
-        // try to parse strings that are JSON
-        if (v.typeId() == QMetaType::QString) {
-            const QString s = v.toString();
-            QJsonParseError perr;
-            QJsonDocument doc = QJsonDocument::fromJson(s.toUtf8(), &perr);
-            if (perr.error == QJsonParseError::NoError) {
-                if (doc.isObject())
-                    jsonVal = doc.object();
-                else if (doc.isArray())
-                    jsonVal = doc.array();
-                else
-                    jsonVal = QJsonValue(s);
-            } else {
-                jsonVal = QJsonValue(s);
-            }
-        } else if (v.typeId() == QMetaType::Bool) {
-            jsonVal = QJsonValue(v.toBool());
-        } else if (v.canConvert<double>()) {
-            jsonVal = QJsonValue(v.toDouble());
-        } else {
-            jsonVal = QJsonValue(v.toString());
-        }
-
-        // unflatten into root by splitting on '/'
-        QStringList parts = fullKey.split('/', Qt::SkipEmptyParts);
-        QJsonObject* current = &root;
-        for (int i = 0; i < parts.size(); ++i) {
-            const QString& p = parts[i];
-            if (i == parts.size() - 1) {
-                current->insert(p, jsonVal);
-            } else {
-                QJsonValue child = current->value(p);
-                if (!child.isObject()) {
-                    // replace non-object or missing with an object
-                    QJsonObject obj;
-                    current->insert(p, obj);
-                    child = current->value(p);
-                }
-                // move deeper
-                QJsonObject nested = child.toObject();
-                // Need to keep a reference; workaround by updating current to a temporary object
-                // pointer We'll update the parent object after inserting deeper entries. Simpler
-                // approach: operate via a stack of object paths using mutable objects. To keep this
-                // implementation concise, extract nested, and set pointer via local variable hack.
-                // Create a mutable copy path: rebuild nested pointers at end when writing; for now,
-                // we will work by recursively merging which is acceptable for small config sizes.
-                // Approach: set current to a temporary object stored in root by reference? C++
-                // doesn't allow. Instead, use iterative merging: get reference to nested by
-                // creating a reference in a map? Simpler: use helper function.
-            }
-        }
-    }
-
-    // Because creating nested QJsonObject references in-place is cumbersome, implement a second
-    // pass that merges each key
-    QJsonObject finalRoot;
-    for (const QString& fullKey : keys) {
-        QVariant v = settings_->value(fullKey);
-        QJsonValue jsonVal;
-        if (v.typeId() == QMetaType::QString) {
-            const QString s = v.toString();
-            QJsonParseError perr;
-            QJsonDocument doc = QJsonDocument::fromJson(s.toUtf8(), &perr);
-            if (perr.error == QJsonParseError::NoError) {
-                if (doc.isObject())
-                    jsonVal = doc.object();
-                else if (doc.isArray())
-                    jsonVal = doc.array();
-                else
-                    jsonVal = QJsonValue(s);
-            } else {
-                jsonVal = QJsonValue(s);
-            }
-        } else if (v.typeId() == QMetaType::Bool) {
-            jsonVal = QJsonValue(v.toBool());
-        } else if (v.canConvert<double>()) {
-            jsonVal = QJsonValue(v.toDouble());
-        } else {
-            jsonVal = QJsonValue(v.toString());
-        }
-
-        QStringList parts = fullKey.split('/', Qt::SkipEmptyParts);
-        QJsonObject* cursor = &finalRoot;
-        for (int i = 0; i < parts.size(); ++i) {
-            const QString& part = parts[i];
-            if (i == parts.size() - 1) {
-                cursor->insert(part, jsonVal);
-            } else {
-                QJsonValue existing = cursor->value(part);
-                if (!existing.isObject()) {
-                    // create
-                    QJsonObject obj;
-                    cursor->insert(part, obj);
-                    existing = cursor->value(part);
-                }
-                QJsonObject nested = existing.toObject();
-                // replace the object in-place to get a mutable reference
-                cursor->insert(part, nested);
-                // get pointer to nested inside finalRoot via lookup again
-                QJsonValue lookup = cursor->value(part);
-                QJsonObject tmp = lookup.toObject();
-                // To modify nested, we need to assign back later. Use a stack of parent pointers:
-                // simpler approach is to descend by keeping a vector of keys and rebuild finalRoot
-                // after all insertions. For small config it's fine. Use a helper: create a
-                // reference path and set using recursive function below. We'll use the recursive
-                // setter defined next.
-            }
-        }
-    }
-
-    // Implement recursive setter to properly merge nested objects
-    std::function<void(QJsonObject&, const QStringList&, int, const QJsonValue&)> setNested;
-    setNested = [&](QJsonObject& obj, const QStringList& parts, int idx, const QJsonValue& val) {
-        const QString& key = parts[idx];
-        if (idx == parts.size() - 1) {
-            obj.insert(key, val);
-            return;
-        }
-        QJsonValue child = obj.value(key);
-        QJsonObject childObj = child.isObject() ? child.toObject() : QJsonObject();
-        setNested(childObj, parts, idx + 1, val);
-        obj.insert(key, childObj);
-    };
+QString ConfigManager::jsonFilePathLocked() const {
+    return jsonFilePath_.isEmpty()
+               ? QCoreApplication::applicationDirPath() + "/CrossControlConfig.json"
+               : jsonFilePath_;
+}
 
-    QJsonObject mergedRoot;
-    for (const QString& fullKey : keys) {
-        QVariant v = settings_->value(fullKey);
-        QJsonValue jsonVal;
-        if (v.typeId() == QMetaType::QString) {
-            const QString s = v.toString();
-            QJsonParseError perr;
-            QJsonDocument doc = QJsonDocument::fromJson(s.toUtf8(), &perr);
-            if (perr.error == QJsonParseError::NoError) {
-                if (doc.isObject())
-                    jsonVal = doc.object();
-                else if (doc.isArray())
-                    jsonVal = doc.array();
-                else
-                    jsonVal = QJsonValue(s);
-            } else {
-                jsonVal = QJsonValue(s);
-            }
-        } else if (v.typeId() == QMetaType::Bool) {
-            jsonVal = QJsonValue(v.toBool());
-        } else if (v.canConvert<double>()) {
-            jsonVal = QJsonValue(v.toDouble());
-        } else {
-            jsonVal = QJsonValue(v.toString());
-        }
-        QStringList parts = fullKey.split('/', Qt::SkipEmptyParts);
-        if (parts.isEmpty()) continue;
-        setNested(mergedRoot, parts, 0, jsonVal);
+void ConfigManager::writeBackLocked() {
+    const QString path = jsonFilePathLocked();
+    std::lock_guard<std::mutex> lock(hotReloadMutex_);
+    if (hotReloader_ && hotReloader_->path() == QFileInfo(path).absoluteFilePath()) {
+        hotReloader_->writeBack(toJsonString().toUtf8());
+        return;
     }
-
-    QJsonDocument outDoc(mergedRoot);
-    QFile out(outPath);
-    if (!out.open(QIODevice::WriteOnly | QIODevice::Text)) return false;
-    out.write(outDoc.toJson(QJsonDocument::Indented));
-    out.close();
-    return true;
+    writeJsonFile(path, toJsonString().toUtf8());
 }
 
 QVariant ConfigManager::getValue(const QString& key, const QVariant& defaultValue) const {
     if (!settings_) return defaultValue;
-    return settings_->value(key, defaultValue);
+    return current().value(key, defaultValue);
 }
 
 void ConfigManager::setValue(const QString& key, const QVariant& value) {
     if (!settings_) init();
-    settings_->setValue(key, value);
-    settings_->sync();
-    // attempt to persist back to JSON immediately (two-way sync). Ignore failures here.
-    saveToJsonFile();
+    QStringList changed;
+    {
+        std::lock_guard<std::recursive_mutex> lock(writeMutex_);
+        settings_->setValue(key, value);
+        settings_->sync();
+        // 写时复制：在旧快照的副本上修改后整体替换
+        QHash<QString, QVariant> values = snapshot_.load()->values();
+        values.insert(key, value);
+        changed = publishLocked(std::move(values));
+        // attempt to persist back to JSON immediately (two-way sync). Ignore failures here.
+        writeBackLocked();
+    }
+    notify(changed);
 }
 
 QVariant ConfigManager::setOrDefault(const QString& key, const QVariant& defaultValue) {
     if (!settings_) init();
-    const QVariant v = settings_->value(key, QVariant());
-    if (!v.isValid() || v.isNull()) {
-        settings_->setValue(key, defaultValue);
-        settings_->sync();
-        return defaultValue;
-    }
-    if (v.canConvert<QString>() && v.toString().isEmpty()) {
-        settings_->setValue(key, defaultValue);
-        settings_->sync();
-        return defaultValue;
+    // 已有值时只读快照；只有首次写入默认值才进入写路径
+    const QVariant cached = current().value(key);
+    if (hasValue(cached)) return cached;
+
+    QStringList changed;
+    QVariant result = defaultValue;
+    {
+        std::lock_guard<std::recursive_mutex> lock(writeMutex_);
+        const QVariant v = settings_->value(key, QVariant());
+        if (hasValue(v)) {
+            result = v;
+        } else {
+            settings_->setValue(key, defaultValue);
+            settings_->sync();
+            QHash<QString, QVariant> values = snapshot_.load()->values();
+            values.insert(key, defaultValue);
+            changed = publishLocked(std::move(values));
+        }
     }
-    return v;
+    notify(changed);
+    return result;
 }
 
 void ConfigManager::remove(const QString& key) {
     if (!settings_) return;
-    settings_->remove(key);
+    QStringList changed;
+    {
+        std::lock_guard<std::recursive_mutex> lock(writeMutex_);
+        settings_->remove(key);
+        changed = republishLocked();
+    }
+    notify(changed);
 }
 
 void ConfigManager::sync() {
     if (!settings_) return;
-    settings_->sync();
+    QStringList changed;
+    {
+        std::lock_guard<std::recursive_mutex> lock(writeMutex_);
+        // sync 会重新读取 INI，其它进程的修改在这里进入快照
+        settings_->sync();
+        changed = republishLocked();
+    }
+    notify(changed);
 }
 
 QStringList ConfigManager::allKeys() const {
+    std::lock_guard<std::recursive_mutex> lock(writeMutex_);
     if (!settings_) return {};
     return settings_->allKeys();
 }
@@ -519,4 +585,156 @@ QVariant ConfigManager::getOrDefault(const QString& key, const QVariant& default
     return v;
 }
 
+std::shared_ptr<const ConfigSnapshot> ConfigManager::snapshot() const {
+    return snapshot_.load(std::memory_order_acquire);
+}
+
+quint64 ConfigManager::subscribe(const QString& prefix, ChangeCallback callback) {
+    if (!callback) return 0;
+    auto subscriber = std::make_shared<Subscriber>();
+    subscriber->prefix = prefix;
+    while (subscriber->prefix.endsWith('/')) subscriber->prefix.chop(1);
+    subscriber->callback = std::move(callback);
+    std::lock_guard<std::mutex> lock(subscribersMutex_);
+    const quint64 id = ++nextSubscriberId_;
+    subscribers_.insert(id, std::move(subscriber));
+    return id;
+}
+
+void ConfigManager::unsubscribe(quint64 id) {
+    std::unique_lock<std::mutex> lock(subscribersMutex_);
+    const std::shared_ptr<Subscriber> subscriber = subscribers_.take(id);
+    if (!subscriber) return;
+    subscriber->active = false;
+    // 在自身回调中（可能经由回调内的写入而嵌套）取消时不能等待自己
+    const auto own = std::count(t_runningSubscribers.cbegin(), t_runningSubscribers.cend(), id);
+    subscribersCv_.wait(lock, [&subscriber, own]() { return subscriber->running <= own; });
+}
+
+bool ConfigManager::enableHotReload(const QString& path, int debounceMs) {
+    QString target = path;
+    if (target.isEmpty()) {
+        std::lock_guard<std::recursive_mutex> lock(writeMutex_);
+        target = jsonFilePathLocked();
+    }
+    if (!QFileInfo(QFileInfo(target).absolutePath()).isDir()) return false;
+
+    auto reloader = std::make_unique<HotReloader>(*this, target, std::max(0, debounceMs));
+    {
+        std::lock_guard<std::mutex> lock(hotReloadMutex_);
+        if (hotReloader_ && hotReloader_->path() == reloader->path()) return true;
+        std::swap(reloader, hotReloader_);
+    }
+    // 旧的监视器在锁外停止：它的线程可能正等待写锁，而写锁持有者可能在等 hotReloadMutex_
+    reloader.reset();
+    return true;
+}
+
+void ConfigManager::disableHotReload() {
+    std::unique_ptr<HotReloader> reloader;
+    {
+        std::lock_guard<std::mutex> lock(hotReloadMutex_);
+        reloader = std::move(hotReloader_);
+    }
+    reloader.reset();
+}
+
+bool ConfigManager::hotReloadEnabled() const {
+    std::lock_guard<std::mutex> lock(hotReloadMutex_);
+    return hotReloader_ != nullptr;
+}
+
+const ConfigSnapshot& ConfigManager::current() const {
+    // 每个线程持有一份快照引用，版本号未变时读取只有一次原子读
+    thread_local std::shared_ptr<const ConfigSnapshot> cached;
+    if (!cached || cached->version() != snapshotVersion_.load(std::memory_order_acquire)) {
+        cached = snapshot_.load(std::memory_order_acquire);
+    }
+    return *cached;
+}
+
+QStringList ConfigManager::publishLocked(QHash<QString, QVariant> values) {
+    const auto previous = snapshot_.load(std::memory_order_acquire);
+    auto next = std::make_shared<const ConfigSnapshot>(std::move(values), previous->version() + 1);
+    QStringList changed = next->diff(*previous);
+    if (changed.isEmpty()) return changed;
+    snapshot_.store(next, std::memory_order_release);
+    snapshotVersion_.store(next->version(), std::memory_order_release);
+    return changed;
+}
+
+QStringList ConfigManager::republishLocked() {
+    QHash<QString, QVariant> values;
+    const QStringList keys = settings_->allKeys();
+    values.reserve(keys.size());
+    for (const QString& key : keys) values.insert(key, settings_->value(key));
+    return publishLocked(std::move(values));
+}
+
+void ConfigManager::notify(const QStringList& changedKeys) {
+    if (changedKeys.isEmpty()) return;
+    struct Call {
+        quint64 id;
+        std::shared_ptr<Subscriber> subscriber;
+        QStringList keys;
+    };
+    std::vector<Call> calls;
+    {
+        std::lock_guard<std::mutex> lock(subscribersMutex_);
+        for (auto it = subscribers_.cbegin(); it != subscribers_.cend(); ++it) {
+            const QString& prefix = it.value()->prefix;
+            QStringList matched;
+            for (const QString& key : changedKeys) {
+                if (prefix.isEmpty() || key == prefix ||
+                    (key.startsWith(prefix) && key.at(prefix.size()) == '/')) {
+                    matched << key;
+                }
+            }
+            if (!matched.isEmpty()) calls.push_back({it.key(), it.value(), std::move(matched)});
+        }
+    }
+    if (calls.empty()) return;
+    const auto latest = snapshot();
+    for (const Call& call : calls) {
+        {
+            std::lock_guard<std::mutex> lock(subscribersMutex_);
+            if (!call.subscriber->active) continue;
+            ++call.subscriber->running;
+        }
+        t_runningSubscribers.push_back(call.id);
+        try {
+            call.subscriber->callback(*latest, call.keys);
+        } catch (...) {
+            // 单个订阅者的异常不影响其它订阅者与写入方
+        }
+        t_runningSubscribers.pop_back();
+        {
+            std::lock_guard<std::mutex> lock(subscribersMutex_);
+            --call.subscriber->running;
+        }
+        subscribersCv_.notify_all();
+    }
+}
+
+void ConfigManager::applyReloaded(const QHash<QString, QVariant>& changes) {
+    QStringList changed;
+    {
+        std::lock_guard<std::recursive_mutex> lock(writeMutex_);
+        if (!settings_) return;
+        QHash<QString, QVariant> values = snapshot_.load()->values();
+        for (auto it = changes.cbegin(); it != changes.cend(); ++it) {
+            if (it.value().isValid()) {
+                settings_->setValue(it.key(), it.value());
+                values.insert(it.key(), it.value());
+            } else {
+                settings_->remove(it.key());
+                values.remove(it.key());
+            }
+        }
+        settings_->sync();
+        changed = publishLocked(std::move(values));
+    }
+    notify(changed);
+}
+
 }  // namespace config
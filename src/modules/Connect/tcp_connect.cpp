@@ -6,7 +6,10 @@
 
 TcpConnect::TcpConnect() = default;
 
-TcpConnect::TcpConnect(const QString& endpoint, bool autoOpen) : TcpConnect() {
+TcpConnect::TcpConnect(const Options& options) : m_options(options) {}
+
+TcpConnect::TcpConnect(const QString& endpoint, bool autoOpen, const Options& options)
+    : m_options(options) {
     if (autoOpen) open(endpoint);
 }
 
@@ -44,8 +47,7 @@ bool TcpConnect::open(const QString& endpoint) {
 
     m_socket.abort();
     m_socket.connectToHost(host, static_cast<quint16>(port));
-    // 最多等待 3 秒
-    if (!m_socket.waitForConnected(3000)) { return false; }
+    if (!m_socket.waitForConnected(m_options.connectTimeoutMs)) { return false; }
     return true;
 }
 
@@ -56,13 +58,13 @@ void TcpConnect::close() {
 qint64 TcpConnect::send(const QByteArray& data) {
     if (!isOpen()) return -1;
     qint64 written = m_socket.write(data);
-    if (!m_socket.waitForBytesWritten(3000)) { return -1; }
+    if (!m_socket.waitForBytesWritten(m_options.writeTimeoutMs)) { return -1; }
     return written;
 }
 
 qint64 TcpConnect::receive(QByteArray& out, qint64 maxBytes) {
     if (!isOpen()) return -1;
-    if (!m_socket.waitForReadyRead(100)) {
+    if (m_socket.bytesAvailable() <= 0 && !m_socket.waitForReadyRead(m_options.readTimeoutMs)) {
         // 没有数据
         return 0;
     }
@@ -0,0 +1,332 @@
+﻿#include "timer_wheel.h"
+
+#include <algorithm>
+#include <exception>
+#include <limits>
+
+namespace {
+
+constexpr TimerId makeId(int index, quint32 generation) {
+    return (static_cast<TimerId>(generation) << 32) | static_cast<TimerId>(index + 1);
+}
+
+TimerWheelOptions normalized(TimerWheelOptions options) {
+    options.tick = std::max(std::chrono::milliseconds(1), options.tick);
+    options.slotBits = std::clamp(options.slotBits, 1, 16);
+    // 总位数不超过 62，保证 tick 计数与位移不溢出
+    options.levels = std::clamp(options.levels, 1, 62 / options.slotBits);
+    return options;
+}
+
+}  // namespace
+
+TimerWheel& TimerWheel::instance() {
+    static TimerWheel inst;
+    static std::once_flag started;
+    std::call_once(started, []() { inst.start(); });
+    return inst;
+}
+
+TimerWheel::TimerWheel(TimerWheelOptions options)
+    : m_options(normalized(options)),
+      m_slots(1 << m_options.slotBits),
+      m_slotMask(m_slots - 1),
+      m_buckets(static_cast<std::size_t>(m_options.levels) * m_slots, -1) {}
+
+TimerWheel::~TimerWheel() {
+    stop();
+}
+
+TimerId TimerWheel::schedule(std::chrono::milliseconds delay, Callback callback) {
+    if (!callback) return 0;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return insertLocked(ticksFor(delay), 0, std::move(callback));
+}
+
+TimerId TimerWheel::scheduleRepeating(std::chrono::milliseconds period, Callback callback) {
+    if (!callback) return 0;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const qint64 ticks = ticksFor(period);
+    return insertLocked(ticks, ticks, std::move(callback));
+}
+
+bool TimerWheel::cancel(TimerId id) {
+    if (id == 0) return false;
+    std::unique_lock<std::mutex> lock(m_mutex);
+    bool found = false;
+    const int index = indexOf(id);
+    if (index >= 0) {
+        unlinkLocked(index);
+        releaseLocked(index);
+        found = true;
+    }
+    if (m_running == id) {
+        found = true;
+        // 在回调内部取消自身时不能等待自己
+        if (m_runningThread != std::this_thread::get_id()) {
+            m_runningCv.wait(lock, [this, id]() { return m_running != id; });
+        }
+    }
+    return found;
+}
+
+void TimerWheel::start() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_thread.joinable()) return;
+    m_stopping = false;
+    // 让当前 tick 与真实时间对齐，手动推进过的进度得以保留
+    m_origin = Clock::now() - m_options.tick * m_currentTick;
+    m_thread = std::thread(&TimerWheel::run, this);
+}
+
+void TimerWheel::stop() {
+    std::thread driver;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_thread.joinable()) return;
+        m_stopping = true;
+        driver = std::move(m_thread);
+    }
+    m_wakeCv.notify_all();
+    driver.join();
+}
+
+int TimerWheel::advance(std::chrono::milliseconds elapsed) {
+    qint64 target = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        target = m_currentTick + std::max<qint64>(0, elapsed / m_options.tick);
+    }
+    return runUntil(target);
+}
+
+std::size_t TimerWheel::pending() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_pending;
+}
+
+TimerId TimerWheel::insertLocked(qint64 ticks, qint64 periodTicks, Callback callback) {
+    qint64 base = m_currentTick;
+    if (m_thread.joinable()) {
+        // 驱动线程睡眠期间不推进 tick，到期时间按真实时间计算，否则新定时器会提前到期；
+        // 没有定时器时可以直接追上真实时间
+        const auto elapsed = Clock::now() - m_origin;
+        const qint64 now = elapsed / m_options.tick;
+        if (m_pending == 0) m_currentTick = std::max(m_currentTick, now);
+        // 从当前 tick 的结束处起算（向上取整）：tick 中途插入的定时器也不会早于 delay 触发
+        const bool partial = elapsed % m_options.tick != Clock::duration::zero();
+        base = std::max(m_currentTick, now + (partial ? 1 : 0));
+    }
+
+    int index = m_freeHead;
+    if (index >= 0) {
+        m_freeHead = m_nodes[index].next;
+    } else {
+        index = static_cast<int>(m_nodes.size());
+        m_nodes.emplace_back();
+    }
+    Node& node = m_nodes[index];
+    node.expireTick = base + ticks;
+    node.periodTicks = periodTicks;
+    node.callback = std::move(callback);
+    node.active = true;
+    linkLocked(index);
+    ++m_pending;
+    // 比驱动线程计划醒来的时刻更早：叫醒它重新计算
+    if (node.expireTick < m_wakeTick) {
+        m_wakeTick = 0;
+        m_wakeCv.notify_one();
+    }
+    return makeId(index, node.generation);
+}
+
+int TimerWheel::indexOf(TimerId id) const {
+    const qint64 index = static_cast<qint64>(id & 0xffffffffu) - 1;
+    if (index < 0 || index >= static_cast<qint64>(m_nodes.size())) return -1;
+    const Node& node = m_nodes[static_cast<std::size_t>(index)];
+    if (!node.active || node.generation != static_cast<quint32>(id >> 32)) return -1;
+    return static_cast<int>(index);
+}
+
+void TimerWheel::linkLocked(int index) {
+    Node& node = m_nodes[index];
+    const qint64 delta = std::max<qint64>(0, node.expireTick - m_currentTick);
+    int level = 0;
+    while (level + 1 < m_options.levels && delta >> (m_options.slotBits * (level + 1)) != 0) {
+        ++level;
+    }
+    const int shift = m_options.slotBits * level;
+    qint64 slot = (node.expireTick >> shift) & m_slotMask;
+    if (delta >> (shift + m_options.slotBits) != 0) {
+        // 超出最高层一圈：放到最晚下放的格子，下放时按真实到期时间重新安置
+        slot = ((m_currentTick >> shift) - 1) & m_slotMask;
+    }
+
+    const int bucket = level * m_slots + static_cast<int>(slot);
+    node.bucket = bucket;
+    node.prev = -1;
+    node.next = m_buckets[bucket];
+    if (node.next >= 0) m_nodes[node.next].prev = index;
+    m_buckets[bucket] = index;
+}
+
+void TimerWheel::unlinkLocked(int index) {
+    Node& node = m_nodes[index];
+    if (node.bucket < 0) return;
+    if (node.prev >= 0) {
+        m_nodes[node.prev].next = node.next;
+    } else {
+        m_buckets[node.bucket] = node.next;
+    }
+    if (node.next >= 0) m_nodes[node.next].prev = node.prev;
+    node.prev = node.next = -1;
+    node.bucket = -1;
+}
+
+void TimerWheel::releaseLocked(int index) {
+    Node& node = m_nodes[index];
+    node.callback = nullptr;
+    node.active = false;
+    ++node.generation;
+    node.next = m_freeHead;
+    m_freeHead = index;
+    --m_pending;
+}
+
+void TimerWheel::stepLocked(std::vector<TimerId>& due) {
+    const qint64 tick = ++m_currentTick;
+
+    // 高层格子在其覆盖区间开始时整体下放
+    for (int level = 1; level < m_options.levels; ++level) {
+        const int shift = m_options.slotBits * level;
+        if ((tick & ((qint64(1) << shift) - 1)) != 0) break;
+        const int bucket = level * m_slots + static_cast<int>((tick >> shift) & m_slotMask);
+        int index = m_buckets[bucket];
+        m_buckets[bucket] = -1;
+        while (index >= 0) {
+            const int next = m_nodes[index].next;
+            m_nodes[index].bucket = -1;
+            linkLocked(index);
+            index = next;
+        }
+    }
+
+    const int bucket = static_cast<int>(tick & m_slotMask);
+    int index = m_buckets[bucket];
+    m_buckets[bucket] = -1;
+    while (index >= 0) {
+        Node& node = m_nodes[index];
+        const int next = node.next;
+        node.prev = node.next = -1;
+        node.bucket = -1;
+        if (node.expireTick > tick) {
+            linkLocked(index);
+        } else {
+            due.push_back(makeId(index, node.generation));
+            // 周期定时器立即按下一周期重新挂上，回调执行期间也可以被取消
+            if (node.periodTicks > 0) {
+                node.expireTick = tick + node.periodTicks;
+                linkLocked(index);
+            }
+        }
+        index = next;
+    }
+}
+
+int TimerWheel::runUntil(qint64 targetTick) {
+    int fired = 0;
+    std::vector<TimerId> due;
+    while (true) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            // 没有定时器时直接跳到目标位置
+            if (m_pending == 0) m_currentTick = std::max(m_currentTick, targetTick);
+            while (m_currentTick < targetTick && due.empty()) stepLocked(due);
+        }
+        if (due.empty()) break;
+        for (const TimerId id : due) {
+            if (fire(id)) ++fired;
+        }
+        due.clear();
+    }
+    return fired;
+}
+
+bool TimerWheel::fire(TimerId id) {
+    Callback callback;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const int index = indexOf(id);
+        if (index < 0) return false;
+        Node& node = m_nodes[index];
+        if (node.periodTicks > 0) {
+            callback = node.callback;
+        } else {
+            callback = std::move(node.callback);
+            releaseLocked(index);
+        }
+        m_running = id;
+        m_runningThread = std::this_thread::get_id();
+    }
+
+    try {
+        callback();
+    } catch (...) {
+        // 回调异常不能终止驱动线程
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_running = 0;
+        m_runningThread = std::thread::id();
+    }
+    m_runningCv.notify_all();
+    return true;
+}
+
+qint64 TimerWheel::ticksFor(std::chrono::milliseconds delay) const {
+    const qint64 tick = m_options.tick.count();
+    const qint64 ms = std::max<qint64>(0, delay.count());
+    return std::max<qint64>(1, (ms + tick - 1) / tick);
+}
+
+qint64 TimerWheel::nextWakeTickLocked() const {
+    qint64 next = std::numeric_limits<qint64>::max();
+    for (int level = 0; level < m_options.levels; ++level) {
+        const int shift = m_options.slotBits * level;
+        const qint64 base = m_currentTick >> shift;
+        // 第 0 层格子在其 tick 到期，高层格子在其区间开始时下放；各层只需看一圈
+        for (qint64 step = 1; step <= m_slots; ++step) {
+            const qint64 tick = (base + step) << shift;
+            if (tick >= next) break;
+            if (m_buckets[level * m_slots + static_cast<int>((base + step) & m_slotMask)] >= 0) {
+                next = tick;
+                break;
+            }
+        }
+    }
+    // 已弹出、等待执行的定时器不在任何格子里，此时下一个 tick 再看
+    return next == std::numeric_limits<qint64>::max() ? m_currentTick + 1 : next;
+}
+
+void TimerWheel::run() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_stopping) {
+        if (m_pending == 0) {
+            m_wakeTick = std::numeric_limits<qint64>::max();
+            m_wakeCv.wait(lock, [this]() { return m_stopping || m_pending > 0; });
+            continue;
+        }
+        // 一直睡到最近的非空格子；期间插入更早的定时器会把 m_wakeTick 清零并唤醒
+        m_wakeTick = nextWakeTickLocked();
+        const auto wakeAt = m_origin + m_options.tick * m_wakeTick;
+        m_wakeCv.wait_until(lock, wakeAt, [this]() { return m_stopping || m_wakeTick == 0; });
+        m_wakeTick = 0;
+        if (m_stopping) break;
+        const qint64 target = (Clock::now() - m_origin) / m_options.tick;
+        lock.unlock();
+        runUntil(target);
+        lock.lock();
+    }
+    m_wakeTick = 0;
+}
@@ -10,7 +10,12 @@ UdpConnect::UdpConnect() {
     m_bound = false;
 }
 
-UdpConnect::UdpConnect(const QString& endpoint, bool autoOpen) : UdpConnect() {
+UdpConnect::UdpConnect(const Options& options) : UdpConnect() {
+    m_options = options;
+}
+
+UdpConnect::UdpConnect(const QString& endpoint, bool autoOpen, const Options& options)
+    : UdpConnect(options) {
     if (autoOpen) open(endpoint);
 }
 
@@ -86,7 +91,9 @@ qint64 UdpConnect::receive(QByteArray& out, qint64 maxBytes) {
         // 如果未绑定本地端口，则不保证能接收
         // 尝试读取已有数据
     }
-    if (!m_socket.waitForReadyRead(100)) { return 0; }
+    if (!m_socket.hasPendingDatagrams() && !m_socket.waitForReadyRead(m_options.readTimeoutMs)) {
+        return 0;
+    }
     while (m_socket.hasPendingDatagrams()) {
         qint64 sz = static_cast<qint64>(m_socket.pendingDatagramSize());
         qint64 toRead = qMin(sz, maxBytes);
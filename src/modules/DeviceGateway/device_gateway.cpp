@@ -9,10 +9,15 @@
 #include <QUrlQuery>
 #include <QtSql/QSqlError>
 #include <QtSql/QSqlQuery>
+#include <utility>
+#include <vector>
 
 #include "modules/Connect/connect_factory.h"
 #include "modules/DeviceGateway/rest_server.h"
+#include "modules/Storage/dbmanager.h"
 #include "modules/Storage/storage.h"
+#include "modules/Storage/telemetry_store.h"
+#include "modules/Storage/write_behind.h"
 #include "spdlog/spdlog.h"
 
 #ifdef HAS_DROGON
@@ -21,6 +26,64 @@ using DeviceGateway::RestServer;
 
 namespace DeviceGateway {
 
+namespace {
+
+using PendingWrites = std::vector<std::pair<QString, std::future<bool>>>;
+
+// 等待批量导入的设备写入提交，记录失败的设备；全部成功时返回 true
+bool awaitPersisted(PendingWrites& pending, const char* source) {
+    std::size_t failed = 0;
+    for (auto& [id, done] : pending) {
+        if (!done.get()) {
+            ++failed;
+            spdlog::warn(
+                "DeviceGateway: failed to persist device {} from {}", id.toStdString(), source);
+        }
+    }
+    if (failed > 0) {
+        spdlog::error("DeviceGateway: {} of {} devices from {} were not persisted",
+                      failed,
+                      pending.size(),
+                      source);
+    }
+    return failed == 0;
+}
+
+// 包装网关持有的设备连接：每次收到数据都记为该设备的一次心跳
+class HeartbeatConnect : public IConnect {
+   public:
+    HeartbeatConnect(IConnectPtr inner, HeartbeatTracker& heartbeats, HeartbeatHandle handle)
+        : m_inner(std::move(inner)), m_heartbeats(heartbeats), m_handle(handle) {}
+
+    bool open(const QString& endpoint) override { return m_inner->open(endpoint); }
+    void close() override { m_inner->close(); }
+    qint64 send(const QByteArray& data) override { return m_inner->send(data); }
+    qint64 receive(QByteArray& out, qint64 maxBytes = 4096) override {
+        const qint64 n = m_inner->receive(out, maxBytes);
+        if (n > 0) m_heartbeats.touch(m_handle);
+        return n;
+    }
+    void flush() override { m_inner->flush(); }
+    bool isOpen() const override { return m_inner->isOpen(); }
+
+   private:
+    IConnectPtr m_inner;
+    HeartbeatTracker& m_heartbeats;
+    HeartbeatHandle m_handle;
+};
+
+// 取得当前线程连接上缓存的预编译语句；prepare 失败时记录错误并返回 nullptr
+QSqlQuery* cachedStatement(const QString& sql) {
+    try {
+        return &storage::DbManager::instance().prepared(sql);
+    } catch (const std::exception& e) {
+        spdlog::error("DeviceGateway: failed to prepare statement: {}", e.what());
+        return nullptr;
+    }
+}
+
+}  // namespace
+
 DeviceGateway::DeviceGateway() = default;
 DeviceGateway::~DeviceGateway() {
     shutdown();
@@ -36,7 +99,14 @@ DeviceRegistry& DeviceGateway::registry() {
     return m_registry;
 }
 
+HeartbeatTracker& DeviceGateway::heartbeats() {
+    return m_heartbeats;
+}
+
 bool DeviceGateway::init() {
+    // 已持久化的设备都纳入在线检测，包括没有连接、只通过 REST 心跳或遥测上报的设备
+    for (const DeviceInfo& dev : loadDevicesFromStorage()) m_heartbeats.registerDevice(dev.id);
+    m_heartbeats.start();
     // Prefer Drogon if compiled in; otherwise use our Qt-based RestServer
     // preserve legacy behavior by starting REST on default port 8080
     return startRest(8080);
@@ -87,6 +157,11 @@ void DeviceGateway::stopRest() {
 }
 
 void DeviceGateway::shutdown() {
+    // 停止心跳检测线程并把最后一批 lastSeen/状态交给写入队列，随后与遥测一并落盘
+    m_heartbeats.stop();
+    // 提交缓冲中的遥测并等待排队中的设备写入落盘，写操作会回调本对象
+    storage::TelemetryStore::instance().flush();
+
     if (m_restServer) {
         auto srv = static_cast<RestServer*>(m_restServer);
         srv->stop();
@@ -106,12 +181,18 @@ bool DeviceGateway::addDeviceWithConnect(const DeviceInfo& dev) {
         spdlog::warn("DeviceGateway: addDeviceWithConnect failed, invalid device id");
         return false;
     }
-    // Persist device metadata into Storage if available
-    if (!persistDevice(dev)) {
-        spdlog::warn("DeviceGateway: failed to persist device {}", dev.id.toStdString());
-    } else {
-        spdlog::info("DeviceGateway: persisted device {}", dev.id.toStdString());
-    }
+    const HeartbeatHandle heartbeat = m_heartbeats.registerDevice(dev.id);
+    // Persist device metadata into Storage on the write-behind thread; the caller (UI/REST) does
+    // not wait for the commit
+    storage::WriteBehindQueue::instance().submit([dev](QSqlDatabase&) {
+        const bool ok = persistDevice(dev);
+        if (!ok) {
+            spdlog::warn("DeviceGateway: failed to persist device {}", dev.id.toStdString());
+        } else {
+            spdlog::info("DeviceGateway: persisted device {}", dev.id.toStdString());
+        }
+        return ok;
+    });
 
     if (dev.endpoint.isEmpty()) return true;  // nothing to connect
 
@@ -144,13 +225,15 @@ bool DeviceGateway::addDeviceWithConnect(const DeviceInfo& dev) {
         if (changed) ep = url.toString();
     }
 
-    auto conn = connect_factory::createByEndpoint(ep);
+    IConnectPtr conn = connect_factory::createByEndpoint(ep);
     if (!conn) {
         spdlog::warn("DeviceGateway: could not create connection for endpoint {}",
                      dev.endpoint.toStdString());
         return true;  // unable to create a connection object, but device still registered
     }
 
+    // 从该连接读到的数据都算作设备的流量
+    conn = std::make_shared<HeartbeatConnect>(std::move(conn), m_heartbeats, heartbeat);
     // try to open; if open fails we still keep the conn object but may not store it
     if (conn->open(dev.endpoint)) {
         m_connections.insert(dev.id, conn);
@@ -171,6 +254,7 @@ bool DeviceGateway::removeDeviceAndClose(const QString& id) {
                      id.toStdString());
         return false;
     }
+    m_heartbeats.unregisterDevice(id);
     if (m_connections.contains(id)) {
         auto conn = m_connections.take(id);
         if (conn && conn->isOpen()) {
@@ -178,78 +262,61 @@ bool DeviceGateway::removeDeviceAndClose(const QString& id) {
             spdlog::info("DeviceGateway: closed connection for device {}", id.toStdString());
         }
     }
-    // Also remove persisted device row if storage available
-    using namespace storage;
-    if (Storage::db().isOpen()) {
-        QSqlQuery q(Storage::db());
-        q.prepare("DELETE FROM devices WHERE id = ?");
-        q.addBindValue(id);
-        if (!q.exec()) {
+    // Remove the persisted row through the same FIFO write-behind queue as the upsert, so a
+    // still-queued INSERT from addDeviceWithConnect cannot recreate it after the DELETE
+    storage::WriteBehindQueue::instance().submit([id](QSqlDatabase&) {
+        using namespace storage;
+        if (!Storage::db().isOpen()) return false;
+        const auto writeLock = DbManager::instance().writeLock();
+        QSqlQuery* q = cachedStatement(QStringLiteral("DELETE FROM devices WHERE id = ?"));
+        if (q) q->bindValue(0, id);
+        if (!q || !q->exec()) {
             spdlog::warn("DeviceGateway: failed to delete device {} from storage: {}",
                          id.toStdString(),
-                         q.lastError().text().toStdString());
-        } else {
-            spdlog::info("DeviceGateway: deleted device {} from storage", id.toStdString());
+                         q ? q->lastError().text().toStdString() : std::string());
+            return false;
         }
-    }
-    return true;
-}
-
-bool DeviceGateway::ensureDevicesTable() {
-    using namespace storage;
-    if (!Storage::db().isOpen()) return false;
-    QSqlQuery q(Storage::db());
-    const QString create = QStringLiteral(
-        "CREATE TABLE IF NOT EXISTS devices ("
-        "id TEXT PRIMARY KEY,"
-        "name TEXT,"
-        "status TEXT,"
-        "endpoint TEXT,"
-        "type TEXT,"
-        "hw_info TEXT,"
-        "firmware_version TEXT,"
-        "owner TEXT,"
-        "group_name TEXT,"
-        "last_seen INTEGER,"
-        "metadata TEXT"
-        ");");
-    if (!q.exec(create)) {
-        spdlog::error("DeviceGateway: Failed to create devices table: {}",
-                      q.lastError().text().toStdString());
-        return false;
-    }
-    spdlog::debug("DeviceGateway: ensured devices table exists");
+        spdlog::info("DeviceGateway: deleted device {} from storage", id.toStdString());
+        return true;
+    });
     return true;
 }
 
 bool DeviceGateway::persistDevice(const DeviceInfo& dev) {
     using namespace storage;
     if (!Storage::db().isOpen()) return false;
-    if (!ensureDevicesTable()) return false;
-
-    QSqlQuery q(Storage::db());
-    q.prepare(
-        "INSERT OR REPLACE INTO "
-        "devices(id,name,status,endpoint,type,hw_info,firmware_version,owner,group_name,last_seen,"
-        "metadata) VALUES(?,?,?,?,?,?,?,?,?,?,?)");
-    q.addBindValue(dev.id);
-    q.addBindValue(dev.name);
-    q.addBindValue(dev.status);
-    q.addBindValue(dev.endpoint);
-    q.addBindValue(dev.type);
-    q.addBindValue(dev.hw_info);
-    q.addBindValue(dev.firmware_version);
-    q.addBindValue(dev.owner);
-    q.addBindValue(dev.group);
+
+    // devices 表由 DbManager::init 创建；语句在当前线程的连接上只 prepare 一次。
+    // 已存在的设备只更新元数据：status/last_seen 由 HeartbeatTracker 维护，不能被覆盖回旧值
+    const auto writeLock = DbManager::instance().writeLock();
+    QSqlQuery* stmt = cachedStatement(QStringLiteral(
+        "INSERT INTO "
+        "devices(id,name,status,endpoint,type,hw_info,firmware_version,owner,group_name,"
+        "last_seen,metadata) VALUES(?,?,?,?,?,?,?,?,?,?,?) "
+        "ON CONFLICT(id) DO UPDATE SET name=excluded.name,endpoint=excluded.endpoint,"
+        "type=excluded.type,hw_info=excluded.hw_info,"
+        "firmware_version=excluded.firmware_version,owner=excluded.owner,"
+        "group_name=excluded.group_name,metadata=excluded.metadata"));
+    if (!stmt) return false;
+    QSqlQuery& q = *stmt;
+    q.bindValue(0, dev.id);
+    q.bindValue(1, dev.name);
+    q.bindValue(2, dev.status);
+    q.bindValue(3, dev.endpoint);
+    q.bindValue(4, dev.type);
+    q.bindValue(5, dev.hw_info);
+    q.bindValue(6, dev.firmware_version);
+    q.bindValue(7, dev.owner);
+    q.bindValue(8, dev.group);
     if (dev.lastSeen.isValid())
-        q.addBindValue(static_cast<qint64>(dev.lastSeen.toSecsSinceEpoch()));
+        q.bindValue(9, static_cast<qint64>(dev.lastSeen.toSecsSinceEpoch()));
     else
-        q.addBindValue(QVariant());
+        q.bindValue(9, QVariant());
 
     QJsonObject mo;
     for (auto it = dev.metadata.constBegin(); it != dev.metadata.constEnd(); ++it)
         mo.insert(it.key(), QJsonValue::fromVariant(it.value()));
-    q.addBindValue(QString::fromUtf8(QJsonDocument(mo).toJson(QJsonDocument::Compact)));
+    q.bindValue(10, QString::fromUtf8(QJsonDocument(mo).toJson(QJsonDocument::Compact)));
 
     if (!q.exec()) {
         spdlog::error("DeviceGateway: Failed to persist device {}: {}",
@@ -260,15 +327,63 @@ bool DeviceGateway::persistDevice(const DeviceInfo& dev) {
     return true;
 }
 
+std::future<bool> DeviceGateway::persistDeviceAsync(const DeviceInfo& dev) {
+    return storage::WriteBehindQueue::instance().submit(
+        [dev](QSqlDatabase&) { return persistDevice(dev); });
+}
+
+bool DeviceGateway::heartbeat(const QString& deviceId) {
+    return m_heartbeats.touch(deviceId);
+}
+
+std::future<bool> DeviceGateway::ingestTelemetry(const QString& deviceId,
+                                                 const QJsonObject& metrics,
+                                                 qint64 timestampMs) {
+    if (timestampMs <= 0) timestampMs = QDateTime::currentMSecsSinceEpoch();
+    QVector<storage::TelemetryPoint> points;
+    points.reserve(metrics.size());
+    for (auto it = metrics.constBegin(); it != metrics.constEnd(); ++it) {
+        // 只记录数值与布尔指标，其它类型忽略
+        const QJsonValue v = it.value();
+        if (!v.isDouble() && !v.isBool()) continue;
+        const double value = v.isBool() ? (v.toBool() ? 1.0 : 0.0) : v.toDouble();
+        points.append({deviceId, it.key(), timestampMs, value});
+    }
+    return ingestTelemetry(std::move(points));
+}
+
+std::future<bool> DeviceGateway::ingestTelemetry(QVector<storage::TelemetryPoint> points) {
+    // 遥测本身即是设备在线的证据；同一设备的连续点只记录一次
+    const QString* last = nullptr;
+    for (const auto& p : points) {
+        if (last && *last == p.deviceId) continue;
+        m_heartbeats.touch(p.deviceId);
+        last = &p.deviceId;
+    }
+    return storage::TelemetryStore::instance().append(std::move(points));
+}
+
+QVector<storage::TelemetrySample> DeviceGateway::queryTelemetry(
+    const QString& deviceId,
+    const QString& metric,
+    qint64 fromMs,
+    qint64 toMs,
+    storage::TelemetryResolution resolution,
+    int limit) const {
+    return storage::TelemetryStore::instance().query(
+        deviceId, metric, fromMs, toMs, resolution, limit);
+}
+
 QVector<DeviceInfo> DeviceGateway::loadDevicesFromStorage() const {
     QVector<DeviceInfo> out;
     using namespace storage;
     if (!Storage::db().isOpen()) return out;
-    QSqlQuery q(Storage::db());
-    if (!q.exec("SELECT "
-                "id,name,status,endpoint,type,hw_info,firmware_version,owner,group_name,last_seen,"
-                "metadata FROM devices"))
-        return out;
+    QSqlQuery* stmt = cachedStatement(QStringLiteral(
+        "SELECT "
+        "id,name,status,endpoint,type,hw_info,firmware_version,owner,group_name,last_seen,"
+        "metadata FROM devices"));
+    if (!stmt || !stmt->exec()) return out;
+    QSqlQuery& q = *stmt;
     while (q.next()) {
         DeviceInfo d;
         d.id = q.value(0).toString();
@@ -291,6 +406,7 @@ QVector<DeviceInfo> DeviceGateway::loadDevicesFromStorage() const {
         spdlog::debug("DeviceGateway: loaded device {} from storage", d.id.toStdString());
         out.append(d);
     }
+    q.finish();
     return out;
 }
 
@@ -383,6 +499,8 @@ bool DeviceGateway::importDevicesCsv(const QString& path, bool createConnections
     const QString header = ts.readLine();
     Q_UNUSED(header);
     int lineNo = 1;
+    // 逐行入队，由写线程按批组提交，导入结束时统一等待
+    PendingWrites pending;
     while (!ts.atEnd()) {
         const QString line = ts.readLine();
         ++lineNo;
@@ -415,12 +533,11 @@ bool DeviceGateway::importDevicesCsv(const QString& path, bool createConnections
             const auto doc = QJsonDocument::fromJson(meta.toUtf8());
             if (doc.isObject()) d.metadata = doc.object().toVariantMap();
         }
-        if (!persistDevice(d)) {
-            spdlog::warn("DeviceGateway: failed to persist device {} from CSV", d.id.toStdString());
-            continue;
-        }
+        m_heartbeats.registerDevice(d.id);
+        pending.emplace_back(d.id, persistDeviceAsync(d));
         if (createConnections) addDeviceWithConnect(d);
     }
+    if (!awaitPersisted(pending, "CSV")) return false;
     spdlog::info("DeviceGateway: CSV import completed from {}", path.toStdString());
     return true;
 }
@@ -433,6 +550,7 @@ bool DeviceGateway::importDevicesJsonND(const QString& path, bool createConnecti
     }
     QTextStream ts(&f);
     int lineNo = 0;
+    PendingWrites pending;
     while (!ts.atEnd()) {
         ++lineNo;
         const QString line = ts.readLine();
@@ -459,13 +577,11 @@ bool DeviceGateway::importDevicesJsonND(const QString& path, bool createConnecti
         }
         if (jo.contains("metadata") && jo.value("metadata").isObject())
             d.metadata = jo.value("metadata").toObject().toVariantMap();
-        if (!persistDevice(d)) {
-            spdlog::warn("DeviceGateway: failed to persist device {} from NDJSON",
-                         d.id.toStdString());
-            continue;
-        }
+        m_heartbeats.registerDevice(d.id);
+        pending.emplace_back(d.id, persistDeviceAsync(d));
         if (createConnections) addDeviceWithConnect(d);
     }
+    if (!awaitPersisted(pending, "NDJSON")) return false;
     spdlog::info("DeviceGateway: NDJSON import completed from {}", path.toStdString());
     return true;
 }
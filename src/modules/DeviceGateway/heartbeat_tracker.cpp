@@ -0,0 +1,258 @@
+﻿#include "modules/DeviceGateway/heartbeat_tracker.h"
+
+#include <QDateTime>
+#include <QtSql/QSqlDatabase>
+#include <QtSql/QSqlQuery>
+#include <algorithm>
+#include <utility>
+
+#include "modules/Storage/dbmanager.h"
+#include "modules/Storage/write_behind.h"
+#include "spdlog/spdlog.h"
+
+namespace DeviceGateway {
+
+namespace {
+
+constexpr quint8 kUnknown = static_cast<quint8>(DeviceLiveness::Unknown);
+constexpr quint8 kOnline = static_cast<quint8>(DeviceLiveness::Online);
+constexpr quint8 kOffline = static_cast<quint8>(DeviceLiveness::Offline);
+
+qint64 nowOr(qint64 ms) {
+    return ms > 0 ? ms : QDateTime::currentMSecsSinceEpoch();
+}
+
+}  // namespace
+
+HeartbeatTracker::HeartbeatTracker(HeartbeatOptions options, TimerWheel& timers)
+    : m_options([&options]() {
+          options.capacity = std::max(1, options.capacity);
+          options.timeout = std::max(std::chrono::milliseconds(1), options.timeout);
+          options.flushInterval = std::max(std::chrono::milliseconds(1), options.flushInterval);
+          return options;
+      }()),
+      m_timers(timers) {
+    m_slots = std::make_unique<Slot[]>(static_cast<std::size_t>(m_options.capacity));
+}
+
+HeartbeatTracker::~HeartbeatTracker() {
+    stop();
+}
+
+HeartbeatHandle HeartbeatTracker::registerDevice(const QString& id) {
+    if (id.isEmpty()) return {};
+    std::unique_lock lock(m_registryMutex);
+    const auto existing = m_index.constFind(id);
+    if (existing != m_index.cend()) {
+        return {existing.value(), m_slots[existing.value()].generation.load()};
+    }
+    int slot = -1;
+    if (!m_freeSlots.empty()) {
+        slot = m_freeSlots.back();
+        m_freeSlots.pop_back();
+    } else if (m_slotCount < m_options.capacity) {
+        slot = m_slotCount++;
+    } else {
+        spdlog::warn("HeartbeatTracker: capacity {} reached, cannot track device {}",
+                     m_options.capacity,
+                     id.toStdString());
+        return {};
+    }
+    Slot& s = m_slots[slot];
+    s.id = id;
+    s.lastSeenMs.store(0);
+    s.liveness.store(kUnknown);
+    s.dirty.store(false);
+    m_index.insert(id, slot);
+    return {slot, s.generation.load()};
+}
+
+void HeartbeatTracker::unregisterDevice(const QString& id) {
+    std::unique_lock lock(m_registryMutex);
+    const auto it = m_index.find(id);
+    if (it == m_index.end()) return;
+    const int slot = it.value();
+    m_index.erase(it);
+    Slot& s = m_slots[slot];
+    // 先换代，之后旧句柄上的 touch 与已在执行的到期检查全部失效
+    s.generation.fetch_add(1);
+    s.liveness.store(kUnknown);
+    s.dirty.store(false);
+    s.id.clear();
+    TimerId timer = 0;
+    {
+        std::lock_guard<std::mutex> timerLock(m_timerMutex);
+        timer = std::exchange(s.timer, 0);
+    }
+    m_timers.cancel(timer);
+    m_freeSlots.push_back(slot);
+}
+
+HeartbeatHandle HeartbeatTracker::handle(const QString& id) const {
+    std::shared_lock lock(m_registryMutex);
+    const auto it = m_index.constFind(id);
+    if (it == m_index.cend()) return {};
+    return {it.value(), m_slots[it.value()].generation.load()};
+}
+
+void HeartbeatTracker::touch(HeartbeatHandle handle, qint64 nowMs) {
+    if (!handle.isValid() || handle.slot >= m_options.capacity) return;
+    Slot& s = m_slots[handle.slot];
+    if (s.generation.load(std::memory_order_acquire) != handle.generation) return;
+
+    const qint64 now = nowOr(nowMs);
+    qint64 prev = s.lastSeenMs.load(std::memory_order_relaxed);
+    while (prev < now && !s.lastSeenMs.compare_exchange_weak(prev, now)) {}
+    // 已经是脏的就不再写，避免每个包都写同一条缓存行
+    if (!s.dirty.load(std::memory_order_relaxed)) s.dirty.store(true, std::memory_order_relaxed);
+    // 稳定在线时只剩上面的原子操作；只有状态变化时才调度到期检查
+    if (s.liveness.load(std::memory_order_relaxed) != kOnline &&
+        s.liveness.exchange(kOnline) != kOnline) {
+        arm(handle.slot);
+    }
+}
+
+bool HeartbeatTracker::touch(const QString& id, qint64 nowMs) {
+    const HeartbeatHandle h = handle(id);
+    if (!h.isValid()) return false;
+    touch(h, nowMs);
+    return true;
+}
+
+std::optional<HeartbeatState> HeartbeatTracker::state(const QString& id) const {
+    std::shared_lock lock(m_registryMutex);
+    const auto it = m_index.constFind(id);
+    if (it == m_index.cend()) return std::nullopt;
+    const Slot& s = m_slots[it.value()];
+    return HeartbeatState{
+        s.id, static_cast<DeviceLiveness>(s.liveness.load()), s.lastSeenMs.load()};
+}
+
+QVector<HeartbeatState> HeartbeatTracker::snapshot() const {
+    std::shared_lock lock(m_registryMutex);
+    QVector<HeartbeatState> out;
+    out.reserve(m_index.size());
+    for (auto it = m_index.cbegin(); it != m_index.cend(); ++it) {
+        const Slot& s = m_slots[it.value()];
+        out.append({s.id, static_cast<DeviceLiveness>(s.liveness.load()), s.lastSeenMs.load()});
+    }
+    return out;
+}
+
+void HeartbeatTracker::arm(int slot) {
+    std::lock_guard<std::mutex> lock(m_timerMutex);
+    if (m_stopping || m_slots[slot].timer != 0) return;
+    scheduleLocked(slot, QDateTime::currentMSecsSinceEpoch());
+}
+
+void HeartbeatTracker::scheduleLocked(int slot, qint64 nowMs) {
+    Slot& s = m_slots[slot];
+    const qint64 deadline = s.lastSeenMs.load() + m_options.timeout.count();
+    const quint32 generation = s.generation.load();
+    s.timer = m_timers.schedule(std::chrono::milliseconds(std::max<qint64>(0, deadline - nowMs)),
+                                [this, slot, generation]() { expire(slot, generation); });
+}
+
+void HeartbeatTracker::expire(int slot, quint32 generation) {
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    const qint64 timeoutMs = m_options.timeout.count();
+    std::lock_guard<std::mutex> lock(m_timerMutex);
+    Slot& s = m_slots[slot];
+    // 设备已注销（槽位可能已被复用），注销时已清理定时器
+    if (s.generation.load() != generation) return;
+    s.timer = 0;
+    if (m_stopping || s.liveness.load() != kOnline) return;
+
+    if (s.lastSeenMs.load() + timeoutMs > now) {
+        // 期间有心跳：按最新 lastSeen 惰性重排
+        scheduleLocked(slot, now);
+        return;
+    }
+    quint8 expected = kOnline;
+    if (!s.liveness.compare_exchange_strong(expected, kOffline)) return;
+    if (s.lastSeenMs.load() + timeoutMs > now) {
+        // 与并发的 touch 竞争：它看到的还是在线，因此没有调度到期检查，这里恢复
+        s.liveness.store(kOnline);
+        scheduleLocked(slot, now);
+        return;
+    }
+    s.dirty.store(true);
+}
+
+QVector<HeartbeatState> HeartbeatTracker::takeDirty() {
+    std::shared_lock lock(m_registryMutex);
+    QVector<HeartbeatState> out;
+    for (int slot = 0; slot < m_slotCount; ++slot) {
+        Slot& s = m_slots[slot];
+        if (!s.dirty.load(std::memory_order_relaxed) || !s.dirty.exchange(false)) continue;
+        if (s.id.isEmpty()) continue;
+        out.append({s.id, static_cast<DeviceLiveness>(s.liveness.load()), s.lastSeenMs.load()});
+    }
+    return out;
+}
+
+std::future<bool> HeartbeatTracker::flush() {
+    QVector<HeartbeatState> dirty = takeDirty();
+    if (dirty.isEmpty()) {
+        std::promise<bool> done;
+        done.set_value(true);
+        return done.get_future();
+    }
+    // 一个写操作即一个事务（与同批其它写操作组提交），每台设备一条 UPDATE
+    return storage::WriteBehindQueue::instance().submit([dirty = std::move(dirty)](QSqlDatabase&) {
+        QSqlQuery& q = storage::DbManager::instance().prepared(QStringLiteral(
+            "UPDATE devices SET last_seen = COALESCE(?, last_seen), status = COALESCE(?, status) "
+            "WHERE id = ?"));
+        for (const HeartbeatState& st : dirty) {
+            q.bindValue(0, st.lastSeenMs > 0 ? QVariant(st.lastSeenMs / 1000) : QVariant());
+            switch (st.liveness) {
+                case DeviceLiveness::Online:
+                    q.bindValue(1, QStringLiteral("online"));
+                    break;
+                case DeviceLiveness::Offline:
+                    q.bindValue(1, QStringLiteral("offline"));
+                    break;
+                default:
+                    q.bindValue(1, QVariant());
+                    break;
+            }
+            q.bindValue(2, st.id);
+            if (!q.exec()) return false;
+        }
+        return true;
+    });
+}
+
+void HeartbeatTracker::start() {
+    {
+        std::lock_guard<std::mutex> lock(m_timerMutex);
+        if (!m_stopping) return;
+        m_stopping = false;
+        m_flushTimer = m_timers.scheduleRepeating(m_options.flushInterval, [this]() { flush(); });
+    }
+    // 停止期间上线的设备没有到期检查，这里补上
+    std::shared_lock lock(m_registryMutex);
+    for (int slot = 0; slot < m_slotCount; ++slot) {
+        if (m_slots[slot].liveness.load() == kOnline) arm(slot);
+    }
+}
+
+void HeartbeatTracker::stop() {
+    std::vector<TimerId> timers;
+    {
+        std::shared_lock registryLock(m_registryMutex);
+        std::lock_guard<std::mutex> lock(m_timerMutex);
+        if (m_stopping) return;
+        m_stopping = true;
+        timers.push_back(std::exchange(m_flushTimer, 0));
+        for (int slot = 0; slot < m_slotCount; ++slot) {
+            const TimerId timer = std::exchange(m_slots[slot].timer, 0);
+            if (timer != 0) timers.push_back(timer);
+        }
+    }
+    // cancel 会等待正在执行的回调结束，之后不再有回调访问本对象
+    for (const TimerId timer : timers) m_timers.cancel(timer);
+    flush();
+}
+
+}  // namespace DeviceGateway
@@ -5,6 +5,7 @@
 #include <drogon/drogon.h>
 
 #include <QByteArray>
+#include <QDateTime>
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
@@ -237,6 +238,7 @@ static void registerHandlers() {
                     mm.insert(it.key(), it.value().toVariant());
                 d.metadata = mm;
             }
+            g_gateway->heartbeats().registerDevice(d.id);
             if (!g_gateway->persistDevice(d)) {
                 restLogger->error(
                     std::string("REST PUT/POST /devices/{id} failed to persist device ") +
@@ -253,6 +255,151 @@ static void registerHandlers() {
         },
         {Post, Put});
 
+    // POST /devices/{id}/telemetry
+    // body: {"ts": <ms, optional>, "metrics": {"name": number, ...}} or an array of such objects
+    app().registerHandler(
+        R"(/devices/{id}/telemetry)",
+        [restLogger](const HttpRequestPtr& req,
+                     std::function<void(const HttpResponsePtr&)>&& callback) {
+            auto resp = HttpResponse::newHttpResponse();
+            resp->setContentTypeCode(CT_APPLICATION_JSON);
+            if (!g_gateway) {
+                resp->setStatusCode(k500InternalServerError);
+                resp->setBody("{\"error\":\"no gateway\"}");
+                callback(resp);
+                return;
+            }
+            const auto idView = req->getParameter("id");
+            const QString id = QString::fromStdString(std::string(idView.data(), idView.size()));
+            const auto bodyView = req->getBody();
+            QJsonParseError perr;
+            const QJsonDocument doc = QJsonDocument::fromJson(
+                QByteArray(bodyView.data(), static_cast<qsizetype>(bodyView.size())), &perr);
+            if (id.trimmed().isEmpty() || perr.error != QJsonParseError::NoError ||
+                (!doc.isObject() && !doc.isArray())) {
+                resp->setStatusCode(k400BadRequest);
+                QJsonObject err;
+                err["error"] = QString("invalid_request");
+                err["message"] = id.trimmed().isEmpty() ? QString("missing id in path")
+                                                        : perr.errorString();
+                resp->setBody(QJsonDocument(err).toJson(QJsonDocument::Compact).toStdString());
+                callback(resp);
+                return;
+            }
+            const QJsonArray samples =
+                doc.isArray() ? doc.array() : QJsonArray{QJsonValue(doc.object())};
+            int accepted = 0;
+            for (const QJsonValue& sample : samples) {
+                const QJsonObject so = sample.toObject();
+                const QJsonObject metrics = so.value("metrics").toObject();
+                // 写入在后台按批提交，这里不等待
+                g_gateway->ingestTelemetry(
+                    id, metrics, static_cast<qint64>(so.value("ts").toDouble(0)));
+                accepted += metrics.size();
+            }
+            resp->setStatusCode(k202Accepted);
+            QJsonObject ok;
+            ok["result"] = QString("accepted");
+            ok["metrics"] = accepted;
+            resp->setBody(QJsonDocument(ok).toJson(QJsonDocument::Compact).toStdString());
+            callback(resp);
+        },
+        {Post});
+
+    // GET /devices/{id}/telemetry?metric=&from=&to=&resolution=raw|1m|1h&limit=
+    app().registerHandler(
+        R"(/devices/{id}/telemetry)",
+        [restLogger](const HttpRequestPtr& req,
+                     std::function<void(const HttpResponsePtr&)>&& callback) {
+            auto resp = HttpResponse::newHttpResponse();
+            resp->setContentTypeCode(CT_APPLICATION_JSON);
+            if (!g_gateway) {
+                resp->setStatusCode(k500InternalServerError);
+                resp->setBody("{\"error\":\"no gateway\"}");
+                callback(resp);
+                return;
+            }
+            const auto param = [&req](const char* name) {
+                const auto view = req->getParameter(name);
+                return QString::fromStdString(std::string(view.data(), view.size()));
+            };
+            const QString id = param("id");
+            const qint64 now = QDateTime::currentMSecsSinceEpoch();
+            bool fromOk = false;
+            bool toOk = false;
+            qint64 from = param("from").toLongLong(&fromOk);
+            qint64 to = param("to").toLongLong(&toOk);
+            if (!toOk) to = now;
+            // 默认查询最近一小时
+            if (!fromOk) from = to - 3600 * 1000;
+            const QString resolutionName = param("resolution");
+            storage::TelemetryResolution resolution = storage::TelemetryResolution::Raw;
+            if (resolutionName == "1m") {
+                resolution = storage::TelemetryResolution::Minute;
+            } else if (resolutionName == "1h") {
+                resolution = storage::TelemetryResolution::Hour;
+            } else if (!resolutionName.isEmpty() && resolutionName != "raw") {
+                resp->setStatusCode(k400BadRequest);
+                resp->setBody("{\"error\":\"invalid resolution\"}");
+                callback(resp);
+                return;
+            }
+
+            const auto samples = g_gateway->queryTelemetry(
+                id, param("metric"), from, to, resolution, param("limit").toInt());
+            QJsonArray arr;
+            for (const auto& s : samples) {
+                QJsonObject jo;
+                jo["metric"] = s.metric;
+                jo["ts"] = s.timestampMs;
+                if (resolution == storage::TelemetryResolution::Raw) {
+                    jo["value"] = s.sum;
+                } else {
+                    jo["count"] = s.count;
+                    jo["min"] = s.min;
+                    jo["max"] = s.max;
+                    jo["avg"] = s.avg();
+                }
+                arr.append(jo);
+            }
+            QJsonObject root;
+            root["device"] = id;
+            root["from"] = from;
+            root["to"] = to;
+            root["samples"] = arr;
+            resp->setStatusCode(k200OK);
+            resp->setBody(QJsonDocument(root).toJson(QJsonDocument::Compact).toStdString());
+            callback(resp);
+        },
+        {Get});
+
+    // POST /devices/{id}/heartbeat
+    // 只更新内存中的 lastSeen/在线状态，由 HeartbeatTracker 按批写回 devices 表
+    app().registerHandler(
+        R"(/devices/{id}/heartbeat)",
+        [](const HttpRequestPtr& req, std::function<void(const HttpResponsePtr&)>&& callback) {
+            auto resp = HttpResponse::newHttpResponse();
+            if (!g_gateway) {
+                resp->setStatusCode(k500InternalServerError);
+                resp->setContentTypeCode(CT_APPLICATION_JSON);
+                resp->setBody("{\"error\":\"no gateway\"}");
+                callback(resp);
+                return;
+            }
+            const auto idView = req->getParameter("id");
+            const QString id = QString::fromStdString(std::string(idView.data(), idView.size()));
+            if (!g_gateway->heartbeat(id)) {
+                resp->setStatusCode(k404NotFound);
+                resp->setContentTypeCode(CT_APPLICATION_JSON);
+                resp->setBody("{\"error\":\"unknown device\"}");
+                callback(resp);
+                return;
+            }
+            resp->setStatusCode(k204NoContent);
+            callback(resp);
+        },
+        {Post});
+
     // DELETE /devices/{id}
     app().registerHandler(
         R"(/devices/{id})",
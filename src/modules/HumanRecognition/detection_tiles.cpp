@@ -0,0 +1,154 @@
+﻿#include "internal/detection_tiles.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace HumanRecognition::detail {
+
+namespace {
+
+/// 计算矩形面积（QRect 的 width/height 已是包含端点的像素数）
+qint64 area(const QRect& r) {
+    return r.isEmpty() ? 0 : static_cast<qint64>(r.width()) * static_cast<qint64>(r.height());
+}
+
+}  // namespace
+
+QVector<QRect> computeDetectionTiles(const QSize& imageSize, int targetTiles, int overlap) {
+    QVector<QRect> tiles;
+    if (imageSize.isEmpty()) return tiles;
+    const QRect bounds(QPoint(0, 0), imageSize);
+    overlap = std::max(0, overlap);
+    const int minSide = std::max(1, 2 * overlap);
+
+    // 在不小于 minSide 的前提下，按宽高比分配行列数，使分块接近正方形
+    const double aspect = static_cast<double>(imageSize.width()) / imageSize.height();
+    const int wanted = std::max(1, targetTiles);
+    int cols = std::max(1, static_cast<int>(std::lround(std::sqrt(wanted * aspect))));
+    int rows = std::max(1, (wanted + cols - 1) / cols);
+    cols = std::clamp(cols, 1, std::max(1, imageSize.width() / minSide));
+    rows = std::clamp(rows, 1, std::max(1, imageSize.height() / minSide));
+
+    if (cols * rows <= 1) {
+        tiles.append(bounds);
+        return tiles;
+    }
+
+    tiles.reserve(cols * rows);
+    for (int r = 0; r < rows; ++r) {
+        const int top = imageSize.height() * r / rows;
+        const int bottom = imageSize.height() * (r + 1) / rows;
+        for (int c = 0; c < cols; ++c) {
+            const int left = imageSize.width() * c / cols;
+            const int right = imageSize.width() * (c + 1) / cols;
+            const QRect cell(QPoint(left, top), QPoint(right - 1, bottom - 1));
+            tiles.append(cell.adjusted(0, 0, overlap, overlap).intersected(bounds));
+        }
+    }
+    return tiles;
+}
+
+unsigned long pyramidLevelsForMaxFace(int maxFaceSize, int windowSize, double levelScale) {
+    if (maxFaceSize <= windowSize || windowSize <= 0 || levelScale <= 0.0 || levelScale >= 1.0) {
+        return 1;
+    }
+    // 第 L 层可检测的人脸尺寸约为 windowSize / levelScale^L，多保留一层以容忍尺度误差
+    const double levels =
+        std::log(static_cast<double>(maxFaceSize) / windowSize) / std::log(1.0 / levelScale);
+    return static_cast<unsigned long>(std::ceil(levels)) + 1;
+}
+
+double intersectionOverUnion(const QRect& a, const QRect& b) {
+    const qint64 inter = area(a.intersected(b));
+    const qint64 uni = area(a) + area(b) - inter;
+    return uni > 0 ? static_cast<double>(inter) / static_cast<double>(uni) : 0.0;
+}
+
+QVector<ScoredRect> nonMaxSuppression(QVector<ScoredRect> boxes,
+                                      double iouThreshold,
+                                      double coverThreshold) {
+    std::stable_sort(boxes.begin(), boxes.end(), [](const ScoredRect& a, const ScoredRect& b) {
+        return a.confidence > b.confidence;
+    });
+
+    QVector<ScoredRect> kept;
+    kept.reserve(boxes.size());
+    for (const ScoredRect& candidate : boxes) {
+        const bool suppressed =
+            std::any_of(kept.cbegin(), kept.cend(), [&](const ScoredRect& existing) {
+                if (intersectionOverUnion(existing.rect, candidate.rect) > iouThreshold) {
+                    return true;
+                }
+                // 分块边缘与全局尺度会产生互相包含的框，IoU 不高但应视为同一张脸
+                const qint64 inter = area(existing.rect.intersected(candidate.rect));
+                const qint64 smaller = std::min(area(existing.rect), area(candidate.rect));
+                return smaller > 0 && static_cast<double>(inter) / smaller > coverThreshold;
+            });
+        if (!suppressed) kept.append(candidate);
+    }
+    return kept;
+}
+
+QVector<QRect> mergeOverlappingRects(QVector<QRect> rects) {
+    bool merged = true;
+    while (merged) {
+        merged = false;
+        for (int i = 0; i < rects.size() && !merged; ++i) {
+            for (int j = i + 1; j < rects.size(); ++j) {
+                if (rects[i].intersects(rects[j])) {
+                    rects[i] = rects[i].united(rects[j]);
+                    rects.removeAt(j);
+                    merged = true;
+                    break;
+                }
+            }
+        }
+    }
+    return rects;
+}
+
+QVector<QRect> prepareDetectionRegions(const QVector<QRect>& regions,
+                                       const QSize& imageSize,
+                                       int margin,
+                                       int minSide,
+                                       double fullFrameRatio) {
+    QVector<QRect> prepared;
+    if (imageSize.isEmpty()) return prepared;
+    const QRect bounds(QPoint(0, 0), imageSize);
+    margin = std::max(0, margin);
+    minSide = std::clamp(minSide, 1, std::min(imageSize.width(), imageSize.height()));
+
+    prepared.reserve(regions.size());
+    for (const QRect& region : regions) {
+        if (!region.isValid() || !region.intersects(bounds)) continue;
+        QRect expanded = region.adjusted(-margin, -margin, margin, margin);
+        // 太小的区域以中心为基准补足边长，再平移回图像内
+        if (expanded.width() < minSide) {
+            expanded.setLeft(expanded.center().x() - minSide / 2);
+            expanded.setWidth(minSide);
+        }
+        if (expanded.height() < minSide) {
+            expanded.setTop(expanded.center().y() - minSide / 2);
+            expanded.setHeight(minSide);
+        }
+        if (expanded.right() > bounds.right()) expanded.moveRight(bounds.right());
+        if (expanded.bottom() > bounds.bottom()) expanded.moveBottom(bounds.bottom());
+        if (expanded.left() < 0) expanded.moveLeft(0);
+        if (expanded.top() < 0) expanded.moveTop(0);
+        expanded = expanded.intersected(bounds);
+        if (!expanded.isEmpty()) prepared.append(expanded);
+    }
+
+    // 外扩后的区域可能重新相交
+    prepared = mergeOverlappingRects(std::move(prepared));
+
+    qint64 total = 0;
+    for (const QRect& r : prepared) total += area(r);
+    if (total > static_cast<qint64>(fullFrameRatio * static_cast<double>(area(bounds)))) {
+        return {bounds};
+    }
+    return prepared;
+}
+
+}  // namespace HumanRecognition::detail
@@ -0,0 +1,94 @@
+﻿#include "internal/enrollment.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <algorithm>
+#include <cmath>
+
+namespace HumanRecognition::detail {
+
+EnrollmentDataset scanEnrollmentDataset(const QString& root) {
+    EnrollmentDataset dataset;
+    const QDir rootDir(root);
+    if (!rootDir.exists()) return dataset;
+
+    const QStringList imageFilters{QStringLiteral("*.jpg"),
+                                   QStringLiteral("*.jpeg"),
+                                   QStringLiteral("*.png"),
+                                   QStringLiteral("*.bmp")};
+    const QFileInfoList personDirs =
+        rootDir.entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name);
+    for (const QFileInfo& personDir : personDirs) {
+        const QDir dir(personDir.absoluteFilePath());
+        // 不带 QDir::CaseSensitive 时名称过滤不区分大小写，可匹配 .JPG 等
+        const QStringList images = dir.entryList(imageFilters, QDir::Files, QDir::Name);
+        if (images.isEmpty()) continue;
+
+        const int person = static_cast<int>(dataset.personIds.size());
+        dataset.personIds.append(personDir.fileName());
+        for (const QString& image : images) {
+            dataset.samples.append(EnrollmentSample{person, dir.filePath(image)});
+        }
+    }
+    return dataset;
+}
+
+FeatureAccumulator::FeatureAccumulator(int persons)
+    : m_counts(std::max(0, persons), 0), m_sums(std::max(0, persons)) {}
+
+bool FeatureAccumulator::add(int person, const float* values, int dimension) {
+    if (person < 0 || person >= m_counts.size() || !values || dimension <= 0) return false;
+    if (m_dimension == 0) {
+        m_dimension = dimension;
+    } else if (dimension != m_dimension) {
+        return false;
+    }
+
+    QVector<double>& sum = m_sums[person];
+    if (sum.isEmpty()) sum.fill(0.0, m_dimension);
+    for (int i = 0; i < m_dimension; ++i) sum[i] += values[i];
+    ++m_counts[person];
+    return true;
+}
+
+void FeatureAccumulator::merge(const FeatureAccumulator& other) {
+    if (other.m_counts.size() != m_counts.size() || other.m_dimension == 0) return;
+    if (m_dimension == 0) {
+        m_dimension = other.m_dimension;
+    } else if (other.m_dimension != m_dimension) {
+        return;
+    }
+
+    for (int person = 0; person < m_counts.size(); ++person) {
+        const QVector<double>& source = other.m_sums[person];
+        if (source.isEmpty()) continue;
+        QVector<double>& sum = m_sums[person];
+        if (sum.isEmpty()) sum.fill(0.0, m_dimension);
+        for (int i = 0; i < m_dimension; ++i) sum[i] += source[i];
+        m_counts[person] += other.m_counts[person];
+    }
+}
+
+int FeatureAccumulator::count(int person) const {
+    return person >= 0 && person < m_counts.size() ? m_counts[person] : 0;
+}
+
+std::optional<FaceFeature> FeatureAccumulator::mean(int person, const QString& version) const {
+    const int n = count(person);
+    if (n == 0) return std::nullopt;
+
+    FaceFeature feature;
+    feature.values.resize(m_dimension);
+    double squared = 0.0;
+    const QVector<double>& sum = m_sums[person];
+    for (int i = 0; i < m_dimension; ++i) {
+        const double value = sum[i] / n;
+        feature.values[i] = static_cast<float>(value);
+        squared += value * value;
+    }
+    feature.version = version;
+    feature.norm = static_cast<float>(std::sqrt(squared));
+    return feature;
+}
+
+}  // namespace HumanRecognition::detail
@@ -0,0 +1,141 @@
+﻿#include "face_tracker.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "internal/detection_tiles.h"
+
+namespace HumanRecognition {
+
+namespace {
+
+QPointF centerOf(const QRect& rect) {
+    return QPointF(rect.x() + rect.width() / 2.0, rect.y() + rect.height() / 2.0);
+}
+
+/**
+ * @brief 按速度平移矩形，得到当前帧的预测位置。
+ */
+QRect predictRect(const FaceTrack& track) {
+    return track.rect.translated(static_cast<int>(std::lround(track.velocity.x())),
+                                 static_cast<int>(std::lround(track.velocity.y())));
+}
+
+}  // namespace
+
+FaceTracker::FaceTracker(const FaceTrackerOptions& options) : m_options(options) {}
+
+void FaceTracker::update(QVector<FaceBox>& boxes) {
+    ++m_stats.framesProcessed;
+
+    QVector<QRect> predicted;
+    predicted.reserve(m_tracks.size());
+    for (const FaceTrack& track : m_tracks) predicted.append(predictRect(track));
+
+    // 收集所有满足阈值的 (轨迹, 检测框) 组合，按 IoU 从大到小贪心关联
+    struct Candidate {
+        double iou;
+        int track;
+        int box;
+    };
+    std::vector<Candidate> candidates;
+    for (int t = 0; t < m_tracks.size(); ++t) {
+        for (int b = 0; b < boxes.size(); ++b) {
+            const double iou = detail::intersectionOverUnion(predicted[t], boxes[b].rect);
+            if (iou >= m_options.iouThreshold) candidates.push_back({iou, t, b});
+        }
+    }
+    std::stable_sort(candidates.begin(), candidates.end(), [](const auto& a, const auto& b) {
+        return a.iou > b.iou;
+    });
+
+    std::vector<int> boxToTrack(static_cast<std::size_t>(boxes.size()), -1);
+    std::vector<bool> trackMatched(static_cast<std::size_t>(m_tracks.size()), false);
+    for (const Candidate& c : candidates) {
+        if (trackMatched[static_cast<std::size_t>(c.track)]) continue;
+        if (boxToTrack[static_cast<std::size_t>(c.box)] >= 0) continue;
+        trackMatched[static_cast<std::size_t>(c.track)] = true;
+        boxToTrack[static_cast<std::size_t>(c.box)] = c.track;
+    }
+
+    const double alpha = std::clamp(m_options.velocitySmoothing, 0.0, 1.0);
+    for (int b = 0; b < boxes.size(); ++b) {
+        const int t = boxToTrack[static_cast<std::size_t>(b)];
+        if (t < 0) continue;
+        FaceTrack& track = m_tracks[t];
+        const QPointF shift = centerOf(boxes[b].rect) - centerOf(track.rect);
+        track.velocity = alpha * shift + (1.0 - alpha) * track.velocity;
+        track.rect = boxes[b].rect;
+        ++track.hits;
+        track.missed = 0;
+        ++track.framesSinceRecognition;
+        boxes[b].trackId = track.id;
+    }
+
+    // 未关联的轨迹沿预测位置继续外推，连续丢失过多帧后删除
+    for (int t = 0; t < m_tracks.size(); ++t) {
+        if (trackMatched[static_cast<std::size_t>(t)]) continue;
+        FaceTrack& track = m_tracks[t];
+        track.rect = predicted[t];
+        ++track.missed;
+        ++track.framesSinceRecognition;
+    }
+    m_tracks.erase(std::remove_if(m_tracks.begin(),
+                                  m_tracks.end(),
+                                  [this](const FaceTrack& track) {
+                                      return track.missed > m_options.maxMissedFrames;
+                                  }),
+                   m_tracks.end());
+
+    for (int b = 0; b < boxes.size(); ++b) {
+        if (boxToTrack[static_cast<std::size_t>(b)] >= 0) continue;
+        FaceTrack track;
+        track.id = m_nextId++;
+        track.rect = boxes[b].rect;
+        track.hits = 1;
+        boxes[b].trackId = track.id;
+        m_tracks.append(track);
+        ++m_stats.tracksCreated;
+    }
+
+    for (const FaceBox& box : boxes) {
+        if (needsRecognition(box.trackId)) {
+            ++m_stats.recognitionsRequested;
+        } else {
+            ++m_stats.recognitionsReused;
+        }
+    }
+}
+
+bool FaceTracker::needsRecognition(int trackId) const {
+    const FaceTrack* found = track(trackId);
+    if (!found) return false;
+    if (!found->recognized) return true;
+    return m_options.reverifyEveryNFrames > 0 &&
+           found->framesSinceRecognition >= m_options.reverifyEveryNFrames;
+}
+
+void FaceTracker::setRecognition(int trackId, const std::optional<RecognitionMatch>& match) {
+    FaceTrack* found = findTrack(trackId);
+    if (!found) return;
+    found->recognized = true;
+    found->framesSinceRecognition = 0;
+    found->match = match;
+}
+
+const FaceTrack* FaceTracker::track(int trackId) const {
+    for (const FaceTrack& track : m_tracks) {
+        if (track.id == trackId) return &track;
+    }
+    return nullptr;
+}
+
+FaceTrack* FaceTracker::findTrack(int trackId) {
+    for (FaceTrack& track : m_tracks) {
+        if (track.id == trackId) return &track;
+    }
+    return nullptr;
+}
+
+}  // namespace HumanRecognition
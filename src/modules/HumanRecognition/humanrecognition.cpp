@@ -1,15 +1,196 @@
 ﻿#include "humanrecognition.h"
 
+#include <QDateTime>
+#include <QUuid>
+#include <atomic>
 #include <mutex>
 
 #include "factory.h"
+#include "internal/latency_stats.h"
+#include "internal/recognition_cache.h"
+#include "internal/request_queue.h"
 
 namespace HumanRecognition {
 
+namespace {
+
+using Clock = detail::RequestQueue::Clock;
+
+double elapsedMs(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+std::optional<Clock::time_point> deadlineFor(const RequestOptions& request) {
+    if (request.deadline.count() <= 0) return std::nullopt;
+    return Clock::now() + request.deadline;
+}
+
+detail::DegradationPolicy::Options policyOptions(const RequestQueueOptions& options) {
+    detail::DegradationPolicy::Options policy;
+    policy.degradedMaxSide = options.degradedMaxSide;
+    policy.safetyFactor = options.budgetSafetyFactor;
+    return policy;
+}
+
+}  // namespace
+
 struct HumanRecognition::Impl {
-    std::unique_ptr<IHumanRecognitionBackend> backend;
+    /// 后端报告的识别参数版本：阈值、检索编码等热更新时由后端回调递增（先于 backend 声明，
+    /// 后端析构时回调仍可访问）；cacheGeneration 记录结果缓存对应的版本
+    std::atomic<quint64> resultsGeneration{0};
+    std::atomic<quint64> cacheGeneration{0};
+    /// 共享所有权：批量入库在 mtx 之外运行，期间切换后端不会析构正在使用的实例
+    std::shared_ptr<IHumanRecognitionBackend> backend;
     QString backendName;
     std::mutex mtx;
+    /// recognize() 结果缓存；自带锁，查找不需要持有 mtx，写入与失效在 mtx 内进行
+    detail::RecognitionCache cache;
+    /// 各阶段延迟直方图与降级计数（无锁）
+    detail::PipelineMetrics metrics;
+    /// 异步请求的降级策略，检测与识别的耗时特征不同，分别估计
+    detail::DegradationPolicy detectPolicy;
+    detail::DegradationPolicy recognizePolicy;
+
+    std::mutex queueMtx;
+    RequestQueueOptions queueOptions;
+    /// 最后声明：析构时先停止工作线程，再释放后端
+    std::unique_ptr<detail::RequestQueue> queue;
+
+    /// 懒创建异步队列
+    detail::RequestQueue& ensureQueue() {
+        std::lock_guard<std::mutex> lock(queueMtx);
+        if (!queue) queue = std::make_unique<detail::RequestQueue>(queueOptions);
+        return *queue;
+    }
+
+    /**
+     * @brief 挂接后端的结果变化通知；只递增版本号，不获取门面锁，配置回调不会与门面互相等待
+     */
+    void attachBackend(IHumanRecognitionBackend& b) {
+        b.setResultsChangedCallback(
+            [this]() { resultsGeneration.fetch_add(1, std::memory_order_acq_rel); });
+    }
+
+    /**
+     * @brief 识别参数版本变化后清空结果缓存，返回当前版本供写入缓存前确认
+     */
+    quint64 syncCacheGeneration() {
+        const quint64 generation = resultsGeneration.load(std::memory_order_acquire);
+        if (cacheGeneration.exchange(generation, std::memory_order_acq_rel) != generation) {
+            cache.invalidate();
+        }
+        return generation;
+    }
+
+    /**
+     * @brief 异步请求开始执行时按剩余预算选择降级档位并计数
+     */
+    DegradationLevel chooseDegradation(const detail::DegradationPolicy& policy,
+                                       const RequestOptions& request,
+                                       const std::optional<Clock::time_point>& deadline,
+                                       const QImage& image,
+                                       const DetectOptions& opts) {
+        DegradationLevel level = DegradationLevel::None;
+        if (request.allowDegradation && deadline) {
+            const double remainingMs =
+                std::chrono::duration<double, std::milli>(*deadline - Clock::now()).count();
+            level = policy.choose(remainingMs, image.size(), opts);
+        }
+        metrics.countDegradation(level);
+        return level;
+    }
+
+    /**
+     * @brief submitDetect 的检测实现：等待门面锁 → 检测，与 recognize() 一样记录各阶段耗时
+     */
+    HRCode detect(const QImage& image,
+                  const DetectOptions& opts,
+                  QVector<FaceBox>& outBoxes,
+                  FrameContextPtr& outContext) {
+        outContext.reset();
+        auto stageStart = Clock::now();
+        std::lock_guard<std::mutex> lock(mtx);
+        metrics.lock.record(elapsedMs(stageStart));
+        if (!backend) return HRCode::UnknownError;
+
+        stageStart = Clock::now();
+        const HRCode code = backend->detectWithContext(image, opts, outBoxes, outContext);
+        metrics.detect.record(elapsedMs(stageStart));
+        return code;
+    }
+
+    /**
+     * @brief recognize() 的实现：缓存查找 → 等待门面锁 → 检测 → 批量特征 → 检索，逐阶段计时
+     * @param cacheHit 可选，输出结果是否来自缓存
+     */
+    HRCode recognize(const QImage& image,
+                     const DetectOptions& opts,
+                     QVector<RecognitionResult>& outResults,
+                     bool* cacheHit = nullptr) {
+        outResults.clear();
+        if (cacheHit) *cacheHit = false;
+        // 近似相同的重复帧直接返回缓存结果，不必等待正在执行的其他请求释放门面锁
+        const quint64 generation = syncCacheGeneration();
+        std::optional<detail::RecognitionCache::Key> key;
+        if (!image.isNull() && cache.enabled()) {
+            key = detail::RecognitionCache::makeKey(image, opts);
+            HRCode cached = HRCode::Ok;
+            if (cache.lookup(*key, cached, outResults)) {
+                if (cacheHit) *cacheHit = true;
+                return cached;
+            }
+        }
+
+        auto stageStart = Clock::now();
+        std::lock_guard<std::mutex> lock(mtx);
+        metrics.lock.record(elapsedMs(stageStart));
+        if (!backend) return HRCode::UnknownError;
+
+        stageStart = Clock::now();
+        QVector<FaceBox> boxes;
+        FrameContextPtr context;
+        const HRCode detectCode = backend->detectWithContext(image, opts, boxes, context);
+        metrics.detect.record(elapsedMs(stageStart));
+        if (detectCode != HRCode::Ok) {
+            // 没有人脸的空场景同样值得缓存；其他错误可能是暂时性的，不缓存
+            if (key && detectCode == HRCode::DetectFailed && generation == resultsGeneration) {
+                cache.insert(*key, detectCode, outResults);
+            }
+            return detectCode;
+        }
+
+        matchFacesLocked(context, image, boxes, outResults);
+        // 计算期间参数发生变化时结果可能按旧阈值得出，不写入缓存
+        if (key && generation == resultsGeneration) cache.insert(*key, HRCode::Ok, outResults);
+        return HRCode::Ok;
+    }
+
+    /**
+     * @brief 对已检测到的人脸批量提取特征并检索；调用方持有 mtx
+     */
+    void matchFacesLocked(const FrameContextPtr& context,
+                          const QImage& image,
+                          const QVector<FaceBox>& boxes,
+                          QVector<RecognitionResult>& outResults) {
+        auto stageStart = Clock::now();
+        QVector<FaceFeature> features;
+        backend->extractFeatures(context, image, boxes, features);
+        metrics.extract.record(elapsedMs(stageStart));
+
+        stageStart = Clock::now();
+        outResults.reserve(boxes.size());
+        for (int i = 0; i < boxes.size(); ++i) {
+            RecognitionResult result;
+            result.face = boxes[i];
+            if (i < features.size() && !features[i].values.isEmpty()) {
+                RecognitionMatch match;
+                if (backend->findNearest(features[i], match) == HRCode::Ok) result.match = match;
+                result.feat = std::move(features[i]);
+            }
+            outResults.append(std::move(result));
+        }
+        metrics.match.record(elapsedMs(stageStart));
+    }
 };
 
 HumanRecognition& HumanRecognition::instance() {
@@ -27,6 +208,7 @@ HumanRecognition::~HumanRecognition() = default;
 HRCode HumanRecognition::loadModel(const path& modelPath) {
     std::lock_guard<std::mutex> lock(m_impl->mtx);
     if (!m_impl->backend) return HRCode::UnknownError;
+    m_impl->cache.invalidate();
     return m_impl->backend->loadModel(QString::fromStdWString(modelPath.wstring()));
 }
 
@@ -88,9 +270,14 @@ HRCode HumanRecognition::setBackend(const QString& backendName) {
     auto b = createBackendInstance(backendName);
     if (!b) return HRCode::UnknownError;
     // 关闭旧后端
-    if (m_impl->backend) m_impl->backend->shutdown();
+    if (m_impl->backend) {
+        m_impl->backend->setResultsChangedCallback({});
+        m_impl->backend->shutdown();
+    }
+    m_impl->attachBackend(*b);
     m_impl->backend = std::move(b);
     m_impl->backendName = backendName;
+    m_impl->cache.invalidate();
     return HRCode::Ok;
 }
 
@@ -112,9 +299,11 @@ bool HumanRecognition::hasBackend() const {
 HRCode HumanRecognition::resetBackend() {
     std::lock_guard<std::mutex> lock(m_impl->mtx);
     if (m_impl->backend) {
+        m_impl->backend->setResultsChangedCallback({});
         m_impl->backend->shutdown();
         m_impl->backend.reset();
         m_impl->backendName.clear();
+        m_impl->cache.invalidate();
     }
     return HRCode::Ok;
 }
@@ -135,6 +324,254 @@ HRCode HumanRecognition::extractFeature(const QImage& image,
     return m_impl->backend->extractFeature(image, box, outFeature);
 }
 
+HRCode HumanRecognition::detect(const QImage& image,
+                                const DetectOptions& opts,
+                                QVector<FaceBox>& outBoxes,
+                                FrameContextPtr& outContext) {
+    std::lock_guard<std::mutex> lock(m_impl->mtx);
+    outContext.reset();
+    if (!m_impl->backend) return HRCode::UnknownError;
+    return m_impl->backend->detectWithContext(image, opts, outBoxes, outContext);
+}
+
+HRCode HumanRecognition::extractFeature(const FrameContextPtr& context,
+                                        const QImage& image,
+                                        const FaceBox& box,
+                                        FaceFeature& outFeature) {
+    std::lock_guard<std::mutex> lock(m_impl->mtx);
+    if (!m_impl->backend) return HRCode::UnknownError;
+    return m_impl->backend->extractFeatureWithContext(context, image, box, outFeature);
+}
+
+HRCode HumanRecognition::extractFeatures(const FrameContextPtr& context,
+                                         const QImage& image,
+                                         const QVector<FaceBox>& boxes,
+                                         QVector<FaceFeature>& outFeatures) {
+    std::lock_guard<std::mutex> lock(m_impl->mtx);
+    outFeatures.clear();
+    if (!m_impl->backend) return HRCode::UnknownError;
+    return m_impl->backend->extractFeatures(context, image, boxes, outFeatures);
+}
+
+HRCode HumanRecognition::recognize(const QImage& image,
+                                   const DetectOptions& opts,
+                                   QVector<RecognitionResult>& outResults) {
+    const auto start = Clock::now();
+    const HRCode code = m_impl->recognize(image, opts, outResults);
+    m_impl->metrics.total.record(elapsedMs(start));
+    return code;
+}
+
+std::future<DetectResponse> HumanRecognition::submitDetect(const QImage& image,
+                                                           const DetectOptions& opts,
+                                                           const RequestOptions& request) {
+    auto promise = std::make_shared<std::promise<DetectResponse>>();
+    auto future = promise->get_future();
+    submitDetect(image, opts, request, [promise](DetectResponse response) {
+        promise->set_value(std::move(response));
+    });
+    return future;
+}
+
+void HumanRecognition::submitDetect(const QImage& image,
+                                    const DetectOptions& opts,
+                                    const RequestOptions& request,
+                                    std::function<void(DetectResponse)> callback) {
+    auto shared = std::make_shared<std::function<void(DetectResponse)>>(std::move(callback));
+    detail::RequestQueue::Task task;
+    task.priority = request.priority;
+    task.deadline = deadlineFor(request);
+    task.run = [this, image, opts, request, deadline = task.deadline, shared](double queueMs) {
+        DetectResponse response;
+        response.timing.queueMs = queueMs;
+        m_impl->metrics.queue.record(queueMs);
+        detail::DegradationPolicy& policy = m_impl->detectPolicy;
+        const auto start = Clock::now();
+        const DegradationLevel level =
+            m_impl->chooseDegradation(policy, request, deadline, image, opts);
+        response.timing.degradation = level;
+        if (level == DegradationLevel::Skipped) {
+            response.code = HRCode::DeadlineExceeded;
+        } else {
+            const DetectOptions effective = policy.apply(level, image.size(), opts);
+            response.code =
+                m_impl->detect(image, effective, response.boxes, response.context);
+            response.timing.processingMs = elapsedMs(start);
+            m_impl->metrics.total.record(response.timing.processingMs);
+            if (response.code == HRCode::Ok || response.code == HRCode::DetectFailed) {
+                policy.observe(level, image.size(), effective, response.timing.processingMs);
+            }
+        }
+        if (*shared) (*shared)(std::move(response));
+    };
+    task.reject = [shared](HRCode reason) {
+        DetectResponse response;
+        response.code = reason;
+        if (*shared) (*shared)(std::move(response));
+    };
+    m_impl->ensureQueue().submit(std::move(task));
+}
+
+std::future<RecognizeResponse> HumanRecognition::submitRecognize(const QImage& image,
+                                                                 const DetectOptions& opts,
+                                                                 const RequestOptions& request) {
+    auto promise = std::make_shared<std::promise<RecognizeResponse>>();
+    auto future = promise->get_future();
+    submitRecognize(image, opts, request, [promise](RecognizeResponse response) {
+        promise->set_value(std::move(response));
+    });
+    return future;
+}
+
+void HumanRecognition::submitRecognize(const QImage& image,
+                                       const DetectOptions& opts,
+                                       const RequestOptions& request,
+                                       std::function<void(RecognizeResponse)> callback) {
+    auto shared = std::make_shared<std::function<void(RecognizeResponse)>>(std::move(callback));
+    RecognizeResponse header;
+    header.requestId = QUuid::createUuid().toString(QUuid::WithoutBraces);
+    header.timestamp = QDateTime::currentSecsSinceEpoch();
+
+    detail::RequestQueue::Task task;
+    task.priority = request.priority;
+    task.deadline = deadlineFor(request);
+    task.run = [this, image, opts, request, deadline = task.deadline, shared, header](
+                   double queueMs) {
+        RecognizeResponse response = header;
+        response.timing.queueMs = queueMs;
+        m_impl->metrics.queue.record(queueMs);
+        detail::DegradationPolicy& policy = m_impl->recognizePolicy;
+        const auto start = Clock::now();
+        const DegradationLevel level =
+            m_impl->chooseDegradation(policy, request, deadline, image, opts);
+        response.timing.degradation = level;
+        if (level == DegradationLevel::Skipped) {
+            response.code = HRCode::DeadlineExceeded;
+        } else {
+            const DetectOptions effective = policy.apply(level, image.size(), opts);
+            bool cacheHit = false;
+            response.code = m_impl->recognize(image, effective, response.results, &cacheHit);
+            response.timing.processingMs = elapsedMs(start);
+            m_impl->metrics.total.record(response.timing.processingMs);
+            // 缓存命中的耗时不代表后端处理能力，不参与估计
+            if (!cacheHit &&
+                (response.code == HRCode::Ok || response.code == HRCode::DetectFailed)) {
+                policy.observe(level, image.size(), effective, response.timing.processingMs);
+            }
+        }
+        if (*shared) (*shared)(std::move(response));
+    };
+    task.reject = [shared, header](HRCode reason) {
+        RecognizeResponse response = header;
+        response.code = reason;
+        if (*shared) (*shared)(std::move(response));
+    };
+    m_impl->ensureQueue().submit(std::move(task));
+}
+
+std::future<RecognizeResponse> HumanRecognition::submitMatchFaces(const FrameContextPtr& context,
+                                                                  const QImage& image,
+                                                                  const QVector<FaceBox>& boxes,
+                                                                  const RequestOptions& request) {
+    auto promise = std::make_shared<std::promise<RecognizeResponse>>();
+    auto future = promise->get_future();
+    submitMatchFaces(context, image, boxes, request, [promise](RecognizeResponse response) {
+        promise->set_value(std::move(response));
+    });
+    return future;
+}
+
+void HumanRecognition::submitMatchFaces(const FrameContextPtr& context,
+                                        const QImage& image,
+                                        const QVector<FaceBox>& boxes,
+                                        const RequestOptions& request,
+                                        std::function<void(RecognizeResponse)> callback) {
+    auto shared = std::make_shared<std::function<void(RecognizeResponse)>>(std::move(callback));
+    RecognizeResponse header;
+    header.requestId = QUuid::createUuid().toString(QUuid::WithoutBraces);
+    header.timestamp = QDateTime::currentSecsSinceEpoch();
+
+    detail::RequestQueue::Task task;
+    task.priority = request.priority;
+    task.deadline = deadlineFor(request);
+    // 人脸已检测完成，没有可降级的档位；截止时间只用于丢弃排队过久的请求
+    task.run = [this, context, image, boxes, shared, header](double queueMs) {
+        RecognizeResponse response = header;
+        response.timing.queueMs = queueMs;
+        m_impl->metrics.queue.record(queueMs);
+        const auto start = Clock::now();
+        {
+            std::lock_guard<std::mutex> lock(m_impl->mtx);
+            m_impl->metrics.lock.record(elapsedMs(start));
+            if (!m_impl->backend) {
+                response.code = HRCode::UnknownError;
+            } else {
+                m_impl->matchFacesLocked(context, image, boxes, response.results);
+                response.code = HRCode::Ok;
+            }
+        }
+        response.timing.processingMs = elapsedMs(start);
+        if (*shared) (*shared)(std::move(response));
+    };
+    task.reject = [shared, header](HRCode reason) {
+        RecognizeResponse response = header;
+        response.code = reason;
+        if (*shared) (*shared)(std::move(response));
+    };
+    m_impl->ensureQueue().submit(std::move(task));
+}
+
+void HumanRecognition::setRequestQueueOptions(const RequestQueueOptions& options) {
+    std::unique_ptr<detail::RequestQueue> previous;
+    {
+        std::lock_guard<std::mutex> lock(m_impl->queueMtx);
+        m_impl->queueOptions = options;
+        previous = std::move(m_impl->queue);
+    }
+    m_impl->detectPolicy.setOptions(policyOptions(options));
+    m_impl->recognizePolicy.setOptions(policyOptions(options));
+    // 在锁外销毁旧队列：等待正在执行的请求完成，并拒绝仍在排队的请求
+    previous.reset();
+}
+
+RequestQueueOptions HumanRecognition::requestQueueOptions() const {
+    std::lock_guard<std::mutex> lock(m_impl->queueMtx);
+    return m_impl->queueOptions;
+}
+
+void HumanRecognition::setRecognitionCacheOptions(const RecognitionCacheOptions& options) {
+    std::lock_guard<std::mutex> lock(m_impl->mtx);
+    m_impl->cache.setOptions(options);
+    m_impl->cache.invalidate();
+}
+
+RecognitionCacheOptions HumanRecognition::recognitionCacheOptions() const {
+    return m_impl->cache.options();
+}
+
+RecognitionCacheStats HumanRecognition::recognitionCacheStats() const {
+    return m_impl->cache.stats();
+}
+
+void HumanRecognition::invalidateRecognitionCache() {
+    std::lock_guard<std::mutex> lock(m_impl->mtx);
+    m_impl->cache.invalidate();
+}
+
+QJsonObject HumanRecognition::latencyStats() const {
+    QJsonObject policies;
+    policies.insert(QStringLiteral("detect"), m_impl->detectPolicy.toJson());
+    policies.insert(QStringLiteral("recognize"), m_impl->recognizePolicy.toJson());
+
+    QJsonObject json = m_impl->metrics.toJson();
+    json.insert(QStringLiteral("policies"), policies);
+    return json;
+}
+
+void HumanRecognition::resetLatencyStats() {
+    m_impl->metrics.reset();
+}
+
 HRCode HumanRecognition::compare(const FaceFeature& a, const FaceFeature& b, float& outDistance) {
     std::lock_guard<std::mutex> lock(m_impl->mtx);
     if (!m_impl->backend) return HRCode::UnknownError;
@@ -150,12 +587,22 @@ HRCode HumanRecognition::findNearest(const FaceFeature& feature, RecognitionMatc
 HRCode HumanRecognition::registerPerson(const PersonInfo& person) {
     std::lock_guard<std::mutex> lock(m_impl->mtx);
     if (!m_impl->backend) return HRCode::UnknownError;
+    m_impl->cache.invalidate();
     return m_impl->backend->registerPerson(person);
 }
 
+HRCode HumanRecognition::registerPersons(const QVector<PersonInfo>& persons,
+                                         bool replaceExisting) {
+    std::lock_guard<std::mutex> lock(m_impl->mtx);
+    if (!m_impl->backend) return HRCode::UnknownError;
+    m_impl->cache.invalidate();
+    return m_impl->backend->registerPersons(persons, replaceExisting);
+}
+
 HRCode HumanRecognition::removePerson(const QString& personId) {
     std::lock_guard<std::mutex> lock(m_impl->mtx);
     if (!m_impl->backend) return HRCode::UnknownError;
+    m_impl->cache.invalidate();
     return m_impl->backend->removePerson(personId);
 }
 
@@ -172,9 +619,33 @@ HRCode HumanRecognition::listPersons(QVector<PersonInfo>& outPersons) {
 }
 
 HRCode HumanRecognition::train(const QString& datasetPath) {
+    // 默认 enrollDataset 会回到后端的 train()，两者走同一条不持有门面锁的路径
+    return enrollDataset(datasetPath, EnrollOptions());
+}
+
+HRCode HumanRecognition::enrollDataset(const QString& datasetPath, const EnrollOptions& opts) {
+    std::shared_ptr<IHumanRecognitionBackend> backend;
+    {
+        std::lock_guard<std::mutex> lock(m_impl->mtx);
+        backend = m_impl->backend;
+    }
+    if (!backend) return HRCode::UnknownError;
+
+    // 解码、检测与特征提取不持有门面锁（进度回调可以调用本对象的其他接口），
+    // 只有最终写入人员库与结果缓存失效在锁内完成，与 recognize() 互斥
+    EnrollOptions options = opts;
+    options.commit = [this, backend](const QVector<PersonInfo>& persons, bool replaceExisting) {
+        std::lock_guard<std::mutex> lock(m_impl->mtx);
+        if (m_impl->backend != backend) return HRCode::UnknownError;
+        m_impl->cache.invalidate();
+        return backend->registerPersons(persons, replaceExisting);
+    };
+    const HRCode code = backend->enrollDataset(datasetPath, options);
+
+    // 不使用 commit 的后端在自己的流程中写入，入库结束后再统一失效一次
     std::lock_guard<std::mutex> lock(m_impl->mtx);
-    if (!m_impl->backend) return HRCode::UnknownError;
-    return m_impl->backend->train(datasetPath);
+    m_impl->cache.invalidate();
+    return code;
 }
 
 }  // namespace HumanRecognition
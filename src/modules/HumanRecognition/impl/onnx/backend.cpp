@@ -0,0 +1,239 @@
+﻿#include "modules/HumanRecognition/impl/onnx/backend.h"
+
+#include "internal/backend_constants.h"
+#include "logging/logging.h"
+#include "modules/HumanRecognition/factory.h"
+
+namespace {
+std::shared_ptr<spdlog::logger> backendLogger() {
+    return logging::LoggerManager::instance().getLogger("HumanRecognition.Onnx");
+}
+}  // namespace
+
+#if defined(HAS_ONNXRUNTIME) && defined(HAS_OPENCV)
+
+#include "internal/backend_impl.h"
+
+namespace HumanRecognition {
+
+OnnxRuntimeBackend::OnnxRuntimeBackend() : d(std::make_unique<Impl>()) {}
+OnnxRuntimeBackend::~OnnxRuntimeBackend() = default;
+
+HRCode OnnxRuntimeBackend::initialize(const QJsonObject& config) {
+    return d->initialize(config);
+}
+
+HRCode OnnxRuntimeBackend::shutdown() {
+    return d->shutdown();
+}
+
+HRCode OnnxRuntimeBackend::loadModel(const QString& modelPath) {
+    return d->loadModel(modelPath);
+}
+
+HRCode OnnxRuntimeBackend::saveModel(const QString& modelPath) {
+    return d->saveModel(modelPath);
+}
+
+HRCode OnnxRuntimeBackend::detect(const QImage& image,
+                                  const DetectOptions& opts,
+                                  QVector<FaceBox>& outBoxes) {
+    FrameContextPtr unused;
+    return d->detectWithContext(image, opts, outBoxes, unused);
+}
+
+HRCode OnnxRuntimeBackend::extractFeature(const QImage& image,
+                                          const FaceBox& box,
+                                          FaceFeature& outFeature) {
+    return extractFeatureWithContext(nullptr, image, box, outFeature);
+}
+
+HRCode OnnxRuntimeBackend::detectWithContext(const QImage& image,
+                                             const DetectOptions& opts,
+                                             QVector<FaceBox>& outBoxes,
+                                             FrameContextPtr& outContext) {
+    return d->detectWithContext(image, opts, outBoxes, outContext);
+}
+
+HRCode OnnxRuntimeBackend::extractFeatureWithContext(const FrameContextPtr& context,
+                                                     const QImage& image,
+                                                     const FaceBox& box,
+                                                     FaceFeature& outFeature) {
+    QVector<FaceFeature> features;
+    const HRCode res = d->extractFeatures(context, image, {box}, features);
+    if (res != HRCode::Ok) return res;
+    outFeature = features.value(0);
+    return HRCode::Ok;
+}
+
+HRCode OnnxRuntimeBackend::extractFeatures(const FrameContextPtr& context,
+                                           const QImage& image,
+                                           const QVector<FaceBox>& boxes,
+                                           QVector<FaceFeature>& outFeatures) {
+    return d->extractFeatures(context, image, boxes, outFeatures);
+}
+
+HRCode OnnxRuntimeBackend::compare(const FaceFeature& a, const FaceFeature& b, float& outDistance) {
+    return d->compare(a, b, outDistance);
+}
+
+HRCode OnnxRuntimeBackend::findNearest(const FaceFeature& feature, RecognitionMatch& outMatch) {
+    return d->findNearest(feature, outMatch);
+}
+
+HRCode OnnxRuntimeBackend::registerPerson(const PersonInfo& person) {
+    return d->registerPerson(person);
+}
+
+HRCode OnnxRuntimeBackend::removePerson(const QString& personId) {
+    return d->removePerson(personId);
+}
+
+HRCode OnnxRuntimeBackend::getPerson(const QString& personId, PersonInfo& outPerson) {
+    return d->getPerson(personId, outPerson);
+}
+
+HRCode OnnxRuntimeBackend::listPersons(QVector<PersonInfo>& outPersons) {
+    return d->listPersons(outPersons);
+}
+
+void OnnxRuntimeBackend::setResultsChangedCallback(std::function<void()> callback) {
+    d->setResultsChangedCallback(std::move(callback));
+}
+
+QString OnnxRuntimeBackend::backendName() const {
+    return d->backendName();
+}
+
+namespace {
+struct BackendRegistrar {
+    BackendRegistrar() {
+        registerBackendFactory(QString::fromLatin1(onnx::kBackendName),
+                               []() -> std::unique_ptr<IHumanRecognitionBackend> {
+                                   return std::make_unique<OnnxRuntimeBackend>();
+                               });
+
+        registerBackendFactory(
+            QString::fromLatin1(onnx::kBackendName),
+            [](const QJsonObject& config) -> std::unique_ptr<IHumanRecognitionBackend> {
+                auto backend = std::make_unique<OnnxRuntimeBackend>();
+                if (backend->initialize(config) != HRCode::Ok) {
+                    if (auto logger = backendLogger()) {
+                        logger->error(
+                            "OnnxRuntimeBackend initialization failed for configured factory");
+                    }
+                    return {};
+                }
+                return backend;
+            });
+    }
+
+    ~BackendRegistrar() { unregisterBackendFactory(QString::fromLatin1(onnx::kBackendName)); }
+};
+
+static BackendRegistrar s_registrar;
+}  // namespace
+
+}  // namespace HumanRecognition
+
+#else  // defined(HAS_ONNXRUNTIME) && defined(HAS_OPENCV)
+
+namespace HumanRecognition {
+
+// 未启用 ONNX Runtime 时不注册工厂，仅保留可链接的空实现
+class OnnxRuntimeBackend::Impl {};
+
+OnnxRuntimeBackend::OnnxRuntimeBackend() = default;
+OnnxRuntimeBackend::~OnnxRuntimeBackend() = default;
+
+HRCode OnnxRuntimeBackend::initialize(const QJsonObject& config) {
+    Q_UNUSED(config);
+    if (auto logger = backendLogger()) {
+        logger->error(
+            "OnnxRuntimeBackend unavailable: ONNX Runtime support disabled at build time");
+    }
+    return HRCode::UnknownError;
+}
+
+HRCode OnnxRuntimeBackend::shutdown() {
+    return HRCode::UnknownError;
+}
+
+HRCode OnnxRuntimeBackend::loadModel(const QString&) {
+    if (auto logger = backendLogger()) {
+        logger->error(
+            "OnnxRuntimeBackend loadModel called but backend is unavailable at build time");
+    }
+    return HRCode::ModelLoadFailed;
+}
+
+HRCode OnnxRuntimeBackend::saveModel(const QString&) {
+    return HRCode::ModelSaveFailed;
+}
+
+HRCode OnnxRuntimeBackend::detect(const QImage&, const DetectOptions&, QVector<FaceBox>&) {
+    return HRCode::DetectFailed;
+}
+
+HRCode OnnxRuntimeBackend::extractFeature(const QImage&, const FaceBox&, FaceFeature&) {
+    return HRCode::ExtractFeatureFailed;
+}
+
+HRCode OnnxRuntimeBackend::detectWithContext(const QImage& image,
+                                             const DetectOptions& opts,
+                                             QVector<FaceBox>& outBoxes,
+                                             FrameContextPtr& outContext) {
+    outContext.reset();
+    return detect(image, opts, outBoxes);
+}
+
+HRCode OnnxRuntimeBackend::extractFeatureWithContext(const FrameContextPtr&,
+                                                     const QImage& image,
+                                                     const FaceBox& box,
+                                                     FaceFeature& outFeature) {
+    return extractFeature(image, box, outFeature);
+}
+
+HRCode OnnxRuntimeBackend::extractFeatures(const FrameContextPtr&,
+                                           const QImage&,
+                                           const QVector<FaceBox>&,
+                                           QVector<FaceFeature>& outFeatures) {
+    outFeatures.clear();
+    return HRCode::ExtractFeatureFailed;
+}
+
+HRCode OnnxRuntimeBackend::compare(const FaceFeature&, const FaceFeature&, float& outDistance) {
+    outDistance = 0.0f;
+    return HRCode::CompareFailed;
+}
+
+HRCode OnnxRuntimeBackend::findNearest(const FaceFeature&, RecognitionMatch&) {
+    return HRCode::PersonNotFound;
+}
+
+HRCode OnnxRuntimeBackend::registerPerson(const PersonInfo&) {
+    return HRCode::UnknownError;
+}
+
+HRCode OnnxRuntimeBackend::removePerson(const QString&) {
+    return HRCode::UnknownError;
+}
+
+HRCode OnnxRuntimeBackend::getPerson(const QString&, PersonInfo&) {
+    return HRCode::PersonNotFound;
+}
+
+HRCode OnnxRuntimeBackend::listPersons(QVector<PersonInfo>& outPersons) {
+    outPersons.clear();
+    return HRCode::UnknownError;
+}
+
+void OnnxRuntimeBackend::setResultsChangedCallback(std::function<void()>) {}
+
+QString OnnxRuntimeBackend::backendName() const {
+    return QString::fromLatin1(onnx::kBackendName);
+}
+
+}  // namespace HumanRecognition
+
+#endif  // defined(HAS_ONNXRUNTIME) && defined(HAS_OPENCV)
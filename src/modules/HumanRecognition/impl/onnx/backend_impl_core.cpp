@@ -0,0 +1,629 @@
+﻿#include "internal/backend_impl.h"
+
+#if defined(HAS_ONNXRUNTIME) && defined(HAS_OPENCV)
+
+#include <QDir>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QSaveFile>
+#include <QVariant>
+#include <QtSql/QSqlDatabase>
+#include <QtSql/QSqlError>
+#include <QtSql/QSqlQuery>
+
+#include "logging/logging.h"
+#include "modules/Config/config.h"
+#include "modules/Storage/dbmanager.h"
+
+namespace HumanRecognition {
+
+using namespace onnx;
+using detail::ModelCache;
+
+namespace {
+
+QJsonObject featureToJson(const FaceFeature& feature) {
+    QJsonObject obj;
+    QJsonArray values;
+    for (float v : feature.values) values.append(v);
+    obj.insert(QStringLiteral("values"), values);
+    obj.insert(QStringLiteral("version"), feature.version);
+    if (feature.norm.has_value()) obj.insert(QStringLiteral("norm"), *feature.norm);
+    return obj;
+}
+
+std::optional<FaceFeature> featureFromJson(const QString& json) {
+    if (json.isEmpty()) return std::nullopt;
+    const QJsonDocument doc = QJsonDocument::fromJson(json.toUtf8());
+    if (!doc.isObject()) return std::nullopt;
+    const QJsonObject obj = doc.object();
+    const QJsonArray values = obj.value(QStringLiteral("values")).toArray();
+    if (values.isEmpty()) return std::nullopt;
+    FaceFeature feat;
+    feat.values.resize(values.size());
+    for (int i = 0; i < values.size(); ++i) {
+        feat.values[i] = static_cast<float>(values.at(i).toDouble());
+    }
+    feat.version = obj.value(QStringLiteral("version")).toString();
+    if (obj.contains(QStringLiteral("norm"))) {
+        feat.norm = static_cast<float>(obj.value(QStringLiteral("norm")).toDouble());
+    }
+    return feat;
+}
+
+/**
+ * @brief 进程共享的 ORT 环境，首次使用时创建。
+ */
+std::shared_ptr<Ort::Env> sharedEnv() {
+    static const std::shared_ptr<Ort::Env> env =
+        std::make_shared<Ort::Env>(ORT_LOGGING_LEVEL_WARNING, "HumanRecognition.Onnx");
+    return env;
+}
+
+/**
+ * @brief 创建 CPU 推理会话：开启全部图优化，算子内并行线程数取配置，算子间串行执行。
+ *
+ * 失败时抛出 Ort::Exception，由模型缓存记录日志。
+ */
+ModelCache::Model createSession(const std::shared_ptr<Ort::Env>& env,
+                                const QString& path,
+                                int intraOpThreads) {
+    Ort::SessionOptions options;
+    options.SetIntraOpNumThreads(intraOpThreads);
+    options.SetInterOpNumThreads(1);
+    options.SetExecutionMode(ExecutionMode::ORT_SEQUENTIAL);
+    options.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_ALL);
+
+    auto model = std::make_shared<OnnxModel>();
+    model->env = env;
+#ifdef _WIN32
+    model->session = std::make_unique<Ort::Session>(*env, path.toStdWString().c_str(), options);
+#else
+    model->session = std::make_unique<Ort::Session>(*env, path.toStdString().c_str(), options);
+#endif
+
+    Ort::AllocatorWithDefaultOptions allocator;
+    model->inputName = model->session->GetInputNameAllocated(0, allocator).get();
+    model->inputShape = model->session->GetInputTypeInfo(0).GetTensorTypeAndShapeInfo().GetShape();
+    const std::size_t outputs = model->session->GetOutputCount();
+    model->outputNames.reserve(outputs);
+    for (std::size_t i = 0; i < outputs; ++i) {
+        model->outputNames.emplace_back(model->session->GetOutputNameAllocated(i, allocator).get());
+    }
+    return model;
+}
+
+}  // namespace
+
+OnnxRuntimeBackend::Impl::Impl()
+    : env(sharedEnv()),
+      logger(logging::LoggerManager::instance().getLogger("HumanRecognition.Onnx")),
+      personsTable(QString::fromLatin1(kDefaultPersonsTable)),
+      matchThreshold(kDefaultMatchThreshold),
+      intraOpThreads(kDefaultIntraOpThreads),
+      detectInputSize(kDefaultDetectInputSize),
+      embeddingBatch(kDefaultEmbeddingBatch) {}
+
+OnnxRuntimeBackend::Impl::~Impl() {
+    // 等待可能正在执行的回调结束，之后不会再访问本对象
+    if (configSubscription != 0) config::ConfigManager::instance().unsubscribe(configSubscription);
+}
+
+/**
+ * @brief 读取配置（JSON 优先于配置中心）并加载人员缓存，配置了模型目录时同时加载模型。
+ */
+HRCode OnnxRuntimeBackend::Impl::initialize(const QJsonObject& config) {
+    if (logger) {
+        logger->info("Initializing OnnxRuntimeBackend with {} config entries",
+                     static_cast<int>(config.size()));
+    }
+    refreshConfiguration();
+    auto& cfg = config::ConfigManager::instance();
+
+    if (config.contains(QStringLiteral("personsTable"))) {
+        personsTable = sanitizeTableName(config.value(QStringLiteral("personsTable")).toString());
+        if (personsTable.isEmpty()) personsTable = QString::fromLatin1(kDefaultPersonsTable);
+        cfg.setValue(QStringLiteral("HumanRecognition/OnnxPersonsTable"), personsTable);
+    }
+
+    if (config.contains(QStringLiteral("matchThreshold"))) {
+        matchThreshold = config.value(QStringLiteral("matchThreshold")).toDouble(matchThreshold);
+        if (matchThreshold < 0.0) matchThreshold = kDefaultMatchThreshold;
+        cfg.setValue(QStringLiteral("HumanRecognition/OnnxMatchThreshold"), matchThreshold);
+    }
+
+    if (config.contains(QStringLiteral("intraOpThreads"))) {
+        // 线程数只在创建会话时生效，已加载的模型需重新 loadModel
+        intraOpThreads = config.value(QStringLiteral("intraOpThreads")).toInt(intraOpThreads);
+        if (intraOpThreads < 0) intraOpThreads = kDefaultIntraOpThreads;
+        cfg.setValue(QStringLiteral("HumanRecognition/OnnxIntraOpThreads"), intraOpThreads);
+    }
+
+    if (config.contains(QStringLiteral("detectInputSize"))) {
+        detectInputSize = config.value(QStringLiteral("detectInputSize")).toInt(detectInputSize);
+        // SCRFD 最大步长为 32，输入边长需为其整数倍
+        if (detectInputSize < 32) detectInputSize = kDefaultDetectInputSize;
+        detectInputSize -= detectInputSize % 32;
+        cfg.setValue(QStringLiteral("HumanRecognition/OnnxDetectInputSize"), detectInputSize);
+    }
+
+    if (config.contains(QStringLiteral("embeddingBatch"))) {
+        embeddingBatch = config.value(QStringLiteral("embeddingBatch")).toInt(embeddingBatch);
+        if (embeddingBatch <= 0) embeddingBatch = kDefaultEmbeddingBatch;
+        cfg.setValue(QStringLiteral("HumanRecognition/OnnxEmbeddingBatch"), embeddingBatch);
+    }
+
+    if (config.contains(QStringLiteral("autoCreateTable"))) {
+        autoCreatePersonsTable =
+            config.value(QStringLiteral("autoCreateTable")).toBool(autoCreatePersonsTable);
+    }
+
+    if (!ensureStorageReady()) return HRCode::ModelLoadFailed;
+
+    if (config.contains(QStringLiteral("modelDirectory"))) {
+        const QString dir = config.value(QStringLiteral("modelDirectory")).toString();
+        if (!dir.isEmpty()) return loadModel(dir);
+    }
+
+    const HRCode res = loadPersonsFromStorage();
+    if (res != HRCode::Ok) return res;
+
+    // 配置文件热加载或运行时修改 HumanRecognition/* 时同步到运行参数
+    if (configSubscription == 0) {
+        configSubscription = cfg.subscribe(
+            QStringLiteral("HumanRecognition"),
+            [this](const config::ConfigSnapshot& snapshot, const QStringList& keys) {
+                applyConfigChange(snapshot, keys);
+            });
+    }
+
+    if (logger) {
+        logger->info(
+            "OnnxRuntimeBackend initialized. Persons table: {}, threshold: {}, threads: {}",
+            personsTable.toStdString(),
+            matchThreshold,
+            intraOpThreads);
+    }
+    return HRCode::Ok;
+}
+
+HRCode OnnxRuntimeBackend::Impl::shutdown() {
+    std::scoped_lock lock(mutex);
+    detector.reset();
+    recognizer.reset();
+    persons.clear();
+    modelDirectory.clear();
+    storageReady = false;
+    if (logger) { logger->info("OnnxRuntimeBackend shut down"); }
+    return HRCode::Ok;
+}
+
+/**
+ * @brief 创建 SCRFD 与 ArcFace 推理会话，成功后替换当前会话并刷新人员缓存。
+ */
+HRCode OnnxRuntimeBackend::Impl::loadModel(const QString& modelPath) {
+    if (logger) { logger->info("Loading ONNX models from {}", modelPath.toStdString()); }
+    QFileInfo info(modelPath);
+    if (!info.exists()) {
+        if (logger) { logger->error("Model path not found: {}", modelPath.toStdString()); }
+        return HRCode::ModelLoadFailed;
+    }
+
+    const ModelFiles files = resolveModelFiles(info);
+    if (files.detector.isEmpty() || files.recognition.isEmpty()) {
+        if (logger) {
+            logger->error(
+                "Missing ONNX models in {}. Expected an SCRFD detector (scrfd*.onnx / det_*.onnx) "
+                "and an ArcFace recognizer (arcface*.onnx / w600k_*.onnx)",
+                files.baseDirectory.toStdString());
+        }
+        return HRCode::ModelLoadFailed;
+    }
+
+    auto det = loadSession(files.detector);
+    auto rec = loadSession(files.recognition);
+    if (!det || !rec) return HRCode::ModelLoadFailed;
+    if (det->outputNames.size() < 6 || rec->outputNames.empty()) {
+        if (logger) {
+            logger->error("Unexpected ONNX model outputs: detector {} outputs, recognizer {}",
+                          det->outputNames.size(),
+                          rec->outputNames.size());
+        }
+        return HRCode::ModelLoadFailed;
+    }
+
+    {
+        std::scoped_lock lock(mutex);
+        detector = std::move(det);
+        recognizer = std::move(rec);
+        modelDirectory = files.baseDirectory;
+    }
+
+    if (!ensureStorageReady()) return HRCode::ModelLoadFailed;
+    const HRCode res = loadPersonsFromStorage();
+    if (res != HRCode::Ok) return res;
+
+    if (logger) {
+        logger->info("Loaded ONNX models: detector={}, recognizer={}",
+                     files.detector.toStdString(),
+                     files.recognition.toStdString());
+    }
+    return HRCode::Ok;
+}
+
+/**
+ * @brief 将人员库导出为 JSON（格式与 opencv_dlib 后端的 people.json 相同）。
+ */
+HRCode OnnxRuntimeBackend::Impl::saveModel(const QString& modelPath) {
+    QFileInfo info(modelPath);
+    const bool isJson = info.suffix().compare("json", Qt::CaseInsensitive) == 0;
+    const QString directory =
+        (info.exists() && info.isDir()) || (!info.exists() && info.suffix().isEmpty())
+            ? info.absoluteFilePath()
+            : info.absolutePath();
+    const QString jsonPath =
+        isJson ? info.absoluteFilePath() : QDir(directory).filePath(QStringLiteral("people.json"));
+    if (directory.isEmpty() || !QDir().mkpath(directory)) return HRCode::ModelSaveFailed;
+
+    const HRCode sync = loadPersonsFromStorage();
+    if (sync != HRCode::Ok) return sync;
+
+    QJsonArray peopleArray;
+    {
+        std::scoped_lock lock(mutex);
+        for (auto it = persons.cbegin(); it != persons.cend(); ++it) {
+            const PersonInfo& person = it.value();
+            QJsonObject obj;
+            obj.insert(QStringLiteral("id"), person.id);
+            obj.insert(QStringLiteral("name"), person.name);
+            obj.insert(QStringLiteral("metadata"), person.metadata);
+            if (person.canonicalFeature.has_value()) {
+                obj.insert(QStringLiteral("feature"), featureToJson(*person.canonicalFeature));
+            }
+            peopleArray.append(obj);
+        }
+    }
+
+    QJsonObject root;
+    root.insert(QStringLiteral("people"), peopleArray);
+    QSaveFile file(jsonPath);
+    if (!file.open(QIODevice::WriteOnly)) return HRCode::ModelSaveFailed;
+    if (file.write(QJsonDocument(root).toJson(QJsonDocument::Indented)) < 0) {
+        return HRCode::ModelSaveFailed;
+    }
+    if (!file.commit()) return HRCode::ModelSaveFailed;
+    if (logger) {
+        logger->info("Exported {} persons to {}", peopleArray.size(), jsonPath.toStdString());
+    }
+    return HRCode::Ok;
+}
+
+HRCode OnnxRuntimeBackend::Impl::registerPerson(const PersonInfo& person) {
+    if (person.id.isEmpty()) return HRCode::UnknownError;
+    if (!storageReady && !ensureStorageReady()) return HRCode::UnknownError;
+
+    {
+        std::scoped_lock lock(mutex);
+        if (persons.contains(person.id)) return HRCode::PersonExists;
+    }
+
+    if (!persistPerson(person)) {
+        // 写入失败可能是并发注册导致主键冲突，刷新缓存后再判断
+        const HRCode reload = loadPersonsFromStorage();
+        std::scoped_lock lock(mutex);
+        if (reload == HRCode::Ok && persons.contains(person.id)) return HRCode::PersonExists;
+        if (logger) { logger->error("Failed to persist person {}", person.id.toStdString()); }
+        return HRCode::UnknownError;
+    }
+
+    std::scoped_lock lock(mutex);
+    persons.insert(person.id, person);
+    if (logger) {
+        logger->info(
+            "Registered person {} ({})", person.id.toStdString(), person.name.toStdString());
+    }
+    return HRCode::Ok;
+}
+
+HRCode OnnxRuntimeBackend::Impl::removePerson(const QString& personId) {
+    if (personId.isEmpty()) return HRCode::UnknownError;
+    if (!storageReady && !ensureStorageReady()) return HRCode::UnknownError;
+
+    {
+        std::scoped_lock lock(mutex);
+        if (!persons.contains(personId)) return HRCode::PersonNotFound;
+    }
+    if (!deletePersonFromDatabase(personId)) return HRCode::UnknownError;
+
+    std::scoped_lock lock(mutex);
+    persons.remove(personId);
+    if (logger) { logger->info("Removed person {}", personId.toStdString()); }
+    return HRCode::Ok;
+}
+
+HRCode OnnxRuntimeBackend::Impl::getPerson(const QString& personId, PersonInfo& outPerson) {
+    std::scoped_lock lock(mutex);
+    auto it = persons.constFind(personId);
+    if (it == persons.cend()) return HRCode::PersonNotFound;
+    outPerson = it.value();
+    return HRCode::Ok;
+}
+
+HRCode OnnxRuntimeBackend::Impl::listPersons(QVector<PersonInfo>& outPersons) {
+    if (!storageReady && !ensureStorageReady()) return HRCode::ModelLoadFailed;
+    std::scoped_lock lock(mutex);
+    outPersons.clear();
+    outPersons.reserve(persons.size());
+    for (auto it = persons.cbegin(); it != persons.cend(); ++it) outPersons.append(it.value());
+    return HRCode::Ok;
+}
+
+void OnnxRuntimeBackend::Impl::setResultsChangedCallback(std::function<void()> callback) {
+    std::scoped_lock lock(mutex);
+    resultsChanged = std::move(callback);
+}
+
+QString OnnxRuntimeBackend::Impl::backendName() const {
+    return QString::fromLatin1(kBackendName);
+}
+
+/**
+ * @brief 在目录中按常见文件名查找模型：SCRFD（scrfd*.onnx、det_*.onnx）与 ArcFace
+ *        （arcface*.onnx、w600k_*.onnx、glintr100.onnx）。直接指定文件时其所在目录同样参与查找。
+ */
+OnnxRuntimeBackend::Impl::ModelFiles OnnxRuntimeBackend::Impl::resolveModelFiles(
+    const QFileInfo& info) const {
+    ModelFiles files;
+    const QDir dir(info.isDir() ? info.absoluteFilePath() : info.absolutePath());
+    files.baseDirectory = dir.absolutePath();
+
+    const auto pick = [&dir](const QStringList& patterns) -> QString {
+        const QStringList found = dir.entryList(patterns, QDir::Files, QDir::Name);
+        return found.isEmpty() ? QString() : dir.filePath(found.first());
+    };
+
+    if (info.isFile()) {
+        const QString lowerName = info.fileName().toLower();
+        if (lowerName.startsWith(QLatin1String("scrfd")) ||
+            lowerName.startsWith(QLatin1String("det_"))) {
+            files.detector = info.absoluteFilePath();
+        } else if (lowerName.endsWith(QLatin1String(".onnx"))) {
+            files.recognition = info.absoluteFilePath();
+        }
+    }
+    if (files.detector.isEmpty()) {
+        files.detector = pick({QStringLiteral("scrfd*.onnx"), QStringLiteral("det_*.onnx")});
+    }
+    if (files.recognition.isEmpty()) {
+        files.recognition = pick({QStringLiteral("arcface*.onnx"),
+                                  QStringLiteral("w600k_*.onnx"),
+                                  QStringLiteral("glintr100.onnx")});
+    }
+    return files;
+}
+
+/**
+ * @brief 从模型缓存获取会话；会话按文件与算子内线程数区分，在调用线程上同步创建。
+ */
+std::shared_ptr<const OnnxModel> OnnxRuntimeBackend::Impl::loadSession(const QString& path) const {
+    const int threads = intraOpThreads;
+    const ModelCache::Handle handle = ModelCache::instance().acquire(
+        path,
+        QStringLiteral("onnx.session/%1").arg(threads),
+        [sharedEnv = env, threads](const QString& file) {
+            return createSession(sharedEnv, file, threads);
+        },
+        ModelCache::LoadMode::Lazy);
+    auto model = ModelCache::get<OnnxModel>(handle);
+    if (!model && logger) { logger->error("Failed to load ONNX model {}", path.toStdString()); }
+    return model;
+}
+
+/**
+ * @brief 应用配置中心推送的变化；只处理本后端的 Onnx* 键。
+ */
+void OnnxRuntimeBackend::Impl::applyConfigChange(const config::ConfigSnapshot& snapshot,
+                                                 const QStringList& keys) {
+    std::function<void()> notify;
+    {
+        std::scoped_lock lock(mutex);
+        for (const QString& key : keys) {
+            if (key == QLatin1String("HumanRecognition/OnnxMatchThreshold")) {
+                matchThreshold = snapshot.getDouble(key, kDefaultMatchThreshold);
+                if (matchThreshold < 0.0) matchThreshold = kDefaultMatchThreshold;
+                if (logger) logger->info("Match threshold changed to {}", matchThreshold);
+                notify = resultsChanged;
+            } else if (key == QLatin1String("HumanRecognition/OnnxEmbeddingBatch")) {
+                embeddingBatch = snapshot.getInt(key, kDefaultEmbeddingBatch);
+                if (embeddingBatch <= 0) embeddingBatch = kDefaultEmbeddingBatch;
+                if (logger) logger->info("Embedding batch changed to {}", embeddingBatch);
+            } else if (key.startsWith(QLatin1String("HumanRecognition/Onnx")) && logger) {
+                logger->info("Configuration key {} changed, takes effect on next initialize",
+                             key.toStdString());
+            }
+        }
+    }
+    // 阈值变化会改变识别结果，在锁外通知门面
+    if (notify) notify();
+}
+
+void OnnxRuntimeBackend::Impl::refreshConfiguration() {
+    auto& cfg = config::ConfigManager::instance();
+    const QString requestedTable =
+        cfg.setOrDefault(QStringLiteral("HumanRecognition/OnnxPersonsTable"),
+                         QString::fromLatin1(kDefaultPersonsTable))
+            .toString();
+    personsTable = sanitizeTableName(requestedTable);
+    if (personsTable.isEmpty()) personsTable = QString::fromLatin1(kDefaultPersonsTable);
+
+    matchThreshold = cfg.setOrDefault(QStringLiteral("HumanRecognition/OnnxMatchThreshold"),
+                                      kDefaultMatchThreshold)
+                         .toDouble();
+    if (matchThreshold < 0.0) matchThreshold = kDefaultMatchThreshold;
+    intraOpThreads = cfg.setOrDefault(QStringLiteral("HumanRecognition/OnnxIntraOpThreads"),
+                                      kDefaultIntraOpThreads)
+                         .toInt();
+    if (intraOpThreads < 0) intraOpThreads = kDefaultIntraOpThreads;
+    detectInputSize = cfg.setOrDefault(QStringLiteral("HumanRecognition/OnnxDetectInputSize"),
+                                       kDefaultDetectInputSize)
+                          .toInt();
+    if (detectInputSize < 32) detectInputSize = kDefaultDetectInputSize;
+    detectInputSize -= detectInputSize % 32;
+    embeddingBatch = cfg.setOrDefault(QStringLiteral("HumanRecognition/OnnxEmbeddingBatch"),
+                                      kDefaultEmbeddingBatch)
+                         .toInt();
+    if (embeddingBatch <= 0) embeddingBatch = kDefaultEmbeddingBatch;
+    autoCreatePersonsTable =
+        cfg.setOrDefault(QStringLiteral("HumanRecognition/AutoCreateTable"), true).toBool();
+}
+
+bool OnnxRuntimeBackend::Impl::ensureStorageReady() {
+    if (storageReady) return true;
+    try {
+        if (!storage::DbManager::instance().init()) {
+            if (logger) { logger->error("Failed to initialize storage database"); }
+            return false;
+        }
+    } catch (const std::exception& ex) {
+        if (logger) { logger->error("Storage initialization threw exception: {}", ex.what()); }
+        return false;
+    }
+
+    if (autoCreatePersonsTable && !ensurePersonsTable()) return false;
+    storageReady = true;
+    return true;
+}
+
+/**
+ * @brief 创建人员表；表结构与 opencv_dlib 后端相同，便于导入导出工具复用。
+ */
+bool OnnxRuntimeBackend::Impl::ensurePersonsTable() {
+    try {
+        const auto writeLock = storage::DbManager::instance().writeLock();
+        QSqlQuery ddl(storage::DbManager::instance().db());
+        const QString sql = QStringLiteral(
+                                "CREATE TABLE IF NOT EXISTS %1 ("
+                                "id TEXT PRIMARY KEY,"
+                                "name TEXT,"
+                                "metadata_json TEXT,"
+                                "feature_json TEXT,"
+                                "created_at TEXT DEFAULT CURRENT_TIMESTAMP,"
+                                "updated_at TEXT DEFAULT CURRENT_TIMESTAMP)")
+                                .arg(personsTable);
+        if (!ddl.exec(sql)) {
+            if (logger) {
+                logger->error("Failed to create table {}: {}",
+                              personsTable.toStdString(),
+                              ddl.lastError().text().toStdString());
+            }
+            return false;
+        }
+        return true;
+    } catch (const std::exception& ex) {
+        if (logger) { logger->error("ensurePersonsTable exception: {}", ex.what()); }
+    }
+    return false;
+}
+
+QString OnnxRuntimeBackend::Impl::sanitizeTableName(const QString& requested) const {
+    QString out;
+    out.reserve(requested.size());
+    for (const QChar& ch : requested) {
+        if (ch.isLetterOrNumber() || ch == QLatin1Char('_')) out.append(ch);
+    }
+    return out;
+}
+
+bool OnnxRuntimeBackend::Impl::persistPerson(const PersonInfo& person) {
+    try {
+        const auto writeLock = storage::DbManager::instance().writeLock();
+        QSqlQuery insert(storage::DbManager::instance().db());
+        insert.prepare(QStringLiteral("INSERT INTO %1 (id, name, metadata_json, feature_json) "
+                                      "VALUES (?, ?, ?, ?)")
+                           .arg(personsTable));
+        insert.addBindValue(person.id);
+        insert.addBindValue(person.name);
+        insert.addBindValue(
+            person.metadata.isEmpty()
+                ? QString()
+                : QString::fromUtf8(QJsonDocument(person.metadata).toJson(QJsonDocument::Compact)));
+        insert.addBindValue(person.canonicalFeature.has_value()
+                                ? QVariant(QString::fromUtf8(
+                                      QJsonDocument(featureToJson(*person.canonicalFeature))
+                                          .toJson(QJsonDocument::Compact)))
+                                : QVariant());
+        if (insert.exec()) return true;
+        if (logger) {
+            logger->warn("Failed to insert person {}: {}",
+                         person.id.toStdString(),
+                         insert.lastError().text().toStdString());
+        }
+    } catch (const std::exception& ex) {
+        if (logger) { logger->error("persistPerson exception: {}", ex.what()); }
+    }
+    return false;
+}
+
+bool OnnxRuntimeBackend::Impl::deletePersonFromDatabase(const QString& personId) {
+    try {
+        const auto writeLock = storage::DbManager::instance().writeLock();
+        QSqlQuery query(storage::DbManager::instance().db());
+        query.prepare(QStringLiteral("DELETE FROM %1 WHERE id = ?").arg(personsTable));
+        query.addBindValue(personId);
+        if (!query.exec()) {
+            if (logger) {
+                logger->error("Failed to delete person {}: {}",
+                              personId.toStdString(),
+                              query.lastError().text().toStdString());
+            }
+            return false;
+        }
+        return query.numRowsAffected() > 0;
+    } catch (const std::exception& ex) {
+        if (logger) { logger->error("deletePersonFromDatabase exception: {}", ex.what()); }
+    }
+    return false;
+}
+
+HRCode OnnxRuntimeBackend::Impl::loadPersonsFromStorage() {
+    if (!storageReady && !ensureStorageReady()) return HRCode::ModelLoadFailed;
+    QHash<QString, PersonInfo> loaded;
+    try {
+        QSqlQuery query(storage::DbManager::instance().db());
+        if (!query.exec(QStringLiteral("SELECT id, name, metadata_json, feature_json FROM %1")
+                            .arg(personsTable))) {
+            if (logger) {
+                logger->error("Failed to query persons from {}: {}",
+                              personsTable.toStdString(),
+                              query.lastError().text().toStdString());
+            }
+            return HRCode::ModelLoadFailed;
+        }
+        while (query.next()) {
+            PersonInfo info;
+            info.id = query.value(0).toString();
+            if (info.id.isEmpty()) continue;
+            info.name = query.value(1).toString();
+            info.metadata = QJsonDocument::fromJson(query.value(2).toString().toUtf8()).object();
+            info.canonicalFeature = featureFromJson(query.value(3).toString());
+            loaded.insert(info.id, info);
+        }
+    } catch (const std::exception& ex) {
+        if (logger) { logger->error("loadPersonsFromStorage exception: {}", ex.what()); }
+        return HRCode::ModelLoadFailed;
+    }
+
+    std::scoped_lock lock(mutex);
+    persons = std::move(loaded);
+    if (logger) {
+        logger->info("Loaded {} persons from table {}",
+                     static_cast<int>(persons.size()),
+                     personsTable.toStdString());
+    }
+    return HRCode::Ok;
+}
+
+}  // namespace HumanRecognition
+
+#endif  // defined(HAS_ONNXRUNTIME) && defined(HAS_OPENCV)
@@ -0,0 +1,423 @@
+﻿#include "internal/backend_impl.h"
+
+#if defined(HAS_ONNXRUNTIME) && defined(HAS_OPENCV)
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <opencv2/imgproc.hpp>
+
+#include "../../internal/detection_tiles.h"
+#include "internal/postprocess.h"
+#include "logging/logging.h"
+
+namespace HumanRecognition {
+
+using namespace onnx;
+
+namespace {
+
+/// SCRFD 三个检测分支的步长
+constexpr std::array<int, 3> kScrfdStrides = {8, 16, 32};
+
+/**
+ * @brief 以 OpenCV 矩阵头包装 RGB888 QImage 的像素（不拷贝，调用方需保证 image 存活）。
+ */
+cv::Mat wrapRgb(const QImage& image) {
+    return cv::Mat(image.height(),
+                   image.width(),
+                   CV_8UC3,
+                   const_cast<uchar*>(image.constBits()),
+                   static_cast<std::size_t>(image.bytesPerLine()));
+}
+
+/**
+ * @brief 将 HWC 的 8 位 RGB 图像归一化为 (x - mean) / std 并写入 CHW 平面。
+ */
+void fillPlanes(const cv::Mat& rgb, float mean, float stddev, float* dst) {
+    cv::Mat normalized;
+    rgb.convertTo(normalized, CV_32FC3, 1.0 / stddev, -mean / stddev);
+    const std::size_t plane = static_cast<std::size_t>(rgb.rows) * rgb.cols;
+    std::vector<cv::Mat> channels;
+    channels.reserve(3);
+    for (int c = 0; c < 3; ++c) channels.emplace_back(rgb.rows, rgb.cols, CV_32F, dst + c * plane);
+    cv::split(normalized, channels);
+}
+
+Ort::MemoryInfo cpuMemory() {
+    return Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
+}
+
+std::vector<const char*> outputNamePointers(const OnnxModel& model) {
+    std::vector<const char*> names;
+    names.reserve(model.outputNames.size());
+    for (const auto& name : model.outputNames) names.push_back(name.c_str());
+    return names;
+}
+
+}  // namespace
+
+/**
+ * @brief 等比缩放到 SCRFD 输入尺寸（右下补零）后一次推理，解码各步长分支并做 NMS。
+ *
+ * 给定 regionsOfInterest 时只对区域外接矩形推理；区域越小，缩放后人脸越大，小脸检出率越高。
+ */
+HRCode OnnxRuntimeBackend::Impl::detectWithContext(const QImage& image,
+                                                   const DetectOptions& opts,
+                                                   QVector<FaceBox>& outBoxes,
+                                                   FrameContextPtr& outContext) {
+    outBoxes.clear();
+    outContext.reset();
+    if (image.isNull()) return HRCode::InvalidImage;
+
+    std::shared_ptr<const OnnxModel> model;
+    int inputSize = 0;
+    {
+        std::scoped_lock lock(mutex);
+        model = detector;
+        inputSize = detectInputSize;
+    }
+    if (!model) {
+        if (logger) { logger->error("Detect failed: detector model not loaded"); }
+        return HRCode::DetectFailed;
+    }
+
+    QRect area = image.rect();
+    if (!opts.regionsOfInterest.isEmpty()) {
+        // 区域四周外扩 16 像素、边长至少 64 像素，避免人脸贴着裁剪边缘
+        const QVector<QRect> regions =
+            detail::prepareDetectionRegions(opts.regionsOfInterest, image.size(), 16, 64);
+        if (regions.isEmpty()) return HRCode::DetectFailed;
+        area = QRect();
+        for (const QRect& region : regions) area = area.united(region);
+    }
+
+    auto context = std::make_shared<OnnxFrameContext>(image, rgbFor(nullptr, image));
+    if (context->rgb.isNull()) return HRCode::InvalidImage;
+    const cv::Mat source = wrapRgb(context->rgb)(
+        cv::Rect(area.x(), area.y(), area.width(), area.height()));
+
+    // 固定输入尺寸的模型以其形状为准，动态尺寸时使用配置的边长
+    const int inputH = model->inputShape.size() == 4 && model->inputShape[2] > 0
+                           ? static_cast<int>(model->inputShape[2])
+                           : inputSize;
+    const int inputW = model->inputShape.size() == 4 && model->inputShape[3] > 0
+                           ? static_cast<int>(model->inputShape[3])
+                           : inputSize;
+    const double scale = std::min(static_cast<double>(inputW) / source.cols,
+                                  static_cast<double>(inputH) / source.rows);
+    const cv::Size scaled(std::max(1, static_cast<int>(std::lround(source.cols * scale))),
+                          std::max(1, static_cast<int>(std::lround(source.rows * scale))));
+    cv::Mat canvas(inputH, inputW, CV_8UC3, cv::Scalar::all(0));
+    cv::Mat placed = canvas(cv::Rect(0, 0, scaled.width, scaled.height));
+    cv::resize(source, placed, scaled);
+
+    std::vector<float> tensor(static_cast<std::size_t>(3) * inputH * inputW);
+    fillPlanes(canvas, 127.5f, 128.0f, tensor.data());
+    const std::array<std::int64_t, 4> shape = {1, 3, inputH, inputW};
+
+    std::vector<Ort::Value> outputs;
+    try {
+        Ort::MemoryInfo memory = cpuMemory();
+        Ort::Value input = Ort::Value::CreateTensor<float>(
+            memory, tensor.data(), tensor.size(), shape.data(), shape.size());
+        const char* inputNames[] = {model->inputName.c_str()};
+        const auto outputNames = outputNamePointers(*model);
+        outputs = model->session->Run(Ort::RunOptions{nullptr},
+                                      inputNames,
+                                      &input,
+                                      1,
+                                      outputNames.data(),
+                                      outputNames.size());
+    } catch (const Ort::Exception& ex) {
+        if (logger) { logger->error("SCRFD inference failed: {}", ex.what()); }
+        return HRCode::DetectFailed;
+    }
+
+    // 输出顺序：3 个置信度分支、3 个框分支，以及可选的 3 个关键点分支
+    const int branchCount = static_cast<int>(kScrfdStrides.size());
+    const bool hasLandmarks = static_cast<int>(outputs.size()) >= 3 * branchCount;
+    QVector<ScrfdBranch> branches;
+    for (int i = 0; i < branchCount; ++i) {
+        const int stride = kScrfdStrides[i];
+        const std::size_t anchors =
+            static_cast<std::size_t>(inputH / stride) * (inputW / stride) * kScrfdAnchorsPerCell;
+        if (outputs[i].GetTensorTypeAndShapeInfo().GetElementCount() < anchors ||
+            outputs[i + branchCount].GetTensorTypeAndShapeInfo().GetElementCount() < anchors * 4) {
+            if (logger) { logger->error("Unexpected SCRFD output layout at stride {}", stride); }
+            return HRCode::DetectFailed;
+        }
+        ScrfdBranch branch;
+        branch.stride = stride;
+        branch.scores = outputs[i].GetTensorData<float>();
+        branch.boxes = outputs[i + branchCount].GetTensorData<float>();
+        if (hasLandmarks) branch.landmarks = outputs[i + 2 * branchCount].GetTensorData<float>();
+        branches.append(branch);
+    }
+
+    QVector<FaceBox> candidates = decodeScrfd(branches,
+                                              QSize(inputW, inputH),
+                                              kScrfdAnchorsPerCell,
+                                              opts.minScore,
+                                              scale,
+                                              area.topLeft());
+    std::stable_sort(candidates.begin(), candidates.end(), [](const FaceBox& a, const FaceBox& b) {
+        return a.score > b.score;
+    });
+
+    for (FaceBox& candidate : candidates) {
+        const int side = std::max(candidate.rect.width(), candidate.rect.height());
+        if (opts.minFaceSize > 0 && side < opts.minFaceSize) continue;
+        if (opts.maxFaceSize > 0 && side > opts.maxFaceSize) continue;
+        const bool suppressed = std::any_of(
+            context->faces.cbegin(), context->faces.cend(), [&candidate](const FaceBox& kept) {
+                return detail::intersectionOverUnion(kept.rect, candidate.rect) >
+                       kScrfdNmsThreshold;
+            });
+        if (suppressed) continue;
+        candidate.rect = candidate.rect.intersected(image.rect());
+        if (candidate.rect.isEmpty()) continue;
+        context->faces.append(candidate);
+    }
+
+    if (context->faces.isEmpty()) {
+        if (logger) { logger->info("Detect result: no face meets threshold"); }
+        return HRCode::DetectFailed;
+    }
+    outBoxes = context->faces;
+    if (!opts.detectLandmarks) {
+        for (FaceBox& box : outBoxes) box.landmarks.clear();
+    }
+    if (logger) { logger->info("Detect found {} faces", outBoxes.size()); }
+    outContext = std::move(context);
+    return HRCode::Ok;
+}
+
+/**
+ * @brief 对齐全部人脸后按 embeddingBatch 分批推理；模型输入批大小固定时不足部分补零。
+ */
+HRCode OnnxRuntimeBackend::Impl::extractFeatures(const FrameContextPtr& context,
+                                                 const QImage& image,
+                                                 const QVector<FaceBox>& boxes,
+                                                 QVector<FaceFeature>& outFeatures) {
+    outFeatures.clear();
+    outFeatures.resize(boxes.size());
+    if (boxes.isEmpty()) return HRCode::Ok;
+    if (image.isNull()) return HRCode::InvalidImage;
+
+    std::shared_ptr<const OnnxModel> model;
+    int batchLimit = 0;
+    {
+        std::scoped_lock lock(mutex);
+        model = recognizer;
+        batchLimit = embeddingBatch;
+    }
+    if (!model) {
+        if (logger) { logger->error("Extract failed: recognition model not loaded"); }
+        return HRCode::ExtractFeatureFailed;
+    }
+
+    const auto* frame = dynamic_cast<const OnnxFrameContext*>(context.get());
+    if (frame &&
+        (frame->sourceCacheKey() != image.cacheKey() || frame->sourceSize() != image.size())) {
+        frame = nullptr;
+    }
+    const QImage rgb = rgbFor(context, image);
+    if (rgb.isNull()) return HRCode::InvalidImage;
+    const cv::Mat mat = wrapRgb(rgb);
+
+    std::vector<cv::Mat> faces;
+    std::vector<int> indices;
+    faces.reserve(boxes.size());
+    indices.reserve(boxes.size());
+    for (int i = 0; i < boxes.size(); ++i) {
+        const QVector<QPointF>* landmarks = &boxes[i].landmarks;
+        if (landmarks->size() < 5 && frame) {
+            if (const auto* cached = frame->landmarksFor(boxes[i].rect)) landmarks = cached;
+        }
+        cv::Mat aligned = alignFace(mat, boxes[i].rect, *landmarks);
+        if (aligned.empty()) continue;
+        faces.push_back(std::move(aligned));
+        indices.push_back(i);
+    }
+
+    const std::int64_t fixedBatch = model->inputShape.empty() ? -1 : model->inputShape[0];
+    const std::size_t chunk = static_cast<std::size_t>(fixedBatch > 0 ? fixedBatch : batchLimit);
+    int succeeded = 0;
+    for (std::size_t begin = 0; begin < faces.size(); begin += chunk) {
+        const std::size_t end = std::min(faces.size(), begin + chunk);
+        const std::vector<cv::Mat> batch(faces.begin() + begin, faces.begin() + end);
+        std::vector<std::vector<float>> embeddings;
+        if (!embedBatch(*model, batch, embeddings)) continue;
+        for (std::size_t k = 0; k < embeddings.size(); ++k) {
+            FaceFeature& feature = outFeatures[indices[begin + k]];
+            feature.values = QVector<float>(embeddings[k].begin(), embeddings[k].end());
+            feature.version = QString::fromLatin1(kFeatureVersion);
+            feature.norm = 1.0f;
+            ++succeeded;
+        }
+    }
+
+    if (logger) {
+        logger->debug(
+            "Extracted {} of {} features in batches of {}", succeeded, boxes.size(), chunk);
+    }
+    return succeeded > 0 ? HRCode::Ok : HRCode::ExtractFeatureFailed;
+}
+
+HRCode OnnxRuntimeBackend::Impl::compare(const FaceFeature& a,
+                                         const FaceFeature& b,
+                                         float& outDistance) {
+    const auto dist = computeDistance(a, b);
+    if (!dist.has_value()) {
+        if (logger) { logger->warn("Compare failed: cannot compute distance"); }
+        return HRCode::CompareFailed;
+    }
+    outDistance = dist.value();
+    return HRCode::Ok;
+}
+
+/**
+ * @brief 线性扫描人员缓存，取余弦距离最小者；超过阈值视为未知人员。
+ */
+HRCode OnnxRuntimeBackend::Impl::findNearest(const FaceFeature& feature,
+                                             RecognitionMatch& outMatch) {
+    std::scoped_lock lock(mutex);
+    float bestDistance = std::numeric_limits<float>::max();
+    const PersonInfo* bestPerson = nullptr;
+    for (auto it = persons.cbegin(); it != persons.cend(); ++it) {
+        if (!it.value().canonicalFeature.has_value()) continue;
+        const auto dist = computeDistance(feature, it.value().canonicalFeature.value());
+        if (dist.has_value() && dist.value() < bestDistance) {
+            bestDistance = dist.value();
+            bestPerson = &it.value();
+        }
+    }
+    if (!bestPerson) return HRCode::PersonNotFound;
+    if (matchThreshold > 0.0 && bestDistance > matchThreshold) {
+        if (logger) {
+            logger->debug("Best match {} rejected: distance {} exceeds threshold {}",
+                          bestPerson->id.toStdString(),
+                          bestDistance,
+                          matchThreshold);
+        }
+        return HRCode::PersonNotFound;
+    }
+
+    outMatch.personId = bestPerson->id;
+    outMatch.personName = bestPerson->name;
+    outMatch.distance = bestDistance;
+    const float norm = matchThreshold > 0.0 ? static_cast<float>(matchThreshold) : 1.0f;
+    outMatch.score = std::max(0.0f, 1.0f - bestDistance / norm);
+    return HRCode::Ok;
+}
+
+QImage OnnxRuntimeBackend::Impl::rgbFor(const FrameContextPtr& context, const QImage& image) const {
+    if (const auto* frame = dynamic_cast<const OnnxFrameContext*>(context.get())) {
+        if (frame->sourceCacheKey() == image.cacheKey() && frame->sourceSize() == image.size()) {
+            return frame->rgb;
+        }
+    }
+    // RGB888 输入隐式共享，其余格式转换一次
+    if (image.format() == QImage::Format_RGB888) return image;
+    return image.convertToFormat(QImage::Format_RGB888);
+}
+
+/**
+ * @brief 将 5 点关键点相似变换到 ArcFace 模板；缺少关键点时裁剪人脸框并缩放。
+ */
+cv::Mat OnnxRuntimeBackend::Impl::alignFace(const cv::Mat& rgb,
+                                            const QRect& rect,
+                                            const QVector<QPointF>& landmarks) const {
+    const cv::Size target(kEmbeddingInputSize, kEmbeddingInputSize);
+    cv::Mat aligned;
+    if (landmarks.size() >= 5) {
+        QVector<QPointF> reference;
+        reference.reserve(5);
+        for (const auto& point : kArcFaceTemplate) reference.append(QPointF(point[0], point[1]));
+        double m[6];
+        if (estimateSimilarityTransform(landmarks.mid(0, 5), reference, m)) {
+            const cv::Mat transform = cv::Mat(2, 3, CV_64F, m).clone();
+            cv::warpAffine(rgb,
+                           aligned,
+                           transform,
+                           target,
+                           cv::INTER_LINEAR,
+                           cv::BORDER_CONSTANT,
+                           cv::Scalar::all(0));
+            return aligned;
+        }
+    }
+
+    const cv::Rect bounded = cv::Rect(rect.x(), rect.y(), rect.width(), rect.height()) &
+                             cv::Rect(0, 0, rgb.cols, rgb.rows);
+    if (bounded.empty()) return aligned;
+    cv::resize(rgb(bounded), aligned, target);
+    return aligned;
+}
+
+bool OnnxRuntimeBackend::Impl::embedBatch(const OnnxModel& model,
+                                          const std::vector<cv::Mat>& faces,
+                                          std::vector<std::vector<float>>& outEmbeddings) const {
+    outEmbeddings.clear();
+    if (faces.empty()) return true;
+    const std::int64_t fixedBatch = model.inputShape.empty() ? -1 : model.inputShape[0];
+    const std::int64_t n = fixedBatch > 0 ? fixedBatch : static_cast<std::int64_t>(faces.size());
+    const std::size_t perFace =
+        static_cast<std::size_t>(3) * kEmbeddingInputSize * kEmbeddingInputSize;
+
+    std::vector<float> tensor(static_cast<std::size_t>(n) * perFace, 0.0f);
+    for (std::size_t k = 0; k < faces.size(); ++k) {
+        fillPlanes(faces[k], 127.5f, 127.5f, tensor.data() + k * perFace);
+    }
+    const std::array<std::int64_t, 4> shape = {n, 3, kEmbeddingInputSize, kEmbeddingInputSize};
+
+    try {
+        Ort::MemoryInfo memory = cpuMemory();
+        Ort::Value input = Ort::Value::CreateTensor<float>(
+            memory, tensor.data(), tensor.size(), shape.data(), shape.size());
+        const char* inputNames[] = {model.inputName.c_str()};
+        const char* outputNames[] = {model.outputNames.front().c_str()};
+        auto outputs =
+            model.session->Run(Ort::RunOptions{nullptr}, inputNames, &input, 1, outputNames, 1);
+        const std::size_t total = outputs.front().GetTensorTypeAndShapeInfo().GetElementCount();
+        const std::size_t dim = total / static_cast<std::size_t>(n);
+        if (dim == 0) return false;
+        const float* data = outputs.front().GetTensorData<float>();
+        outEmbeddings.reserve(faces.size());
+        for (std::size_t k = 0; k < faces.size(); ++k) {
+            const float* row = data + k * dim;
+            double sq = 0.0;
+            for (std::size_t j = 0; j < dim; ++j) sq += static_cast<double>(row[j]) * row[j];
+            const float inv = sq > 0.0 ? static_cast<float>(1.0 / std::sqrt(sq)) : 0.0f;
+            std::vector<float> embedding(dim);
+            for (std::size_t j = 0; j < dim; ++j) embedding[j] = row[j] * inv;
+            outEmbeddings.push_back(std::move(embedding));
+        }
+    } catch (const Ort::Exception& ex) {
+        if (logger) { logger->error("ArcFace inference failed: {}", ex.what()); }
+        outEmbeddings.clear();
+        return false;
+    }
+    return true;
+}
+
+std::optional<float> OnnxRuntimeBackend::Impl::computeDistance(const FaceFeature& a,
+                                                               const FaceFeature& b) const {
+    if (a.values.isEmpty() || a.values.size() != b.values.size()) return std::nullopt;
+    double dot = 0.0;
+    double normA = 0.0;
+    double normB = 0.0;
+    for (int i = 0; i < a.values.size(); ++i) {
+        dot += static_cast<double>(a.values[i]) * b.values[i];
+        normA += static_cast<double>(a.values[i]) * a.values[i];
+        normB += static_cast<double>(b.values[i]) * b.values[i];
+    }
+    if (normA <= 0.0 || normB <= 0.0) return std::nullopt;
+    return static_cast<float>(1.0 - dot / std::sqrt(normA * normB));
+}
+
+}  // namespace HumanRecognition
+
+#endif  // defined(HAS_ONNXRUNTIME) && defined(HAS_OPENCV)
@@ -0,0 +1,25 @@
+﻿#pragma once
+
+namespace HumanRecognition::onnx {
+
+inline constexpr auto kBackendName = "onnx_cpu";
+/// ArcFace 特征与 dlib 特征维度不同，人员表默认与 opencv_dlib 后端分开
+inline constexpr auto kDefaultPersonsTable = "hr_persons_onnx";
+/// 余弦距离（1 - cos）阈值，约对应 ArcFace 相似度 0.4
+inline constexpr double kDefaultMatchThreshold = 0.6;
+/// 单个算子内部并行线程数；0 表示由 ONNX Runtime 按物理核心数决定
+inline constexpr int kDefaultIntraOpThreads = 0;
+/// SCRFD 检测输入边长（图像按比例缩放后右下补零到该尺寸）
+inline constexpr int kDefaultDetectInputSize = 640;
+/// 一次前向计算最多合并的人脸数
+inline constexpr int kDefaultEmbeddingBatch = 16;
+/// SCRFD 每个网格点的锚点数
+inline constexpr int kScrfdAnchorsPerCell = 2;
+/// SCRFD 检测结果 NMS 的 IoU 阈值
+inline constexpr double kScrfdNmsThreshold = 0.4;
+/// ArcFace 对齐后的输入边长
+inline constexpr int kEmbeddingInputSize = 112;
+/// 特征版本标识，写入 FaceFeature::version
+inline constexpr auto kFeatureVersion = "onnx.arcface.v1";
+
+}  // namespace HumanRecognition::onnx
@@ -0,0 +1,193 @@
+﻿#pragma once
+
+#include "backend_constants.h"
+#include "modules/HumanRecognition/impl/onnx/backend.h"
+
+#if defined(HAS_ONNXRUNTIME) && defined(HAS_OPENCV)
+
+#include <onnxruntime_cxx_api.h>
+
+#include <QFileInfo>
+#include <QHash>
+#include <QImage>
+#include <QJsonObject>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+#include <opencv2/core.hpp>
+
+#include "../../../internal/model_cache.h"
+
+namespace spdlog {
+class logger;
+}  // namespace spdlog
+
+namespace config {
+class ConfigSnapshot;
+}  // namespace config
+
+namespace HumanRecognition {
+
+namespace onnx {
+
+/**
+ * @brief ONNX 后端的帧上下文：保存一次转换得到的 RGB 图像与检测到的关键点，
+ *        特征提取时直接在其上做对齐（即使调用方关闭了 detectLandmarks 也能按关键点对齐）。
+ */
+class OnnxFrameContext final : public FrameContext {
+   public:
+    OnnxFrameContext(const QImage& source, QImage rgbImage)
+        : FrameContext(source.cacheKey(), source.size()), rgb(std::move(rgbImage)) {}
+
+    /**
+     * @brief 查找检测阶段为该人脸框输出的关键点；未缓存时返回 nullptr。
+     */
+    const QVector<QPointF>* landmarksFor(const QRect& rect) const {
+        for (const FaceBox& face : faces) {
+            if (face.rect == rect) return &face.landmarks;
+        }
+        return nullptr;
+    }
+
+    QImage rgb;              ///< Format_RGB888 像素（与源图像隐式共享或为转换后的副本）
+    QVector<FaceBox> faces;  ///< 检测结果（含完整 5 点关键点）
+};
+
+/**
+ * @brief 一个已加载的推理会话及其输入输出描述。
+ */
+struct OnnxModel {
+    std::shared_ptr<Ort::Env> env;  ///< 会话依赖的环境，声明在 session 之前以保证后析构
+    std::unique_ptr<Ort::Session> session;
+    std::string inputName;
+    std::vector<std::string> outputNames;
+    std::vector<std::int64_t> inputShape;  ///< NCHW；动态维度为 -1
+};
+
+}  // namespace onnx
+
+/**
+ * @brief OnnxRuntimeBackend 的实现体。
+ *
+ * 推理会话以 shared_ptr 持有：loadModel 在锁内替换指针，正在进行的推理持有旧会话直至结束，
+ * 因此检测与特征提取不需要长时间持有 mutex（Ort::Session::Run 本身是线程安全的）。
+ * 人员缓存与数据库交互方式与 OpenCVDlibBackend 一致，但使用独立的人员表。
+ */
+class OnnxRuntimeBackend::Impl {
+   public:
+    Impl();
+    ~Impl();
+
+    HRCode initialize(const QJsonObject& config);
+    HRCode shutdown();
+
+    HRCode loadModel(const QString& modelPath);
+    HRCode saveModel(const QString& modelPath);
+
+    HRCode detectWithContext(const QImage& image,
+                             const DetectOptions& opts,
+                             QVector<FaceBox>& outBoxes,
+                             FrameContextPtr& outContext);
+    HRCode extractFeatures(const FrameContextPtr& context,
+                           const QImage& image,
+                           const QVector<FaceBox>& boxes,
+                           QVector<FaceFeature>& outFeatures);
+
+    HRCode compare(const FaceFeature& a, const FaceFeature& b, float& outDistance);
+    HRCode findNearest(const FaceFeature& feature, RecognitionMatch& outMatch);
+
+    HRCode registerPerson(const PersonInfo& person);
+    HRCode removePerson(const QString& personId);
+    HRCode getPerson(const QString& personId, PersonInfo& outPerson);
+    HRCode listPersons(QVector<PersonInfo>& outPersons);
+
+    void setResultsChangedCallback(std::function<void()> callback);
+    QString backendName() const;
+
+   private:
+    struct ModelFiles {
+        /// 模型所在目录
+        QString baseDirectory;
+        /// SCRFD 检测模型
+        QString detector;
+        /// ArcFace 特征模型
+        QString recognition;
+    };
+
+    /**
+     * @brief 根据输入路径查找检测与特征模型文件。
+     */
+    ModelFiles resolveModelFiles(const QFileInfo& info) const;
+    /**
+     * @brief 经由进程级模型缓存获取会话：同一文件与线程配置的会话在后端实例间共享。
+     */
+    std::shared_ptr<const onnx::OnnxModel> loadSession(const QString& path) const;
+
+    /**
+     * @brief 将源图像转换为 RGB888；上下文有效时直接复用其中的像素。
+     */
+    QImage rgbFor(const FrameContextPtr& context, const QImage& image) const;
+    /**
+     * @brief 按 5 点关键点对齐到 112×112；关键点缺失时退回按人脸框裁剪缩放。
+     */
+    cv::Mat alignFace(const cv::Mat& rgb,
+                      const QRect& rect,
+                      const QVector<QPointF>& landmarks) const;
+    /**
+     * @brief 对若干张已对齐的人脸做批量推理，输出 L2 归一化特征。
+     */
+    bool embedBatch(const onnx::OnnxModel& model,
+                    const std::vector<cv::Mat>& faces,
+                    std::vector<std::vector<float>>& outEmbeddings) const;
+
+    /**
+     * @brief 计算两个特征的余弦距离；维度不一致时返回空。
+     */
+    std::optional<float> computeDistance(const FaceFeature& a, const FaceFeature& b) const;
+
+    void refreshConfiguration();
+    /**
+     * @brief 配置热更新回调：阈值与批大小立即生效，其余参数在下次初始化或加载模型时生效。
+     */
+    void applyConfigChange(const config::ConfigSnapshot& snapshot, const QStringList& keys);
+    bool ensureStorageReady();
+    bool ensurePersonsTable();
+    QString sanitizeTableName(const QString& requested) const;
+    bool persistPerson(const PersonInfo& person);
+    bool deletePersonFromDatabase(const QString& personId);
+    HRCode loadPersonsFromStorage();
+
+    /// 进程共享的 ORT 环境；缓存中的会话可能比创建它的后端实例活得更久
+    std::shared_ptr<Ort::Env> env;
+    std::shared_ptr<const onnx::OnnxModel> detector;
+    std::shared_ptr<const onnx::OnnxModel> recognizer;
+    mutable std::mutex mutex;
+    QHash<QString, PersonInfo> persons;
+    QString modelDirectory;
+    std::shared_ptr<spdlog::logger> logger;
+    QString personsTable;
+    double matchThreshold;
+    /// 单个算子内部并行线程数；0 表示由 ONNX Runtime 决定
+    int intraOpThreads;
+    /// SCRFD 输入边长（模型输入为动态尺寸时使用）
+    int detectInputSize;
+    /// 单次前向计算最多合并的人脸数
+    int embeddingBatch;
+    /// HumanRecognition/* 配置变化的订阅标识，0 表示尚未订阅
+    quint64 configSubscription = 0;
+    /// 匹配阈值热更新后的通知（门面用于使结果缓存失效）
+    std::function<void()> resultsChanged;
+    bool autoCreatePersonsTable = true;
+    bool storageReady = false;
+};
+
+}  // namespace HumanRecognition
+
+#endif  // defined(HAS_ONNXRUNTIME) && defined(HAS_OPENCV)
@@ -0,0 +1,59 @@
+﻿#pragma once
+
+#include <QPoint>
+#include <QPointF>
+#include <QSize>
+#include <QVector>
+
+#include "modules/HumanRecognition/types.h"
+
+namespace HumanRecognition::onnx {
+
+/**
+ * @brief SCRFD 单个步长分支的原始输出（行优先的连续内存）。
+ *
+ * 每个网格点有 anchorsPerCell 个锚点，锚点总数 N = (输入高/stride) × (输入宽/stride) × anchorsPerCell；
+ * scores 为 N 个置信度，boxes 为 N×4 个以步长为单位的 (左, 上, 右, 下) 距离，
+ * landmarks 为 N×10 个以步长为单位的 5 点偏移（模型不输出关键点时为空）。
+ */
+struct ScrfdBranch {
+    int stride = 0;
+    const float* scores = nullptr;
+    const float* boxes = nullptr;
+    const float* landmarks = nullptr;
+};
+
+/**
+ * @brief 将 SCRFD 各分支输出解码为原图坐标的人脸框（未做 NMS）。
+ *
+ * @param inputSize 网络输入尺寸
+ * @param scale 原图到网络输入的缩放比，网络坐标 / scale + offset 即原图坐标
+ * @param offset 网络输入左上角在原图中的位置（只检测 ROI 时为 ROI 左上角）
+ */
+QVector<FaceBox> decodeScrfd(const QVector<ScrfdBranch>& branches,
+                             const QSize& inputSize,
+                             int anchorsPerCell,
+                             float scoreThreshold,
+                             double scale,
+                             const QPoint& offset);
+
+/**
+ * @brief 求从 from 到 to 的最小二乘相似变换（旋转 + 等比缩放 + 平移，不含镜像）。
+ *
+ * 结果以 2×3 仿射矩阵行优先写入 out：[a, -b, tx, b, a, ty]。
+ * 点数不一致、少于 2 个或 from 退化为一点时返回 false。
+ */
+bool estimateSimilarityTransform(const QVector<QPointF>& from,
+                                 const QVector<QPointF>& to,
+                                 double out[6]);
+
+/**
+ * @brief ArcFace 112×112 对齐模板：左眼、右眼、鼻尖、左嘴角、右嘴角。
+ */
+inline constexpr float kArcFaceTemplate[5][2] = {{38.2946f, 51.6963f},
+                                                 {73.5318f, 51.5014f},
+                                                 {56.0252f, 71.7366f},
+                                                 {41.5493f, 92.3655f},
+                                                 {70.7299f, 92.2041f}};
+
+}  // namespace HumanRecognition::onnx
@@ -0,0 +1,98 @@
+﻿#include "internal/postprocess.h"
+
+#include <cmath>
+
+namespace HumanRecognition::onnx {
+
+QVector<FaceBox> decodeScrfd(const QVector<ScrfdBranch>& branches,
+                             const QSize& inputSize,
+                             int anchorsPerCell,
+                             float scoreThreshold,
+                             double scale,
+                             const QPoint& offset) {
+    QVector<FaceBox> out;
+    if (scale <= 0.0 || anchorsPerCell <= 0) return out;
+
+    const auto toSource = [scale, &offset](double x, double y) {
+        return QPointF(x / scale + offset.x(), y / scale + offset.y());
+    };
+
+    for (const ScrfdBranch& branch : branches) {
+        if (branch.stride <= 0 || !branch.scores || !branch.boxes) continue;
+        const int cols = inputSize.width() / branch.stride;
+        const int rows = inputSize.height() / branch.stride;
+        const int count = rows * cols * anchorsPerCell;
+        for (int i = 0; i < count; ++i) {
+            const float score = branch.scores[i];
+            if (score < scoreThreshold) continue;
+
+            // 锚点按 (行, 列, 锚点) 顺序排列，同一网格点的锚点共用中心
+            const int cell = i / anchorsPerCell;
+            const double cx = static_cast<double>(cell % cols) * branch.stride;
+            const double cy = static_cast<double>(cell / cols) * branch.stride;
+            const float* d = branch.boxes + static_cast<std::size_t>(i) * 4;
+            const QPointF topLeft = toSource(cx - d[0] * branch.stride, cy - d[1] * branch.stride);
+            const QPointF bottomRight =
+                toSource(cx + d[2] * branch.stride, cy + d[3] * branch.stride);
+
+            FaceBox box;
+            box.rect = QRect(static_cast<int>(std::lround(topLeft.x())),
+                             static_cast<int>(std::lround(topLeft.y())),
+                             static_cast<int>(std::lround(bottomRight.x() - topLeft.x())),
+                             static_cast<int>(std::lround(bottomRight.y() - topLeft.y())));
+            box.score = score;
+            if (branch.landmarks) {
+                const float* k = branch.landmarks + static_cast<std::size_t>(i) * 10;
+                box.landmarks.reserve(5);
+                for (int p = 0; p < 5; ++p) {
+                    box.landmarks.append(toSource(cx + k[2 * p] * branch.stride,
+                                                  cy + k[2 * p + 1] * branch.stride));
+                }
+            }
+            out.append(box);
+        }
+    }
+    return out;
+}
+
+bool estimateSimilarityTransform(const QVector<QPointF>& from,
+                                 const QVector<QPointF>& to,
+                                 double out[6]) {
+    const int n = from.size();
+    if (n < 2 || to.size() != n) return false;
+
+    QPointF fromMean;
+    QPointF toMean;
+    for (int i = 0; i < n; ++i) {
+        fromMean += from[i];
+        toMean += to[i];
+    }
+    fromMean /= n;
+    toMean /= n;
+
+    // 去中心化后 [a -b; b a] 的最小二乘解为：
+    // a = Σ(x·u + y·v) / Σ(x² + y²)，b = Σ(x·v - y·u) / Σ(x² + y²)
+    double dot = 0.0;
+    double cross = 0.0;
+    double energy = 0.0;
+    for (int i = 0; i < n; ++i) {
+        const QPointF p = from[i] - fromMean;
+        const QPointF q = to[i] - toMean;
+        dot += p.x() * q.x() + p.y() * q.y();
+        cross += p.x() * q.y() - p.y() * q.x();
+        energy += p.x() * p.x() + p.y() * p.y();
+    }
+    if (energy <= 1e-12) return false;
+
+    const double a = dot / energy;
+    const double b = cross / energy;
+    out[0] = a;
+    out[1] = -b;
+    out[2] = toMean.x() - (a * fromMean.x() - b * fromMean.y());
+    out[3] = b;
+    out[4] = a;
+    out[5] = toMean.y() - (b * fromMean.x() + a * fromMean.y());
+    return true;
+}
+
+}  // namespace HumanRecognition::onnx
@@ -47,6 +47,20 @@ HRCode OpenCVDlibBackend::extractFeature(const QImage& image,
     return d->extractFeature(image, box, outFeature);
 }
 
+HRCode OpenCVDlibBackend::detectWithContext(const QImage& image,
+                                            const DetectOptions& opts,
+                                            QVector<FaceBox>& outBoxes,
+                                            FrameContextPtr& outContext) {
+    return d->detectWithContext(image, opts, outBoxes, outContext);
+}
+
+HRCode OpenCVDlibBackend::extractFeatureWithContext(const FrameContextPtr& context,
+                                                    const QImage& image,
+                                                    const FaceBox& box,
+                                                    FaceFeature& outFeature) {
+    return d->extractFeatureWithContext(context, image, box, outFeature);
+}
+
 HRCode OpenCVDlibBackend::compare(const FaceFeature& a, const FaceFeature& b, float& outDistance) {
     return d->compare(a, b, outDistance);
 }
@@ -59,6 +73,11 @@ HRCode OpenCVDlibBackend::registerPerson(const PersonInfo& person) {
     return d->registerPerson(person);
 }
 
+HRCode OpenCVDlibBackend::registerPersons(const QVector<PersonInfo>& persons,
+                                          bool replaceExisting) {
+    return d->registerPersons(persons, replaceExisting);
+}
+
 HRCode OpenCVDlibBackend::removePerson(const QString& personId) {
     return d->removePerson(personId);
 }
@@ -75,6 +94,14 @@ HRCode OpenCVDlibBackend::train(const QString& datasetPath) {
     return d->train(datasetPath);
 }
 
+HRCode OpenCVDlibBackend::enrollDataset(const QString& datasetPath, const EnrollOptions& opts) {
+    return d->enrollDataset(datasetPath, opts);
+}
+
+void OpenCVDlibBackend::setResultsChangedCallback(std::function<void()> callback) {
+    d->setResultsChangedCallback(std::move(callback));
+}
+
 QString OpenCVDlibBackend::backendName() const {
     return d->backendName();
 }
@@ -163,6 +190,21 @@ HRCode OpenCVDlibBackend::extractFeature(const QImage&, const FaceBox&, FaceFeat
     return HRCode::ExtractFeatureFailed;
 }
 
+HRCode OpenCVDlibBackend::detectWithContext(const QImage& image,
+                                            const DetectOptions& opts,
+                                            QVector<FaceBox>& outBoxes,
+                                            FrameContextPtr& outContext) {
+    outContext.reset();
+    return detect(image, opts, outBoxes);
+}
+
+HRCode OpenCVDlibBackend::extractFeatureWithContext(const FrameContextPtr&,
+                                                    const QImage& image,
+                                                    const FaceBox& box,
+                                                    FaceFeature& outFeature) {
+    return extractFeature(image, box, outFeature);
+}
+
 HRCode OpenCVDlibBackend::compare(const FaceFeature&, const FaceFeature&, float& outDistance) {
     outDistance = 0.0f;
     if (auto logger = backendLogger()) {
@@ -185,6 +227,13 @@ HRCode OpenCVDlibBackend::registerPerson(const PersonInfo&) {
     return HRCode::UnknownError;
 }
 
+HRCode OpenCVDlibBackend::registerPersons(const QVector<PersonInfo>&, bool) {
+    if (auto logger = backendLogger()) {
+        logger->warn("OpenCVDlibBackend registerPersons invoked without backend availability");
+    }
+    return HRCode::UnknownError;
+}
+
 HRCode OpenCVDlibBackend::removePerson(const QString&) {
     if (auto logger = backendLogger()) {
         logger->warn("OpenCVDlibBackend removePerson invoked without backend availability");
@@ -214,6 +263,15 @@ HRCode OpenCVDlibBackend::train(const QString&) {
     return HRCode::UnknownError;
 }
 
+HRCode OpenCVDlibBackend::enrollDataset(const QString&, const EnrollOptions&) {
+    if (auto logger = backendLogger()) {
+        logger->warn("OpenCVDlibBackend enrollDataset invoked without backend availability");
+    }
+    return HRCode::UnknownError;
+}
+
+void OpenCVDlibBackend::setResultsChangedCallback(std::function<void()>) {}
+
 QString OpenCVDlibBackend::backendName() const {
     return QString::fromLatin1(opencv_dlib::kBackendName);
 }
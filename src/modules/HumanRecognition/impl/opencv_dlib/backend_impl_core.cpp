@@ -23,6 +23,43 @@ namespace HumanRecognition {
 
 using namespace opencv_dlib;
 
+namespace {
+
+/**
+ * @brief 解析检测器名称（hog / dnn，忽略大小写）。
+ */
+std::optional<detail::DetectorKind> parseDetectorKind(const QString& name) {
+    const QString lower = name.trimmed().toLower();
+    if (lower == QLatin1String("hog")) return detail::DetectorKind::Hog;
+    if (lower == QLatin1String("dnn")) return detail::DetectorKind::Dnn;
+    return std::nullopt;
+}
+
+/**
+ * @brief 解析模型加载方式（lazy / prefetch / eager，忽略大小写）。
+ */
+std::optional<detail::ModelLoading> parseModelLoading(const QString& name) {
+    const QString lower = name.trimmed().toLower();
+    if (lower == QLatin1String("lazy")) return detail::ModelLoading::Lazy;
+    if (lower == QLatin1String("prefetch")) return detail::ModelLoading::Prefetch;
+    if (lower == QLatin1String("eager")) return detail::ModelLoading::Eager;
+    return std::nullopt;
+}
+
+detail::ModelCache::Model loadShapePredictor(const QString& path) {
+    auto predictor = std::make_shared<dlib::shape_predictor>();
+    dlib::deserialize(path.toStdString()) >> *predictor;
+    return predictor;
+}
+
+detail::ModelCache::Model loadFaceNet(const QString& path) {
+    auto net = std::make_shared<detail::FaceNet>();
+    dlib::deserialize(path.toStdString()) >> *net;
+    return net;
+}
+
+}  // namespace
+
 OpenCVDlibBackend::Impl::Impl()
     : detector(dlib::get_frontal_face_detector()),
       shapePredictor(),
@@ -32,9 +69,16 @@ OpenCVDlibBackend::Impl::Impl()
       modelDirectory(),
       logger(logging::LoggerManager::instance().getLogger("HumanRecognition.OpenCVDlib")),
       personsTable(QString::fromLatin1(kDefaultPersonsTable)),
-      matchThreshold(kDefaultMatchThreshold) {}
-
-OpenCVDlibBackend::Impl::~Impl() = default;
+      matchThreshold(kDefaultMatchThreshold),
+      rerankTopK(kDefaultRerankTopK),
+      detectThreads(kDefaultDetectThreads),
+      dnnInputSize(kDefaultDnnInputSize),
+      dnnThreads(kDefaultDnnThreads) {}
+
+OpenCVDlibBackend::Impl::~Impl() {
+    // 等待可能正在执行的回调结束，之后不会再访问本对象
+    if (configSubscription != 0) config::ConfigManager::instance().unsubscribe(configSubscription);
+}
 
 /**
  * @brief 初始化后端，读取配置并加载人员缓存。
@@ -65,6 +109,88 @@ HRCode OpenCVDlibBackend::Impl::initialize(const QJsonObject& config) {
             QStringLiteral("HumanRecognition/MatchThreshold"), matchThreshold);
     }
 
+    if (config.contains(QStringLiteral("galleryEncoding"))) {
+        // 量化编码只影响检索路径，无法识别的名称保持当前设置。
+        const QString name = config.value(QStringLiteral("galleryEncoding")).toString();
+        if (auto encoding = parseFeatureEncoding(name)) {
+            galleryEncoding = *encoding;
+            galleryDirty = true;
+            config::ConfigManager::instance().setValue(
+                QStringLiteral("HumanRecognition/GalleryEncoding"),
+                featureEncodingName(galleryEncoding));
+        } else if (logger) {
+            logger->warn("Unknown gallery encoding '{}', keeping {}",
+                         name.toStdString(),
+                         featureEncodingName(galleryEncoding).toStdString());
+        }
+    }
+
+    if (config.contains(QStringLiteral("rerankTopK"))) {
+        rerankTopK = config.value(QStringLiteral("rerankTopK")).toInt(rerankTopK);
+        if (rerankTopK <= 0) rerankTopK = kDefaultRerankTopK;
+        config::ConfigManager::instance().setValue(QStringLiteral("HumanRecognition/RerankTopK"),
+                                                   rerankTopK);
+    }
+
+    if (config.contains(QStringLiteral("detectThreads"))) {
+        // 0 表示跟随硬件并发数，负值视为非法并回退默认值。
+        detectThreads = config.value(QStringLiteral("detectThreads")).toInt(detectThreads);
+        if (detectThreads < 0) detectThreads = kDefaultDetectThreads;
+        config::ConfigManager::instance().setValue(QStringLiteral("HumanRecognition/DetectThreads"),
+                                                   detectThreads);
+    }
+
+    if (config.contains(QStringLiteral("detector"))) {
+        // 检测器类型只接受 hog / dnn，无法识别的名称保持当前设置。
+        const QString name = config.value(QStringLiteral("detector")).toString();
+        if (auto kind = parseDetectorKind(name)) {
+            detectorKind = *kind;
+            config::ConfigManager::instance().setValue(QStringLiteral("HumanRecognition/Detector"),
+                                                       name.trimmed().toLower());
+        } else if (logger) {
+            logger->warn("Unknown detector '{}', keeping current detector", name.toStdString());
+        }
+    }
+
+    if (config.contains(QStringLiteral("dnnModel"))) {
+        dnnModelPath = config.value(QStringLiteral("dnnModel")).toString();
+        config::ConfigManager::instance().setValue(
+            QStringLiteral("HumanRecognition/DnnDetectorModel"), dnnModelPath);
+    }
+
+    if (config.contains(QStringLiteral("dnnInputSize"))) {
+        dnnInputSize = config.value(QStringLiteral("dnnInputSize")).toInt(dnnInputSize);
+        if (dnnInputSize <= 0) dnnInputSize = kDefaultDnnInputSize;
+        config::ConfigManager::instance().setValue(QStringLiteral("HumanRecognition/DnnInputSize"),
+                                                   dnnInputSize);
+    }
+
+    if (config.contains(QStringLiteral("dnnThreads"))) {
+        dnnThreads = config.value(QStringLiteral("dnnThreads")).toInt(dnnThreads);
+        if (dnnThreads < 0) dnnThreads = kDefaultDnnThreads;
+        config::ConfigManager::instance().setValue(QStringLiteral("HumanRecognition/DnnThreads"),
+                                                   dnnThreads);
+    }
+    // cv::setNumThreads 是进程级设置，会影响所有 OpenCV 调用方：只在进程内首次初始化时应用
+    if (detail::applyOpenCvThreadsOnce(dnnThreads)) {
+        if (logger) logger->info("OpenCV threads set to {} (process-wide)", dnnThreads);
+    } else if (dnnThreads > 0 && logger) {
+        logger->debug("OpenCV threads already applied for this process, ignoring DnnThreads={}",
+                      dnnThreads);
+    }
+
+    if (config.contains(QStringLiteral("modelLoading"))) {
+        const QString name = config.value(QStringLiteral("modelLoading")).toString();
+        if (auto loading = parseModelLoading(name)) {
+            modelLoading = *loading;
+            config::ConfigManager::instance().setValue(
+                QStringLiteral("HumanRecognition/ModelLoading"), name.trimmed().toLower());
+        } else if (logger) {
+            logger->warn("Unknown model loading mode '{}', keeping current mode",
+                         name.toStdString());
+        }
+    }
+
     if (config.contains(QStringLiteral("autoCreateTable"))) {
         // 插件级别的开关，可按需禁用自动建表（例如只读部署场景）。
         autoCreatePersonsTable =
@@ -82,10 +208,22 @@ HRCode OpenCVDlibBackend::Impl::initialize(const QJsonObject& config) {
         if (!dir.isEmpty()) { return loadModel(dir); }
     }
 
+    // 未指定模型目录时，DNN 检测器仅能使用显式配置的模型路径。
+    if (detectorKind == detail::DetectorKind::Dnn) reloadDnnDetector(dnnModelPath);
+
     // 初始化完成后预加载一次人员缓存，保证随后的查询立即可用。
     const HRCode res = loadPersonsFromStorage();
     if (res != HRCode::Ok) return res;
 
+    // 配置文件热加载或运行时修改 HumanRecognition/* 时同步到运行参数
+    if (configSubscription == 0) {
+        configSubscription = config::ConfigManager::instance().subscribe(
+            QStringLiteral("HumanRecognition"),
+            [this](const config::ConfigSnapshot& snapshot, const QStringList& keys) {
+                applyConfigChange(snapshot, keys);
+            });
+    }
+
     if (logger) {
         logger->info("OpenCVDlibBackend initialized. Persons table: {}, threshold: {}",
                      personsTable.toStdString(),
@@ -98,10 +236,23 @@ HRCode OpenCVDlibBackend::Impl::initialize(const QJsonObject& config) {
  * @brief 释放 dlib 网络与缓存资源，清理运行状态。
  */
 HRCode OpenCVDlibBackend::Impl::shutdown() {
+    {
+        std::scoped_lock poolLock(detectPoolMutex);
+        detectPool.reset();
+        detectorPools.clear();
+    }
     std::scoped_lock lock(mutex);
     recognitionNet.reset();
     shapePredictor.reset();
+    pendingPredictor = {};
+    pendingNet = {};
+    ++modelGeneration;
+    dnnDetector.reset();
     persons.clear();
+    gallery.reset();
+    galleryDirty = true;
+    featuresResident = true;
+    rerankFeatures.clear();
     modelDirectory.clear();
     storageReady = false;
     if (logger) { logger->info("OpenCVDlibBackend shut down"); }
@@ -133,25 +284,40 @@ HRCode OpenCVDlibBackend::Impl::loadModel(const QString& modelPath) {
         return HRCode::ModelLoadFailed;
     }
 
-    auto predictor = std::make_unique<dlib::shape_predictor>();
-    auto net = std::make_unique<detail::FaceNet>();
-    try {
-        // 使用 dlib 自带的反序列化工具加载模型，若格式错误会抛出异常。
-        dlib::deserialize(files.shapePredictor.toStdString()) >> *predictor;
-        dlib::deserialize(files.recognition.toStdString()) >> *net;
-    } catch (const std::exception& ex) {
-        if (logger) { logger->error("Failed to deserialize models: {}", ex.what()); }
-        return HRCode::ModelLoadFailed;
-    }
+    // 模型经由进程级缓存获取：同一文件只反序列化一次，切换或重建后端时直接复用。
+    auto& cache = detail::ModelCache::instance();
+    const auto mode = modelLoading == detail::ModelLoading::Lazy
+                          ? detail::ModelCache::LoadMode::Lazy
+                          : detail::ModelCache::LoadMode::Prefetch;
+    const detail::ModelCache::Handle predictorHandle =
+        cache.acquire(files.shapePredictor,
+                      QString::fromLatin1(kShapePredictorKind),
+                      loadShapePredictor,
+                      mode);
+    const detail::ModelCache::Handle netHandle = cache.acquire(
+        files.recognition, QString::fromLatin1(kFaceNetKind), loadFaceNet, mode);
 
     {
-        // 写入共享成员需要加锁，避免其他线程正在进行识别导致 data race。
+        // 写入共享成员需要加锁，避免其他线程正在进行识别导致 data race；
+        // 旧模型的引用在此释放，新模型在首次使用时由 ensureModelsLoaded() 取出。
         std::scoped_lock lock(mutex);
-        shapePredictor = std::move(predictor);
-        recognitionNet = std::move(net);
+        shapePredictor.reset();
+        recognitionNet.reset();
+        pendingPredictor = predictorHandle;
+        pendingNet = netHandle;
+        ++modelGeneration;
         modelDirectory = files.baseDirectory;
     }
 
+    if (modelLoading == detail::ModelLoading::Eager && !ensureModelsLoaded(true)) {
+        return HRCode::ModelLoadFailed;
+    }
+
+    // DNN 检测器是可选组件：加载失败时仅告警并退回 HOG，不影响识别模型。
+    if (detectorKind == detail::DetectorKind::Dnn) {
+        reloadDnnDetector(dnnModelPath.isEmpty() ? files.dnnDetector : dnnModelPath);
+    }
+
     // 加载模型完成后再次确保数据库可用（运行期间可能被关闭）。
     if (!ensureStorageReady()) return HRCode::ModelLoadFailed;
 
@@ -168,7 +334,7 @@ HRCode OpenCVDlibBackend::Impl::loadModel(const QString& modelPath) {
         }
     }
 
-    if (logger) { logger->info("Loaded OpenCV/dlib models from {}", modelPath.toStdString()); }
+    if (logger) { logger->info("Registered OpenCV/dlib models from {}", modelPath.toStdString()); }
     return HRCode::Ok;
 }
 
@@ -216,7 +382,7 @@ HRCode OpenCVDlibBackend::Impl::saveModel(const QString& modelPath) {
 }
 
 /**
- * @brief 向数据库注册新人员，失败时自动刷新缓存重试。
+ * @brief 向数据库注册新人员，成功后增量更新缓存与量化人员库。
  */
 HRCode OpenCVDlibBackend::Impl::registerPerson(const PersonInfo& person) {
     if (person.id.isEmpty()) return HRCode::UnknownError;
@@ -229,13 +395,12 @@ HRCode OpenCVDlibBackend::Impl::registerPerson(const PersonInfo& person) {
     }
 
     if (!persistPerson(person, false)) {
-        // 如果数据库写入失败，刷新缓存以判断是否由于并发注册导致记录已经存在。
-        const HRCode reload = loadPersonsFromStorage();
-        {
+        // 写入失败时只回读这一行，判断是否由于并发注册导致记录已经存在。
+        const std::optional<PersonInfo> existing = fetchPersonFromStorage(person.id);
+        if (existing.has_value()) {
             std::scoped_lock lock(mutex);
-            if (reload == HRCode::Ok && persons.contains(person.id)) {
-                return HRCode::PersonExists;
-            }
+            applyPersonUpsert(existing.value());
+            return HRCode::PersonExists;
         }
         if (logger) { logger->error("Failed to persist person {}", person.id.toStdString()); }
         return HRCode::UnknownError;
@@ -243,7 +408,7 @@ HRCode OpenCVDlibBackend::Impl::registerPerson(const PersonInfo& person) {
 
     {
         std::scoped_lock lock(mutex);
-        persons.insert(person.id, person);
+        applyPersonUpsert(person);
     }
 
     if (logger) {
@@ -253,6 +418,96 @@ HRCode OpenCVDlibBackend::Impl::registerPerson(const PersonInfo& person) {
     return HRCode::Ok;
 }
 
+/**
+ * @brief 批量注册人员：所有行在同一事务中写入，任意一条失败则整体回滚。
+ *
+ * replaceExisting 为 false 时，批次内重复 id 或缓存中已存在的 id 会使整批返回 PersonExists；
+ * 为 true 时已存在的记录被更新（保留 created_at），批次内重复 id 以最后一条为准。
+ */
+HRCode OpenCVDlibBackend::Impl::registerPersons(const QVector<PersonInfo>& batch,
+                                                bool replaceExisting) {
+    if (batch.isEmpty()) return HRCode::Ok;
+    if (!storageReady && !ensureStorageReady()) return HRCode::UnknownError;
+
+    // 去重并保持首次出现的顺序，后出现的同 id 记录覆盖先前的内容。
+    QVector<PersonInfo> unique;
+    unique.reserve(batch.size());
+    QHash<QString, int> indexOf;
+    for (const PersonInfo& person : batch) {
+        if (person.id.isEmpty()) return HRCode::UnknownError;
+        auto it = indexOf.constFind(person.id);
+        if (it == indexOf.cend()) {
+            indexOf.insert(person.id, static_cast<int>(unique.size()));
+            unique.append(person);
+        } else if (replaceExisting) {
+            unique[it.value()] = person;
+        } else {
+            return HRCode::PersonExists;
+        }
+    }
+
+    if (!replaceExisting) {
+        std::scoped_lock lock(mutex);
+        for (const PersonInfo& person : unique) {
+            if (persons.contains(person.id)) return HRCode::PersonExists;
+        }
+    }
+
+    try {
+        QSqlDatabase& db = storage::DbManager::instance().db();
+        const auto writeLock = storage::DbManager::instance().writeLock();
+        if (!db.transaction()) {
+            if (logger) {
+                logger->error("Failed to start transaction for batch registration: {}",
+                              db.lastError().text().toStdString());
+            }
+            return HRCode::UnknownError;
+        }
+
+        for (const PersonInfo& person : unique) {
+            if (persistPerson(person, replaceExisting)) continue;
+            db.rollback();
+            if (!replaceExisting) {
+                // 与单条注册一致：冲突行可能由并发注册写入，回读后补进缓存。
+                const std::optional<PersonInfo> existing = fetchPersonFromStorage(person.id);
+                if (existing.has_value()) {
+                    std::scoped_lock lock(mutex);
+                    applyPersonUpsert(existing.value());
+                    return HRCode::PersonExists;
+                }
+            }
+            if (logger) {
+                logger->error("Batch registration rolled back at person {}",
+                              person.id.toStdString());
+            }
+            return HRCode::UnknownError;
+        }
+
+        if (!db.commit()) {
+            if (logger) {
+                logger->error("Failed to commit batch registration: {}",
+                              db.lastError().text().toStdString());
+            }
+            db.rollback();
+            return HRCode::UnknownError;
+        }
+    } catch (const std::exception& ex) {
+        if (logger) { logger->error("registerPersons exception: {}", ex.what()); }
+        return HRCode::UnknownError;
+    } catch (...) {
+        if (logger) { logger->error("registerPersons unknown exception"); }
+        return HRCode::UnknownError;
+    }
+
+    {
+        std::scoped_lock lock(mutex);
+        for (const PersonInfo& person : unique) applyPersonUpsert(person);
+    }
+
+    if (logger) { logger->info("Registered {} persons in one transaction", unique.size()); }
+    return HRCode::Ok;
+}
+
 /**
  * @brief 从数据库删除人员并同步到内存缓存。
  */
@@ -275,7 +530,7 @@ HRCode OpenCVDlibBackend::Impl::removePerson(const QString& personId) {
 
     {
         std::scoped_lock lock(mutex);
-        persons.remove(personId);
+        applyPersonRemoval(personId);
     }
 
     if (logger) { logger->info("Removed person {}", personId.toStdString()); }
@@ -284,6 +539,8 @@ HRCode OpenCVDlibBackend::Impl::removePerson(const QString& personId) {
 
 /**
  * @brief 根据 id 查询人员（仅访问内存缓存，O(1)）。
+ *
+ * 量化模式下返回的特征由量化行反量化得到，version 带编码后缀（例如 "dlib_resnet_128@int8"）。
  */
 HRCode OpenCVDlibBackend::Impl::getPerson(const QString& personId, PersonInfo& outPerson) {
     std::scoped_lock lock(mutex);
@@ -292,7 +549,7 @@ HRCode OpenCVDlibBackend::Impl::getPerson(const QString& personId, PersonInfo& o
         if (logger) { logger->info("GetPerson: {} not found", personId.toStdString()); }
         return HRCode::PersonNotFound;
     }
-    outPerson = it.value();
+    outPerson = publicPersonLocked(it.value());
     if (logger) {
         logger->debug("GetPerson: {} ({}) fetched from cache",
                       outPerson.id.toStdString(),
@@ -307,17 +564,23 @@ HRCode OpenCVDlibBackend::Impl::listPersons(QVector<PersonInfo>& outPersons) {
     std::scoped_lock lock(mutex);
     outPersons.clear();
     outPersons.reserve(persons.size());
-    for (auto it = persons.cbegin(); it != persons.cend(); ++it) { outPersons.append(it.value()); }
+    for (auto it = persons.cbegin(); it != persons.cend(); ++it) {
+        outPersons.append(publicPersonLocked(it.value()));
+    }
     if (logger) { logger->debug("ListPersons: returning {} cached entries", outPersons.size()); }
     return HRCode::Ok;
 }
 
-/**
- * @brief 训练接口暂未实现，直接返回 UnknownError。
- */
-HRCode OpenCVDlibBackend::Impl::train(const QString&) {
-    if (logger) { logger->warn("Train not implemented for OpenCVDlibBackend"); }
-    return HRCode::UnknownError;
+PersonInfo OpenCVDlibBackend::Impl::publicPersonLocked(const PersonInfo& person) const {
+    if (featuresResident || !gallery) return person;
+    PersonInfo out = person;
+    out.canonicalFeature = gallery->decode(person.id);
+    return out;
+}
+
+void OpenCVDlibBackend::Impl::setResultsChangedCallback(std::function<void()> callback) {
+    std::scoped_lock lock(mutex);
+    resultsChanged = std::move(callback);
 }
 
 QString OpenCVDlibBackend::Impl::backendName() const {
@@ -400,6 +663,11 @@ OpenCVDlibBackend::Impl::ModelFiles OpenCVDlibBackend::Impl::resolveModelFiles(
     if (files.personDatabase.isEmpty()) {
         files.personDatabase = dir.filePath(QStringLiteral("people.json"));
     }
+    // YuNet 模型按 OpenCV Zoo 的命名查找（例如 face_detection_yunet_2023mar.onnx）
+    const QStringList yunet = dir.entryList({QStringLiteral("face_detection_yunet*.onnx")},
+                                            QDir::Files,
+                                            QDir::Name | QDir::Reversed);
+    if (!yunet.isEmpty()) files.dnnDetector = dir.filePath(yunet.front());
 
     // 验证关键模型文件是否存在
     if (files.shapePredictor.isEmpty() || files.recognition.isEmpty()) {
@@ -417,6 +685,53 @@ OpenCVDlibBackend::Impl::ModelFiles OpenCVDlibBackend::Impl::resolveModelFiles(
     return files;
 }
 
+/**
+ * @brief 应用配置中心推送的变化。
+ *
+ * 只处理检索路径上可以随时替换的参数；检测器、模型与表名等需要重新加载资源，
+ * 在下一次 initialize() 时读取。
+ */
+void OpenCVDlibBackend::Impl::applyConfigChange(const config::ConfigSnapshot& snapshot,
+                                                const QStringList& keys) {
+    std::function<void()> notify;
+    {
+        std::scoped_lock lock(mutex);
+        bool resultsAffected = false;
+        for (const QString& key : keys) {
+            if (key == QLatin1String("HumanRecognition/MatchThreshold")) {
+                matchThreshold = snapshot.getDouble(key, kDefaultMatchThreshold);
+                if (matchThreshold < 0.0) matchThreshold = kDefaultMatchThreshold;
+                if (logger) logger->info("Match threshold changed to {}", matchThreshold);
+                resultsAffected = true;
+            } else if (key == QLatin1String("HumanRecognition/RerankTopK")) {
+                rerankTopK = snapshot.getInt(key, kDefaultRerankTopK);
+                if (rerankTopK <= 0) rerankTopK = kDefaultRerankTopK;
+                if (logger) logger->info("Rerank top-K changed to {}", rerankTopK);
+                resultsAffected = true;
+            } else if (key == QLatin1String("HumanRecognition/GalleryEncoding")) {
+                const FeatureEncoding encoding = parseFeatureEncoding(snapshot.getString(key))
+                                                     .value_or(FeatureEncoding::Float32);
+                if (encoding != galleryEncoding) {
+                    galleryEncoding = encoding;
+                    galleryDirty = true;
+                    resultsAffected = true;
+                    if (logger) {
+                        logger->info("Gallery encoding changed to {}",
+                                     featureEncodingName(galleryEncoding).toStdString());
+                    }
+                }
+            } else if (!key.startsWith(QLatin1String("HumanRecognition/Onnx")) && logger) {
+                // Onnx* 键属于 ONNX 后端
+                logger->info("Configuration key {} changed, takes effect on next initialize",
+                             key.toStdString());
+            }
+        }
+        if (resultsAffected) notify = resultsChanged;
+    }
+    // 阈值、重排数量或编码变化会改变识别结果；在锁外通知，回调可以安全地进入门面
+    if (notify) notify();
+}
+
 /**
  * @brief 从全局配置中心刷新阈值、表名等运行参数。
  */
@@ -434,6 +749,126 @@ void OpenCVDlibBackend::Impl::refreshConfiguration() {
     if (matchThreshold < 0.0) matchThreshold = kDefaultMatchThreshold;
     autoCreatePersonsTable =
         cfg.setOrDefault(QStringLiteral("HumanRecognition/AutoCreateTable"), true).toBool();
+
+    const QString encodingName =
+        cfg.setOrDefault(QStringLiteral("HumanRecognition/GalleryEncoding"),
+                         featureEncodingName(FeatureEncoding::Float32))
+            .toString();
+    const FeatureEncoding encoding =
+        parseFeatureEncoding(encodingName).value_or(FeatureEncoding::Float32);
+    if (encoding != galleryEncoding) {
+        galleryEncoding = encoding;
+        galleryDirty = true;
+    }
+    rerankTopK =
+        cfg.setOrDefault(QStringLiteral("HumanRecognition/RerankTopK"), kDefaultRerankTopK).toInt();
+    if (rerankTopK <= 0) rerankTopK = kDefaultRerankTopK;
+    detectThreads =
+        cfg.setOrDefault(QStringLiteral("HumanRecognition/DetectThreads"), kDefaultDetectThreads)
+            .toInt();
+    if (detectThreads < 0) detectThreads = kDefaultDetectThreads;
+
+    const QString detectorName =
+        cfg.setOrDefault(QStringLiteral("HumanRecognition/Detector"),
+                         QString::fromLatin1(kDefaultDetectorKind))
+            .toString();
+    detectorKind = parseDetectorKind(detectorName).value_or(detail::DetectorKind::Hog);
+    dnnModelPath =
+        cfg.setOrDefault(QStringLiteral("HumanRecognition/DnnDetectorModel"), QString()).toString();
+    dnnInputSize =
+        cfg.setOrDefault(QStringLiteral("HumanRecognition/DnnInputSize"), kDefaultDnnInputSize)
+            .toInt();
+    if (dnnInputSize <= 0) dnnInputSize = kDefaultDnnInputSize;
+    dnnThreads =
+        cfg.setOrDefault(QStringLiteral("HumanRecognition/DnnThreads"), kDefaultDnnThreads).toInt();
+    if (dnnThreads < 0) dnnThreads = kDefaultDnnThreads;
+
+    const QString loadingName =
+        cfg.setOrDefault(QStringLiteral("HumanRecognition/ModelLoading"),
+                         QString::fromLatin1(kDefaultModelLoading))
+            .toString();
+    modelLoading = parseModelLoading(loadingName).value_or(detail::ModelLoading::Prefetch);
+}
+
+/**
+ * @brief 从模型缓存取出 loadModel 登记的模型；首次调用时可能等待后台加载完成。
+ *
+ * 等待在 mutex 之外进行，加载期间不阻塞人员库查询等其他操作。特征网络会复制一份
+ * 供本实例独占使用，缓存中的原件保持只读。
+ */
+bool OpenCVDlibBackend::Impl::ensureModelsLoaded(bool needRecognitionNet) {
+    detail::ModelCache::Handle predictorHandle;
+    detail::ModelCache::Handle netHandle;
+    std::uint64_t generation = 0;
+    {
+        std::scoped_lock lock(mutex);
+        if (shapePredictor && (!needRecognitionNet || recognitionNet)) return true;
+        predictorHandle = pendingPredictor;
+        netHandle = pendingNet;
+        generation = modelGeneration;
+    }
+    if (!predictorHandle.valid() || (needRecognitionNet && !netHandle.valid())) return false;
+
+    const auto predictor = detail::ModelCache::get<dlib::shape_predictor>(predictorHandle);
+    std::unique_ptr<detail::FaceNet> net;
+    if (needRecognitionNet) {
+        if (const auto shared = detail::ModelCache::get<detail::FaceNet>(netHandle)) {
+            net = std::make_unique<detail::FaceNet>(*shared);
+        }
+    }
+    if (!predictor || (needRecognitionNet && !net)) {
+        if (logger) { logger->error("Models unavailable: deserialization failed, see cache log"); }
+        return false;
+    }
+
+    std::scoped_lock lock(mutex);
+    if (generation != modelGeneration) return shapePredictor != nullptr;  // 期间已重新加载
+    if (!shapePredictor) shapePredictor = predictor;
+    if (net && !recognitionNet) recognitionNet = std::move(net);
+    return true;
+}
+
+/**
+ * @brief 按当前配置创建 DNN 检测器并替换旧实例。
+ */
+bool OpenCVDlibBackend::Impl::reloadDnnDetector(const QString& modelPath) {
+    if (detectorKind != detail::DetectorKind::Dnn) {
+        std::scoped_lock lock(mutex);
+        dnnDetector.reset();
+        return true;
+    }
+
+    if (modelPath.isEmpty() || !QFileInfo::exists(modelPath)) {
+        if (logger) {
+            logger->warn("DNN detector model not found ({}), falling back to HOG",
+                         modelPath.isEmpty() ? "<unset>" : modelPath.toStdString());
+        }
+        std::scoped_lock lock(mutex);
+        dnnDetector.reset();
+        return false;
+    }
+
+    QString error;
+    std::shared_ptr<detail::DnnFaceDetector> created =
+        detail::DnnFaceDetector::create(modelPath, dnnInputSize, &error);
+    if (!created) {
+        if (logger) {
+            logger->warn("Failed to load DNN detector {}: {}; falling back to HOG",
+                         modelPath.toStdString(),
+                         error.toStdString());
+        }
+        std::scoped_lock lock(mutex);
+        dnnDetector.reset();
+        return false;
+    }
+
+    if (logger) {
+        logger->info(
+            "DNN detector loaded: {} (input={})", modelPath.toStdString(), dnnInputSize);
+    }
+    std::scoped_lock lock(mutex);
+    dnnDetector = std::move(created);
+    return true;
 }
 
 /**
@@ -599,6 +1034,7 @@ bool OpenCVDlibBackend::Impl::persistPerson(const PersonInfo& person, bool allow
         personsTable.isEmpty() ? QString::fromLatin1(kDefaultPersonsTable) : personsTable;
     try {
         QSqlDatabase& db = storage::DbManager::instance().db();
+        const auto writeLock = storage::DbManager::instance().writeLock();
         const QString metadataJson = serializeMetadata(person.metadata);
         const QString featureJson = person.canonicalFeature.has_value()
                                         ? serializeFeature(*person.canonicalFeature)
@@ -672,6 +1108,7 @@ bool OpenCVDlibBackend::Impl::deletePersonFromDatabase(const QString& personId)
         personsTable.isEmpty() ? QString::fromLatin1(kDefaultPersonsTable) : personsTable;
     try {
         QSqlDatabase& db = storage::DbManager::instance().db();
+        const auto writeLock = storage::DbManager::instance().writeLock();
         QSqlQuery query(db);
         // DELETE 语句执行完毕后，可通过受影响行数判断是否删除成功。
         query.prepare(QStringLiteral("DELETE FROM %1 WHERE id = ?").arg(table));
@@ -700,7 +1137,7 @@ bool OpenCVDlibBackend::Impl::deletePersonFromDatabase(const QString& personId)
 /**
  * @brief 全量加载人员表到内存缓存。
  */
-HRCode OpenCVDlibBackend::Impl::loadPersonsFromStorage() {
+HRCode OpenCVDlibBackend::Impl::loadPersonsFromStorage(QVector<PersonInfo>* loadedRows) {
     if (!storageReady && !ensureStorageReady()) return HRCode::ModelLoadFailed;
     const QString table =
         personsTable.isEmpty() ? QString::fromLatin1(kDefaultPersonsTable) : personsTable;
@@ -744,6 +1181,10 @@ HRCode OpenCVDlibBackend::Impl::loadPersonsFromStorage() {
         for (const PersonInfo& info : loaded) {
             if (!info.id.isEmpty()) { persons.insert(info.id, info); }
         }
+        // 量化模式下立即建库并释放 float 特征，不等到第一次检索
+        featuresResident = true;
+        galleryDirty = true;
+        rebuildGalleryIfNeeded();
     }
 
     if (logger) {
@@ -751,9 +1192,122 @@ HRCode OpenCVDlibBackend::Impl::loadPersonsFromStorage() {
                      static_cast<int>(loaded.size()),
                      table.toStdString());
     }
+    if (loadedRows) *loadedRows = std::move(loaded);
     return HRCode::Ok;
 }
 
+/**
+ * @brief 读取人员表中的 float 特征，供量化模式下的重排与重建使用。
+ */
+std::optional<QHash<QString, FaceFeature>> OpenCVDlibBackend::Impl::fetchFeaturesFromStorage(
+    const QStringList& ids) {
+    if (!storageReady) return std::nullopt;
+    const QString table =
+        personsTable.isEmpty() ? QString::fromLatin1(kDefaultPersonsTable) : personsTable;
+    try {
+        QSqlQuery query(storage::DbManager::instance().db());
+        QString sql = QStringLiteral("SELECT id, feature_json FROM %1").arg(table);
+        if (!ids.isEmpty()) {
+            QStringList placeholders;
+            placeholders.fill(QStringLiteral("?"), ids.size());
+            sql += QStringLiteral(" WHERE id IN (%1)").arg(placeholders.join(QLatin1Char(',')));
+        }
+        query.prepare(sql);
+        for (const QString& id : ids) query.addBindValue(id);
+        if (!query.exec()) {
+            if (logger) {
+                logger->error("Failed to read features from {}: {}",
+                              table.toStdString(),
+                              query.lastError().text().toStdString());
+            }
+            return std::nullopt;
+        }
+
+        QHash<QString, FaceFeature> features;
+        while (query.next()) {
+            auto feat = deserializeFeature(query.value(1).toString());
+            if (feat.has_value()) features.insert(query.value(0).toString(), std::move(*feat));
+        }
+        return features;
+    } catch (const std::exception& ex) {
+        if (logger) { logger->error("fetchFeaturesFromStorage exception: {}", ex.what()); }
+    } catch (...) {
+        if (logger) { logger->error("fetchFeaturesFromStorage unknown exception"); }
+    }
+    return std::nullopt;
+}
+
+/**
+ * @brief 按主键读取单条人员记录，用于冲突后的缓存修正。
+ */
+std::optional<PersonInfo> OpenCVDlibBackend::Impl::fetchPersonFromStorage(
+    const QString& personId) {
+    if (!storageReady && !ensureStorageReady()) return std::nullopt;
+    const QString table =
+        personsTable.isEmpty() ? QString::fromLatin1(kDefaultPersonsTable) : personsTable;
+    try {
+        QSqlDatabase& db = storage::DbManager::instance().db();
+        QSqlQuery query(db);
+        query.prepare(
+            QStringLiteral("SELECT id, name, metadata_json, feature_json FROM %1 WHERE id = ?")
+                .arg(table));
+        query.addBindValue(personId);
+        if (!query.exec()) {
+            if (logger) {
+                logger->error("Failed to query person {}: {}",
+                              personId.toStdString(),
+                              query.lastError().text().toStdString());
+            }
+            return std::nullopt;
+        }
+        if (!query.next()) return std::nullopt;
+
+        PersonInfo info;
+        info.id = query.value(0).toString();
+        info.name = query.value(1).toString();
+        info.metadata = deserializeMetadata(query.value(2).toString());
+        auto feat = deserializeFeature(query.value(3).toString());
+        if (feat.has_value()) info.canonicalFeature = feat;
+        return info;
+    } catch (const std::exception& ex) {
+        if (logger) { logger->error("fetchPersonFromStorage exception: {}", ex.what()); }
+    } catch (...) {
+        if (logger) { logger->error("fetchPersonFromStorage unknown exception"); }
+    }
+    return std::nullopt;
+}
+
+/**
+ * @brief 单条写入缓存；量化人员库已构建且未过期时原地更新，避免整库重建。
+ *
+ * 量化模式下 persons 不保存 float 特征，新特征放入重排缓存（人员表中已有持久副本）。
+ */
+void OpenCVDlibBackend::Impl::applyPersonUpsert(const PersonInfo& person) {
+    if (featuresResident) {
+        persons.insert(person.id, person);
+    } else {
+        PersonInfo info = person;
+        info.canonicalFeature.reset();
+        persons.insert(person.id, info);
+        rerankFeatures.remove(person.id);
+        if (person.canonicalFeature.has_value()) {
+            rerankFeatures.insert(person.id, new FaceFeature(person.canonicalFeature.value()));
+        }
+    }
+    if (!gallery || galleryDirty) return;
+    // 无特征或维度与已有行不一致时与全量重建保持一致：该行不进入量化库
+    if (!person.canonicalFeature.has_value() ||
+        !gallery->upsert(person.id, person.canonicalFeature.value())) {
+        gallery->remove(person.id);
+    }
+}
+
+void OpenCVDlibBackend::Impl::applyPersonRemoval(const QString& personId) {
+    persons.remove(personId);
+    rerankFeatures.remove(personId);
+    if (gallery && !galleryDirty) gallery->remove(personId);
+}
+
 /**
  * @brief 兼容旧版 JSON 人员库并导入到数据库。
  */
@@ -800,6 +1354,7 @@ HRCode OpenCVDlibBackend::Impl::loadPersonDatabase(const QString& jsonPath) {
     const int parsedCount = parsed.size();
     try {
         QSqlDatabase& db = storage::DbManager::instance().db();
+        const auto writeLock = storage::DbManager::instance().writeLock();
         // 批量导入使用事务，保证错误时能完全回滚。
         if (!db.transaction()) {
             if (logger) {
@@ -842,35 +1397,35 @@ HRCode OpenCVDlibBackend::Impl::loadPersonDatabase(const QString& jsonPath) {
 }
 
 /**
- * @brief 将当前缓存内容写入 JSON 文件，便于导出/调试。
+ * @brief 将人员表内容写入 JSON 文件（同时刷新缓存），便于导出/调试。
+ *
+ * 导出使用人员表中的 float 特征，量化模式下也不会写出反量化后的近似值。
  */
 HRCode OpenCVDlibBackend::Impl::savePersonDatabase(const QString& jsonPath) {
-    const HRCode syncResult = loadPersonsFromStorage();
+    QVector<PersonInfo> rows;
+    const HRCode syncResult = loadPersonsFromStorage(&rows);
     if (syncResult != HRCode::Ok) return syncResult;
 
     QJsonArray peopleArray;
-    {
-        std::scoped_lock lock(mutex);
-        for (auto it = persons.cbegin(); it != persons.cend(); ++it) {
-            const PersonInfo& person = it.value();
-            QJsonObject obj;
-            obj.insert(QStringLiteral("id"), person.id);
-            obj.insert(QStringLiteral("name"), person.name);
-            obj.insert(QStringLiteral("metadata"), person.metadata);
-
-            if (person.canonicalFeature.has_value()) {
-                const FaceFeature& feat = person.canonicalFeature.value();
-                QJsonObject featObj;
-                QJsonArray values;
-                for (float v : feat.values) values.append(v);
-                featObj.insert(QStringLiteral("values"), values);
-                featObj.insert(QStringLiteral("version"), feat.version);
-                if (feat.norm.has_value()) featObj.insert(QStringLiteral("norm"), *feat.norm);
-                obj.insert(QStringLiteral("feature"), featObj);
-            }
-
-            peopleArray.append(obj);
+    for (const PersonInfo& person : rows) {
+        if (person.id.isEmpty()) continue;
+        QJsonObject obj;
+        obj.insert(QStringLiteral("id"), person.id);
+        obj.insert(QStringLiteral("name"), person.name);
+        obj.insert(QStringLiteral("metadata"), person.metadata);
+
+        if (person.canonicalFeature.has_value()) {
+            const FaceFeature& feat = person.canonicalFeature.value();
+            QJsonObject featObj;
+            QJsonArray values;
+            for (float v : feat.values) values.append(v);
+            featObj.insert(QStringLiteral("values"), values);
+            featObj.insert(QStringLiteral("version"), feat.version);
+            if (feat.norm.has_value()) featObj.insert(QStringLiteral("norm"), *feat.norm);
+            obj.insert(QStringLiteral("feature"), featObj);
         }
+
+        peopleArray.append(obj);
     }
 
     QJsonObject root;
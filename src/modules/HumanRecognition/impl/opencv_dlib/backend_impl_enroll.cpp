@@ -0,0 +1,290 @@
+﻿#include "../../internal/enrollment.h"
+#include "internal/backend_impl.h"
+#include "internal/image_view.h"
+#include "logging/logging.h"
+
+#if defined(HAS_OPENCV) && defined(HAS_DLIB)
+
+#include <dlib/image_processing/shape_predictor.h>
+#include <dlib/image_transforms.h>
+
+#include <QElapsedTimer>
+#include <QImage>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <exception>
+#include <mutex>
+#include <opencv2/core.hpp>
+#include <thread>
+#include <vector>
+
+namespace HumanRecognition {
+
+using namespace opencv_dlib;
+
+namespace {
+
+/**
+ * @brief 入库工作线程的私有状态：检测器与特征网络副本、待前向的人脸批次以及特征累加结果。
+ */
+struct EnrollWorker {
+    dlib::frontal_face_detector detector;
+    std::unique_ptr<detail::FaceNet> net;
+    std::vector<dlib::matrix<dlib::rgb_pixel>> chips;
+    std::vector<int> chipPersons;
+    detail::FeatureAccumulator features;
+};
+
+/// 像素面积，用于在多张人脸中选出主体
+qint64 area(const QRect& r) {
+    return static_cast<qint64>(r.width()) * static_cast<qint64>(r.height());
+}
+
+}  // namespace
+
+/**
+ * @brief 训练接口：以默认参数对数据集执行批量入库。
+ */
+HRCode OpenCVDlibBackend::Impl::train(const QString& datasetPath) {
+    return enrollDataset(datasetPath, EnrollOptions());
+}
+
+/**
+ * @brief 并行批量入库。
+ *
+ * 每个工作线程独立完成解码 → 缩放 → 检测 → 关键点 → 对齐裁剪，攒满 batchSize 张人脸后
+ * 用自己的特征网络副本做一次批量前向计算，并把特征累加到线程私有的累加器中；
+ * 全部完成后合并各线程的累加结果，按人员取平均，最后通过 registerPersons（或 opts.commit）
+ * 在一个事务中提交。
+ * 图片按原子计数器动态分配，解码耗时差异较大的数据集也能保持各线程负载均衡。
+ */
+HRCode OpenCVDlibBackend::Impl::enrollDataset(const QString& datasetPath,
+                                              const EnrollOptions& opts) {
+    const detail::EnrollmentDataset dataset = detail::scanEnrollmentDataset(datasetPath);
+    if (dataset.samples.isEmpty()) {
+        if (logger) {
+            logger->warn("Enroll aborted: no person images found under {}",
+                         datasetPath.toStdString());
+        }
+        return HRCode::TrainFailed;
+    }
+    if (!storageReady && !ensureStorageReady()) return HRCode::UnknownError;
+    if (!ensureModelsLoaded(true)) {
+        if (logger) { logger->error("Enroll aborted: models not loaded"); }
+        return HRCode::ModelLoadFailed;
+    }
+
+    const int personCount = static_cast<int>(dataset.personIds.size());
+    const int sampleCount = static_cast<int>(dataset.samples.size());
+    // 按图片并行，与检测分块无关：未指定时使用全部核心，而不是 DetectThreads
+    const int requested = opts.threads > 0
+                              ? opts.threads
+                              : static_cast<int>(std::thread::hardware_concurrency());
+    const int threads = std::min(std::clamp(requested, 1, 64), sampleCount);
+    const int batchSize = opts.batchSize > 0 ? opts.batchSize : kDefaultEnrollBatchSize;
+    const float minScore = DetectOptions().minScore;
+
+    // 检测器与特征网络在前向计算时会修改内部状态，每个线程各复制一份；关键点模型只读共享
+    std::shared_ptr<const dlib::shape_predictor> predictor;
+    std::shared_ptr<detail::DnnFaceDetector> dnn;
+    std::vector<EnrollWorker> workers(static_cast<std::size_t>(threads));
+    {
+        std::scoped_lock lock(mutex);
+        if (!shapePredictor || !recognitionNet) return HRCode::ModelLoadFailed;
+        predictor = shapePredictor;
+        if (detectorKind == detail::DetectorKind::Dnn) dnn = dnnDetector;
+        for (EnrollWorker& worker : workers) {
+            worker.detector = detector;
+            worker.net = std::make_unique<detail::FaceNet>(*recognitionNet);
+            worker.features = detail::FeatureAccumulator(personCount);
+        }
+    }
+
+    EnrollProgress progress;
+    progress.totalImages = sampleCount;
+    progress.totalPersons = personCount;
+    std::atomic<int> next{0};
+    std::atomic<int> processed{0};
+    std::atomic<int> failed{0};
+    std::mutex progressMutex;
+    QElapsedTimer timer;
+    timer.start();
+
+    // 回调已被其他线程占用时直接跳过本次汇报，避免工作线程在回调上排队
+    const auto report = [&](bool wait) {
+        if (!opts.progress) return;
+        std::unique_lock<std::mutex> lock(progressMutex, std::defer_lock);
+        if (wait) {
+            lock.lock();
+        } else if (!lock.try_lock()) {
+            return;
+        }
+        progress.processedImages = processed.load();
+        progress.failedImages = failed.load();
+        const double seconds = static_cast<double>(timer.nsecsElapsed()) / 1e9;
+        progress.imagesPerSecond = seconds > 0.0 ? progress.processedImages / seconds : 0.0;
+        opts.progress(progress);
+    };
+
+    // 用线程私有的网络副本对攒下的人脸做一次批量前向计算
+    const auto flush = [&](EnrollWorker& worker) {
+        if (worker.chips.empty()) return;
+        try {
+            const std::vector<dlib::matrix<float, 0, 1>> descriptors =
+                (*worker.net)(worker.chips, static_cast<std::size_t>(batchSize));
+            for (std::size_t i = 0; i < descriptors.size(); ++i) {
+                const auto& descriptor = descriptors[i];
+                if (descriptor.size() == 0 ||
+                    !worker.features.add(worker.chipPersons[i],
+                                         &descriptor(0),
+                                         static_cast<int>(descriptor.size()))) {
+                    ++failed;
+                }
+            }
+        } catch (const std::exception& ex) {
+            failed += static_cast<int>(worker.chips.size());
+            if (logger) { logger->warn("Enroll: batch feature extraction failed: {}", ex.what()); }
+        }
+        worker.chips.clear();
+        worker.chipPersons.clear();
+    };
+
+    // 解码并对齐一张图片，成功时把 150x150 人脸追加到该线程的批次中
+    const auto prepare = [&](EnrollWorker& worker, const detail::EnrollmentSample& sample) {
+        const QImage image(sample.path);
+        detail::RgbImageView rgb = detail::RgbImageView::fromQImage(image);
+        if (rgb.isNull()) return false;
+
+        // 对齐后的人脸只有 150 像素，检测与关键点在缩小后的图上完成即可
+        const int longSide = std::max(rgb.width(), rgb.height());
+        if (opts.maxImageSide > 0 && longSide > opts.maxImageSide) {
+            const double scale = static_cast<double>(opts.maxImageSide) / longSide;
+            rgb = rgb.resized(
+                cv::Size(std::max(1, static_cast<int>(std::round(rgb.width() * scale))),
+                         std::max(1, static_cast<int>(std::round(rgb.height() * scale)))));
+        }
+        const auto view = rgb.dlibView();
+
+        // 数据集照片通常是单人照，多张人脸时取面积最大的一张，其余视为背景
+        dlib::rectangle face;
+        if (dnn) {
+            const QVector<detail::ScoredRect> detections = dnn->detect(rgb.mat(), minScore);
+            if (detections.isEmpty()) return false;
+            const QRect best = std::max_element(detections.cbegin(),
+                                                detections.cend(),
+                                                [](const auto& a, const auto& b) {
+                                                    return area(a.rect) < area(b.rect);
+                                                })
+                                   ->rect;
+            face = dlib::rectangle(best.left(), best.top(), best.right(), best.bottom());
+        } else {
+            const std::vector<dlib::rectangle> faces = worker.detector(view);
+            if (faces.empty()) return false;
+            face = *std::max_element(
+                faces.cbegin(), faces.cend(), [](const auto& a, const auto& b) {
+                    return a.area() < b.area();
+                });
+        }
+
+        const dlib::full_object_detection shape = (*predictor)(view, face);
+        dlib::matrix<dlib::rgb_pixel> chip;
+        extract_image_chip(
+            view, get_face_chip_details(shape, kFaceChipSize, kFaceChipPadding), chip);
+        worker.chips.push_back(std::move(chip));
+        worker.chipPersons.push_back(sample.person);
+        return true;
+    };
+
+    dlib::thread_pool pool(static_cast<unsigned long>(threads));
+    dlib::parallel_for(
+        pool,
+        0,
+        threads,
+        [&](long index) {
+            EnrollWorker& worker = workers[static_cast<std::size_t>(index)];
+            for (int i = next++; i < sampleCount; i = next++) {
+                const detail::EnrollmentSample& sample = dataset.samples[i];
+                bool ok = false;
+                try {
+                    ok = prepare(worker, sample);
+                } catch (const std::exception& ex) {
+                    if (logger) {
+                        logger->warn("Enroll: failed to process {}: {}",
+                                     sample.path.toStdString(),
+                                     ex.what());
+                    }
+                }
+                if (!ok) ++failed;
+                ++processed;
+                if (static_cast<int>(worker.chips.size()) >= batchSize) {
+                    flush(worker);
+                    report(false);
+                }
+            }
+            flush(worker);
+        },
+        1);
+
+    detail::FeatureAccumulator total(personCount);
+    for (const EnrollWorker& worker : workers) total.merge(worker.features);
+
+    QVector<PersonInfo> batch;
+    batch.reserve(personCount);
+    int skipped = 0;
+    {
+        std::scoped_lock lock(mutex);
+        for (int person = 0; person < personCount; ++person) {
+            const int images = total.count(person);
+            if (images == 0 || images < opts.minImagesPerPerson) {
+                ++skipped;
+                continue;
+            }
+            // 已存在的人员保留姓名与其他元数据，只更新标准特征
+            const QString& id = dataset.personIds[person];
+            PersonInfo info;
+            auto existing = persons.constFind(id);
+            if (existing != persons.cend()) {
+                if (!opts.replaceExisting) {
+                    ++skipped;
+                    continue;
+                }
+                info = existing.value();
+            } else {
+                info.id = id;
+                info.name = id;
+            }
+            info.canonicalFeature = total.mean(person, QString::fromLatin1(kFeatureVersion));
+            info.metadata.insert(QStringLiteral("enrolledImages"), images);
+            batch.append(info);
+        }
+    }
+
+    HRCode code = HRCode::TrainFailed;
+    if (!batch.isEmpty()) {
+        code = opts.commit ? opts.commit(batch, opts.replaceExisting)
+                           : registerPersons(batch, opts.replaceExisting);
+    }
+    if (code == HRCode::Ok) progress.enrolledPersons = static_cast<int>(batch.size());
+    report(true);
+
+    const double seconds = static_cast<double>(timer.nsecsElapsed()) / 1e9;
+    if (logger) {
+        logger->info(
+            "Enrolled {} of {} persons from {} images ({} failed, {} skipped) in {:.1f}s "
+            "({:.1f} images/s, {} threads)",
+            progress.enrolledPersons,
+            personCount,
+            sampleCount,
+            failed.load(),
+            skipped,
+            seconds,
+            seconds > 0.0 ? sampleCount / seconds : 0.0,
+            threads);
+    }
+    return code;
+}
+
+}  // namespace HumanRecognition
+
+#endif  // defined(HAS_OPENCV) && defined(HAS_DLIB)
@@ -1,4 +1,6 @@
-﻿#include "internal/backend_impl.h"
+﻿#include "../../internal/detection_tiles.h"
+#include "internal/backend_impl.h"
+#include "internal/image_view.h"
 #include "logging/logging.h"
 
 #if defined(HAS_OPENCV) && defined(HAS_DLIB)
@@ -13,31 +15,35 @@
 #include <cmath>
 #include <limits>
 #include <opencv2/core.hpp>
-#include <opencv2/imgproc.hpp>
+#include <thread>
 #include <vector>
 
 namespace HumanRecognition {
 
+using namespace opencv_dlib;
+
 namespace {
 
+QRect toQRect(const dlib::rectangle& r) {
+    return QRect(QPoint(static_cast<int>(r.left()), static_cast<int>(r.top())),
+                 QPoint(static_cast<int>(r.right()), static_cast<int>(r.bottom())));
+}
+
+dlib::rectangle toDlibRect(const QRect& r) {
+    return dlib::rectangle(r.left(), r.top(), r.right(), r.bottom());
+}
+
 /**
- * @brief 将 Qt 的 QImage 转换为 OpenCV 的 BGR 格式 Mat。
- *
- * dlib 的处理流程依赖 RGB 排列，因此后续还会做一次色彩空间转换。
+ * @brief 复制检测器并限制其金字塔层数（层数只能在构造扫描器时设定）。
  */
-cv::Mat qImageToBgrMat(const QImage& image) {
-    if (image.isNull()) return {};
-    QImage converted = image.format() == QImage::Format_RGB888
-                           ? image
-                           : image.convertToFormat(QImage::Format_RGB888);
-    cv::Mat rgb(converted.height(),                         // rows
-                converted.width(),                          // cols
-                CV_8UC3,                                    // 3-channel uchar
-                const_cast<uchar*>(converted.constBits()),  // data pointer
-                converted.bytesPerLine());                  // stride
-    cv::Mat bgr;
-    cv::cvtColor(rgb, bgr, cv::COLOR_RGB2BGR);
-    return bgr;
+dlib::frontal_face_detector withMaxPyramidLevels(const dlib::frontal_face_detector& base,
+                                                 unsigned long maxLevels) {
+    auto scanner = base.get_scanner();
+    scanner.set_max_pyramid_levels(maxLevels);
+    std::vector<dlib::frontal_face_detector::feature_vector_type> weights;
+    weights.reserve(base.num_detectors());
+    for (unsigned long i = 0; i < base.num_detectors(); ++i) weights.push_back(base.get_w(i));
+    return dlib::frontal_face_detector(scanner, base.get_overlap_tester(), weights);
 }
 
 /**
@@ -63,42 +69,42 @@ QRect scaleRectToOriginal(const dlib::rectangle& rect,
 }
 
 /**
- * @brief 还原关键点坐标至原图（带边界夹取）。
+ * @brief 将原图坐标系下的矩形映射到缩放后的工作图像。
  */
-QVector<QPointF> scaleLandmarksToOriginal(const dlib::full_object_detection& shape,
-                                          double scaleX,
-                                          double scaleY,
-                                          const QSize& originalSize) {
-    QVector<QPointF> pts;
-    pts.reserve(shape.num_parts());
-    if (scaleX <= 0.0 || scaleY <= 0.0) return pts;
+QRect scaleRectToWorking(const QRect& rect, double scaleX, double scaleY) {
+    const int left = static_cast<int>(std::floor(rect.left() * scaleX));
+    const int top = static_cast<int>(std::floor(rect.top() * scaleY));
+    const int right = static_cast<int>(std::ceil((rect.right() + 1) * scaleX)) - 1;
+    const int bottom = static_cast<int>(std::ceil((rect.bottom() + 1) * scaleY)) - 1;
+    return QRect(QPoint(left, top), QPoint(right, bottom));
+}
 
-    for (unsigned long i = 0; i < shape.num_parts(); ++i) {
-        double x = std::clamp(static_cast<double>(shape.part(i).x()) / scaleX,
-                              0.0,
-                              static_cast<double>(originalSize.width()));
-        double y = std::clamp(static_cast<double>(shape.part(i).y()) / scaleY,
-                              0.0,
-                              static_cast<double>(originalSize.height()));
-        pts.append(QPointF{x, y});
-    }
-    return pts;
+/**
+ * @brief 将原图坐标的人脸框夹取到图像范围内，作为关键点模型的输入；框退化时返回空矩形。
+ */
+dlib::rectangle clampFaceRect(const QRect& rect, const QSize& imageSize) {
+    const int left = std::clamp(rect.left(), 0, imageSize.width() - 1);
+    const int top = std::clamp(rect.top(), 0, imageSize.height() - 1);
+    const int right = std::clamp(rect.right(), 0, imageSize.width() - 1);
+    const int bottom = std::clamp(rect.bottom(), 0, imageSize.height() - 1);
+    if (left >= right || top >= bottom) return {};
+    return dlib::rectangle(left, top, right, bottom);
 }
 
 /**
- * @brief 将 OpenCV Mat 转换为 dlib RGB 矩阵。
+ * @brief 将原图上的关键点结果转换为 FaceBox 的关键点列表（带边界夹取）。
  */
-dlib::matrix<dlib::rgb_pixel> matToDlibRgb(const cv::Mat& bgr) {
-    if (bgr.empty()) return {};
-    dlib::matrix<dlib::rgb_pixel> out(bgr.rows, bgr.cols);
-    for (int r = 0; r < bgr.rows; ++r) {
-        const auto* rowPtr = bgr.ptr<cv::Vec3b>(r);
-        for (int c = 0; c < bgr.cols; ++c) {
-            const cv::Vec3b& px = rowPtr[c];
-            out(r, c) = dlib::rgb_pixel(px[2], px[1], px[0]);
-        }
+QVector<QPointF> toLandmarks(const dlib::full_object_detection& shape, const QSize& imageSize) {
+    QVector<QPointF> pts;
+    pts.reserve(shape.num_parts());
+    for (unsigned long i = 0; i < shape.num_parts(); ++i) {
+        const double x = std::clamp(
+            static_cast<double>(shape.part(i).x()), 0.0, static_cast<double>(imageSize.width()));
+        const double y = std::clamp(
+            static_cast<double>(shape.part(i).y()), 0.0, static_cast<double>(imageSize.height()));
+        pts.append(QPointF{x, y});
     }
-    return out;
+    return pts;
 }
 
 /**
@@ -118,7 +124,7 @@ FaceFeature fromDlibFeature(const dlib::matrix<float, 0, 1>& feature) {
     FaceFeature out;
     out.values.resize(feature.size());
     for (long i = 0; i < feature.size(); ++i) out.values[i] = feature(i);
-    out.version = QStringLiteral("dlib_resnet_128");
+    out.version = QString::fromLatin1(kFeatureVersion);
     out.norm = static_cast<float>(dlib::length(feature));
     return out;
 }
@@ -133,6 +139,18 @@ FaceFeature fromDlibFeature(const dlib::matrix<float, 0, 1>& feature) {
 HRCode OpenCVDlibBackend::Impl::detect(const QImage& image,
                                        const DetectOptions& opts,
                                        QVector<FaceBox>& outBoxes) {
+    FrameContextPtr unused;
+    return detectWithContext(image, opts, outBoxes, unused);
+}
+
+/**
+ * @brief 检测并保留 RGB 视图、缩放后的工作图像与关键点，供后续特征提取复用。
+ */
+HRCode OpenCVDlibBackend::Impl::detectWithContext(const QImage& image,
+                                                  const DetectOptions& opts,
+                                                  QVector<FaceBox>& outBoxes,
+                                                  FrameContextPtr& outContext) {
+    outContext.reset();
     if (logger) {
         logger->debug("Detect request: image={}x{}, landmarks={}, minScore={}, resize={}x{}",
                       image.width(),
@@ -147,68 +165,131 @@ HRCode OpenCVDlibBackend::Impl::detect(const QImage& image,
         return HRCode::InvalidImage;
     }
 
-    cv::Mat originalBgr = qImageToBgrMat(image);
-    if (originalBgr.empty()) {
-        if (logger) { logger->warn("Detect aborted: failed to convert image to BGR"); }
+    // RGB888 输入零拷贝，其余格式一次转换；后续缩放与检测都在 RGB 空间完成
+    auto context = std::make_shared<detail::DlibFrameContext>(
+        image, detail::RgbImageView::fromQImage(image));
+    const detail::RgbImageView& original = context->original;
+    if (original.isNull()) {
+        if (logger) { logger->warn("Detect aborted: failed to convert image to RGB"); }
         return HRCode::InvalidImage;
     }
 
-    cv::Mat working = originalBgr;
+    context->working = original;
 
     double scaleX = 1.0;
     double scaleY = 1.0;
     if (opts.resizeTo.width() > 0 || opts.resizeTo.height() > 0) {
         // 为了提升检测速度，可按配置对输入进行等比缩放
-        cv::Size target = working.size();
+        cv::Size target(original.width(), original.height());
         if (opts.resizeTo.width() > 0 && opts.resizeTo.height() > 0) {
             target = cv::Size(opts.resizeTo.width(), opts.resizeTo.height());
         } else if (opts.resizeTo.width() > 0) {
-            const double ratio = static_cast<double>(opts.resizeTo.width()) / working.cols;
-            target =
-                cv::Size(opts.resizeTo.width(), static_cast<int>(std::round(working.rows * ratio)));
+            const double ratio = static_cast<double>(opts.resizeTo.width()) / original.width();
+            target = cv::Size(opts.resizeTo.width(),
+                              static_cast<int>(std::round(original.height() * ratio)));
         } else {
-            const double ratio = static_cast<double>(opts.resizeTo.height()) / working.rows;
-            target = cv::Size(static_cast<int>(std::round(working.cols * ratio)),
+            const double ratio = static_cast<double>(opts.resizeTo.height()) / original.height();
+            target = cv::Size(static_cast<int>(std::round(original.width() * ratio)),
                               opts.resizeTo.height());
         }
-        scaleX = static_cast<double>(target.width) / originalBgr.cols;
-        scaleY = static_cast<double>(target.height) / originalBgr.rows;
-        cv::resize(originalBgr, working, target, 0, 0, cv::INTER_LINEAR);
+        scaleX = static_cast<double>(target.width) / original.width();
+        scaleY = static_cast<double>(target.height) / original.height();
+        context->working = original.resized(target);
         if (logger) {
             logger->debug("Detect resize applied: src={}x{}, dst={}x{}",
-                          originalBgr.cols,
-                          originalBgr.rows,
+                          original.width(),
+                          original.height(),
                           target.width,
                           target.height);
         }
     }
 
-    dlib::matrix<dlib::rgb_pixel> rgbWorking = matToDlibRgb(working);
-    std::vector<dlib::rectangle> faces;
-    {
-        // dlib 检测器不是线程安全的，共享读取时需要加锁。
+    std::shared_ptr<detail::DnnFaceDetector> dnn;
+    if (detectorKind == detail::DetectorKind::Dnn) {
         std::scoped_lock lock(mutex);
-        faces = detector(rgbWorking);
+        dnn = dnnDetector;
+    }
+
+    // 最小人脸大于检测窗口时整体缩小，直接省掉金字塔中最精细（也最耗时）的几层；
+    // DNN 检测器自行缩放到固定输入尺寸，不需要该预缩放
+    const double minFaceWorking = opts.minFaceSize * std::min(scaleX, scaleY);
+    if (!dnn && minFaceWorking > kHogWindowSize) {
+        const double prescale = kHogWindowSize / minFaceWorking;
+        const cv::Size target(
+            std::max(1, static_cast<int>(std::round(context->working.width() * prescale))),
+            std::max(1, static_cast<int>(std::round(context->working.height() * prescale))));
+        scaleX *= static_cast<double>(target.width) / context->working.width();
+        scaleY *= static_cast<double>(target.height) / context->working.height();
+        context->working = context->working.resized(target);
+    }
+    const int maxFaceWorking =
+        opts.maxFaceSize > 0
+            ? std::max(1, static_cast<int>(std::round(opts.maxFaceSize * std::max(scaleX, scaleY))))
+            : 0;
+
+    QVector<QRect> workingRegions;
+    workingRegions.reserve(opts.regionsOfInterest.size());
+    for (const QRect& roi : opts.regionsOfInterest) {
+        workingRegions.append(scaleRectToWorking(roi, scaleX, scaleY));
+    }
+
+    std::vector<dlib::rectangle> faces;
+    std::vector<float> scores;  // 与 faces 对应的置信度；HOG 路径为空，视为 1.0
+    if (dnn) {
+        const QVector<detail::ScoredRect> detections =
+            detectFacesDnn(*dnn, context->working, workingRegions, opts.minScore);
+        faces.reserve(static_cast<std::size_t>(detections.size()));
+        scores.reserve(static_cast<std::size_t>(detections.size()));
+        for (const auto& detection : detections) {
+            if (maxFaceWorking > 0 &&
+                std::max(detection.rect.width(), detection.rect.height()) > maxFaceWorking) {
+                continue;
+            }
+            faces.push_back(toDlibRect(detection.rect));
+            scores.push_back(static_cast<float>(detection.confidence));
+        }
+    } else {
+        const int threads = resolveDetectThreads(opts.threads);
+        if (workingRegions.isEmpty()) {
+            faces = detectFaces(context->working, maxFaceWorking, threads);
+        } else {
+            faces =
+                detectFacesInRegions(context->working, workingRegions, maxFaceWorking, threads);
+        }
     }
 
     outBoxes.clear();
     outBoxes.reserve(static_cast<int>(faces.size()));
 
+    // 关键点模型可能仍在后台加载，首次使用时在锁外等待
+    if (opts.detectLandmarks && !faces.empty() && !ensureModelsLoaded(false) && logger) {
+        logger->warn("Landmarks skipped: shape predictor not available");
+    }
+
     const QSize originalSize = image.size();
-    for (const auto& rect : faces) {
+    const auto originalView = original.dlibView();
+    for (std::size_t i = 0; i < faces.size(); ++i) {
+        const dlib::rectangle& rect = faces[i];
         const QRect boxRect = scaleRectToOriginal(rect, scaleX, scaleY, originalSize);
         if (!boxRect.isValid() || boxRect.isEmpty()) continue;
+        // HOG 路径已通过预缩放排除小脸；DNN 结果在原图坐标下按最小人脸过滤
+        if (dnn && std::min(boxRect.width(), boxRect.height()) < opts.minFaceSize) continue;
 
         FaceBox box;
         box.rect = boxRect;
-        box.score = 1.0f;
+        box.score = i < scores.size() ? scores[i] : 1.0f;
 
         if (opts.detectLandmarks) {
             std::scoped_lock lock(mutex);
-            if (shapePredictor) {
+            const dlib::rectangle faceRect = clampFaceRect(boxRect, originalSize);
+            if (shapePredictor && !faceRect.is_empty()) {
                 // 只在启用关键点检测时才运行 68/5 点模型，节约算力。
-                const dlib::full_object_detection shape = (*shapePredictor)(rgbWorking, rect);
-                box.landmarks = scaleLandmarksToOriginal(shape, scaleX, scaleY, originalSize);
+                // 关键点在原图上计算（回归树的开销与分辨率无关）：缩放后的关键点映射回原图会损失
+                // 精度，且与 extractFeature 的输入不一致，不能用于对齐
+                const dlib::full_object_detection shape = (*shapePredictor)(originalView, faceRect);
+                box.landmarks = toLandmarks(shape, originalSize);
+                // 与 extractFeature 对同一人脸框的计算完全相同，缓存后特征提取直接复用
+                context->shapes.emplace_back(boxRect, shape);
             }
         }
 
@@ -222,59 +303,290 @@ HRCode OpenCVDlibBackend::Impl::detect(const QImage& image,
     if (logger) {
         logger->info("Detect found {} faces (landmarks={})", outBoxes.size(), opts.detectLandmarks);
     }
+    outContext = std::move(context);
     return HRCode::Ok;
 }
 
+/**
+ * @brief 分块并行 + 全图低分辨率检测，结果以 NMS 合并。
+ *
+ * 分块在原分辨率上只检测不超过 kDetectTileOverlap 的人脸（限制金字塔层数），
+ * 更大的人脸在按 kHogWindowSize / kDetectTileOverlap 缩小后的全图上检测；
+ * 两部分的尺度范围互相衔接，重复结果由 NMS 去除。
+ */
+std::vector<dlib::rectangle> OpenCVDlibBackend::Impl::detectFaces(
+    const detail::RgbImageView& image, int maxFaceSize, int threads) {
+    const unsigned long maxLevels =
+        maxFaceSize > 0
+            ? detail::pyramidLevelsForMaxFace(maxFaceSize, kHogWindowSize, kHogLevelScale)
+            : kUnlimitedPyramidLevels;
+    const int overlap = maxFaceSize > 0 ? std::min(maxFaceSize, kDetectTileOverlap)
+                                        : kDetectTileOverlap;
+    const QVector<QRect> tiles =
+        threads > 1 ? detail::computeDetectionTiles(QSize(image.width(), image.height()),
+                                                    threads * 2,
+                                                    overlap)
+                    : QVector<QRect>{};
+
+    if (tiles.size() <= 1) {
+        if (maxLevels == kUnlimitedPyramidLevels) {
+            // dlib 检测器不是线程安全的，共享读取时需要加锁。
+            std::scoped_lock lock(mutex);
+            return detector(image.dlibView());
+        }
+        std::scoped_lock poolLock(detectPoolMutex);
+        return detectorsFor(maxLevels, 1).front()(image.dlibView());
+    }
+
+    struct Job {
+        QRect region;        ///< 分块区域；全图任务为空
+        double scale = 1.0;  ///< 全图任务的缩放比
+    };
+    QVector<Job> jobs;
+    jobs.reserve(tiles.size() + 1);
+    for (const QRect& tile : tiles) jobs.append(Job{tile, 1.0});
+    const bool needGlobalPass = maxFaceSize <= 0 || maxFaceSize > overlap;
+    if (needGlobalPass) jobs.append(Job{QRect(), static_cast<double>(kHogWindowSize) / overlap});
+
+    const unsigned long tileLevels = std::min(
+        maxLevels, detail::pyramidLevelsForMaxFace(overlap, kHogWindowSize, kHogLevelScale));
+    unsigned long globalLevels = kUnlimitedPyramidLevels;
+    if (needGlobalPass && maxFaceSize > 0) {
+        const int scaledMaxFace = static_cast<int>(std::ceil(maxFaceSize * jobs.back().scale));
+        globalLevels =
+            detail::pyramidLevelsForMaxFace(scaledMaxFace, kHogWindowSize, kHogLevelScale);
+    }
+
+    std::scoped_lock poolLock(detectPoolMutex);
+    if (!detectPool || detectPool->num_threads_in_pool() != static_cast<unsigned long>(threads)) {
+        detectPool = std::make_unique<dlib::thread_pool>(static_cast<unsigned long>(threads));
+    }
+    auto& tileDetectors = detectorsFor(tileLevels, threads);
+    auto* globalDetectors = needGlobalPass ? &detectorsFor(globalLevels, threads) : nullptr;
+
+    // 每个工作线程按步长领取任务并使用自己的检测器副本，结果写入各自的槽位
+    std::vector<QVector<detail::ScoredRect>> perWorker(static_cast<std::size_t>(threads));
+    dlib::parallel_for(
+        *detectPool,
+        0,
+        threads,
+        [&](long worker) {
+            auto& results = perWorker[static_cast<std::size_t>(worker)];
+            for (int j = static_cast<int>(worker); j < jobs.size(); j += threads) {
+                const Job& job = jobs[j];
+                std::vector<dlib::rect_detection> dets;
+                if (job.region.isNull()) {
+                    const cv::Size target(
+                        std::max(1, static_cast<int>(std::round(image.width() * job.scale))),
+                        std::max(1, static_cast<int>(std::round(image.height() * job.scale))));
+                    const detail::RgbImageView scaled = image.resized(target);
+                    (*globalDetectors)[static_cast<std::size_t>(worker)](scaled.dlibView(), dets);
+                    const double sx = static_cast<double>(target.width) / image.width();
+                    const double sy = static_cast<double>(target.height) / image.height();
+                    const auto unscale = [](long value, double scale) {
+                        return static_cast<int>(std::round(static_cast<double>(value) / scale));
+                    };
+                    for (const auto& det : dets) {
+                        const QRect rect(
+                            QPoint(unscale(det.rect.left(), sx), unscale(det.rect.top(), sy)),
+                            QPoint(unscale(det.rect.right(), sx), unscale(det.rect.bottom(), sy)));
+                        results.append(detail::ScoredRect{rect, det.detection_confidence});
+                    }
+                } else {
+                    const cv::Mat roi = image.mat()(cv::Rect(job.region.x(),
+                                                             job.region.y(),
+                                                             job.region.width(),
+                                                             job.region.height()));
+                    tileDetectors[static_cast<std::size_t>(worker)](
+                        dlib::cv_image<dlib::rgb_pixel>(roi), dets);
+                    for (const auto& det : dets) {
+                        results.append(detail::ScoredRect{
+                            toQRect(det.rect).translated(job.region.topLeft()),
+                            det.detection_confidence});
+                    }
+                }
+            }
+        },
+        1);
+
+    QVector<detail::ScoredRect> merged;
+    for (const auto& results : perWorker) merged += results;
+    const QVector<detail::ScoredRect> kept = detail::nonMaxSuppression(merged, 0.4);
+
+    std::vector<dlib::rectangle> faces;
+    faces.reserve(static_cast<std::size_t>(kept.size()));
+    const QRect bounds(0, 0, image.width(), image.height());
+    for (const auto& candidate : kept) {
+        faces.push_back(toDlibRect(candidate.rect.intersected(bounds)));
+    }
+    if (logger) {
+        logger->debug("Parallel detect: {} jobs on {} threads, {} raw boxes, {} after NMS",
+                      jobs.size(),
+                      threads,
+                      merged.size(),
+                      faces.size());
+    }
+    return faces;
+}
+
+std::vector<dlib::rectangle> OpenCVDlibBackend::Impl::detectFacesInRegions(
+    const detail::RgbImageView& image,
+    const QVector<QRect>& regions,
+    int maxFaceSize,
+    int threads) {
+    const QSize imageSize(image.width(), image.height());
+    // 外扩半个检测窗口，并保证区域至少容纳一个完整的 HOG 窗口及其位移
+    const QVector<QRect> prepared = detail::prepareDetectionRegions(
+        regions, imageSize, kHogWindowSize / 2, 2 * kHogWindowSize);
+    if (prepared.size() == 1 && prepared.front() == QRect(QPoint(0, 0), imageSize)) {
+        return detectFaces(image, maxFaceSize, threads);
+    }
+
+    QVector<detail::ScoredRect> candidates;
+    for (const QRect& region : prepared) {
+        const detail::RgbImageView crop = image.cropped(
+            cv::Rect(region.x(), region.y(), region.width(), region.height()));
+        if (crop.isNull()) continue;
+        for (const auto& rect : detectFaces(crop, maxFaceSize, threads)) {
+            candidates.append(detail::ScoredRect{toQRect(rect).translated(region.topLeft()), 1.0});
+        }
+    }
+    const QVector<detail::ScoredRect> kept = detail::nonMaxSuppression(candidates, 0.4);
+
+    std::vector<dlib::rectangle> faces;
+    faces.reserve(static_cast<std::size_t>(kept.size()));
+    for (const auto& candidate : kept) faces.push_back(toDlibRect(candidate.rect));
+    if (logger) {
+        logger->debug("ROI detect: {} regions requested, {} scanned, {} faces",
+                      regions.size(),
+                      prepared.size(),
+                      faces.size());
+    }
+    return faces;
+}
+
+/**
+ * @brief DNN 检测：有 ROI 时裁剪到外扩后的并集范围，只做一次推理。
+ *
+ * YuNet 的耗时取决于推理输入尺寸，多次小区域推理并不比一次并集推理便宜，
+ * 因此这里与 ONNX 后端一致，使用并集矩形而不是逐区域裁剪。
+ */
+QVector<detail::ScoredRect> OpenCVDlibBackend::Impl::detectFacesDnn(
+    detail::DnnFaceDetector& dnn,
+    const detail::RgbImageView& image,
+    const QVector<QRect>& regions,
+    float minScore) {
+    const QSize imageSize(image.width(), image.height());
+    QRect area(QPoint(0, 0), imageSize);
+    if (!regions.isEmpty()) {
+        QRect united;
+        for (const QRect& region : detail::prepareDetectionRegions(
+                 regions, imageSize, kHogWindowSize / 2, kHogWindowSize)) {
+            united = united.united(region);
+        }
+        if (!united.isEmpty()) area = united;
+    }
+
+    QVector<detail::ScoredRect> detections =
+        dnn.detect(image.mat()(cv::Rect(area.x(), area.y(), area.width(), area.height())),
+                   minScore);
+    for (auto& detection : detections) detection.rect.translate(area.topLeft());
+    if (logger) {
+        logger->debug("DNN detect: area={}x{}, input={}, {} faces",
+                      area.width(),
+                      area.height(),
+                      dnn.inputSize(),
+                      detections.size());
+    }
+    return detections;
+}
+
+std::vector<dlib::frontal_face_detector>& OpenCVDlibBackend::Impl::detectorsFor(
+    unsigned long maxLevels, int count) {
+    auto& pool = detectorPools[maxLevels];
+    if (pool.empty()) {
+        std::scoped_lock lock(mutex);
+        pool.push_back(withMaxPyramidLevels(detector, maxLevels));
+    }
+    while (static_cast<int>(pool.size()) < count) pool.push_back(pool.front());
+    return pool;
+}
+
+int OpenCVDlibBackend::Impl::resolveDetectThreads(int requested) const {
+    int threads = requested > 0 ? requested : detectThreads;
+    if (threads <= 0) threads = static_cast<int>(std::thread::hardware_concurrency());
+    return std::clamp(threads, 1, 64);
+}
+
 /**
  * @brief 将特定人脸区域裁剪成标准尺寸并送入 dlib 网络提取得分。
  */
 HRCode OpenCVDlibBackend::Impl::extractFeature(const QImage& image,
                                                const FaceBox& box,
                                                FaceFeature& outFeature) {
+    return extractFeatureWithContext(nullptr, image, box, outFeature);
+}
+
+/**
+ * @brief 提取特征；上下文有效时复用其 RGB 视图与检测阶段缓存的关键点。
+ */
+HRCode OpenCVDlibBackend::Impl::extractFeatureWithContext(const FrameContextPtr& frameContext,
+                                                          const QImage& image,
+                                                          const FaceBox& box,
+                                                          FaceFeature& outFeature) {
     if (logger) {
-        logger->debug("Extract feature request: image={}x{}, box=({}, {}, {}, {})",
+        logger->debug("Extract feature request: image={}x{}, box=({}, {}, {}, {}), context={}",
                       image.width(),
                       image.height(),
                       box.rect.left(),
                       box.rect.top(),
                       box.rect.width(),
-                      box.rect.height());
+                      box.rect.height(),
+                      frameContext != nullptr);
     }
     if (image.isNull()) {
         if (logger) { logger->warn("ExtractFeature aborted: image is null"); }
         return HRCode::InvalidImage;
     }
 
-    cv::Mat originalBgr = qImageToBgrMat(image);
-    if (originalBgr.empty()) {
-        if (logger) { logger->warn("ExtractFeature aborted: BGR conversion failed"); }
-        return HRCode::InvalidImage;
+    // 只接受本后端创建且与当前图像对应的上下文，否则退回完整预处理
+    auto context = std::dynamic_pointer_cast<detail::DlibFrameContext>(frameContext);
+    if (context && (context->sourceCacheKey() != image.cacheKey() ||
+                    context->sourceSize() != image.size() || context->original.isNull())) {
+        if (logger) { logger->debug("ExtractFeature: frame context does not match image"); }
+        context.reset();
     }
 
-    dlib::matrix<dlib::rgb_pixel> img = matToDlibRgb(originalBgr);
+    detail::RgbImageView converted;
+    if (!context) {
+        converted = detail::RgbImageView::fromQImage(image);
+        if (converted.isNull()) {
+            if (logger) { logger->warn("ExtractFeature aborted: RGB conversion failed"); }
+            return HRCode::InvalidImage;
+        }
+    }
+    const auto img = context ? context->original.dlibView() : converted.dlibView();
 
-    const int left = std::clamp(box.rect.left(), 0, image.width() - 1);
-    const int top = std::clamp(box.rect.top(), 0, image.height() - 1);
-    const int right = std::clamp(box.rect.right(), 0, image.width() - 1);
-    const int bottom = std::clamp(box.rect.bottom(), 0, image.height() - 1);
-    if (left >= right || top >= bottom) {
+    const dlib::rectangle rect = clampFaceRect(box.rect, image.size());
+    if (rect.is_empty()) {
         if (logger) { logger->warn("ExtractFeature aborted: invalid ROI bounds"); }
         return HRCode::ExtractFeatureFailed;
     }
 
-    const dlib::rectangle rect(left, top, right, bottom);
-
+    ensureModelsLoaded(true);
     std::scoped_lock lock(mutex);
     if (!shapePredictor || !recognitionNet) {
         if (logger) { logger->error("ExtractFeature aborted: model not loaded"); }
         return HRCode::ExtractFeatureFailed;
     }
 
-    // 先使用关键点对齐，确保输入到 CNN 的人脸姿态统一。
-    const dlib::full_object_detection shape = (*shapePredictor)(img, rect);
+    // 先使用关键点对齐，确保输入到 CNN 的人脸姿态统一；检测阶段已算过的关键点直接复用。
+    const dlib::full_object_detection* cached = context ? context->shapeFor(box.rect) : nullptr;
+    const dlib::full_object_detection shape = cached ? *cached : (*shapePredictor)(img, rect);
 
     dlib::matrix<dlib::rgb_pixel> faceChip;
-    extract_image_chip(img, get_face_chip_details(shape, 150, 0.25), faceChip);
+    extract_image_chip(
+        img, get_face_chip_details(shape, kFaceChipSize, kFaceChipPadding), faceChip);
 
     // dlib ResNet 输出 128 维特征向量，后续用于距离计算。
     const dlib::matrix<float, 0, 1> descriptor = (*recognitionNet)(faceChip);
@@ -323,14 +635,37 @@ HRCode OpenCVDlibBackend::Impl::findNearest(const FaceFeature& feature,
     auto bestDistance = std::numeric_limits<float>::max();
     const PersonInfo* bestPerson = nullptr;
 
-    for (auto it = persons.cbegin(); it != persons.cend(); ++it) {
-        if (!it.value().canonicalFeature.has_value()) continue;
-        // 对每一条人员都计算距离，特点是实现简单，后续可替换为向量索引以提升性能。
-        auto dist = computeDistance(feature, it.value().canonicalFeature.value());
-        if (!dist.has_value()) continue;
-        if (dist.value() < bestDistance) {
-            bestDistance = dist.value();
-            bestPerson = &it.value();
+    rebuildGalleryIfNeeded();
+    if (gallery) {
+        // 量化库粗排出 topK 候选，再用 float 特征精确重排，结果与全量 float 扫描一致，
+        // 除非真实最近邻落在 topK 之外。float 特征来自重排缓存或人员表，读不到时用近似距离
+        const auto candidates = gallery->dimension() == feature.values.size()
+                                    ? gallery->search(feature, rerankTopK)
+                                    : QVector<detail::QuantizedGallery::Candidate>();
+        const QHash<QString, FaceFeature> floats = rerankFeaturesFor(candidates);
+        for (const auto& candidate : candidates) {
+            auto it = persons.constFind(candidate.personId);
+            if (it == persons.cend()) continue;
+            const auto stored = floats.constFind(candidate.personId);
+            const std::optional<float> dist = stored != floats.cend()
+                                                  ? computeDistance(feature, stored.value())
+                                                  : std::optional<float>(candidate.approxDistance);
+            if (!dist.has_value()) continue;
+            if (dist.value() < bestDistance) {
+                bestDistance = dist.value();
+                bestPerson = &it.value();
+            }
+        }
+    } else {
+        for (auto it = persons.cbegin(); it != persons.cend(); ++it) {
+            if (!it.value().canonicalFeature.has_value()) continue;
+            // 对每一条人员都计算距离，特点是实现简单；大规模人员库可启用量化编码加速。
+            auto dist = computeDistance(feature, it.value().canonicalFeature.value());
+            if (!dist.has_value()) continue;
+            if (dist.value() < bestDistance) {
+                bestDistance = dist.value();
+                bestPerson = &it.value();
+            }
         }
     }
 
@@ -365,6 +700,97 @@ HRCode OpenCVDlibBackend::Impl::findNearest(const FaceFeature& feature,
     return HRCode::Ok;
 }
 
+/**
+ * @brief 按当前编码重建量化人员库，调用方需持有 mutex。
+ *
+ * 量化模式下量化行是唯一常驻的特征副本：重建后释放 persons 中的 float 特征。
+ * float 特征已释放时（再次切换编码或切回 Float32）从人员表重新读取；读取失败则保留现状，
+ * 下一次检索时重试。
+ */
+void OpenCVDlibBackend::Impl::rebuildGalleryIfNeeded() {
+    const bool quantized = galleryEncoding != FeatureEncoding::Float32;
+    if (quantized && gallery && gallery->encoding() == galleryEncoding && !galleryDirty) return;
+    if (!quantized && featuresResident) {
+        gallery.reset();
+        rerankFeatures.clear();
+        return;
+    }
+
+    QHash<QString, FaceFeature> stored;
+    if (!featuresResident) {
+        auto fetched = fetchFeaturesFromStorage({});
+        if (!fetched.has_value()) {
+            if (logger) { logger->warn("Gallery rebuild postponed: cannot read features"); }
+            return;
+        }
+        stored = std::move(*fetched);
+    }
+
+    if (!quantized) {
+        for (auto it = persons.begin(); it != persons.end(); ++it) {
+            const auto feature = stored.constFind(it.key());
+            it.value().canonicalFeature = feature != stored.cend()
+                                              ? std::optional<FaceFeature>(feature.value())
+                                              : std::nullopt;
+        }
+        featuresResident = true;
+        gallery.reset();
+        rerankFeatures.clear();
+        if (logger) { logger->info("Float features reloaded for {} persons", persons.size()); }
+        return;
+    }
+
+    gallery = std::make_unique<detail::QuantizedGallery>(galleryEncoding);
+    gallery->reserve(static_cast<int>(persons.size()));
+    int skipped = 0;
+    for (auto it = persons.begin(); it != persons.end(); ++it) {
+        std::optional<FaceFeature> feature = std::move(it.value().canonicalFeature);
+        it.value().canonicalFeature.reset();
+        if (!featuresResident) {
+            const auto found = stored.constFind(it.key());
+            if (found != stored.cend()) feature = found.value();
+        }
+        if (!feature.has_value()) continue;
+        // 维度与首行不一致的特征（例如旧模型遗留）不进入量化库
+        if (!gallery->upsert(it.key(), feature.value())) ++skipped;
+    }
+    featuresResident = false;
+    rerankFeatures.clear();
+    galleryDirty = false;
+    if (logger) {
+        logger->info("Quantized gallery rebuilt: encoding={} rows={} skipped={} bytes={}",
+                     featureEncodingName(galleryEncoding).toStdString(),
+                     gallery->size(),
+                     skipped,
+                     gallery->memoryBytes());
+    }
+}
+
+/**
+ * @brief 按候选取得重排用的 float 特征，缺失部分合并成一次人员表查询，调用方需持有 mutex。
+ */
+QHash<QString, FaceFeature> OpenCVDlibBackend::Impl::rerankFeaturesFor(
+    const QVector<detail::QuantizedGallery::Candidate>& candidates) {
+    QHash<QString, FaceFeature> out;
+    QStringList missing;
+    for (const auto& candidate : candidates) {
+        if (const FaceFeature* cached = rerankFeatures.object(candidate.personId)) {
+            out.insert(candidate.personId, *cached);
+        } else {
+            missing.append(candidate.personId);
+        }
+    }
+    if (missing.isEmpty()) return out;
+
+    const auto stored = fetchFeaturesFromStorage(missing);
+    if (!stored.has_value()) return out;
+    for (auto it = stored->cbegin(); it != stored->cend(); ++it) {
+        out.insert(it.key(), it.value());
+        rerankFeatures.insert(it.key(), new FaceFeature(it.value()));
+    }
+    return out;
+}
+
 /**
  * @brief 将内部特征向量转为 dlib 矩阵后计算欧氏距离。
  */
@@ -0,0 +1,123 @@
+﻿#include "internal/dnn_detector.h"
+
+#if defined(HAS_OPENCV) && defined(HAS_DLIB)
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <opencv2/imgproc.hpp>
+
+#if __has_include(<opencv2/objdetect/face.hpp>)
+#include <opencv2/dnn.hpp>
+#include <opencv2/objdetect/face.hpp>
+#define HR_HAS_FACE_DETECTOR_YN 1
+#endif
+
+namespace HumanRecognition::detail {
+
+namespace {
+/// YuNet 内部 NMS 阈值与候选数上限（与 OpenCV 示例一致）
+constexpr float kYuNetNmsThreshold = 0.3f;
+constexpr int kYuNetTopK = 5000;
+}  // namespace
+
+struct DnnFaceDetector::Model {
+#ifdef HR_HAS_FACE_DETECTOR_YN
+    cv::Ptr<cv::FaceDetectorYN> detector;
+    cv::Size configuredSize;  ///< 最近一次 setInputSize 的尺寸，相同时跳过重新分配
+#endif
+};
+
+DnnFaceDetector::~DnnFaceDetector() = default;
+
+std::unique_ptr<DnnFaceDetector> DnnFaceDetector::create(const QString& modelPath,
+                                                         int inputSize,
+                                                         QString* error) {
+#ifdef HR_HAS_FACE_DETECTOR_YN
+    try {
+        std::unique_ptr<DnnFaceDetector> out(new DnnFaceDetector());
+        out->m_model = std::make_unique<Model>();
+        out->m_model->detector = cv::FaceDetectorYN::create(modelPath.toStdString(),
+                                                            std::string(),
+                                                            cv::Size(inputSize, inputSize),
+                                                            0.5f,
+                                                            kYuNetNmsThreshold,
+                                                            kYuNetTopK,
+                                                            cv::dnn::DNN_BACKEND_OPENCV,
+                                                            cv::dnn::DNN_TARGET_CPU);
+        if (out->m_model->detector.empty()) {
+            if (error) *error = QStringLiteral("FaceDetectorYN::create returned null");
+            return {};
+        }
+        out->m_modelPath = modelPath;
+        out->m_inputSize = inputSize;
+        return out;
+    } catch (const cv::Exception& ex) {
+        if (error) *error = QString::fromStdString(ex.what());
+        return {};
+    }
+#else
+    Q_UNUSED(modelPath);
+    Q_UNUSED(inputSize);
+    if (error) *error = QStringLiteral("OpenCV was built without objdetect/dnn FaceDetectorYN");
+    return {};
+#endif
+}
+
+QVector<ScoredRect> DnnFaceDetector::detect(const cv::Mat& rgb, float scoreThreshold) {
+    QVector<ScoredRect> out;
+#ifdef HR_HAS_FACE_DETECTOR_YN
+    if (rgb.empty()) return out;
+
+    // 长边缩放到 inputSize（小图不放大），YuNet 以 BGR 为输入
+    const double scale =
+        std::min(1.0, static_cast<double>(m_inputSize) / std::max(rgb.cols, rgb.rows));
+    const cv::Size target(std::max(1, static_cast<int>(std::lround(rgb.cols * scale))),
+                          std::max(1, static_cast<int>(std::lround(rgb.rows * scale))));
+    cv::Mat bgr;
+    if (target == rgb.size()) {
+        cv::cvtColor(rgb, bgr, cv::COLOR_RGB2BGR);
+    } else {
+        cv::Mat resized;
+        cv::resize(rgb, resized, target, 0, 0, cv::INTER_AREA);
+        cv::cvtColor(resized, bgr, cv::COLOR_RGB2BGR);
+    }
+
+    cv::Mat faces;
+    {
+        std::scoped_lock lock(m_mutex);
+        if (m_model->configuredSize != target) {
+            m_model->detector->setInputSize(target);
+            m_model->configuredSize = target;
+        }
+        m_model->detector->setScoreThreshold(scoreThreshold);
+        m_model->detector->detect(bgr, faces);
+    }
+
+    // 每行：x, y, w, h, 5 个关键点 (x, y)，score
+    out.reserve(faces.rows);
+    for (int i = 0; i < faces.rows; ++i) {
+        const float* row = faces.ptr<float>(i);
+        const QRect rect(static_cast<int>(std::lround(row[0] / scale)),
+                         static_cast<int>(std::lround(row[1] / scale)),
+                         static_cast<int>(std::lround(row[2] / scale)),
+                         static_cast<int>(std::lround(row[3] / scale)));
+        out.append(ScoredRect{rect.intersected(QRect(0, 0, rgb.cols, rgb.rows)), row[14]});
+    }
+#else
+    Q_UNUSED(rgb);
+    Q_UNUSED(scoreThreshold);
+#endif
+    return out;
+}
+
+bool applyOpenCvThreadsOnce(int threads) {
+    static std::atomic<bool> applied{false};
+    if (threads <= 0 || applied.exchange(true)) return false;
+    cv::setNumThreads(threads);
+    return true;
+}
+
+}  // namespace HumanRecognition::detail
+
+#endif  // defined(HAS_OPENCV) && defined(HAS_DLIB)
@@ -0,0 +1,102 @@
+﻿#include "internal/image_view.h"
+
+#if defined(HAS_OPENCV) && defined(HAS_DLIB)
+
+#include <QtEndian>
+#include <opencv2/imgproc.hpp>
+
+namespace HumanRecognition::detail {
+
+namespace {
+
+/**
+ * @brief 用 QImage 的像素构造不拥有内存的 cv::Mat 头。
+ */
+cv::Mat wrapBits(const QImage& image, int type) {
+    return cv::Mat(image.height(),
+                   image.width(),
+                   type,
+                   const_cast<uchar*>(image.constBits()),
+                   static_cast<size_t>(image.bytesPerLine()));
+}
+
+/**
+ * @brief 返回将该格式转换为 RGB 的 cvtColor 代码；无直接对应时返回 -1。
+ */
+int cvtCodeToRgb(QImage::Format format) {
+    switch (format) {
+        case QImage::Format_RGB32:
+        case QImage::Format_ARGB32:
+            // 0xAARRGGBB 按 32 位整数存储，小端机器上的字节序为 B,G,R,A
+            return Q_BYTE_ORDER == Q_LITTLE_ENDIAN ? cv::COLOR_BGRA2RGB : -1;
+        case QImage::Format_RGBX8888:
+        case QImage::Format_RGBA8888:
+            return cv::COLOR_RGBA2RGB;
+        case QImage::Format_BGR888:
+            return cv::COLOR_BGR2RGB;
+        case QImage::Format_Grayscale8:
+            return cv::COLOR_GRAY2RGB;
+        default:
+            return -1;
+    }
+}
+
+int cvTypeFor(QImage::Format format) {
+    switch (format) {
+        case QImage::Format_BGR888:
+            return CV_8UC3;
+        case QImage::Format_Grayscale8:
+            return CV_8UC1;
+        default:
+            return CV_8UC4;
+    }
+}
+
+}  // namespace
+
+RgbImageView RgbImageView::fromQImage(const QImage& image) {
+    RgbImageView view;
+    if (image.isNull()) return view;
+
+    if (image.format() == QImage::Format_RGB888) {
+        // 隐式共享：复制 QImage 只增加引用计数，像素保持原地
+        view.m_image = image;
+        view.m_mat = wrapBits(view.m_image, CV_8UC3);
+        view.m_zeroCopy = true;
+        return view;
+    }
+
+    const int code = cvtCodeToRgb(image.format());
+    if (code >= 0) {
+        cv::cvtColor(wrapBits(image, cvTypeFor(image.format())), view.m_mat, code);
+        return view;
+    }
+
+    // 预乘 alpha、调色板等少见格式交给 Qt 处理，仍然只有一次拷贝
+    view.m_image = image.convertToFormat(QImage::Format_RGB888);
+    if (view.m_image.isNull()) return view;
+    view.m_mat = wrapBits(view.m_image, CV_8UC3);
+    return view;
+}
+
+RgbImageView RgbImageView::resized(const cv::Size& target) const {
+    RgbImageView out;
+    if (isNull() || target.width <= 0 || target.height <= 0) return out;
+    cv::resize(m_mat, out.m_mat, target, 0, 0, cv::INTER_LINEAR);
+    return out;
+}
+
+RgbImageView RgbImageView::cropped(const cv::Rect& region) const {
+    RgbImageView out;
+    const cv::Rect bounded = region & cv::Rect(0, 0, width(), height());
+    if (isNull() || bounded.empty()) return out;
+    // ROI 矩阵头与 m_mat 共享引用计数；同时保留 m_image 以维持零拷贝路径下的缓冲
+    out.m_image = m_image;
+    out.m_mat = m_mat(bounded);
+    out.m_zeroCopy = m_zeroCopy;
+    return out;
+}
+
+}  // namespace HumanRecognition::detail
+
+#endif  // defined(HAS_OPENCV) && defined(HAS_DLIB)
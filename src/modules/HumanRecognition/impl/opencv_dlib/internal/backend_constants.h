@@ -5,5 +5,37 @@ namespace HumanRecognition::opencv_dlib {
 inline constexpr auto kBackendName = "opencv_dlib";
 inline constexpr auto kDefaultPersonsTable = "hr_persons";
 inline constexpr double kDefaultMatchThreshold = 0.6;
+/// 量化粗排后使用 float 特征重排的候选数量
+inline constexpr int kDefaultRerankTopK = 8;
+/// 量化模式下常驻内存的 float 重排特征上限（最近参与重排的人员），其余按需从人员表读取
+inline constexpr int kDefaultRerankCacheSize = 1024;
+/// 并行检测线程数默认值；1 表示单线程整图检测（不分块），0 表示使用硬件并发数
+inline constexpr int kDefaultDetectThreads = 1;
+/// dlib 正面人脸 HOG 检测窗口边长（像素），即金字塔第 0 层可检测的人脸尺寸
+inline constexpr int kHogWindowSize = 80;
+/// dlib pyramid_down<6> 相邻层的缩放比
+inline constexpr double kHogLevelScale = 5.0 / 6.0;
+/// 分块检测的重叠宽度；不超过该尺寸的人脸由分块负责，更大的人脸由缩小后的全图检测负责
+inline constexpr int kDetectTileOverlap = 2 * kHogWindowSize;
+/// dlib scan_fhog_pyramid 的默认最大层数（等价于不限制）
+inline constexpr unsigned long kUnlimitedPyramidLevels = 1000;
+/// 默认检测器：hog（dlib 正面人脸 HOG）或 dnn（OpenCV YuNet）
+inline constexpr auto kDefaultDetectorKind = "hog";
+/// DNN 检测器的推理输入边长（长边缩放到该尺寸，不放大）
+inline constexpr int kDefaultDnnInputSize = 320;
+/// OpenCV 线程数（进程级，只在首次初始化时应用一次）；0 表示保持 OpenCV 默认设置
+inline constexpr int kDefaultDnnThreads = 0;
+/// 模型加载方式：lazy（首次使用时加载）、prefetch（后台预取）、eager（loadModel 内同步加载）
+inline constexpr auto kDefaultModelLoading = "prefetch";
+/// 模型缓存中的类型标签
+inline constexpr auto kShapePredictorKind = "dlib.shape_predictor";
+inline constexpr auto kFaceNetKind = "dlib.face_net";
+/// 特征版本标签（dlib ResNet 128 维）
+inline constexpr auto kFeatureVersion = "dlib_resnet_128";
+/// 送入特征网络的对齐人脸边长与外扩比例
+inline constexpr unsigned long kFaceChipSize = 150;
+inline constexpr double kFaceChipPadding = 0.25;
+/// 批量入库时每个线程一次前向计算的人脸数默认值
+inline constexpr int kDefaultEnrollBatchSize = 16;
 
 }  // namespace HumanRecognition::opencv_dlib
@@ -17,18 +17,31 @@ class FaceNet;
 #endif
 
 #include <dlib/image_processing/frontal_face_detector.h>
+#include <dlib/image_processing/full_object_detection.h>
+#include <dlib/threads.h>
 
+#include <QCache>
 #include <QFileInfo>
 #include <QHash>
 #include <QImage>
 #include <QJsonObject>
 #include <QString>
+#include <QStringList>
 #include <QVector>
+#include <cstdint>
+#include <functional>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <optional>
+#include <utility>
+#include <vector>
 
+#include "../../../internal/model_cache.h"
+#include "../../../internal/quantized_gallery.h"
 #include "backend_network.h"
+#include "dnn_detector.h"
+#include "image_view.h"
 
 namespace spdlog {
 class logger;
@@ -38,12 +51,63 @@ namespace dlib {
 class shape_predictor;
 }  // namespace dlib
 
+namespace config {
+class ConfigSnapshot;
+}  // namespace config
+
 namespace HumanRecognition {
 
 namespace test {
 class ImplAccessor;
 }  // namespace test
 
+namespace detail {
+
+/**
+ * @brief 检测阶段使用的检测器类型。
+ */
+enum class DetectorKind {
+    Hog,  ///< dlib 正面人脸 HOG 检测器（默认，无需额外模型）
+    Dnn,  ///< OpenCV DNN（YuNet）检测器，需要 face_detection_yunet*.onnx
+};
+
+/**
+ * @brief 模型加载方式。
+ */
+enum class ModelLoading {
+    Lazy,      ///< loadModel 只解析文件，首次使用时在调用线程上反序列化
+    Prefetch,  ///< loadModel 立即在后台反序列化，首次使用时等待其完成
+    Eager,     ///< loadModel 内同步反序列化，失败时直接返回 ModelLoadFailed
+};
+
+/**
+ * @brief dlib 后端的帧上下文：原图 RGB 视图、检测用的工作图像以及检测阶段得到的关键点。
+ *
+ * 关键点在原图上按检测输出的人脸框计算（即使检测在缩放后的工作图像上进行），以该框为键保存，
+ * 特征提取时按框查找复用。
+ */
+class DlibFrameContext final : public FrameContext {
+   public:
+    DlibFrameContext(const QImage& source, RgbImageView rgb)
+        : FrameContext(source.cacheKey(), source.size()), original(std::move(rgb)) {}
+
+    /**
+     * @brief 查找检测阶段为该人脸框计算的关键点；未缓存时返回 nullptr。
+     */
+    const dlib::full_object_detection* shapeFor(const QRect& rect) const {
+        for (const auto& [boxRect, shape] : shapes) {
+            if (boxRect == rect) return &shape;
+        }
+        return nullptr;
+    }
+
+    RgbImageView original;  ///< 原图 RGB 视图（RGB888 输入时与 QImage 共享像素）
+    RgbImageView working;   ///< 检测使用的图像（按 DetectOptions::resizeTo 缩放）
+    std::vector<std::pair<QRect, dlib::full_object_detection>> shapes;  ///< 原图上计算的关键点
+};
+
+}  // namespace detail
+
 /**
  * @brief OpenCVDlibBackend 的真正实现体，封装具体算法、数据库交互与日志逻辑。
  *
@@ -86,11 +150,25 @@ class OpenCVDlibBackend::Impl {
      * @brief 执行人脸检测。
      */
     HRCode detect(const QImage& image, const DetectOptions& opts, QVector<FaceBox>& outBoxes);
+    /**
+     * @brief 执行人脸检测并输出可复用的帧上下文。
+     */
+    HRCode detectWithContext(const QImage& image,
+                             const DetectOptions& opts,
+                             QVector<FaceBox>& outBoxes,
+                             FrameContextPtr& outContext);
 
     /**
      * @brief 提取单个人脸的特征。
      */
     HRCode extractFeature(const QImage& image, const FaceBox& box, FaceFeature& outFeature);
+    /**
+     * @brief 借助帧上下文提取特征，跳过图像转换与重复的关键点预测。
+     */
+    HRCode extractFeatureWithContext(const FrameContextPtr& frameContext,
+                                     const QImage& image,
+                                     const FaceBox& box,
+                                     FaceFeature& outFeature);
 
     /**
      * @brief 计算两个特征的距离。
@@ -105,6 +183,10 @@ class OpenCVDlibBackend::Impl {
      * @brief 将新人员写入数据库与缓存。
      */
     HRCode registerPerson(const PersonInfo& person);
+    /**
+     * @brief 在同一事务中批量写入人员，成功后逐条增量更新缓存。
+     */
+    HRCode registerPersons(const QVector<PersonInfo>& batch, bool replaceExisting);
     /**
      * @brief 从数据库与缓存移除人员。
      */
@@ -122,6 +204,15 @@ class OpenCVDlibBackend::Impl {
      * @brief 训练接口（预留）。
      */
     HRCode train(const QString& datasetPath);
+    /**
+     * @brief 从 <根目录>/<person_id>/<图片> 数据集并行解码、检测并批量提取特征，按人员平均后一次性入库。
+     */
+    HRCode enrollDataset(const QString& datasetPath, const EnrollOptions& opts);
+    /**
+     * @brief 设置识别结果变化通知，配置热更新修改阈值、重排数量或检索编码后在锁外调用。
+     */
+    void setResultsChangedCallback(std::function<void()> callback);
+
     /**
      * @brief 返回后端名称。
      */
@@ -137,12 +228,62 @@ class OpenCVDlibBackend::Impl {
         QString recognition;
         /// 旧版 JSON 人员数据库
         QString personDatabase;
+        /// OpenCV YuNet 人脸检测模型（可选，仅 DNN 检测器需要）
+        QString dnnDetector;
     };
 
     /**
      * @brief 根据输入路径推断需要的模型文件。
      */
     ModelFiles resolveModelFiles(const QFileInfo& info) const;
+    /**
+     * @brief 确保模型已从缓存取得（必要时等待后台加载或在当前线程加载），不持有 mutex 时调用。
+     *
+     * @param needRecognitionNet 为 false 时只需要关键点模型（检测阶段）
+     * @return 所需模型可用时返回 true
+     */
+    bool ensureModelsLoaded(bool needRecognitionNet);
+    /**
+     * @brief 在工作图像上运行 HOG 检测；threads > 1 且图像足够大时按重叠分块并行检测，
+     *        并在缩小后的全图上检测大脸，最终以 NMS 合并。返回工作图像坐标系下的矩形。
+     *
+     * @param maxFaceSize 工作图像坐标下的最大人脸尺寸，>0 时据此限制金字塔层数
+     */
+    std::vector<dlib::rectangle> detectFaces(const detail::RgbImageView& image,
+                                             int maxFaceSize,
+                                             int threads);
+    /**
+     * @brief 仅在给定区域（工作图像坐标）内检测：区域外扩并合并后逐个裁剪调用 detectFaces，
+     *        结果平移回工作图像坐标并以 NMS 去重；区域覆盖大部分画面时退回整图检测。
+     */
+    std::vector<dlib::rectangle> detectFacesInRegions(const detail::RgbImageView& image,
+                                                      const QVector<QRect>& regions,
+                                                      int maxFaceSize,
+                                                      int threads);
+    /**
+     * @brief 使用 DNN 检测器在工作图像上检测，regions 非空时只在其外扩后的并集范围内推理。
+     *        返回工作图像坐标系下的矩形与置信度。
+     */
+    QVector<detail::ScoredRect> detectFacesDnn(detail::DnnFaceDetector& dnn,
+                                               const detail::RgbImageView& image,
+                                               const QVector<QRect>& regions,
+                                               float minScore);
+    /**
+     * @brief 按当前配置加载（或重新加载）DNN 检测器；检测器类型为 hog 时释放已有实例。
+     *
+     * @param modelPath 模型路径；为空时使用配置 HumanRecognition/DnnDetectorModel
+     * @return 检测器类型为 dnn 但模型不可用时返回 false（检测阶段退回 HOG）
+     */
+    bool reloadDnnDetector(const QString& modelPath);
+    /**
+     * @brief 返回指定金字塔层数的检测器副本（至少 count 个），调用方需持有 detectPoolMutex。
+     */
+    std::vector<dlib::frontal_face_detector>& detectorsFor(unsigned long maxLevels, int count);
+    /**
+     * @brief 解析本次检测使用的线程数（DetectOptions 优先，其次为配置，0 为硬件并发数）。
+     */
+    int resolveDetectThreads(int requested) const;
+
     /**
      * @brief 计算两个特征的欧氏距离。
      */
@@ -152,6 +293,10 @@ class OpenCVDlibBackend::Impl {
      * @brief 重新读取配置中心的参数。
      */
     void refreshConfiguration();
+    /**
+     * @brief 配置热更新回调：阈值、重排数量与检索编码立即生效，其余参数在下次初始化时生效。
+     */
+    void applyConfigChange(const config::ConfigSnapshot& snapshot, const QStringList& keys);
     /**
      * @brief 确保数据库连接和必要表结构可用。
      */
@@ -164,6 +309,24 @@ class OpenCVDlibBackend::Impl {
      * @brief 将任意字符串净化为合法的表名。
      */
     QString sanitizeTableName(const QString& requested) const;
+    /**
+     * @brief 按当前编码重建量化人员库（编码变化或缓存整体重载后执行），调用方需持有 mutex。
+     *
+     * 量化模式下只有量化行常驻，persons 中的 float 特征在重建时释放；float 特征不在内存时
+     * （包括切回 Float32）从人员表重新读取。
+     */
+    void rebuildGalleryIfNeeded();
+    /**
+     * @brief 取得粗排候选的 float 特征：先查有界的重排缓存，缺失的一次性从人员表读取。
+     *        读取失败的候选不在结果中，调用方需持有 mutex。
+     */
+    QHash<QString, FaceFeature> rerankFeaturesFor(
+        const QVector<detail::QuantizedGallery::Candidate>& candidates);
+    /**
+     * @brief 返回对外暴露的人员信息：量化模式下附上反量化的特征（version 带编码后缀），
+     *        调用方需持有 mutex。
+     */
+    PersonInfo publicPersonLocked(const PersonInfo& person) const;
 
     /**
      * @brief 将元数据 JSON 序列化为字符串。
@@ -192,8 +355,27 @@ class OpenCVDlibBackend::Impl {
     bool deletePersonFromDatabase(const QString& personId);
     /**
      * @brief 从数据库拉取全部人员缓存。
+     *
+     * @param loadedRows 非空时输出读取到的完整记录（含 float 特征，不受量化模式影响）
+     */
+    HRCode loadPersonsFromStorage(QVector<PersonInfo>* loadedRows = nullptr);
+    /**
+     * @brief 从人员表读取 float 特征；ids 为空时读取全部。数据库不可用或查询失败时返回空，
+     *        不会重新初始化存储，可在持有 mutex 时调用。
+     */
+    std::optional<QHash<QString, FaceFeature>> fetchFeaturesFromStorage(const QStringList& ids);
+    /**
+     * @brief 从数据库读取单个人员记录，不存在或读取失败时返回空。
+     */
+    std::optional<PersonInfo> fetchPersonFromStorage(const QString& personId);
+    /**
+     * @brief 将单条人员写入缓存并同步量化人员库，调用方需持有 mutex。
+     */
+    void applyPersonUpsert(const PersonInfo& person);
+    /**
+     * @brief 从缓存与量化人员库移除单条人员，调用方需持有 mutex。
      */
-    HRCode loadPersonsFromStorage();
+    void applyPersonRemoval(const QString& personId);
     /**
      * @brief 从 JSON 文件导入旧版人员库。
      */
@@ -204,9 +386,18 @@ class OpenCVDlibBackend::Impl {
     HRCode savePersonDatabase(const QString& jsonPath);
 
     dlib::frontal_face_detector detector;
-    std::unique_ptr<dlib::shape_predictor> shapePredictor;
+    /// 关键点模型，与其他后端实例共享（只读，来自 ModelCache）
+    std::shared_ptr<const dlib::shape_predictor> shapePredictor;
+    /// 本实例私有的特征网络副本：dlib 前向计算会写入各层输出，不能跨实例共享
     std::unique_ptr<HumanRecognition::detail::FaceNet> recognitionNet;
+    /// 模型加载方式（配置 HumanRecognition/ModelLoading）
+    detail::ModelLoading modelLoading = detail::ModelLoading::Prefetch;
+    /// loadModel 登记的缓存句柄，首次使用时取出；modelGeneration 用于丢弃过期的加载结果
+    detail::ModelCache::Handle pendingPredictor;
+    detail::ModelCache::Handle pendingNet;
+    std::uint64_t modelGeneration = 0;
     mutable std::mutex mutex;
+    /// 人员缓存；量化模式下不含 float 特征（featuresResident 为 false），特征由 gallery 保存
     QHash<QString, PersonInfo> persons;
     QString modelDirectory;
     std::shared_ptr<spdlog::logger> logger;
@@ -214,6 +405,37 @@ class OpenCVDlibBackend::Impl {
     double matchThreshold;
     bool autoCreatePersonsTable = true;
     bool storageReady = false;
+    /// 人员库检索编码；Float32 时直接线性扫描 persons
+    FeatureEncoding galleryEncoding = FeatureEncoding::Float32;
+    /// 量化粗排后参与 float 重排的候选数量
+    int rerankTopK;
+    /// HumanRecognition/* 配置变化的订阅标识，0 表示尚未订阅
+    quint64 configSubscription = 0;
+    /// 识别结果相关参数热更新后的通知（门面用于使结果缓存失效）
+    std::function<void()> resultsChanged;
+    /// 量化人员库；单条增删直接同步，整体重载或编码变化时标记为脏并在下一次检索前重建
+    std::unique_ptr<detail::QuantizedGallery> gallery;
+    bool galleryDirty = true;
+    /// persons 是否保存 float 特征；量化库建成后释放，切回 Float32 时从人员表重新读取
+    bool featuresResident = true;
+    /// 量化模式下参与重排的 float 特征（LRU，容量 kDefaultRerankCacheSize 条）
+    QCache<QString, FaceFeature> rerankFeatures{opencv_dlib::kDefaultRerankCacheSize};
+    /// 并行检测线程数配置；0 表示使用硬件并发数
+    int detectThreads;
+    /// 并行检测线程池（按需创建），以及按金字塔层数缓存的检测器副本；
+    /// dlib 检测器在调用时会修改扫描器状态，因此每个工作线程需要独立的一份
+    std::unique_ptr<dlib::thread_pool> detectPool;
+    std::map<unsigned long, std::vector<dlib::frontal_face_detector>> detectorPools;
+    /// 保护 detectPool 与 detectorPools；加锁顺序为 detectPoolMutex -> mutex
+    std::mutex detectPoolMutex;
+    /// 检测器类型（配置 HumanRecognition/Detector）
+    detail::DetectorKind detectorKind = detail::DetectorKind::Hog;
+    /// DNN 检测器模型路径、推理输入边长与 OpenCV 线程数（进程级，见 applyOpenCvThreadsOnce）
+    QString dnnModelPath;
+    int dnnInputSize;
+    int dnnThreads;
+    /// DNN 检测器实例；替换时只交换指针，正在检测的线程持有旧实例直到返回（受 mutex 保护）
+    std::shared_ptr<detail::DnnFaceDetector> dnnDetector;
 
     friend class test::ImplAccessor;
 };
@@ -0,0 +1,64 @@
+﻿#pragma once
+
+#if defined(HAS_OPENCV) && defined(HAS_DLIB)
+
+#include <QString>
+#include <QVector>
+#include <memory>
+#include <mutex>
+#include <opencv2/core.hpp>
+
+#include "../../../internal/detection_tiles.h"
+
+namespace HumanRecognition::detail {
+
+/**
+ * @brief 基于 OpenCV DNN 的人脸检测器（YuNet，cv::FaceDetectorYN），作为 HOG 的可选替代。
+ *
+ * 输入图像按长边缩放到 inputSize（不放大）后推理，结果映射回输入图像坐标。
+ * 相比 HOG，耗时主要取决于 inputSize 而不是原图分辨率，并且能检出侧脸。
+ * cv::FaceDetectorYN 在推理时会修改内部状态，detect() 内部串行化调用。
+ */
+class DnnFaceDetector {
+   public:
+    /**
+     * @brief 加载 YuNet ONNX 模型；失败时返回空指针并写入 error。
+     *
+     * 需要 OpenCV >= 4.5.4 且包含 objdetect 与 dnn 模块，否则总是失败。
+     * FaceDetectorYN 没有单实例的线程设置，推理线程数由 applyOpenCvThreadsOnce 决定。
+     */
+    static std::unique_ptr<DnnFaceDetector> create(const QString& modelPath,
+                                                   int inputSize,
+                                                   QString* error = nullptr);
+
+    ~DnnFaceDetector();
+
+    /**
+     * @brief 在 RGB 图像上检测人脸，返回输入图像坐标的矩形与置信度。
+     */
+    QVector<ScoredRect> detect(const cv::Mat& rgb, float scoreThreshold);
+
+    int inputSize() const { return m_inputSize; }
+    const QString& modelPath() const { return m_modelPath; }
+
+   private:
+    DnnFaceDetector() = default;
+
+    struct Model;
+    std::unique_ptr<Model> m_model;
+    std::mutex m_mutex;
+    QString m_modelPath;
+    int m_inputSize = 0;
+};
+
+/**
+ * @brief 设置 OpenCV 线程数（cv::setNumThreads）。
+ *
+ * 这是进程级设置，影响进程内所有 OpenCV 调用方（不只是 DNN 检测器），因此每个进程只应用一次：
+ * 首次以正数调用时生效并返回 true，之后的调用不再修改并返回 false。threads <= 0 时不做任何事。
+ */
+bool applyOpenCvThreadsOnce(int threads);
+
+}  // namespace HumanRecognition::detail
+
+#endif  // defined(HAS_OPENCV) && defined(HAS_DLIB)
@@ -0,0 +1,70 @@
+﻿#pragma once
+
+#if defined(HAS_OPENCV) && defined(HAS_DLIB)
+
+#include <dlib/opencv.h>
+
+#include <QImage>
+#include <opencv2/core.hpp>
+
+namespace HumanRecognition::detail {
+
+/**
+ * @brief 以 RGB 排列暴露 QImage 像素的轻量视图，供 OpenCV 与 dlib 共用。
+ *
+ * - Format_RGB888 输入直接共享 QImage 的像素缓冲（零拷贝，仅增加隐式共享引用计数）；
+ * - 常见的 32 位、BGR888、灰度格式通过 cv::cvtColor（SIMD 实现）一次转换为 RGB；
+ * - 其余格式退回 QImage::convertToFormat，同样只产生一次拷贝。
+ *
+ * dlib::rgb_pixel 的内存布局即 R,G,B 三字节，因此 dlibView() 无需任何通道交换。
+ * 视图持有底层缓冲的所有权，生命周期内可安全读取；调用方不得写入像素。
+ */
+class RgbImageView {
+   public:
+    RgbImageView() = default;
+
+    /**
+     * @brief 从 QImage 构造视图；空图像返回 isNull() 为 true 的视图。
+     */
+    static RgbImageView fromQImage(const QImage& image);
+
+    bool isNull() const { return m_mat.empty(); }
+    int width() const { return m_mat.cols; }
+    int height() const { return m_mat.rows; }
+
+    /**
+     * @brief 是否直接引用了输入 QImage 的像素（未发生拷贝）。
+     */
+    bool isZeroCopy() const { return m_zeroCopy; }
+
+    /**
+     * @brief CV_8UC3 的 RGB 矩阵头。
+     */
+    const cv::Mat& mat() const { return m_mat; }
+
+    /**
+     * @brief 以 dlib 通用图像接口访问同一块像素。
+     */
+    dlib::cv_image<dlib::rgb_pixel> dlibView() const {
+        return dlib::cv_image<dlib::rgb_pixel>(m_mat);
+    }
+
+    /**
+     * @brief 在 RGB 空间直接缩放，返回持有新缓冲的视图。
+     */
+    RgbImageView resized(const cv::Size& target) const;
+
+    /**
+     * @brief 截取子区域（与 image 求交后），与当前视图共享像素缓冲，不产生拷贝。
+     */
+    RgbImageView cropped(const cv::Rect& region) const;
+
+   private:
+    QImage m_image;  ///< 零拷贝或 Qt 转换路径下保持像素缓冲存活
+    cv::Mat m_mat;   ///< 指向 m_image 或自有缓冲的 RGB 矩阵
+    bool m_zeroCopy = false;
+};
+
+}  // namespace HumanRecognition::detail
+
+#endif  // defined(HAS_OPENCV) && defined(HAS_DLIB)
@@ -0,0 +1,62 @@
+﻿#pragma once
+
+#include <QRect>
+#include <QSize>
+#include <QVector>
+
+namespace HumanRecognition::detail {
+
+/**
+ * @brief 带置信度的检测框，用于跨分块/跨尺度合并。
+ */
+struct ScoredRect {
+    QRect rect;
+    double confidence = 0.0;
+};
+
+/**
+ * @brief 将图像切分为约 targetTiles 个分块，每块向右/向下扩展 overlap 像素。
+ *
+ * 任意边长不超过 overlap 的人脸必然完整落在其左上角所在分块内，
+ * 因此分块检测不会漏检被切割的小脸。分块边长不会小于 2 * overlap；
+ * 图像过小或 targetTiles <= 1 时只返回覆盖整图的一块。
+ */
+QVector<QRect> computeDetectionTiles(const QSize& imageSize, int targetTiles, int overlap);
+
+/**
+ * @brief 计算 HOG 金字塔需要的层数，使检测窗口 windowSize 能覆盖到 maxFaceSize 大小的人脸。
+ *
+ * @param levelScale 相邻层的缩放比（dlib pyramid_down<6> 为 5/6）
+ */
+unsigned long pyramidLevelsForMaxFace(int maxFaceSize, int windowSize, double levelScale);
+
+/**
+ * @brief 两个矩形的交并比（IoU）。
+ */
+double intersectionOverUnion(const QRect& a, const QRect& b);
+
+/**
+ * @brief 非极大值抑制：按置信度降序保留，IoU 超过阈值或较小框被覆盖 coverThreshold 以上时抑制。
+ */
+QVector<ScoredRect> nonMaxSuppression(QVector<ScoredRect> boxes,
+                                      double iouThreshold,
+                                      double coverThreshold = 0.8);
+
+/**
+ * @brief 反复合并相交的矩形，直到两两不相交（运动区域与待检测区域共用）。
+ */
+QVector<QRect> mergeOverlappingRects(QVector<QRect> rects);
+
+/**
+ * @brief 整理待检测的感兴趣区域：四周外扩 margin、边长补足 minSide、裁剪到图像内并合并相交区域。
+ *
+ * 合并后的总面积超过图像面积的 fullFrameRatio 时直接返回整图（此时整图检测更划算）；
+ * 所有区域都落在图像外时返回空列表。
+ */
+QVector<QRect> prepareDetectionRegions(const QVector<QRect>& regions,
+                                       const QSize& imageSize,
+                                       int margin,
+                                       int minSide,
+                                       double fullFrameRatio = 0.6);
+
+}  // namespace HumanRecognition::detail
@@ -0,0 +1,67 @@
+﻿#pragma once
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <optional>
+
+#include "modules/HumanRecognition/types.h"
+
+namespace HumanRecognition::detail {
+
+/**
+ * @brief 数据集中的一张图片及其所属人员（personIds 的下标）。
+ */
+struct EnrollmentSample {
+    int person = 0;
+    QString path;
+};
+
+/**
+ * @brief 扫描得到的入库数据集：人员按目录名排序，samples 按人员聚集排列。
+ */
+struct EnrollmentDataset {
+    QStringList personIds;
+    QVector<EnrollmentSample> samples;
+};
+
+/**
+ * @brief 扫描 <root>/<person_id>/ 下的 jpg、jpeg、png、bmp 图片（扩展名不区分大小写）。
+ *
+ * 只取一级子目录中的图片；没有图片的子目录被忽略。root 不存在时返回空数据集。
+ */
+EnrollmentDataset scanEnrollmentDataset(const QString& root);
+
+/**
+ * @brief 按人员累加特征向量并求平均，每个工作线程持有一份，最后合并。
+ *
+ * 维度以第一条特征为准，维度不一致的特征被丢弃。累加使用 double 避免上万张图片时的精度损失。
+ */
+class FeatureAccumulator {
+   public:
+    explicit FeatureAccumulator(int persons = 0);
+
+    /**
+     * @brief 累加一条特征；维度不一致时返回 false。
+     */
+    bool add(int person, const float* values, int dimension);
+
+    /**
+     * @brief 合并另一份累加结果（人员数量需一致）。
+     */
+    void merge(const FeatureAccumulator& other);
+
+    int count(int person) const;
+
+    /**
+     * @brief 返回平均特征（values、version 与 L2 范数）；该人员没有特征时返回空。
+     */
+    std::optional<FaceFeature> mean(int person, const QString& version) const;
+
+   private:
+    int m_dimension = 0;
+    QVector<int> m_counts;
+    QVector<QVector<double>> m_sums;
+};
+
+}  // namespace HumanRecognition::detail
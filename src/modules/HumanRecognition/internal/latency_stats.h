@@ -0,0 +1,142 @@
+﻿#pragma once
+
+#include <QJsonObject>
+#include <QSize>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+
+#include "modules/HumanRecognition/types.h"
+
+namespace HumanRecognition::detail {
+
+/**
+ * @brief 固定分桶的无锁延迟直方图（毫秒）。
+ *
+ * 桶上界按 1-2-5 递增并包含 300ms（门禁 P95 目标），最后一个桶收纳超过 10s 的样本。
+ * record() 只做几次原子加法，可在任意线程调用；分位数在所在桶内线性插值。
+ */
+class LatencyHistogram {
+   public:
+    static constexpr std::array<double, 14> kBoundsMs{
+        1, 2, 5, 10, 20, 50, 100, 200, 300, 500, 1000, 2000, 5000, 10000};
+
+    void record(double ms);
+
+    std::uint64_t count() const;
+    double meanMs() const;
+    double maxMs() const;
+
+    /**
+     * @brief 估计分位数（q 取 0~1）；没有样本时返回 0
+     */
+    double percentile(double q) const;
+
+    /**
+     * @brief 导出 {"count", "mean_ms", "max_ms", "p50_ms", "p95_ms", "p99_ms", "buckets"}，
+     *        buckets 为 [{"le", "count"}]，最后一个桶的 le 为 null
+     */
+    QJsonObject toJson() const;
+
+    void reset();
+
+   private:
+    std::array<std::atomic<std::uint64_t>, kBoundsMs.size() + 1> m_buckets{};
+    std::atomic<std::uint64_t> m_count{0};
+    std::atomic<std::uint64_t> m_sumUs{0};
+    std::atomic<std::uint64_t> m_maxUs{0};
+};
+
+/**
+ * @brief recognize() 各阶段的延迟直方图与降级计数。
+ *
+ * lock 为等待门面锁的时长，直接反映请求在锁上排队的程度；total 覆盖同步与异步调用，
+ * queue 与 degradations 只统计异步请求。
+ */
+struct PipelineMetrics {
+    LatencyHistogram queue;
+    LatencyHistogram lock;
+    LatencyHistogram detect;
+    LatencyHistogram extract;
+    LatencyHistogram match;
+    LatencyHistogram total;
+    std::array<std::atomic<std::uint64_t>, 4> degradations{};  ///< 按 DegradationLevel 计数
+
+    void countDegradation(DegradationLevel level);
+    QJsonObject toJson() const;
+    void reset();
+};
+
+/**
+ * @brief 按剩余预算选择降级档位。
+ *
+ * 对每个档位维护"每百万像素耗时"的指数滑动平均，预估耗时 = 速率 × 该档位实际处理的像素数
+ * × 安全系数。依次尝试 None → Downscaled → NoLandmarks，选第一个能在剩余预算内完成的档位，
+ * 都不满足时返回 Skipped。某档位尚无样本时借用上一档位的速率；完全没有样本时总是完整处理，
+ * 由首批请求建立估计。
+ */
+class DegradationPolicy {
+   public:
+    struct Options {
+        int degradedMaxSide = 640;  ///< 降级时图像长边上限
+        double safetyFactor = 1.2;  ///< 预估耗时的放大系数
+        double smoothing = 0.2;     ///< 滑动平均中新样本的权重
+    };
+
+    explicit DegradationPolicy(const Options& options = {});
+
+    void setOptions(const Options& options);
+    Options options() const;
+
+    /**
+     * @brief 选择档位；remainingMs 为空表示没有截止时间，总是返回 None
+     */
+    DegradationLevel choose(std::optional<double> remainingMs,
+                            const QSize& imageSize,
+                            const DetectOptions& opts) const;
+
+    /**
+     * @brief 生成指定档位下实际使用的检测参数（Skipped 原样返回）
+     */
+    DetectOptions apply(DegradationLevel level,
+                        const QSize& imageSize,
+                        const DetectOptions& opts) const;
+
+    /**
+     * @brief 预估指定档位的处理耗时（不含安全系数）；该档位及更低档位都没有样本时返回空
+     */
+    std::optional<double> estimateMs(DegradationLevel level,
+                                     const QSize& imageSize,
+                                     const DetectOptions& opts) const;
+
+    /**
+     * @brief 记录一次实际处理耗时；effective 为该档位下 apply() 的结果
+     */
+    void observe(DegradationLevel level,
+                 const QSize& imageSize,
+                 const DetectOptions& effective,
+                 double ms);
+
+    /**
+     * @brief 各档位当前的每百万像素耗时估计
+     */
+    QJsonObject toJson() const;
+
+    void reset();
+
+    /**
+     * @brief 后端实际处理的像素数（考虑 resizeTo）
+     */
+    static double workingMegapixels(const QSize& imageSize, const DetectOptions& opts);
+
+   private:
+    static constexpr int kLevels = 3;  ///< 参与估计的档位数（不含 Skipped）
+
+    mutable std::mutex m_mutex;
+    Options m_options;
+    std::array<std::optional<double>, kLevels> m_msPerMegapixel;
+};
+
+}  // namespace HumanRecognition::detail
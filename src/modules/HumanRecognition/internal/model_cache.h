@@ -0,0 +1,101 @@
+﻿#pragma once
+
+#include <QDateTime>
+#include <QHash>
+#include <QString>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+
+namespace HumanRecognition::detail {
+
+/**
+ * @brief 进程级模型缓存：按（规范化路径, 模型类型）缓存只读模型，文件修改时间或大小变化时重新加载。
+ *
+ * - 相同文件的并发请求只加载一次，其余调用方等待同一个 shared_future；
+ * - Lazy 模式把加载推迟到第一次 get()，并在调用 get() 的线程上执行；
+ *   Prefetch 模式立即在后台线程加载；
+ * - 缓存持有模型的共享引用，后端实例析构或 setBackend 切换后再次请求同一文件时直接命中；
+ * - 加载失败（loader 返回空或抛出异常）的条目在下次请求时重新加载，不会被永久缓存。
+ *
+ * 缓存中的模型以 const 共享，调用方若需要可变状态（例如 dlib 网络前向计算）应自行复制。
+ */
+class ModelCache {
+   public:
+    using Model = std::shared_ptr<const void>;
+    using Loader = std::function<Model(const QString& path)>;
+    using Handle = std::shared_future<Model>;
+
+    enum class LoadMode {
+        Lazy,      ///< 第一次 get() 时在调用线程上加载
+        Prefetch,  ///< 立即在后台线程加载
+    };
+
+    struct Stats {
+        std::uint64_t hits = 0;      ///< 命中已有条目（含正在加载中）的请求数
+        std::uint64_t loads = 0;     ///< 新建加载的次数（含文件变更后的重新加载）
+        std::uint64_t failures = 0;  ///< 加载失败次数
+        int entries = 0;             ///< 当前条目数
+    };
+
+    /**
+     * @brief 进程级共享实例。
+     */
+    static ModelCache& instance();
+
+    ModelCache() = default;
+    ~ModelCache();
+
+    ModelCache(const ModelCache&) = delete;
+    ModelCache& operator=(const ModelCache&) = delete;
+
+    /**
+     * @brief 获取模型句柄；条目不存在、文件已变更或上次加载失败时按 mode 新建加载。
+     *
+     * @param kind 模型类型标签（同一文件可按不同类型/参数分别缓存，例如不同线程数的会话）
+     * @return 句柄；文件不存在时返回无效句柄（valid() == false）
+     */
+    Handle acquire(const QString& path, const QString& kind, Loader loader, LoadMode mode);
+
+    /**
+     * @brief 等待句柄并转换为具体类型；句柄无效或加载失败时返回空指针。
+     */
+    template <typename T>
+    static std::shared_ptr<const T> get(const Handle& handle) {
+        if (!handle.valid()) return {};
+        return std::static_pointer_cast<const T>(handle.get());
+    }
+
+    /**
+     * @brief 移除已加载完成且只被缓存自身引用的条目，返回移除数量。
+     */
+    int evictUnused();
+
+    /**
+     * @brief 清空全部条目（已取得的模型引用不受影响）。
+     */
+    void clear();
+
+    Stats stats() const;
+
+   private:
+    struct Entry {
+        QDateTime modified;  ///< 加载时的文件修改时间
+        qint64 size = 0;     ///< 加载时的文件大小
+        Handle handle;
+    };
+
+    Handle startLoad(const QString& path, Loader loader, LoadMode mode);
+
+    mutable std::mutex m_mutex;
+    QHash<QString, Entry> m_entries;  ///< 键为 "<kind>|<规范化路径>"
+    Stats m_stats;
+    /// 失败计数由加载任务更新；Lazy 任务可能在缓存析构后才执行，因此单独共享
+    std::shared_ptr<std::atomic<std::uint64_t>> m_failures =
+        std::make_shared<std::atomic<std::uint64_t>>(0);
+};
+
+}  // namespace HumanRecognition::detail
@@ -0,0 +1,98 @@
+﻿#pragma once
+
+#include <QHash>
+#include <QString>
+#include <QVector>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "modules/HumanRecognition/types.h"
+
+namespace HumanRecognition::detail {
+
+/**
+ * @brief 量化人员库：以 fp16 或 int8（逐向量缩放）紧凑存储特征，用于 findNearest 的粗排。
+ *
+ * 所有行按固定维度连续存放（维度补齐到 16 的倍数，便于 SIMD 内核无尾处理），
+ * 查询向量保持 float 精度，只有库内向量被量化，因此近似距离的误差仅来自库侧。
+ * 调用方负责在粗排得到的 topK 候选上使用原始 float 特征重排（后端从人员表按需读取）。
+ *
+ * 该类不是线程安全的，由持有者（后端 Impl）的互斥锁保护。
+ */
+class QuantizedGallery {
+   public:
+    struct Candidate {
+        QString personId;        ///< 候选人员 ID
+        float approxDistance{};  ///< 基于量化向量的近似欧氏距离
+    };
+
+    explicit QuantizedGallery(FeatureEncoding encoding = FeatureEncoding::Int8);
+
+    FeatureEncoding encoding() const { return m_encoding; }
+    int size() const { return m_ids.size(); }
+    int dimension() const { return m_dimension; }
+    bool isEmpty() const { return m_ids.isEmpty(); }
+
+    /**
+     * @brief 清空全部行并重置维度。
+     */
+    void clear();
+
+    /**
+     * @brief 预留行容量，批量构建前调用可避免多次扩容。
+     */
+    void reserve(int rows);
+
+    /**
+     * @brief 插入或替换一行；特征为空或维度与已有行不一致时返回 false。
+     */
+    bool upsert(const QString& personId, const FaceFeature& feature);
+
+    /**
+     * @brief 删除一行（与末行交换，O(1)）；不存在时返回 false。
+     */
+    bool remove(const QString& personId);
+
+    bool contains(const QString& personId) const { return m_rowOf.contains(personId); }
+
+    /**
+     * @brief 以 float 查询向量扫描全部行，返回近似距离最小的 topK 个候选（升序）。
+     */
+    QVector<Candidate> search(const FaceFeature& query, int topK) const;
+
+    /**
+     * @brief 反量化指定行，返回的 version 带有编码后缀（例如 "dlib_resnet_128@int8"）。
+     */
+    std::optional<FaceFeature> decode(const QString& personId) const;
+
+    /**
+     * @brief 量化存储占用的字节数（不含 ID 索引），用于日志与基准。
+     */
+    std::size_t memoryBytes() const;
+
+   private:
+    void encodeRow(int row, const QVector<float>& values);
+
+    FeatureEncoding m_encoding;
+    int m_dimension = 0;  ///< 原始维度
+    int m_stride = 0;     ///< 补齐后的行宽（元素个数）
+    QString m_modelTag;   ///< 首行特征的模型标识，用于 decode 时生成 version
+
+    QVector<QString> m_ids;
+    QHash<QString, int> m_rowOf;
+
+    std::vector<std::int8_t> m_int8Codes;     ///< Int8 行数据（m_stride 对齐）
+    std::vector<std::uint16_t> m_halfCodes;   ///< Float16 行数据（IEEE 754 binary16）
+    std::vector<float> m_scales;              ///< Int8 逐行缩放系数
+    std::vector<float> m_squaredNorms;        ///< 反量化后向量的平方范数
+};
+
+/**
+ * @brief float 与 IEEE 754 binary16 之间的可移植转换（含舍入到最近偶数）。
+ */
+std::uint16_t floatToHalf(float value);
+float halfToFloat(std::uint16_t value);
+
+}  // namespace HumanRecognition::detail
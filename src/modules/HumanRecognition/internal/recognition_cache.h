@@ -0,0 +1,105 @@
+﻿#pragma once
+
+#include <QImage>
+#include <QVector>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+
+#include "modules/HumanRecognition/types.h"
+
+namespace HumanRecognition::detail {
+
+/**
+ * @brief 256 位差值哈希（dHash）：把帧缩成 17x16 的平均亮度网格，逐行比较相邻格子。
+ *
+ * 每格只抽样至多 4x4 个像素，1080p 帧的计算量约 4k 次像素读取（微秒级），且不转换整帧格式。
+ * 亮度整体变化不影响哈希；噪声只会翻转差值接近 0 的少数位。
+ */
+struct FrameHash {
+    std::array<std::uint64_t, 4> bits{};
+
+    static FrameHash compute(const QImage& image);
+
+    /// 与另一哈希的汉明距离（0~256）
+    int distance(const FrameHash& other) const;
+
+    bool operator==(const FrameHash& other) const { return bits == other.bits; }
+};
+
+/**
+ * @brief recognize() 前的 LRU 结果缓存。
+ *
+ * 键由帧哈希与上下文指纹（图像尺寸 + 影响结果的检测参数）组成。maxHammingDistance 为 0 时
+ * 通过哈希表 O(1) 查找；大于 0 时在同一上下文的条目中线性查找距离最小者。
+ * 所有方法线程安全；查找可以在不持有门面锁的情况下进行。
+ */
+class RecognitionCache {
+   public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Key {
+        FrameHash hash;
+        std::uint64_t context = 0;
+    };
+
+    explicit RecognitionCache(const RecognitionCacheOptions& options = {});
+
+    /**
+     * @brief 计算帧的缓存键。
+     */
+    static Key makeKey(const QImage& image, const DetectOptions& opts);
+
+    bool enabled() const;
+
+    /**
+     * @brief 查找未过期的结果；命中时写入 outCode / outResults 并返回 true。
+     */
+    bool lookup(const Key& key,
+                HRCode& outCode,
+                QVector<RecognitionResult>& outResults,
+                Clock::time_point now = Clock::now());
+
+    /**
+     * @brief 写入（或替换）结果，超出容量时淘汰最久未使用的条目。
+     */
+    void insert(const Key& key,
+                HRCode code,
+                const QVector<RecognitionResult>& results,
+                Clock::time_point now = Clock::now());
+
+    /**
+     * @brief 清空全部条目（人员库、模型或后端变化时调用）。
+     */
+    void invalidate();
+
+    void setOptions(const RecognitionCacheOptions& options);
+    RecognitionCacheOptions options() const;
+    RecognitionCacheStats stats() const;
+
+   private:
+    struct Entry {
+        Key key;
+        HRCode code = HRCode::Ok;
+        QVector<RecognitionResult> results;
+        Clock::time_point storedAt;
+    };
+    using List = std::list<Entry>;
+
+    static std::uint64_t exactKey(const Key& key);
+    List::iterator findLocked(const Key& key);
+    void eraseLocked(List::iterator it);
+    void trimLocked();
+
+    mutable std::mutex m_mutex;
+    RecognitionCacheOptions m_options;
+    List m_entries;  ///< 头部为最近使用
+    std::unordered_map<std::uint64_t, List::iterator> m_index;
+    RecognitionCacheStats m_stats;
+};
+
+}  // namespace HumanRecognition::detail
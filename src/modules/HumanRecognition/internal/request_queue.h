@@ -0,0 +1,80 @@
+﻿#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "modules/HumanRecognition/types.h"
+
+namespace HumanRecognition::detail {
+
+/**
+ * @brief 有界优先级请求队列，由固定数量的工作线程消费。
+ *
+ * - 高优先级先出队，同优先级按提交顺序（FIFO）；
+ * - 队列已满时，新请求若优先级高于队尾（最低优先级中最新提交的）请求则将其挤出，否则被拒绝；
+ * - 出队时已超过截止时间的请求不再执行，直接以 DeadlineExceeded 拒绝；
+ * - 析构时停止工作线程，尚未执行的请求以 UnknownError 拒绝。
+ *
+ * 每个请求的 run/reject 恰好会被调用其中之一且只调用一次，均在队列内部锁之外执行。
+ */
+class RequestQueue {
+   public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Task {
+        RequestPriority priority = RequestPriority::Normal;
+        std::optional<Clock::time_point> deadline;  ///< 截止时间点；为空表示不限
+        Clock::time_point enqueuedAt;               ///< 入队时间，由 submit() 填写
+        /// 执行请求；参数为在队列中等待的毫秒数
+        std::function<void(double queueMs)> run;
+        /// 请求未被执行时的回调（QueueFull / DeadlineExceeded / UnknownError）
+        std::function<void(HRCode reason)> reject;
+    };
+
+    struct Stats {
+        std::uint64_t submitted = 0;  ///< 成功入队的请求数
+        std::uint64_t completed = 0;  ///< 已执行完成的请求数
+        std::uint64_t rejected = 0;   ///< 因队列已满被拒绝或被挤出的请求数
+        std::uint64_t expired = 0;    ///< 因超过截止时间被丢弃的请求数
+        std::size_t pending = 0;      ///< 当前排队中的请求数
+    };
+
+    explicit RequestQueue(const RequestQueueOptions& options);
+    ~RequestQueue();
+
+    RequestQueue(const RequestQueue&) = delete;
+    RequestQueue& operator=(const RequestQueue&) = delete;
+
+    /**
+     * @brief 提交请求；返回 false 时 reject(QueueFull) 已在当前线程调用
+     */
+    bool submit(Task task);
+
+    const RequestQueueOptions& options() const { return m_options; }
+    Stats stats() const;
+
+   private:
+    /// 排序键：优先级降序，其次提交序号升序
+    using Key = std::pair<int, std::uint64_t>;
+
+    void workerLoop();
+
+    RequestQueueOptions m_options;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::map<Key, Task> m_tasks;
+    std::uint64_t m_sequence = 0;
+    bool m_stopping = false;
+    Stats m_stats;
+    std::vector<std::thread> m_workers;
+};
+
+}  // namespace HumanRecognition::detail
@@ -0,0 +1,257 @@
+﻿#include "internal/latency_stats.h"
+
+#include <QJsonArray>
+#include <QJsonValue>
+#include <algorithm>
+#include <cmath>
+
+namespace HumanRecognition::detail {
+
+namespace {
+
+constexpr std::array<const char*, 4> kLevelNames{"none", "downscaled", "no_landmarks", "skipped"};
+
+/// 与 OpenCV+dlib 后端一致地解析 resizeTo：只给一边时按原图比例推算另一边
+QSize workingSize(const QSize& imageSize, const DetectOptions& opts) {
+    if (imageSize.isEmpty()) return QSize();
+    const QSize& target = opts.resizeTo;
+    if (target.width() > 0 && target.height() > 0) return target;
+    if (target.width() > 0) {
+        const double ratio = static_cast<double>(target.width()) / imageSize.width();
+        return QSize(target.width(), static_cast<int>(std::round(imageSize.height() * ratio)));
+    }
+    if (target.height() > 0) {
+        const double ratio = static_cast<double>(target.height()) / imageSize.height();
+        return QSize(static_cast<int>(std::round(imageSize.width() * ratio)), target.height());
+    }
+    return imageSize;
+}
+
+DetectOptions degrade(DegradationLevel level,
+                      const QSize& imageSize,
+                      const DetectOptions& opts,
+                      int maxSide) {
+    if (level == DegradationLevel::None || level == DegradationLevel::Skipped) return opts;
+
+    DetectOptions degraded = opts;
+    const QSize working = workingSize(imageSize, opts);
+    const int longSide = std::max(working.width(), working.height());
+    if (maxSide > 0 && longSide > maxSide) {
+        const double scale = static_cast<double>(maxSide) / longSide;
+        degraded.resizeTo =
+            QSize(std::max(1, static_cast<int>(std::round(working.width() * scale))),
+                  std::max(1, static_cast<int>(std::round(working.height() * scale))));
+    }
+    if (level == DegradationLevel::NoLandmarks) degraded.detectLandmarks = false;
+    return degraded;
+}
+
+}  // namespace
+
+void LatencyHistogram::record(double ms) {
+    ms = std::max(0.0, ms);
+    const auto bound = std::lower_bound(kBoundsMs.begin(), kBoundsMs.end(), ms);
+    const auto index = static_cast<std::size_t>(bound - kBoundsMs.begin());
+    m_buckets[index].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+
+    const auto us = static_cast<std::uint64_t>(std::llround(ms * 1000.0));
+    m_sumUs.fetch_add(us, std::memory_order_relaxed);
+    std::uint64_t previous = m_maxUs.load(std::memory_order_relaxed);
+    while (previous < us &&
+           !m_maxUs.compare_exchange_weak(previous, us, std::memory_order_relaxed)) {
+    }
+}
+
+std::uint64_t LatencyHistogram::count() const {
+    return m_count.load(std::memory_order_relaxed);
+}
+
+double LatencyHistogram::meanMs() const {
+    const std::uint64_t n = count();
+    return n == 0 ? 0.0 : static_cast<double>(m_sumUs.load(std::memory_order_relaxed)) / n / 1000.0;
+}
+
+double LatencyHistogram::maxMs() const {
+    return static_cast<double>(m_maxUs.load(std::memory_order_relaxed)) / 1000.0;
+}
+
+double LatencyHistogram::percentile(double q) const {
+    // 以各桶快照为准（并发 record 时 m_count 可能略有出入）
+    std::array<std::uint64_t, kBoundsMs.size() + 1> snapshot{};
+    std::uint64_t total = 0;
+    for (std::size_t i = 0; i < snapshot.size(); ++i) {
+        snapshot[i] = m_buckets[i].load(std::memory_order_relaxed);
+        total += snapshot[i];
+    }
+    if (total == 0) return 0.0;
+
+    const double target = std::clamp(q, 0.0, 1.0) * static_cast<double>(total);
+    const double max = maxMs();
+    std::uint64_t cumulative = 0;
+    for (std::size_t i = 0; i < snapshot.size(); ++i) {
+        if (snapshot[i] == 0) continue;
+        if (static_cast<double>(cumulative + snapshot[i]) >= target) {
+            const double lower = i == 0 ? 0.0 : kBoundsMs[i - 1];
+            const double upper = i < kBoundsMs.size() ? kBoundsMs[i] : max;
+            const double fraction = (target - static_cast<double>(cumulative)) / snapshot[i];
+            return std::min(max, lower + (upper - lower) * fraction);
+        }
+        cumulative += snapshot[i];
+    }
+    return max;
+}
+
+QJsonObject LatencyHistogram::toJson() const {
+    QJsonArray buckets;
+    for (std::size_t i = 0; i < m_buckets.size(); ++i) {
+        QJsonObject bucket;
+        bucket.insert(QStringLiteral("le"),
+                      i < kBoundsMs.size() ? QJsonValue(kBoundsMs[i]) : QJsonValue());
+        bucket.insert(QStringLiteral("count"),
+                      static_cast<qint64>(m_buckets[i].load(std::memory_order_relaxed)));
+        buckets.append(bucket);
+    }
+
+    QJsonObject json;
+    json.insert(QStringLiteral("count"), static_cast<qint64>(count()));
+    json.insert(QStringLiteral("mean_ms"), meanMs());
+    json.insert(QStringLiteral("max_ms"), maxMs());
+    json.insert(QStringLiteral("p50_ms"), percentile(0.50));
+    json.insert(QStringLiteral("p95_ms"), percentile(0.95));
+    json.insert(QStringLiteral("p99_ms"), percentile(0.99));
+    json.insert(QStringLiteral("buckets"), buckets);
+    return json;
+}
+
+void LatencyHistogram::reset() {
+    for (auto& bucket : m_buckets) bucket.store(0, std::memory_order_relaxed);
+    m_count.store(0, std::memory_order_relaxed);
+    m_sumUs.store(0, std::memory_order_relaxed);
+    m_maxUs.store(0, std::memory_order_relaxed);
+}
+
+void PipelineMetrics::countDegradation(DegradationLevel level) {
+    const auto index = static_cast<std::size_t>(level);
+    if (index < degradations.size()) degradations[index].fetch_add(1, std::memory_order_relaxed);
+}
+
+QJsonObject PipelineMetrics::toJson() const {
+    QJsonObject counts;
+    for (std::size_t i = 0; i < degradations.size(); ++i) {
+        counts.insert(QLatin1String(kLevelNames[i]),
+                      static_cast<qint64>(degradations[i].load(std::memory_order_relaxed)));
+    }
+
+    QJsonObject json;
+    json.insert(QStringLiteral("queue"), queue.toJson());
+    json.insert(QStringLiteral("lock"), lock.toJson());
+    json.insert(QStringLiteral("detect"), detect.toJson());
+    json.insert(QStringLiteral("extract"), extract.toJson());
+    json.insert(QStringLiteral("match"), match.toJson());
+    json.insert(QStringLiteral("total"), total.toJson());
+    json.insert(QStringLiteral("degradations"), counts);
+    return json;
+}
+
+void PipelineMetrics::reset() {
+    for (LatencyHistogram* histogram : {&queue, &lock, &detect, &extract, &match, &total}) {
+        histogram->reset();
+    }
+    for (auto& counter : degradations) counter.store(0, std::memory_order_relaxed);
+}
+
+DegradationPolicy::DegradationPolicy(const Options& options) {
+    setOptions(options);
+}
+
+void DegradationPolicy::setOptions(const Options& options) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_options = options;
+    m_options.smoothing = std::clamp(m_options.smoothing, 0.01, 1.0);
+}
+
+DegradationPolicy::Options DegradationPolicy::options() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_options;
+}
+
+DegradationLevel DegradationPolicy::choose(std::optional<double> remainingMs,
+                                           const QSize& imageSize,
+                                           const DetectOptions& opts) const {
+    if (!remainingMs) return DegradationLevel::None;
+    if (*remainingMs <= 0.0) return DegradationLevel::Skipped;
+
+    for (DegradationLevel level : {DegradationLevel::None,
+                                   DegradationLevel::Downscaled,
+                                   DegradationLevel::NoLandmarks}) {
+        const std::optional<double> estimate = estimateMs(level, imageSize, opts);
+        // 还没有任何样本：先完整处理，用实际耗时建立估计
+        if (!estimate) return level;
+        if (*estimate * options().safetyFactor <= *remainingMs) return level;
+    }
+    return DegradationLevel::Skipped;
+}
+
+DetectOptions DegradationPolicy::apply(DegradationLevel level,
+                                       const QSize& imageSize,
+                                       const DetectOptions& opts) const {
+    return degrade(level, imageSize, opts, options().degradedMaxSide);
+}
+
+std::optional<double> DegradationPolicy::estimateMs(DegradationLevel level,
+                                                    const QSize& imageSize,
+                                                    const DetectOptions& opts) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const int last = std::min(static_cast<int>(level), kLevels - 1);
+    for (int i = last; i >= 0; --i) {
+        const std::optional<double>& rate = m_msPerMegapixel[static_cast<std::size_t>(i)];
+        if (!rate) continue;
+        const DetectOptions effective = degrade(level, imageSize, opts, m_options.degradedMaxSide);
+        return *rate * workingMegapixels(imageSize, effective);
+    }
+    return std::nullopt;
+}
+
+void DegradationPolicy::observe(DegradationLevel level,
+                                const QSize& imageSize,
+                                const DetectOptions& effective,
+                                double ms) {
+    const int index = static_cast<int>(level);
+    if (index < 0 || index >= kLevels) return;
+    const double megapixels = workingMegapixels(imageSize, effective);
+    if (megapixels <= 0.0 || ms < 0.0) return;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::optional<double>& rate = m_msPerMegapixel[static_cast<std::size_t>(index)];
+    const double sample = ms / megapixels;
+    rate = rate ? *rate + (sample - *rate) * m_options.smoothing : sample;
+}
+
+QJsonObject DegradationPolicy::toJson() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    QJsonObject rates;
+    for (int i = 0; i < kLevels; ++i) {
+        const std::optional<double>& rate = m_msPerMegapixel[static_cast<std::size_t>(i)];
+        rates.insert(QLatin1String(kLevelNames[static_cast<std::size_t>(i)]),
+                     rate ? QJsonValue(*rate) : QJsonValue());
+    }
+
+    QJsonObject json;
+    json.insert(QStringLiteral("ms_per_megapixel"), rates);
+    json.insert(QStringLiteral("degraded_max_side"), m_options.degradedMaxSide);
+    json.insert(QStringLiteral("safety_factor"), m_options.safetyFactor);
+    return json;
+}
+
+void DegradationPolicy::reset() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_msPerMegapixel.fill(std::nullopt);
+}
+
+double DegradationPolicy::workingMegapixels(const QSize& imageSize, const DetectOptions& opts) {
+    const QSize working = workingSize(imageSize, opts);
+    return static_cast<double>(working.width()) * working.height() / 1e6;
+}
+
+}  // namespace HumanRecognition::detail
@@ -0,0 +1,128 @@
+﻿#include "internal/model_cache.h"
+
+#include <QFileInfo>
+#include <chrono>
+#include <exception>
+
+#include "logging/logging.h"
+
+namespace HumanRecognition::detail {
+
+namespace {
+
+/// 判断句柄是否已完成且结果为空（加载失败）；Lazy 句柄在首次 get() 之前视为未完成
+bool failed(const ModelCache::Handle& handle) {
+    return handle.wait_for(std::chrono::seconds(0)) == std::future_status::ready &&
+           !handle.get();
+}
+
+/// 判断句柄是否已完成加载且模型只被缓存引用
+bool unused(const ModelCache::Handle& handle) {
+    if (handle.wait_for(std::chrono::seconds(0)) != std::future_status::ready) return false;
+    const ModelCache::Model& model = handle.get();
+    return !model || model.use_count() == 1;
+}
+
+}  // namespace
+
+ModelCache& ModelCache::instance() {
+    static ModelCache cache;
+    return cache;
+}
+
+ModelCache::~ModelCache() {
+    // 等待仍在后台执行的预取任务；Lazy 任务只在调用方 get() 时执行，不依赖缓存对象
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const Entry& entry : m_entries) {
+        if (entry.handle.wait_for(std::chrono::seconds(0)) != std::future_status::deferred) {
+            entry.handle.wait();
+        }
+    }
+}
+
+ModelCache::Handle ModelCache::acquire(const QString& path,
+                                       const QString& kind,
+                                       Loader loader,
+                                       LoadMode mode) {
+    const QFileInfo info(path);
+    if (!info.exists() || !loader) return {};
+    const QString canonical = info.canonicalFilePath();
+    const QString key = kind + QLatin1Char('|') + canonical;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_entries.find(key);
+    if (it != m_entries.end() && it->modified == info.lastModified() && it->size == info.size() &&
+        !failed(it->handle)) {
+        ++m_stats.hits;
+        return it->handle;
+    }
+
+    Entry entry;
+    entry.modified = info.lastModified();
+    entry.size = info.size();
+    entry.handle = startLoad(canonical, std::move(loader), mode);
+    ++m_stats.loads;
+    m_entries.insert(key, entry);
+    m_stats.entries = m_entries.size();
+    return entry.handle;
+}
+
+ModelCache::Handle ModelCache::startLoad(const QString& path, Loader loader, LoadMode mode) {
+    auto task = [failures = m_failures, path, loader = std::move(loader)]() -> Model {
+        Model model;
+        QString error;
+        try {
+            model = loader(path);
+            if (!model) error = QStringLiteral("loader returned no model");
+        } catch (const std::exception& ex) {
+            error = QString::fromUtf8(ex.what());
+        } catch (...) {
+            error = QStringLiteral("unknown exception");
+        }
+
+        auto logger = logging::LoggerManager::instance().getLogger("HumanRecognition.ModelCache");
+        if (!model) {
+            ++*failures;
+            if (logger) {
+                logger->error("Failed to load model {}: {}",
+                              path.toStdString(),
+                              error.toStdString());
+            }
+        } else if (logger) {
+            logger->info("Model loaded into cache: {}", path.toStdString());
+        }
+        return model;
+    };
+    const auto policy = mode == LoadMode::Prefetch ? std::launch::async : std::launch::deferred;
+    return std::async(policy, std::move(task)).share();
+}
+
+int ModelCache::evictUnused() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    int removed = 0;
+    for (auto it = m_entries.begin(); it != m_entries.end();) {
+        if (unused(it->handle)) {
+            it = m_entries.erase(it);
+            ++removed;
+        } else {
+            ++it;
+        }
+    }
+    m_stats.entries = m_entries.size();
+    return removed;
+}
+
+void ModelCache::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.clear();
+    m_stats.entries = 0;
+}
+
+ModelCache::Stats ModelCache::stats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Stats stats = m_stats;
+    stats.failures = m_failures->load();
+    return stats;
+}
+
+}  // namespace HumanRecognition::detail
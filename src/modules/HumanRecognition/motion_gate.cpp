@@ -0,0 +1,193 @@
+﻿#include "motion_gate.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <utility>
+
+#include "internal/detection_tiles.h"
+
+namespace HumanRecognition {
+
+namespace {
+
+QSize analysisSizeFor(const QSize& frameSize, int analysisWidth) {
+    const int width = std::clamp(analysisWidth, 16, std::max(16, frameSize.width()));
+    const int height = std::max(
+        1, static_cast<int>(std::lround(static_cast<double>(frameSize.height()) * width /
+                                        std::max(1, frameSize.width()))));
+    return QSize(width, height);
+}
+
+}  // namespace
+
+MotionGate::MotionGate(const MotionGateOptions& options) : m_options(options) {}
+
+void MotionGate::setOptions(const MotionGateOptions& options) {
+    // 分析分辨率变化会使背景模型失效
+    const bool resetModel = options.analysisWidth != m_options.analysisWidth;
+    m_options = options;
+    if (resetModel) reset();
+}
+
+void MotionGate::setSensitivity(double sensitivity) {
+    const double s = std::clamp(sensitivity, 0.0, 1.0);
+    // s = 0.5 时与默认参数一致：pixelThreshold 25，minChangedRatio 0.2%
+    m_options.pixelThreshold = static_cast<int>(std::lround(45.0 - 40.0 * s));
+    m_options.minChangedRatio = 0.01 * std::pow(0.04, s);
+}
+
+void MotionGate::reset() {
+    m_background.clear();
+    m_frameSize = QSize();
+    m_analysisSize = QSize();
+    m_framesSinceForced = 0;
+}
+
+MotionGate::Result MotionGate::process(const QImage& frame) {
+    Result result;
+    if (frame.isNull()) return result;
+    ++m_stats.framesProcessed;
+
+    // 先缩放再转灰度，转换只作用在很小的分析图上
+    const QSize analysisSize = analysisSizeFor(frame.size(), m_options.analysisWidth);
+    const QImage gray = frame.scaled(analysisSize, Qt::IgnoreAspectRatio, Qt::FastTransformation)
+                            .convertToFormat(QImage::Format_Grayscale8);
+    const int width = gray.width();
+    const int height = gray.height();
+
+    const auto forceFullFrame = [&]() {
+        result.shouldDetect = true;
+        result.forced = true;
+        result.regions = {QRect(QPoint(0, 0), frame.size())};
+        m_framesSinceForced = 0;
+        ++m_stats.framesForced;
+        return result;
+    };
+
+    if (m_background.empty() || frame.size() != m_frameSize || gray.size() != m_analysisSize) {
+        // 首帧或分辨率变化：以当前帧建立背景并整帧放行
+        m_frameSize = frame.size();
+        m_analysisSize = gray.size();
+        m_background.resize(static_cast<std::size_t>(width) * static_cast<std::size_t>(height));
+        for (int y = 0; y < height; ++y) {
+            const uchar* row = gray.constScanLine(y);
+            float* bg = m_background.data() + static_cast<std::size_t>(y) * width;
+            for (int x = 0; x < width; ++x) bg[x] = row[x];
+        }
+        return forceFullFrame();
+    }
+
+    std::vector<std::uint8_t> mask(m_background.size(), 0);
+    const float threshold = static_cast<float>(m_options.pixelThreshold);
+    const float alpha = static_cast<float>(std::clamp(m_options.backgroundAlpha, 0.0, 1.0));
+    std::size_t changed = 0;
+    for (int y = 0; y < height; ++y) {
+        const uchar* row = gray.constScanLine(y);
+        const std::size_t offset = static_cast<std::size_t>(y) * width;
+        float* bg = m_background.data() + offset;
+        std::uint8_t* maskRow = mask.data() + offset;
+        for (int x = 0; x < width; ++x) {
+            const float value = row[x];
+            const float diff = value - bg[x];
+            const std::uint8_t isChanged = std::abs(diff) > threshold ? 1 : 0;
+            maskRow[x] = isChanged;
+            changed += isChanged;
+            bg[x] += alpha * diff;
+        }
+    }
+    result.changedRatio = static_cast<double>(changed) / static_cast<double>(mask.size());
+
+    ++m_framesSinceForced;
+    if (m_options.forceEveryNFrames > 0 &&
+        m_framesSinceForced >= static_cast<quint64>(m_options.forceEveryNFrames)) {
+        return forceFullFrame();
+    }
+
+    if (result.changedRatio < m_options.minChangedRatio) {
+        ++m_stats.framesSkipped;
+        return result;
+    }
+
+    result.regions = extractRegions(mask, frame.size());
+    if (result.regions.isEmpty()) {
+        // 变化像素分散成噪点，没有形成有效区域
+        ++m_stats.framesSkipped;
+        return result;
+    }
+    result.shouldDetect = true;
+    ++m_stats.framesWithMotion;
+    return result;
+}
+
+QVector<QRect> MotionGate::extractRegions(const std::vector<std::uint8_t>& mask,
+                                          const QSize& frameSize) const {
+    const int width = m_analysisSize.width();
+    const int height = m_analysisSize.height();
+    const int cell = std::max(1, m_options.cellSize);
+    const int cols = (width + cell - 1) / cell;
+    const int rows = (height + cell - 1) / cell;
+
+    // 统计每个网格的变化像素数，得到活动网格
+    std::vector<int> counts(static_cast<std::size_t>(cols) * static_cast<std::size_t>(rows), 0);
+    for (int y = 0; y < height; ++y) {
+        const std::uint8_t* maskRow = mask.data() + static_cast<std::size_t>(y) * width;
+        int* countRow = counts.data() + static_cast<std::size_t>(y / cell) * cols;
+        for (int x = 0; x < width; ++x) countRow[x / cell] += maskRow[x];
+    }
+    const int minChanged = std::clamp(m_options.cellMinChanged, 1, cell * cell);
+    std::vector<std::uint8_t> active(counts.size(), 0);
+    for (std::size_t i = 0; i < counts.size(); ++i) active[i] = counts[i] >= minChanged ? 1 : 0;
+
+    // 8 邻域连通域，记录每个连通域的网格包围盒
+    QVector<QRect> cellBoxes;
+    std::vector<int> stack;
+    for (int start = 0; start < static_cast<int>(active.size()); ++start) {
+        if (!active[static_cast<std::size_t>(start)]) continue;
+        int minX = cols, minY = rows, maxX = -1, maxY = -1;
+        active[static_cast<std::size_t>(start)] = 0;
+        stack.push_back(start);
+        while (!stack.empty()) {
+            const int index = stack.back();
+            stack.pop_back();
+            const int cx = index % cols;
+            const int cy = index / cols;
+            minX = std::min(minX, cx);
+            minY = std::min(minY, cy);
+            maxX = std::max(maxX, cx);
+            maxY = std::max(maxY, cy);
+            for (int dy = -1; dy <= 1; ++dy) {
+                for (int dx = -1; dx <= 1; ++dx) {
+                    const int nx = cx + dx;
+                    const int ny = cy + dy;
+                    if (nx < 0 || ny < 0 || nx >= cols || ny >= rows) continue;
+                    const int neighbor = ny * cols + nx;
+                    if (!active[static_cast<std::size_t>(neighbor)]) continue;
+                    active[static_cast<std::size_t>(neighbor)] = 0;
+                    stack.push_back(neighbor);
+                }
+            }
+        }
+        const int pad = std::max(0, m_options.roiPadding);
+        const QPoint topLeft(std::max(0, minX - pad), std::max(0, minY - pad));
+        const QPoint bottomRight(std::min(cols - 1, maxX + pad), std::min(rows - 1, maxY + pad));
+        cellBoxes.append(QRect(topLeft, bottomRight));
+    }
+
+    // 网格坐标 -> 原图坐标
+    const double sx = static_cast<double>(frameSize.width()) / width;
+    const double sy = static_cast<double>(frameSize.height()) / height;
+    const QRect frameBounds(QPoint(0, 0), frameSize);
+    QVector<QRect> regions;
+    regions.reserve(cellBoxes.size());
+    for (const QRect& box : cellBoxes) {
+        const int left = static_cast<int>(std::floor(box.left() * cell * sx));
+        const int top = static_cast<int>(std::floor(box.top() * cell * sy));
+        const int right = static_cast<int>(std::ceil((box.right() + 1) * cell * sx)) - 1;
+        const int bottom = static_cast<int>(std::ceil((box.bottom() + 1) * cell * sy)) - 1;
+        regions.append(QRect(QPoint(left, top), QPoint(right, bottom)).intersected(frameBounds));
+    }
+    return detail::mergeOverlappingRects(std::move(regions));
+}
+
+}  // namespace HumanRecognition
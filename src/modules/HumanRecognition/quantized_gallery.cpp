@@ -0,0 +1,350 @@
+﻿#include "internal/quantized_gallery.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <utility>
+
+// 编译器开启 AVX2/FMA（GCC/Clang 的 -mavx2 -mfma -mf16c 或 MSVC 的 /arch:AVX2）时使用向量内核，
+// 否则退回标量循环（其写法可被编译器在 SSE2 基线上自动向量化）。
+#if defined(__AVX2__) && (defined(__FMA__) || defined(_MSC_VER))
+#define HR_GALLERY_AVX2 1
+#include <immintrin.h>
+#endif
+#if defined(HR_GALLERY_AVX2) && (defined(__F16C__) || defined(_MSC_VER))
+#define HR_GALLERY_F16C 1
+#endif
+
+namespace HumanRecognition::detail {
+
+namespace {
+
+/// 行宽按 16 个元素对齐，使 AVX2 内核（每次处理 16 个 int8 / 8 个 fp16）无需处理尾部。
+constexpr int kRowAlignment = 16;
+
+int alignedStride(int dimension) {
+    return (dimension + kRowAlignment - 1) / kRowAlignment * kRowAlignment;
+}
+
+#if defined(HR_GALLERY_AVX2)
+float horizontalSum(__m256 v) {
+    const __m128 lo = _mm256_castps256_ps128(v);
+    const __m128 hi = _mm256_extractf128_ps(v, 1);
+    __m128 sum = _mm_add_ps(lo, hi);
+    sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+    sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 0x55));
+    return _mm_cvtss_f32(sum);
+}
+#endif
+
+/**
+ * @brief float 查询向量与 int8 行的点积（未乘缩放系数）。
+ */
+float dotInt8(const float* query, const std::int8_t* codes, int stride) {
+#if defined(HR_GALLERY_AVX2)
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    for (int i = 0; i < stride; i += 16) {
+        const __m128i packed = _mm_loadu_si128(reinterpret_cast<const __m128i*>(codes + i));
+        const __m256 lo = _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(packed));
+        const __m256 hi = _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(_mm_srli_si128(packed, 8)));
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(query + i), lo, acc0);
+        acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(query + i + 8), hi, acc1);
+    }
+    return horizontalSum(_mm256_add_ps(acc0, acc1));
+#else
+    float acc = 0.0f;
+    for (int i = 0; i < stride; ++i) acc += query[i] * static_cast<float>(codes[i]);
+    return acc;
+#endif
+}
+
+/**
+ * @brief float 查询向量与 fp16 行的平方欧氏距离。
+ */
+float squaredDistanceHalf(const float* query, const std::uint16_t* codes, int stride) {
+#if defined(HR_GALLERY_F16C)
+    __m256 acc = _mm256_setzero_ps();
+    for (int i = 0; i < stride; i += 8) {
+        const __m256 row =
+            _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(codes + i)));
+        const __m256 diff = _mm256_sub_ps(_mm256_loadu_ps(query + i), row);
+        acc = _mm256_fmadd_ps(diff, diff, acc);
+    }
+    return horizontalSum(acc);
+#else
+    float acc = 0.0f;
+    for (int i = 0; i < stride; ++i) {
+        const float diff = query[i] - halfToFloat(codes[i]);
+        acc += diff * diff;
+    }
+    return acc;
+#endif
+}
+
+}  // namespace
+
+std::uint16_t floatToHalf(float value) {
+    const auto bits = std::bit_cast<std::uint32_t>(value);
+    const std::uint32_t sign = (bits >> 16) & 0x8000u;
+    std::uint32_t mantissa = bits & 0x007FFFFFu;
+    const int exponent = static_cast<int>((bits >> 23) & 0xFFu);
+
+    if (exponent == 0xFF) {
+        // Inf / NaN：保留 NaN 的静默位
+        return static_cast<std::uint16_t>(sign | 0x7C00u | (mantissa ? 0x0200u : 0u));
+    }
+    const int halfExponent = exponent - 127 + 15;
+    if (halfExponent >= 0x1F) return static_cast<std::uint16_t>(sign | 0x7C00u);
+    if (halfExponent <= 0) {
+        // 结果为次正规数或 0
+        if (halfExponent < -10) return static_cast<std::uint16_t>(sign);
+        mantissa |= 0x00800000u;
+        const int shift = 14 - halfExponent;
+        std::uint32_t half = mantissa >> shift;
+        const std::uint32_t remainder = mantissa & ((1u << shift) - 1u);
+        const std::uint32_t halfway = 1u << (shift - 1);
+        if (remainder > halfway || (remainder == halfway && (half & 1u))) ++half;
+        return static_cast<std::uint16_t>(sign | half);
+    }
+    std::uint32_t half = sign | (static_cast<std::uint32_t>(halfExponent) << 10) | (mantissa >> 13);
+    const std::uint32_t remainder = mantissa & 0x1FFFu;
+    // 舍入进位可能溢出到指数位，这正是 IEEE 的正确结果
+    if (remainder > 0x1000u || (remainder == 0x1000u && (half & 1u))) ++half;
+    return static_cast<std::uint16_t>(half);
+}
+
+float halfToFloat(std::uint16_t value) {
+    const std::uint32_t sign = static_cast<std::uint32_t>(value & 0x8000u) << 16;
+    std::uint32_t exponent = (value >> 10) & 0x1Fu;
+    std::uint32_t mantissa = value & 0x03FFu;
+    std::uint32_t bits = 0;
+    if (exponent == 0) {
+        if (mantissa == 0) {
+            bits = sign;
+        } else {
+            // 次正规数：规格化后转为 float 正规数
+            exponent = 127 - 15 + 1;
+            while ((mantissa & 0x0400u) == 0) {
+                mantissa <<= 1;
+                --exponent;
+            }
+            mantissa &= 0x03FFu;
+            bits = sign | (exponent << 23) | (mantissa << 13);
+        }
+    } else if (exponent == 0x1F) {
+        bits = sign | 0x7F800000u | (mantissa << 13);
+    } else {
+        bits = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+    }
+    return std::bit_cast<float>(bits);
+}
+
+QuantizedGallery::QuantizedGallery(FeatureEncoding encoding) : m_encoding(encoding) {
+    // Float32 不属于量化编码，退化为 fp16 以保持类的语义单一
+    if (m_encoding == FeatureEncoding::Float32) m_encoding = FeatureEncoding::Float16;
+}
+
+void QuantizedGallery::clear() {
+    m_dimension = 0;
+    m_stride = 0;
+    m_modelTag.clear();
+    m_ids.clear();
+    m_rowOf.clear();
+    m_int8Codes.clear();
+    m_halfCodes.clear();
+    m_scales.clear();
+    m_squaredNorms.clear();
+}
+
+void QuantizedGallery::reserve(int rows) {
+    if (rows <= 0) return;
+    m_ids.reserve(rows);
+    m_rowOf.reserve(rows);
+    m_scales.reserve(static_cast<std::size_t>(rows));
+    m_squaredNorms.reserve(static_cast<std::size_t>(rows));
+    if (m_stride > 0) {
+        const auto elements = static_cast<std::size_t>(rows) * static_cast<std::size_t>(m_stride);
+        if (m_encoding == FeatureEncoding::Int8) {
+            m_int8Codes.reserve(elements);
+        } else {
+            m_halfCodes.reserve(elements);
+        }
+    }
+}
+
+bool QuantizedGallery::upsert(const QString& personId, const FaceFeature& feature) {
+    if (personId.isEmpty() || feature.values.isEmpty()) return false;
+    if (m_dimension == 0) {
+        m_dimension = static_cast<int>(feature.values.size());
+        m_stride = alignedStride(m_dimension);
+        m_modelTag = featureModelTag(feature.version);
+    } else if (feature.values.size() != m_dimension) {
+        return false;
+    }
+
+    auto it = m_rowOf.constFind(personId);
+    int row = 0;
+    if (it != m_rowOf.cend()) {
+        row = it.value();
+    } else {
+        row = static_cast<int>(m_ids.size());
+        m_ids.append(personId);
+        m_rowOf.insert(personId, row);
+        m_scales.push_back(0.0f);
+        m_squaredNorms.push_back(0.0f);
+        const auto newSize = static_cast<std::size_t>(row + 1) * static_cast<std::size_t>(m_stride);
+        if (m_encoding == FeatureEncoding::Int8) {
+            m_int8Codes.resize(newSize, 0);
+        } else {
+            m_halfCodes.resize(newSize, 0);
+        }
+    }
+    encodeRow(row, feature.values);
+    return true;
+}
+
+void QuantizedGallery::encodeRow(int row, const QVector<float>& values) {
+    const auto offset = static_cast<std::size_t>(row) * static_cast<std::size_t>(m_stride);
+    float squaredNorm = 0.0f;
+    if (m_encoding == FeatureEncoding::Int8) {
+        float maxAbs = 0.0f;
+        for (float v : values) maxAbs = std::max(maxAbs, std::abs(v));
+        const float scale = maxAbs > 0.0f ? maxAbs / 127.0f : 1.0f;
+        std::int8_t* dst = m_int8Codes.data() + offset;
+        for (int i = 0; i < m_dimension; ++i) {
+            const float q = std::clamp(std::round(values[i] / scale), -127.0f, 127.0f);
+            dst[i] = static_cast<std::int8_t>(q);
+            squaredNorm += q * q;
+        }
+        std::fill(dst + m_dimension, dst + m_stride, std::int8_t{0});
+        m_scales[static_cast<std::size_t>(row)] = scale;
+        squaredNorm *= scale * scale;
+    } else {
+        std::uint16_t* dst = m_halfCodes.data() + offset;
+        for (int i = 0; i < m_dimension; ++i) {
+            dst[i] = floatToHalf(values[i]);
+            const float restored = halfToFloat(dst[i]);
+            squaredNorm += restored * restored;
+        }
+        std::fill(dst + m_dimension, dst + m_stride, std::uint16_t{0});
+        m_scales[static_cast<std::size_t>(row)] = 1.0f;
+    }
+    m_squaredNorms[static_cast<std::size_t>(row)] = squaredNorm;
+}
+
+bool QuantizedGallery::remove(const QString& personId) {
+    auto it = m_rowOf.find(personId);
+    if (it == m_rowOf.end()) return false;
+    const int row = it.value();
+    const int last = static_cast<int>(m_ids.size()) - 1;
+    m_rowOf.erase(it);
+
+    if (row != last) {
+        // 与末行交换后截断，保持存储连续
+        const auto stride = static_cast<std::size_t>(m_stride);
+        const auto dstOffset = static_cast<std::size_t>(row) * stride;
+        const auto srcOffset = static_cast<std::size_t>(last) * stride;
+        if (m_encoding == FeatureEncoding::Int8) {
+            std::copy_n(m_int8Codes.begin() + static_cast<std::ptrdiff_t>(srcOffset),
+                        stride,
+                        m_int8Codes.begin() + static_cast<std::ptrdiff_t>(dstOffset));
+        } else {
+            std::copy_n(m_halfCodes.begin() + static_cast<std::ptrdiff_t>(srcOffset),
+                        stride,
+                        m_halfCodes.begin() + static_cast<std::ptrdiff_t>(dstOffset));
+        }
+        m_scales[static_cast<std::size_t>(row)] = m_scales[static_cast<std::size_t>(last)];
+        m_squaredNorms[static_cast<std::size_t>(row)] =
+            m_squaredNorms[static_cast<std::size_t>(last)];
+        m_ids[row] = m_ids[last];
+        m_rowOf.insert(m_ids[row], row);
+    }
+
+    m_ids.removeLast();
+    m_scales.pop_back();
+    m_squaredNorms.pop_back();
+    const auto newSize = static_cast<std::size_t>(last) * static_cast<std::size_t>(m_stride);
+    if (m_encoding == FeatureEncoding::Int8) {
+        m_int8Codes.resize(newSize);
+    } else {
+        m_halfCodes.resize(newSize);
+    }
+    if (m_ids.isEmpty()) clear();
+    return true;
+}
+
+QVector<QuantizedGallery::Candidate> QuantizedGallery::search(const FaceFeature& query,
+                                                              int topK) const {
+    QVector<Candidate> out;
+    if (topK <= 0 || m_ids.isEmpty() || query.values.size() != m_dimension) return out;
+
+    // 查询向量补零到行宽，内核可直接按对齐步长处理
+    std::vector<float> padded(static_cast<std::size_t>(m_stride), 0.0f);
+    float querySquaredNorm = 0.0f;
+    for (int i = 0; i < m_dimension; ++i) {
+        padded[static_cast<std::size_t>(i)] = query.values[i];
+        querySquaredNorm += query.values[i] * query.values[i];
+    }
+
+    const int rows = static_cast<int>(m_ids.size());
+    const int keep = std::min(topK, rows);
+    // 最大堆保存当前最好的 keep 个候选，堆顶为其中最差者
+    std::vector<std::pair<float, int>> heap;
+    heap.reserve(static_cast<std::size_t>(keep) + 1);
+
+    for (int row = 0; row < rows; ++row) {
+        const auto offset = static_cast<std::size_t>(row) * static_cast<std::size_t>(m_stride);
+        float squared = 0.0f;
+        if (m_encoding == FeatureEncoding::Int8) {
+            const float dot = dotInt8(padded.data(), m_int8Codes.data() + offset, m_stride) *
+                              m_scales[static_cast<std::size_t>(row)];
+            squared = querySquaredNorm - 2.0f * dot + m_squaredNorms[static_cast<std::size_t>(row)];
+        } else {
+            squared = squaredDistanceHalf(padded.data(), m_halfCodes.data() + offset, m_stride);
+        }
+        if (static_cast<int>(heap.size()) < keep) {
+            heap.emplace_back(squared, row);
+            std::push_heap(heap.begin(), heap.end());
+        } else if (squared < heap.front().first) {
+            std::pop_heap(heap.begin(), heap.end());
+            heap.back() = {squared, row};
+            std::push_heap(heap.begin(), heap.end());
+        }
+    }
+
+    std::sort_heap(heap.begin(), heap.end());
+    out.reserve(static_cast<int>(heap.size()));
+    for (const auto& [squared, row] : heap) {
+        out.append(Candidate{m_ids[row], std::sqrt(std::max(0.0f, squared))});
+    }
+    return out;
+}
+
+std::optional<FaceFeature> QuantizedGallery::decode(const QString& personId) const {
+    auto it = m_rowOf.constFind(personId);
+    if (it == m_rowOf.cend()) return std::nullopt;
+    const int row = it.value();
+    const auto offset = static_cast<std::size_t>(row) * static_cast<std::size_t>(m_stride);
+
+    FaceFeature out;
+    out.values.resize(m_dimension);
+    for (int i = 0; i < m_dimension; ++i) {
+        if (m_encoding == FeatureEncoding::Int8) {
+            out.values[i] = static_cast<float>(m_int8Codes[offset + static_cast<std::size_t>(i)]) *
+                            m_scales[static_cast<std::size_t>(row)];
+        } else {
+            out.values[i] = halfToFloat(m_halfCodes[offset + static_cast<std::size_t>(i)]);
+        }
+    }
+    out.version = featureVersionWithEncoding(m_modelTag, m_encoding);
+    out.norm = std::sqrt(m_squaredNorms[static_cast<std::size_t>(row)]);
+    return out;
+}
+
+std::size_t QuantizedGallery::memoryBytes() const {
+    return m_int8Codes.size() * sizeof(std::int8_t) + m_halfCodes.size() * sizeof(std::uint16_t) +
+           m_scales.size() * sizeof(float) + m_squaredNorms.size() * sizeof(float);
+}
+
+}  // namespace HumanRecognition::detail
@@ -0,0 +1,212 @@
+﻿#include "internal/recognition_cache.h"
+
+#include <QColor>
+#include <algorithm>
+#include <bit>
+
+namespace HumanRecognition::detail {
+
+namespace {
+
+constexpr int kHashColumns = 17;
+constexpr int kHashRows = 16;
+constexpr int kSamplesPerCell = 4;
+constexpr int kHashBits = (kHashColumns - 1) * kHashRows;
+
+/// splitmix64 混合函数，用于组合上下文指纹
+std::uint64_t mix(std::uint64_t seed, std::uint64_t value) {
+    std::uint64_t z = seed ^ (value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2));
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+std::uint64_t mixRect(std::uint64_t seed, const QRect& rect) {
+    seed = mix(seed, static_cast<std::uint32_t>(rect.x()));
+    seed = mix(seed, static_cast<std::uint32_t>(rect.y()));
+    seed = mix(seed, static_cast<std::uint32_t>(rect.width()));
+    return mix(seed, static_cast<std::uint32_t>(rect.height()));
+}
+
+}  // namespace
+
+FrameHash FrameHash::compute(const QImage& image) {
+    FrameHash hash;
+    if (image.isNull()) return hash;
+
+    // 每格在均匀分布的 kSamplesPerCell x kSamplesPerCell 个点上取亮度平均
+    const int width = image.width();
+    const int height = image.height();
+    std::array<int, kHashColumns * kHashRows> cells{};
+    for (int row = 0; row < kHashRows; ++row) {
+        for (int col = 0; col < kHashColumns; ++col) {
+            int sum = 0;
+            for (int sy = 0; sy < kSamplesPerCell; ++sy) {
+                const int y = static_cast<int>(
+                    (static_cast<qint64>(row * kSamplesPerCell + sy) * 2 + 1) * height /
+                    (2 * kHashRows * kSamplesPerCell));
+                for (int sx = 0; sx < kSamplesPerCell; ++sx) {
+                    const int x = static_cast<int>(
+                        (static_cast<qint64>(col * kSamplesPerCell + sx) * 2 + 1) * width /
+                        (2 * kHashColumns * kSamplesPerCell));
+                    sum += qGray(image.pixel(x, y));
+                }
+            }
+            cells[static_cast<std::size_t>(row * kHashColumns + col)] = sum;
+        }
+    }
+
+    int bit = 0;
+    for (int row = 0; row < kHashRows; ++row) {
+        for (int col = 0; col + 1 < kHashColumns; ++col, ++bit) {
+            const int left = cells[static_cast<std::size_t>(row * kHashColumns + col)];
+            const int right = cells[static_cast<std::size_t>(row * kHashColumns + col + 1)];
+            if (left < right) hash.bits[static_cast<std::size_t>(bit / 64)] |= 1ULL << (bit % 64);
+        }
+    }
+    return hash;
+}
+
+int FrameHash::distance(const FrameHash& other) const {
+    int total = 0;
+    for (std::size_t i = 0; i < bits.size(); ++i) total += std::popcount(bits[i] ^ other.bits[i]);
+    return total;
+}
+
+RecognitionCache::RecognitionCache(const RecognitionCacheOptions& options) {
+    setOptions(options);
+}
+
+RecognitionCache::Key RecognitionCache::makeKey(const QImage& image, const DetectOptions& opts) {
+    Key key;
+    key.hash = FrameHash::compute(image);
+
+    // 检测框以原图坐标返回，因此尺寸不同的帧不能共用结果；线程数不影响结果，不参与指纹
+    std::uint64_t context = mix(0, static_cast<std::uint32_t>(image.width()));
+    context = mix(context, static_cast<std::uint32_t>(image.height()));
+    context = mix(context, opts.detectLandmarks ? 1 : 0);
+    context = mix(context, std::bit_cast<std::uint32_t>(opts.minScore));
+    context = mix(context, static_cast<std::uint32_t>(opts.resizeTo.width()));
+    context = mix(context, static_cast<std::uint32_t>(opts.resizeTo.height()));
+    context = mix(context, static_cast<std::uint32_t>(opts.minFaceSize));
+    context = mix(context, static_cast<std::uint32_t>(opts.maxFaceSize));
+    for (const QRect& roi : opts.regionsOfInterest) context = mixRect(context, roi);
+    key.context = context;
+    return key;
+}
+
+bool RecognitionCache::enabled() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_options.capacity > 0;
+}
+
+bool RecognitionCache::lookup(const Key& key,
+                              HRCode& outCode,
+                              QVector<RecognitionResult>& outResults,
+                              Clock::time_point now) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_options.capacity <= 0) return false;
+
+    auto it = findLocked(key);
+    if (it == m_entries.end()) {
+        ++m_stats.misses;
+        return false;
+    }
+    if (now - it->storedAt > m_options.ttl) {
+        eraseLocked(it);
+        ++m_stats.expirations;
+        ++m_stats.misses;
+        return false;
+    }
+
+    m_entries.splice(m_entries.begin(), m_entries, it);
+    ++m_stats.hits;
+    outCode = it->code;
+    outResults = it->results;
+    return true;
+}
+
+void RecognitionCache::insert(const Key& key,
+                              HRCode code,
+                              const QVector<RecognitionResult>& results,
+                              Clock::time_point now) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_options.capacity <= 0) return;
+
+    auto existing = m_index.find(exactKey(key));
+    if (existing != m_index.end()) eraseLocked(existing->second);
+    m_entries.push_front(Entry{key, code, results, now});
+    m_index[exactKey(key)] = m_entries.begin();
+    trimLocked();
+}
+
+void RecognitionCache::invalidate() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_entries.empty()) return;
+    m_entries.clear();
+    m_index.clear();
+    ++m_stats.invalidations;
+}
+
+void RecognitionCache::setOptions(const RecognitionCacheOptions& options) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_options = options;
+    m_options.capacity = std::max(0, m_options.capacity);
+    m_options.maxHammingDistance = std::clamp(m_options.maxHammingDistance, 0, kHashBits);
+    trimLocked();
+}
+
+RecognitionCacheOptions RecognitionCache::options() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_options;
+}
+
+RecognitionCacheStats RecognitionCache::stats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    RecognitionCacheStats stats = m_stats;
+    stats.entries = static_cast<int>(m_entries.size());
+    return stats;
+}
+
+std::uint64_t RecognitionCache::exactKey(const Key& key) {
+    std::uint64_t value = key.context;
+    for (std::uint64_t word : key.hash.bits) value = mix(value, word);
+    return value;
+}
+
+RecognitionCache::List::iterator RecognitionCache::findLocked(const Key& key) {
+    auto exact = m_index.find(exactKey(key));
+    if (exact != m_index.end() && exact->second->key.context == key.context &&
+        exact->second->key.hash == key.hash) {
+        return exact->second;
+    }
+    if (m_options.maxHammingDistance == 0) return m_entries.end();
+
+    // 近似匹配：同一上下文中距离最小且不超过阈值的条目
+    auto best = m_entries.end();
+    int bestDistance = m_options.maxHammingDistance + 1;
+    for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+        if (it->key.context != key.context) continue;
+        const int distance = it->key.hash.distance(key.hash);
+        if (distance < bestDistance) {
+            best = it;
+            bestDistance = distance;
+        }
+    }
+    return best;
+}
+
+void RecognitionCache::eraseLocked(List::iterator it) {
+    auto indexed = m_index.find(exactKey(it->key));
+    if (indexed != m_index.end() && indexed->second == it) m_index.erase(indexed);
+    m_entries.erase(it);
+}
+
+void RecognitionCache::trimLocked() {
+    while (static_cast<int>(m_entries.size()) > m_options.capacity) {
+        eraseLocked(std::prev(m_entries.end()));
+        ++m_stats.evictions;
+    }
+}
+
+}  // namespace HumanRecognition::detail
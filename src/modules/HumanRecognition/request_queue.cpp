@@ -0,0 +1,103 @@
+﻿#include "internal/request_queue.h"
+
+#include <algorithm>
+
+namespace HumanRecognition::detail {
+
+RequestQueue::RequestQueue(const RequestQueueOptions& options) : m_options(options) {
+    m_options.workers = std::clamp(m_options.workers, 1, 64);
+    m_options.capacity = std::max(1, m_options.capacity);
+    m_workers.reserve(static_cast<std::size_t>(m_options.workers));
+    for (int i = 0; i < m_options.workers; ++i) {
+        m_workers.emplace_back([this]() { workerLoop(); });
+    }
+}
+
+RequestQueue::~RequestQueue() {
+    std::map<Key, Task> abandoned;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+        abandoned.swap(m_tasks);
+        m_stats.pending = 0;
+    }
+    m_cv.notify_all();
+    for (auto& worker : m_workers) {
+        if (worker.joinable()) worker.join();
+    }
+    for (auto& entry : abandoned) {
+        if (entry.second.reject) entry.second.reject(HRCode::UnknownError);
+    }
+}
+
+bool RequestQueue::submit(Task task) {
+    std::optional<Task> evicted;
+    bool accepted = false;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_stopping && static_cast<int>(m_tasks.size()) >= m_options.capacity) {
+            // 队尾是最低优先级中最新提交的请求；只有更高优先级的新请求才能挤掉它
+            auto last = std::prev(m_tasks.end());
+            if (-last->first.first < static_cast<int>(task.priority)) {
+                evicted = std::move(last->second);
+                m_tasks.erase(last);
+                ++m_stats.rejected;
+            }
+        }
+        accepted = !m_stopping && static_cast<int>(m_tasks.size()) < m_options.capacity;
+        if (accepted) {
+            task.enqueuedAt = Clock::now();
+            m_tasks.emplace(Key{-static_cast<int>(task.priority), m_sequence++}, std::move(task));
+            ++m_stats.submitted;
+        } else {
+            ++m_stats.rejected;
+        }
+        m_stats.pending = m_tasks.size();
+    }
+
+    if (evicted && evicted->reject) evicted->reject(HRCode::QueueFull);
+    if (!accepted) {
+        if (task.reject) task.reject(HRCode::QueueFull);
+        return false;
+    }
+    m_cv.notify_one();
+    return true;
+}
+
+RequestQueue::Stats RequestQueue::stats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+void RequestQueue::workerLoop() {
+    while (true) {
+        std::optional<Task> task;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [this]() { return m_stopping || !m_tasks.empty(); });
+            if (m_stopping) return;
+            auto first = m_tasks.begin();
+            task = std::move(first->second);
+            m_tasks.erase(first);
+            m_stats.pending = m_tasks.size();
+        }
+
+        const auto now = Clock::now();
+        if (task->deadline && now > *task->deadline) {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                ++m_stats.expired;
+            }
+            if (task->reject) task->reject(HRCode::DeadlineExceeded);
+            continue;
+        }
+
+        const double queueMs =
+            std::chrono::duration<double, std::milli>(now - task->enqueuedAt).count();
+        if (task->run) task->run(queueMs);
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_stats.completed;
+    }
+}
+
+}  // namespace HumanRecognition::detail
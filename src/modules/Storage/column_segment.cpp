@@ -0,0 +1,704 @@
+﻿#include "column_segment.h"
+
+#include <QDataStream>
+#include <QDate>
+#include <QDateTime>
+#include <QDir>
+#include <QHash>
+#include <QSaveFile>
+#include <QTimeZone>
+#include <QUuid>
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+#include "logging.h"
+
+namespace storage::columnar {
+
+namespace {
+
+constexpr quint64 kSegmentMagic = 0x4343534547303031ull;  // "CCSEG001"
+constexpr quint32 kFormatVersion = 1;
+// 段尾：footer 偏移（quint64）+ 魔数（quint64）
+constexpr qint64 kTrailerSize = 16;
+constexpr qint64 kDayMs = 24 * 3600 * 1000;
+
+enum ColumnIndex { kDeviceColumn = 0, kMetricColumn = 1, kTimestampColumn = 2, kValueColumn = 3 };
+
+std::shared_ptr<spdlog::logger> segmentLogger() {
+    return logging::LoggerManager::instance().getLogger("Storage.Columnar");
+}
+
+/**
+ * @brief 高位在前的位写入器
+ */
+class BitWriter {
+   public:
+    void write(quint64 value, int bits) {
+        while (bits > 0) {
+            if (m_used == 0) m_bytes.append('\0');
+            const int free = 8 - m_used;
+            const int take = std::min(free, bits);
+            const quint64 chunk = (value >> (bits - take)) & ((1ull << take) - 1);
+            m_bytes.back() = static_cast<char>(static_cast<quint8>(m_bytes.back()) |
+                                               static_cast<quint8>(chunk << (free - take)));
+            bits -= take;
+            m_used = (m_used + take) % 8;
+        }
+    }
+
+    QByteArray take() { return std::move(m_bytes); }
+
+   private:
+    QByteArray m_bytes;
+    int m_used = 0;  // 最后一个字节已用的位数，0 表示需要新字节
+};
+
+/**
+ * @brief 与 BitWriter 对应的读取器；越界时返回 false
+ */
+class BitReader {
+   public:
+    explicit BitReader(const QByteArray& bytes) : m_bytes(bytes) {}
+
+    bool read(int bits, quint64& out) {
+        out = 0;
+        while (bits > 0) {
+            if (m_byte >= m_bytes.size()) return false;
+            const int avail = 8 - m_bit;
+            const int take = std::min(avail, bits);
+            const quint64 chunk =
+                (static_cast<quint8>(m_bytes[m_byte]) >> (avail - take)) & ((1u << take) - 1);
+            out = (out << take) | chunk;
+            bits -= take;
+            m_bit += take;
+            if (m_bit == 8) {
+                m_bit = 0;
+                ++m_byte;
+            }
+        }
+        return true;
+    }
+
+   private:
+    const QByteArray& m_bytes;
+    qsizetype m_byte = 0;
+    int m_bit = 0;
+};
+
+// 时间戳：首值与首个差值原样保存，之后按 Gorilla 的 delta-of-delta 分段位宽编码
+QByteArray encodeTimestamps(const qint64* ts, std::size_t n) {
+    BitWriter w;
+    if (n == 0) return {};
+    w.write(static_cast<quint64>(ts[0]), 64);
+    if (n == 1) return w.take();
+    quint64 prevDelta = static_cast<quint64>(ts[1]) - static_cast<quint64>(ts[0]);
+    w.write(prevDelta, 64);
+    for (std::size_t i = 2; i < n; ++i) {
+        const quint64 delta = static_cast<quint64>(ts[i]) - static_cast<quint64>(ts[i - 1]);
+        const qint64 dod = static_cast<qint64>(delta - prevDelta);
+        prevDelta = delta;
+        if (dod == 0) {
+            w.write(0b0, 1);
+        } else if (dod >= -63 && dod <= 64) {
+            w.write(0b10, 2);
+            w.write(static_cast<quint64>(dod + 63), 7);
+        } else if (dod >= -255 && dod <= 256) {
+            w.write(0b110, 3);
+            w.write(static_cast<quint64>(dod + 255), 9);
+        } else if (dod >= -2047 && dod <= 2048) {
+            w.write(0b1110, 4);
+            w.write(static_cast<quint64>(dod + 2047), 12);
+        } else {
+            w.write(0b1111, 4);
+            w.write(static_cast<quint64>(dod), 64);
+        }
+    }
+    return w.take();
+}
+
+bool decodeTimestamps(const QByteArray& bytes, std::size_t n, std::vector<qint64>& out) {
+    out.resize(n);
+    if (n == 0) return true;
+    BitReader r(bytes);
+    quint64 v = 0;
+    if (!r.read(64, v)) return false;
+    out[0] = static_cast<qint64>(v);
+    if (n == 1) return true;
+    quint64 delta = 0;
+    if (!r.read(64, delta)) return false;
+    quint64 prev = v + delta;
+    out[1] = static_cast<qint64>(prev);
+    for (std::size_t i = 2; i < n; ++i) {
+        // 前缀：0 / 10 / 110 / 1110 / 1111
+        int ones = 0;
+        quint64 bit = 0;
+        while (ones < 4) {
+            if (!r.read(1, bit)) return false;
+            if (bit == 0) break;
+            ++ones;
+        }
+        qint64 dod = 0;
+        quint64 raw = 0;
+        switch (ones) {
+            case 0:
+                break;
+            case 1:
+                if (!r.read(7, raw)) return false;
+                dod = static_cast<qint64>(raw) - 63;
+                break;
+            case 2:
+                if (!r.read(9, raw)) return false;
+                dod = static_cast<qint64>(raw) - 255;
+                break;
+            case 3:
+                if (!r.read(12, raw)) return false;
+                dod = static_cast<qint64>(raw) - 2047;
+                break;
+            default:
+                if (!r.read(64, raw)) return false;
+                dod = static_cast<qint64>(raw);
+                break;
+        }
+        delta += static_cast<quint64>(dod);
+        prev += delta;
+        out[i] = static_cast<qint64>(prev);
+    }
+    return true;
+}
+
+// 数值：Gorilla XOR 编码，与前值相同只占 1 位，变化的有效位落在上一窗口内时复用窗口
+QByteArray encodeValues(const double* values, std::size_t n) {
+    BitWriter w;
+    if (n == 0) return {};
+    quint64 prev = std::bit_cast<quint64>(values[0]);
+    w.write(prev, 64);
+    int prevLeading = -1;
+    int prevTrailing = 0;
+    for (std::size_t i = 1; i < n; ++i) {
+        const quint64 cur = std::bit_cast<quint64>(values[i]);
+        const quint64 x = cur ^ prev;
+        prev = cur;
+        if (x == 0) {
+            w.write(0b0, 1);
+            continue;
+        }
+        const int leading = std::min(std::countl_zero(x), 31);
+        const int trailing = std::countr_zero(x);
+        if (prevLeading >= 0 && leading >= prevLeading && trailing >= prevTrailing) {
+            w.write(0b10, 2);
+            w.write(x >> prevTrailing, 64 - prevLeading - prevTrailing);
+        } else {
+            const int significant = 64 - leading - trailing;
+            w.write(0b11, 2);
+            w.write(static_cast<quint64>(leading), 5);
+            // 6 位长度中 0 表示 64
+            w.write(static_cast<quint64>(significant & 63), 6);
+            w.write(x >> trailing, significant);
+            prevLeading = leading;
+            prevTrailing = trailing;
+        }
+    }
+    return w.take();
+}
+
+bool decodeValues(const QByteArray& bytes, std::size_t n, std::vector<double>& out) {
+    out.resize(n);
+    if (n == 0) return true;
+    BitReader r(bytes);
+    quint64 prev = 0;
+    if (!r.read(64, prev)) return false;
+    out[0] = std::bit_cast<double>(prev);
+    int leading = -1;
+    int trailing = 0;
+    for (std::size_t i = 1; i < n; ++i) {
+        quint64 bit = 0;
+        if (!r.read(1, bit)) return false;
+        if (bit != 0) {
+            if (!r.read(1, bit)) return false;
+            if (bit != 0) {
+                quint64 lead = 0;
+                quint64 sig = 0;
+                if (!r.read(5, lead) || !r.read(6, sig)) return false;
+                if (sig == 0) sig = 64;
+                if (lead + sig > 64) return false;
+                leading = static_cast<int>(lead);
+                trailing = 64 - leading - static_cast<int>(sig);
+            } else if (leading < 0) {
+                return false;
+            }
+            quint64 meaningful = 0;
+            if (!r.read(64 - leading - trailing, meaningful)) return false;
+            prev ^= meaningful << trailing;
+        }
+        out[i] = std::bit_cast<double>(prev);
+    }
+    return true;
+}
+
+// 字典下标：差分 + zigzag + varint，同一设备/指标的连续行各占 1 字节
+QByteArray encodeIds(const quint32* ids, std::size_t n) {
+    QByteArray out;
+    out.reserve(static_cast<qsizetype>(n));
+    qint64 prev = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        const qint64 d = static_cast<qint64>(ids[i]) - prev;
+        prev = ids[i];
+        quint64 z = (static_cast<quint64>(d) << 1) ^ static_cast<quint64>(d >> 63);
+        while (z >= 0x80) {
+            out.append(static_cast<char>((z & 0x7f) | 0x80));
+            z >>= 7;
+        }
+        out.append(static_cast<char>(z));
+    }
+    return out;
+}
+
+bool decodeIds(const QByteArray& bytes,
+               std::size_t n,
+               quint32 dictionarySize,
+               std::vector<quint32>& out) {
+    out.resize(n);
+    qsizetype pos = 0;
+    qint64 prev = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        quint64 z = 0;
+        int shift = 0;
+        while (true) {
+            if (pos >= bytes.size() || shift > 63) return false;
+            const quint8 byte = static_cast<quint8>(bytes[pos++]);
+            z |= static_cast<quint64>(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0) break;
+            shift += 7;
+        }
+        const qint64 d = static_cast<qint64>(z >> 1) ^ -static_cast<qint64>(z & 1);
+        prev += d;
+        // 损坏的段不能产生越过字典的下标
+        if (prev < 0 || prev >= static_cast<qint64>(dictionarySize)) return false;
+        out[i] = static_cast<quint32>(prev);
+    }
+    return true;
+}
+
+/**
+ * @brief 写入前按 (metric, device, ts) 排序的一行
+ */
+struct Row {
+    quint32 metric;
+    quint32 device;
+    qint64 ts;
+    double value;
+};
+
+QDataStream& operator<<(QDataStream& out, const BlockIndex& b) {
+    out << b.rows << b.minTs << b.maxTs << b.minValue << b.maxValue << b.minDevice << b.maxDevice
+        << b.minMetric << b.maxMetric;
+    for (int c = 0; c < kColumnCount; ++c) out << b.offset[c] << b.size[c];
+    return out;
+}
+
+QDataStream& operator>>(QDataStream& in, BlockIndex& b) {
+    in >> b.rows >> b.minTs >> b.maxTs >> b.minValue >> b.maxValue >> b.minDevice >> b.maxDevice >>
+        b.minMetric >> b.maxMetric;
+    for (int c = 0; c < kColumnCount; ++c) in >> b.offset[c] >> b.size[c];
+    return in;
+}
+
+QStringList sortedDictionary(QStringList values) {
+    values.sort();
+    values.removeDuplicates();
+    return values;
+}
+
+bool fail(QString* error, const QString& message) {
+    if (error) *error = message;
+    return false;
+}
+
+QString dayDirectory(qint64 day) {
+    return QDateTime::fromMSecsSinceEpoch(day * kDayMs, QTimeZone::UTC)
+        .date()
+        .toString(QStringLiteral("yyyyMMdd"));
+}
+
+qint64 floorDay(qint64 ms) {
+    const qint64 q = ms / kDayMs;
+    return (ms % kDayMs != 0 && ms < 0) ? q - 1 : q;
+}
+
+}  // namespace
+
+void ColumnRows::clear() {
+    devices.clear();
+    metrics.clear();
+    deviceIds.clear();
+    metricIds.clear();
+    timestamps.clear();
+    values.clear();
+    rows = 0;
+}
+
+bool writeSegment(const QString& path,
+                  const QVector<TelemetryPoint>& points,
+                  const SegmentWriteOptions& options,
+                  QString* error) {
+    QStringList deviceNames;
+    QStringList metricNames;
+    for (const TelemetryPoint& p : points) {
+        if (p.deviceId.isEmpty() || p.metric.isEmpty() || !std::isfinite(p.value)) continue;
+        deviceNames.append(p.deviceId);
+        metricNames.append(p.metric);
+    }
+    if (deviceNames.isEmpty()) return fail(error, QStringLiteral("no valid telemetry points"));
+
+    // 排序字典：块内下标范围可以直接用于按设备/指标排除块
+    const QStringList devices = sortedDictionary(std::move(deviceNames));
+    const QStringList metrics = sortedDictionary(std::move(metricNames));
+    QHash<QString, quint32> deviceIndex;
+    QHash<QString, quint32> metricIndex;
+    for (qsizetype i = 0; i < devices.size(); ++i) deviceIndex.insert(devices[i], i);
+    for (qsizetype i = 0; i < metrics.size(); ++i) metricIndex.insert(metrics[i], i);
+
+    std::vector<Row> rows;
+    rows.reserve(static_cast<std::size_t>(points.size()));
+    for (const TelemetryPoint& p : points) {
+        if (p.deviceId.isEmpty() || p.metric.isEmpty() || !std::isfinite(p.value)) continue;
+        rows.push_back({metricIndex.value(p.metric), deviceIndex.value(p.deviceId), p.timestampMs,
+                        p.value});
+    }
+    std::sort(rows.begin(), rows.end(), [](const Row& a, const Row& b) {
+        if (a.metric != b.metric) return a.metric < b.metric;
+        if (a.device != b.device) return a.device < b.device;
+        return a.ts < b.ts;
+    });
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) return fail(error, file.errorString());
+    QDataStream header(&file);
+    header << kSegmentMagic;
+
+    const std::size_t blockRows = static_cast<std::size_t>(std::max(1, options.rowsPerBlock));
+    std::vector<BlockIndex> blocks;
+    std::vector<quint32> deviceIds;
+    std::vector<quint32> metricIds;
+    std::vector<qint64> timestamps;
+    std::vector<double> values;
+    for (std::size_t begin = 0; begin < rows.size(); begin += blockRows) {
+        const std::size_t n = std::min(blockRows, rows.size() - begin);
+        deviceIds.resize(n);
+        metricIds.resize(n);
+        timestamps.resize(n);
+        values.resize(n);
+        BlockIndex block;
+        block.rows = static_cast<quint32>(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            const Row& row = rows[begin + i];
+            deviceIds[i] = row.device;
+            metricIds[i] = row.metric;
+            timestamps[i] = row.ts;
+            values[i] = row.value;
+        }
+        // 行已按 metric 排序，指标范围取首尾即可
+        block.minMetric = metricIds.front();
+        block.maxMetric = metricIds.back();
+        const auto [minDevice, maxDevice] = std::minmax_element(deviceIds.begin(), deviceIds.end());
+        const auto [minTs, maxTs] = std::minmax_element(timestamps.begin(), timestamps.end());
+        const auto [minValue, maxValue] = std::minmax_element(values.begin(), values.end());
+        block.minDevice = *minDevice;
+        block.maxDevice = *maxDevice;
+        block.minTs = *minTs;
+        block.maxTs = *maxTs;
+        block.minValue = *minValue;
+        block.maxValue = *maxValue;
+
+        const QByteArray encoded[kColumnCount] = {
+            encodeIds(deviceIds.data(), n),
+            encodeIds(metricIds.data(), n),
+            encodeTimestamps(timestamps.data(), n),
+            encodeValues(values.data(), n),
+        };
+        for (int c = 0; c < kColumnCount; ++c) {
+            block.offset[c] = static_cast<quint64>(file.pos());
+            block.size[c] = static_cast<quint32>(encoded[c].size());
+            if (file.write(encoded[c]) != encoded[c].size()) {
+                file.cancelWriting();
+                return fail(error, file.errorString());
+            }
+        }
+        blocks.push_back(block);
+    }
+
+    const quint64 footerOffset = static_cast<quint64>(file.pos());
+    QDataStream footer(&file);
+    footer.setVersion(QDataStream::Qt_6_0);
+    footer << kFormatVersion << devices << metrics << static_cast<quint32>(blocks.size());
+    for (const BlockIndex& block : blocks) footer << block;
+    footer << footerOffset << kSegmentMagic;
+    if (footer.status() != QDataStream::Ok) {
+        file.cancelWriting();
+        return fail(error, QStringLiteral("failed to write segment footer"));
+    }
+    if (!file.commit()) return fail(error, file.errorString());
+    return true;
+}
+
+bool writeDaySegments(const QString& root,
+                      const QVector<TelemetryPoint>& points,
+                      const SegmentWriteOptions& options,
+                      QString* error) {
+    QHash<qint64, QVector<TelemetryPoint>> byDay;
+    for (const TelemetryPoint& p : points) byDay[floorDay(p.timestampMs)].append(p);
+
+    bool ok = true;
+    for (auto it = byDay.cbegin(); it != byDay.cend(); ++it) {
+        QDir dir(root);
+        const QString day = dayDirectory(it.key());
+        if (!dir.mkpath(day)) {
+            ok = fail(error, QStringLiteral("cannot create segment directory %1").arg(day));
+            continue;
+        }
+        // 文件名以首个时间戳开头，同一天内按名字排序即大致按时间排序
+        qint64 first = it.value().front().timestampMs;
+        for (const TelemetryPoint& p : it.value()) first = std::min(first, p.timestampMs);
+        const QString name = QStringLiteral("seg_%1_%2.ccseg")
+                                 .arg(first)
+                                 .arg(QUuid::createUuid().toString(QUuid::Id128).left(8));
+        if (!writeSegment(dir.filePath(day + QLatin1Char('/') + name), it.value(), options, error))
+            ok = false;
+    }
+    return ok;
+}
+
+QStringList segmentFiles(const QString& root, qint64 fromMs, qint64 toMs) {
+    QStringList files;
+    if (toMs < fromMs) return files;
+    const QDir dir(root);
+    const QString first = dayDirectory(floorDay(fromMs));
+    const QString last = dayDirectory(floorDay(toMs));
+    // 目录名 yyyyMMdd 的字典序即日期顺序
+    for (const QString& day : dir.entryList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name)) {
+        if (day.size() != 8 || day < first || day > last) continue;
+        const QDir dayDir(dir.filePath(day));
+        for (const QString& name :
+             dayDir.entryList({QStringLiteral("*.ccseg")}, QDir::Files, QDir::Name)) {
+            files << dayDir.filePath(name);
+        }
+    }
+    return files;
+}
+
+int removeExpiredSegments(const QString& root, qint64 cutoffMs) {
+    QDir dir(root);
+    if (!dir.exists()) return 0;
+    int removed = 0;
+    for (const QString& day : dir.entryList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name)) {
+        const QDate date = QDate::fromString(day, QStringLiteral("yyyyMMdd"));
+        if (!date.isValid()) continue;
+        const qint64 endMs =
+            QDateTime(date.addDays(1), QTime(0, 0), QTimeZone::UTC).toMSecsSinceEpoch();
+        if (endMs > cutoffMs) continue;
+        if (QDir(dir.filePath(day)).removeRecursively()) {
+            ++removed;
+        } else if (auto logger = segmentLogger()) {
+            logger->warn("Failed to remove expired segment directory {}", day.toStdString());
+        }
+    }
+    return removed;
+}
+
+bool SegmentReader::open(const QString& path) {
+    close();
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        m_error = m_file.errorString();
+        return false;
+    }
+    const qint64 size = m_file.size();
+    QDataStream in(&m_file);
+    in.setVersion(QDataStream::Qt_6_0);
+    quint64 magic = 0;
+    quint64 footerOffset = 0;
+    if (size >= static_cast<qint64>(sizeof(quint64)) + kTrailerSize && m_file.seek(0)) {
+        in >> magic;
+    }
+    if (magic == kSegmentMagic && m_file.seek(size - kTrailerSize)) {
+        magic = 0;
+        in >> footerOffset >> magic;
+    }
+    if (magic != kSegmentMagic || footerOffset >= static_cast<quint64>(size - kTrailerSize) ||
+        !m_file.seek(static_cast<qint64>(footerOffset))) {
+        m_error = QStringLiteral("not a telemetry segment: %1").arg(path);
+        close();
+        return false;
+    }
+
+    quint32 version = 0;
+    quint32 blockCount = 0;
+    in >> version;
+    if (version != kFormatVersion) {
+        m_error = QStringLiteral("unsupported segment version %1").arg(version);
+        close();
+        return false;
+    }
+    in >> m_devices >> m_metrics >> blockCount;
+    // 每个块索引至少占 16 字节，明显超出文件大小的块数说明段尾已损坏
+    if (in.status() != QDataStream::Ok || blockCount > static_cast<quint64>(size) / 16) {
+        m_error = QStringLiteral("corrupt segment footer: %1").arg(path);
+        close();
+        return false;
+    }
+    m_blocks.resize(blockCount);
+    for (BlockIndex& block : m_blocks) {
+        in >> block;
+        m_rows += block.rows;
+    }
+    if (in.status() != QDataStream::Ok) {
+        m_error = QStringLiteral("corrupt segment footer: %1").arg(path);
+        close();
+        return false;
+    }
+    return true;
+}
+
+void SegmentReader::close() {
+    if (m_file.isOpen()) m_file.close();
+    m_devices.clear();
+    m_metrics.clear();
+    m_blocks.clear();
+    m_rows = 0;
+}
+
+bool SegmentReader::readColumn(const BlockIndex& block,
+                               int column,
+                               QByteArray& bytes,
+                               ScanStats& stats) {
+    if (!m_file.seek(static_cast<qint64>(block.offset[column]))) return false;
+    bytes = m_file.read(block.size[column]);
+    stats.bytesRead += bytes.size();
+    return bytes.size() == static_cast<qsizetype>(block.size[column]);
+}
+
+bool SegmentReader::scan(const ScanPredicate& predicate,
+                         unsigned columns,
+                         ColumnRows& out,
+                         ScanStats* stats) {
+    out.clear();
+    ScanStats local;
+    local.blocksTotal = blocks();
+    const auto finish = [&](bool ok) {
+        if (stats) *stats = local;
+        return ok;
+    };
+    if (!m_file.isOpen()) {
+        m_error = QStringLiteral("segment not open");
+        return finish(false);
+    }
+    out.devices = m_devices;
+    out.metrics = m_metrics;
+
+    // 谓词中的名字先换成字典下标；字典中不存在则整段无匹配
+    const bool filterMetric = !predicate.metric.isEmpty();
+    quint32 metricId = 0;
+    if (filterMetric) {
+        const auto it = std::lower_bound(m_metrics.cbegin(), m_metrics.cend(), predicate.metric);
+        if (it == m_metrics.cend() || *it != predicate.metric) return finish(true);
+        metricId = static_cast<quint32>(it - m_metrics.cbegin());
+    }
+    const bool filterDevice = !predicate.devices.isEmpty();
+    std::vector<quint8> allowedDevice;
+    quint32 minAllowed = std::numeric_limits<quint32>::max();
+    quint32 maxAllowed = 0;
+    if (filterDevice) {
+        allowedDevice.assign(static_cast<std::size_t>(m_devices.size()), 0);
+        for (const QString& device : predicate.devices) {
+            const auto it = std::lower_bound(m_devices.cbegin(), m_devices.cend(), device);
+            if (it == m_devices.cend() || *it != device) continue;
+            const auto id = static_cast<quint32>(it - m_devices.cbegin());
+            allowedDevice[id] = 1;
+            minAllowed = std::min(minAllowed, id);
+            maxAllowed = std::max(maxAllowed, id);
+        }
+        if (minAllowed > maxAllowed) return finish(true);
+    }
+    const bool filterTs = predicate.fromMs != std::numeric_limits<qint64>::min() ||
+                          predicate.toMs != std::numeric_limits<qint64>::max();
+    const bool filterValue = std::isfinite(predicate.minValue) || std::isfinite(predicate.maxValue);
+
+    const unsigned needed = columns | (filterDevice ? DeviceColumn : 0u) |
+                            (filterMetric ? MetricColumn : 0u) |
+                            (filterTs ? TimestampColumn : 0u) | (filterValue ? ValueColumn : 0u);
+
+    std::vector<quint32> deviceIds;
+    std::vector<quint32> metricIds;
+    std::vector<qint64> timestamps;
+    std::vector<double> values;
+    std::vector<quint8> selected;
+    QByteArray bytes;
+    for (const BlockIndex& block : m_blocks) {
+        // 稀疏索引：块的取值范围与谓词不相交时整块跳过，不读取任何列
+        if (filterMetric && (metricId < block.minMetric || metricId > block.maxMetric)) continue;
+        if (filterDevice && (maxAllowed < block.minDevice || minAllowed > block.maxDevice))
+            continue;
+        if (block.maxTs < predicate.fromMs || block.minTs > predicate.toMs) continue;
+        if (block.maxValue < predicate.minValue || block.minValue > predicate.maxValue) continue;
+        ++local.blocksRead;
+
+        const std::size_t n = block.rows;
+        bool ok = true;
+        if (ok && (needed & DeviceColumn)) {
+            ok = readColumn(block, kDeviceColumn, bytes, local) &&
+                 decodeIds(bytes, n, m_devices.size(), deviceIds);
+        }
+        if (ok && (needed & MetricColumn)) {
+            ok = readColumn(block, kMetricColumn, bytes, local) &&
+                 decodeIds(bytes, n, m_metrics.size(), metricIds);
+        }
+        if (ok && (needed & TimestampColumn)) {
+            ok = readColumn(block, kTimestampColumn, bytes, local) &&
+                 decodeTimestamps(bytes, n, timestamps);
+        }
+        if (ok && (needed & ValueColumn)) {
+            ok = readColumn(block, kValueColumn, bytes, local) && decodeValues(bytes, n, values);
+        }
+        if (!ok) {
+            m_error = QStringLiteral("corrupt segment block in %1").arg(m_file.fileName());
+            return finish(false);
+        }
+
+        // 选择向量：各谓词按列整块计算，循环内无分支，便于编译器向量化
+        selected.assign(n, 1);
+        if (filterMetric) {
+            for (std::size_t i = 0; i < n; ++i) selected[i] &= metricIds[i] == metricId;
+        }
+        if (filterDevice) {
+            for (std::size_t i = 0; i < n; ++i) selected[i] &= allowedDevice[deviceIds[i]];
+        }
+        if (filterTs) {
+            const qint64 from = predicate.fromMs;
+            const qint64 to = predicate.toMs;
+            for (std::size_t i = 0; i < n; ++i) {
+                selected[i] &= static_cast<quint8>((timestamps[i] >= from) & (timestamps[i] <= to));
+            }
+        }
+        if (filterValue) {
+            const double lo = predicate.minValue;
+            const double hi = predicate.maxValue;
+            for (std::size_t i = 0; i < n; ++i) {
+                selected[i] &= static_cast<quint8>((values[i] >= lo) & (values[i] <= hi));
+            }
+        }
+
+        for (std::size_t i = 0; i < n; ++i) {
+            if (!selected[i]) continue;
+            if (columns & DeviceColumn) out.deviceIds.push_back(deviceIds[i]);
+            if (columns & MetricColumn) out.metricIds.push_back(metricIds[i]);
+            if (columns & TimestampColumn) out.timestamps.push_back(timestamps[i]);
+            if (columns & ValueColumn) out.values.push_back(values[i]);
+            ++out.rows;
+        }
+    }
+    return finish(true);
+}
+
+}  // namespace storage::columnar
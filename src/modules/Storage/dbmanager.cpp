@@ -2,12 +2,16 @@
 
 #include <QDir>
 #include <QFileInfo>
+#include <QHash>
 #include <QStandardPaths>
+#include <QStringList>
 #include <QUuid>
 #include <QtSql/QSqlError>
 #include <QtSql/QSqlQuery>
+#include <memory>
 
 #include "logging.h"
+#include "schema.h"
 // 使用 config 模块提供配置
 #include "modules/Config/config.h"
 
@@ -15,6 +19,48 @@ namespace storage {
 
 auto l = logging::Logger("DbManager");
 
+namespace {
+
+// 每个连接缓存的预编译语句数量告警阈值；语句文本基本是固定集合，超出说明调用方拼接了参数
+constexpr int kStatementCacheWarnSize = 256;
+
+bool isSqlite(const QString& driver) {
+    return driver.compare("QSQLITE", Qt::CaseInsensitive) == 0;
+}
+
+/**
+ * @brief 当前线程持有的连接；线程退出时析构并移除连接
+ */
+struct ThreadConnection {
+    QString name;
+    quint64 generation = 0;
+    quint64 pragmaGeneration = 0;
+    QSqlDatabase db;
+    // 按 SQL 文本缓存的预编译语句；用指针保存，插入新语句不会使已返回的引用失效
+    QHash<QString, std::shared_ptr<QSqlQuery>> statements;
+
+    ~ThreadConnection() { release(); }
+
+    void release() {
+        if (name.isEmpty()) return;
+        try {
+            // 语句必须先于连接释放
+            statements.clear();
+            if (db.isOpen()) db.close();
+            // removeDatabase 要求不再有引用该连接的 QSqlDatabase 对象
+            db = QSqlDatabase();
+            QSqlDatabase::removeDatabase(name);
+        } catch (...) {}
+        name.clear();
+        generation = 0;
+        pragmaGeneration = 0;
+    }
+};
+
+thread_local ThreadConnection t_connection;
+
+}  // namespace
+
 DbManager& DbManager::instance() {
     static DbManager inst;
     return inst;
@@ -27,88 +73,107 @@ bool DbManager::init(bool force) noexcept {
         // If a previous connection exists, close it first when forcing
         if (m_initialized && force) close();
 
-        // Build a unique connection name to avoid clashing with others
-        m_connectionName =
-            QStringLiteral("crosscontrol_connection_%1").arg(QUuid::createUuid().toString());
-
         // 从 config 模块读取 Storage 相关配置
         auto& cfgm = config::ConfigManager::instance();
         // 必要配置项：driver, database（如果缺失则写入默认值）
-        const QString driver = cfgm.setOrDefault("Storage/driver", QString("QSQLITE")).toString();
-        const QString database = cfgm.setOrDefault("Storage/database", QString()).toString();
-        const bool foreignKeys = cfgm.setOrDefault("Storage/foreignKeys", true).toBool();
+        Settings settings;
+        settings.driver = cfgm.setOrDefault("Storage/driver", QString("QSQLITE")).toString();
+        settings.database = cfgm.setOrDefault("Storage/database", QString()).toString();
+        settings.foreignKeys = cfgm.setOrDefault("Storage/foreignKeys", true).toBool();
+        // SQLite 调优：WAL 允许读写并发，NORMAL 在 WAL 下只在检查点时 fsync
+        settings.journalMode = cfgm.setOrDefault("Storage/journalMode", QString("WAL")).toString();
+        settings.synchronous =
+            cfgm.setOrDefault("Storage/synchronous", QString("NORMAL")).toString();
+        settings.busyTimeoutMs = cfgm.setOrDefault("Storage/busyTimeoutMs", 5000).toInt();
+        settings.cacheSizeKiB = cfgm.setOrDefault("Storage/cacheSizeKiB", 16384).toInt();
+        settings.mmapSizeMiB = cfgm.setOrDefault("Storage/mmapSizeMiB", 256).toLongLong();
 
-        if (database.isEmpty()) {
+        if (settings.database.isEmpty()) {
             l.info("Storage/database is empty in config even after setOrDefault");
             return false;
         }
 
         l.info("Initializing database with driver '{}' at '{}'",
-               driver.toStdString(),
-               database.toStdString());
-
-        // Ensure parent folder for file-based DB exists
-        if (driver.compare("QSQLITE", Qt::CaseInsensitive) == 0) {
-            QFileInfo fi(database);
-            QDir dir = fi.dir();
-            if (!dir.exists()) dir.mkpath(".");
+               settings.driver.toStdString(),
+               settings.database.toStdString());
+
+        if (isSqlite(settings.driver)) {
+            if (settings.database == QStringLiteral(":memory:")) {
+                // 每个线程各有一个连接，普通内存库无法共享；改用命名的共享缓存内存库
+                settings.database = QStringLiteral("file:crosscontrol_%1?mode=memory&cache=shared")
+                                        .arg(QUuid::createUuid().toString(QUuid::Id128));
+                settings.connectOptions = QStringLiteral("QSQLITE_OPEN_URI");
+            } else {
+                // Ensure parent folder for file-based DB exists
+                QFileInfo fi(settings.database);
+                QDir dir = fi.dir();
+                if (!dir.exists()) dir.mkpath(".");
+            }
         }
 
-        m_db = QSqlDatabase::addDatabase(driver, m_connectionName);
-        m_db.setDatabaseName(database);
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_settings = settings;
+            // Build a unique connection name to avoid clashing with others
+            m_connectionPrefix =
+                QStringLiteral("crosscontrol_connection_%1").arg(QUuid::createUuid().toString());
+            ++m_generation;
+        }
 
-        if (!m_db.open()) {
-            l.warn("Failed to open database: {}", m_db.lastError().text().toStdString());
+        QString error;
+        if (!openThreadConnection(error)) {
             // 如果打开失败，尝试回退到用户可写位置（例如 AppDataLocation）以避免在 Program Files
             // 下无写权限导致失败
             l.warn("Initial DB open failed, attempting fallback to user data directory. Error: {}",
-                   m_db.lastError().text().toStdString());
+                   error.toStdString());
 
             const QString fallbackDir =
                 QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
-            if (!fallbackDir.isEmpty()) {
-                QDir fd(fallbackDir);
-                if (!fd.exists()) fd.mkpath(".");
-                const QString fallbackDb = fd.filePath("crosscontrol.db");
-                l.info("Attempting fallback DB at {}", fallbackDb.toStdString());
-
-                // remove the failing connection and create a fresh one with same name
-                if (m_db.isOpen()) m_db.close();
-                QSqlDatabase::removeDatabase(m_connectionName);
-                m_db = QSqlDatabase::addDatabase(driver, m_connectionName);
-                m_db.setDatabaseName(fallbackDb);
-                if (m_db.open()) {
-                    l.info("Fallback DB opened successfully at {}", fallbackDb.toStdString());
-                    // persist this new path to config for future runs
-                    try {
-                        auto& cfgm = config::ConfigManager::instance();
-                        cfgm.setValue("Storage/database", fallbackDb);
-                        cfgm.sync();
-                    } catch (...) { l.warn("Failed to persist fallback DB path to config"); }
-                } else {
-                    l.warn("Fallback DB open also failed: {}",
-                           m_db.lastError().text().toStdString());
-                    QSqlDatabase::removeDatabase(m_connectionName);
-                    m_connectionName.clear();
-                    return false;
-                }
-            } else {
+            if (fallbackDir.isEmpty()) {
                 l.warn("No writable AppDataLocation available for fallback");
-                QSqlDatabase::removeDatabase(m_connectionName);
-                m_connectionName.clear();
                 return false;
             }
+            QDir fd(fallbackDir);
+            if (!fd.exists()) fd.mkpath(".");
+            const QString fallbackDb = fd.filePath("crosscontrol.db");
+            l.info("Attempting fallback DB at {}", fallbackDb.toStdString());
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_settings.database = fallbackDb;
+                m_settings.connectOptions.clear();
+            }
+            if (!openThreadConnection(error)) {
+                l.warn("Fallback DB open also failed: {}", error.toStdString());
+                return false;
+            }
+            l.info("Fallback DB opened successfully at {}", fallbackDb.toStdString());
+            // persist this new path to config for future runs
+            try {
+                cfgm.setValue("Storage/database", fallbackDb);
+                cfgm.sync();
+            } catch (...) { l.warn("Failed to persist fallback DB path to config"); }
         }
 
-        // Set PRAGMA foreign_keys = ON for SQLite if requested
-        if (cfgm.getString("Storage/driver", QString("QSQLITE"))
-                    .compare("QSQLITE", Qt::CaseInsensitive) == 0 &&
-            foreignKeys) {
-            QSqlQuery q(m_db);
-            if (!q.exec("PRAGMA foreign_keys = ON;")) {
-                l.warn("Failed to enable foreign_keys: {}", q.lastError().text().toStdString());
+        // 结构迁移只在初始化时执行一次，读写路径不再执行 DDL
+        {
+            const auto lock = writeLock();
+            if (!schema::migrate(t_connection.db)) {
+                l.warn("Schema migration incomplete (at version {} of {})",
+                       schema::currentVersion(t_connection.db),
+                       schema::latestVersion());
             }
         }
+
+        // 运行时修改 Storage/* （包括配置文件热加载）时更新连接参数
+        if (m_configSubscription == 0) {
+            m_configSubscription = cfgm.subscribe(
+                QStringLiteral("Storage"),
+                [this](const config::ConfigSnapshot& snapshot, const QStringList& keys) {
+                    onConfigChanged(snapshot, keys);
+                });
+        }
+
         // 不再保存本地结构体 m_cfg
         m_initialized = true;
         return true;
@@ -120,18 +185,158 @@ bool DbManager::init(bool force) noexcept {
 
 QSqlDatabase& DbManager::db() {
     if (!m_initialized) throw std::runtime_error("DbManager not initialized");
-    return m_db;
+    if (t_connection.generation != m_generation.load() || !t_connection.db.isOpen()) {
+        QString error;
+        if (!openThreadConnection(error)) {
+            throw std::runtime_error("Failed to open database connection: " + error.toStdString());
+        }
+    } else if (t_connection.pragmaGeneration != m_pragmaGeneration.load()) {
+        Settings settings;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            settings = m_settings;
+            t_connection.pragmaGeneration = m_pragmaGeneration.load();
+        }
+        if (isSqlite(settings.driver)) applyPragmas(t_connection.db, settings);
+    }
+    return t_connection.db;
+}
+
+QSqlQuery& DbManager::prepared(const QString& sql) {
+    QSqlDatabase& connection = db();
+    const auto cached = t_connection.statements.constFind(sql);
+    if (cached != t_connection.statements.cend()) {
+        cached.value()->finish();
+        return *cached.value();
+    }
+
+    auto query = std::make_shared<QSqlQuery>(connection);
+    if (!query->prepare(sql)) {
+        throw std::runtime_error("Failed to prepare statement: " +
+                                 query->lastError().text().toStdString());
+    }
+    t_connection.statements.insert(sql, query);
+    if (t_connection.statements.size() == kStatementCacheWarnSize) {
+        l.warn("Prepared statement cache holds {} statements on connection {}",
+               kStatementCacheWarnSize,
+               t_connection.name.toStdString());
+    }
+    return *query;
+}
+
+std::unique_lock<std::recursive_mutex> DbManager::writeLock() {
+    return std::unique_lock<std::recursive_mutex>(m_writeMutex);
 }
 
 void DbManager::close() {
     if (!m_initialized) return;
 
-    try {
-        if (m_db.isOpen()) m_db.close();
-        if (!m_connectionName.isEmpty()) QSqlDatabase::removeDatabase(m_connectionName);
-    } catch (...) {}
-    m_connectionName.clear();
+    // 其它线程的连接只能由所属线程关闭，递增代数后它们会在下次使用时重新打开
+    ++m_generation;
+    t_connection.release();
     m_initialized = false;
 }
 
+bool DbManager::openThreadConnection(QString& error) {
+    t_connection.release();
+
+    Settings settings;
+    QString name;
+    quint64 generation = 0;
+    quint64 pragmaGeneration = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        settings = m_settings;
+        name = QStringLiteral("%1_%2").arg(m_connectionPrefix).arg(++m_connectionSerial);
+        generation = m_generation.load();
+        pragmaGeneration = m_pragmaGeneration.load();
+    }
+
+    QSqlDatabase db = QSqlDatabase::addDatabase(settings.driver, name);
+    db.setDatabaseName(settings.database);
+    if (!settings.connectOptions.isEmpty()) db.setConnectOptions(settings.connectOptions);
+    if (!db.open()) {
+        error = db.lastError().text();
+        db = QSqlDatabase();
+        QSqlDatabase::removeDatabase(name);
+        return false;
+    }
+    if (isSqlite(settings.driver)) applyPragmas(db, settings);
+
+    t_connection.name = name;
+    t_connection.generation = generation;
+    t_connection.pragmaGeneration = pragmaGeneration;
+    t_connection.db = db;
+    l.debug("Opened database connection {}", name.toStdString());
+    return true;
+}
+
+void DbManager::onConfigChanged(const config::ConfigSnapshot& snapshot, const QStringList& keys) {
+    bool pragmasChanged = false;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (const QString& key : keys) {
+            if (key == QLatin1String("Storage/busyTimeoutMs")) {
+                m_settings.busyTimeoutMs = snapshot.getInt(key, 5000);
+            } else if (key == QLatin1String("Storage/cacheSizeKiB")) {
+                m_settings.cacheSizeKiB = snapshot.getInt(key, 16384);
+            } else if (key == QLatin1String("Storage/mmapSizeMiB")) {
+                m_settings.mmapSizeMiB = snapshot.value(key, 256).toLongLong();
+            } else if (key == QLatin1String("Storage/synchronous")) {
+                m_settings.synchronous = snapshot.getString(key, QStringLiteral("NORMAL"));
+            } else if (key == QLatin1String("Storage/journalMode")) {
+                m_settings.journalMode = snapshot.getString(key, QStringLiteral("WAL"));
+            } else if (key == QLatin1String("Storage/foreignKeys")) {
+                m_settings.foreignKeys = snapshot.getBool(key, true);
+            } else {
+                if (key == QLatin1String("Storage/driver") ||
+                    key == QLatin1String("Storage/database")) {
+                    l.warn("{} changed, takes effect after restart or init(force)",
+                           key.toStdString());
+                }
+                continue;
+            }
+            pragmasChanged = true;
+        }
+    }
+    if (!pragmasChanged) return;
+    // 各线程的连接只能在所属线程上执行 PRAGMA，递增代数后在下次 db() 时重新应用
+    ++m_pragmaGeneration;
+    l.info("Storage connection settings changed, reapplying pragmas on next use");
+}
+
+void DbManager::applyPragmas(QSqlDatabase& db, const Settings& settings) {
+    QStringList pragmas;
+    // busy_timeout 放在最前：切换 journal_mode 需要短暂的排它锁
+    if (settings.busyTimeoutMs > 0) {
+        pragmas << QStringLiteral("PRAGMA busy_timeout = %1").arg(settings.busyTimeoutMs);
+    }
+    if (!settings.journalMode.isEmpty()) {
+        pragmas << QStringLiteral("PRAGMA journal_mode = %1").arg(settings.journalMode);
+    }
+    if (!settings.synchronous.isEmpty()) {
+        pragmas << QStringLiteral("PRAGMA synchronous = %1").arg(settings.synchronous);
+    }
+    if (settings.cacheSizeKiB > 0) {
+        // 负值表示以 KiB 为单位
+        pragmas << QStringLiteral("PRAGMA cache_size = -%1").arg(settings.cacheSizeKiB);
+    }
+    if (settings.mmapSizeMiB > 0) {
+        pragmas << QStringLiteral("PRAGMA mmap_size = %1").arg(settings.mmapSizeMiB * 1024 * 1024);
+    }
+    pragmas << QStringLiteral("PRAGMA temp_store = MEMORY");
+    // 显式写出 OFF，运行时关闭外键检查时也能生效
+    pragmas << QStringLiteral("PRAGMA foreign_keys = %1")
+                   .arg(settings.foreignKeys ? QStringLiteral("ON") : QStringLiteral("OFF"));
+
+    QSqlQuery q(db);
+    for (const QString& pragma : pragmas) {
+        if (!q.exec(pragma)) {
+            l.warn("Failed to apply '{}': {}",
+                   pragma.toStdString(),
+                   q.lastError().text().toStdString());
+        }
+    }
+}
+
 }  // namespace storage
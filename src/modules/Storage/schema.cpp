@@ -0,0 +1,243 @@
+﻿#include "schema.h"
+
+#include <QtSql/QSqlError>
+#include <QtSql/QSqlQuery>
+#include <algorithm>
+
+#include "logging.h"
+
+namespace storage::schema {
+
+namespace {
+
+std::shared_ptr<spdlog::logger> schemaLogger() {
+    return logging::LoggerManager::instance().getLogger("Storage.Schema");
+}
+
+bool execAll(QSqlDatabase& db, const QStringList& statements) {
+    QSqlQuery q(db);
+    for (const QString& sql : statements) {
+        if (q.exec(sql)) continue;
+        if (auto logger = schemaLogger()) {
+            logger->error("Schema statement failed: {} ({})",
+                          sql.toStdString(),
+                          q.lastError().text().toStdString());
+        }
+        return false;
+    }
+    return true;
+}
+
+bool tableExists(QSqlDatabase& db, const QString& table) {
+    QSqlQuery q(db);
+    q.prepare(QStringLiteral("SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = ?"));
+    q.addBindValue(table);
+    return q.exec() && q.next();
+}
+
+// 1: 动作表与设备表（原先散落在 saveAction / DeviceGateway 中的 CREATE TABLE）
+bool createBaseTables(QSqlDatabase& db) {
+    QStringList statements;
+    for (const QString& table : actionTables()) {
+        statements << QStringLiteral(
+                          "CREATE TABLE IF NOT EXISTS %1 (name TEXT PRIMARY KEY, payload BLOB, "
+                          "created_at TEXT)")
+                          .arg(table);
+    }
+    statements << QStringLiteral(
+        "CREATE TABLE IF NOT EXISTS devices ("
+        "id TEXT PRIMARY KEY,"
+        "name TEXT,"
+        "status TEXT,"
+        "endpoint TEXT,"
+        "type TEXT,"
+        "hw_info TEXT,"
+        "firmware_version TEXT,"
+        "owner TEXT,"
+        "group_name TEXT,"
+        "last_seen INTEGER,"
+        "metadata TEXT"
+        ")");
+    return execAll(db, statements);
+}
+
+// 2: 旧版 actions 表迁入按类型划分的表
+bool importLegacyActionTable(QSqlDatabase& db) {
+    return importLegacyActions(db) >= 0;
+}
+
+// 3: 热点查询索引；loadActions 按 created_at 倒序取前 100 条可以直接沿索引反向扫描
+bool createQueryIndexes(QSqlDatabase& db) {
+    QStringList statements{
+        QStringLiteral("CREATE INDEX IF NOT EXISTS idx_devices_group_name ON devices(group_name)"),
+        QStringLiteral("CREATE INDEX IF NOT EXISTS idx_devices_status ON devices(status)"),
+        QStringLiteral("CREATE INDEX IF NOT EXISTS idx_devices_last_seen ON devices(last_seen)")};
+    for (const QString& table : actionTables()) {
+        statements << QStringLiteral(
+                          "CREATE INDEX IF NOT EXISTS idx_%1_created_at ON %1(created_at)")
+                          .arg(table);
+    }
+    return execAll(db, statements);
+}
+
+// 4: 遥测分区目录；分区表本身在首次写入对应日期/月份时由 TelemetryStore 创建
+bool createTelemetryCatalog(QSqlDatabase& db) {
+    return execAll(db,
+                   {QStringLiteral("CREATE TABLE IF NOT EXISTS telemetry_partitions ("
+                                   "name TEXT PRIMARY KEY,"
+                                   "resolution INTEGER NOT NULL,"
+                                   "start_ms INTEGER NOT NULL,"
+                                   "end_ms INTEGER NOT NULL"
+                                   ")"),
+                    QStringLiteral("CREATE INDEX IF NOT EXISTS idx_telemetry_partitions_range ON "
+                                   "telemetry_partitions(resolution, start_ms)")});
+}
+
+bool ensureVersionTable(QSqlDatabase& db) {
+    return execAll(db,
+                   {QStringLiteral("CREATE TABLE IF NOT EXISTS schema_version ("
+                                   "version INTEGER PRIMARY KEY,"
+                                   "description TEXT,"
+                                   "applied_at TEXT"
+                                   ")")});
+}
+
+bool applyMigration(QSqlDatabase& db, const Migration& migration) {
+    auto logger = schemaLogger();
+    if (!db.transaction()) {
+        if (logger) {
+            logger->error("Cannot start transaction for migration {}: {}",
+                          migration.version,
+                          db.lastError().text().toStdString());
+        }
+        return false;
+    }
+
+    bool ok = migration.apply(db);
+    if (ok) {
+        QSqlQuery q(db);
+        q.prepare(QStringLiteral(
+            "INSERT INTO schema_version(version, description, applied_at) "
+            "VALUES(?, ?, datetime('now'))"));
+        q.addBindValue(migration.version);
+        q.addBindValue(QString::fromUtf8(migration.description));
+        ok = q.exec();
+        if (!ok && logger) {
+            logger->error("Failed to record migration {}: {}",
+                          migration.version,
+                          q.lastError().text().toStdString());
+        }
+    }
+    if (ok) ok = db.commit();
+    if (!ok) {
+        db.rollback();
+        if (logger) {
+            logger->error("Migration {} ({}) failed and was rolled back",
+                          migration.version,
+                          migration.description);
+        }
+        return false;
+    }
+    if (logger) {
+        logger->info("Applied schema migration {} ({})", migration.version, migration.description);
+    }
+    return true;
+}
+
+}  // namespace
+
+QString actionsTable(const QString& type) {
+    if (type.compare("http", Qt::CaseInsensitive) == 0) return QStringLiteral("http_actions");
+    if (type.compare("tcp", Qt::CaseInsensitive) == 0) return QStringLiteral("tcp_actions");
+    if (type.compare("udp", Qt::CaseInsensitive) == 0) return QStringLiteral("udp_actions");
+    if (type.compare("serial", Qt::CaseInsensitive) == 0) return QStringLiteral("serial_actions");
+    return QString();
+}
+
+const QStringList& actionTables() {
+    static const QStringList tables{QStringLiteral("http_actions"),
+                                    QStringLiteral("tcp_actions"),
+                                    QStringLiteral("udp_actions"),
+                                    QStringLiteral("serial_actions")};
+    return tables;
+}
+
+const std::vector<Migration>& migrations() {
+    static const std::vector<Migration> all{
+        {1, "create action and device tables", &createBaseTables},
+        {2, "import legacy actions table", &importLegacyActionTable},
+        {3, "add indexes for device and action queries", &createQueryIndexes},
+        {4, "create telemetry partition catalog", &createTelemetryCatalog},
+    };
+    return all;
+}
+
+int latestVersion() {
+    return migrations().empty() ? 0 : migrations().back().version;
+}
+
+int currentVersion(QSqlDatabase& db) {
+    if (!tableExists(db, QStringLiteral("schema_version"))) return 0;
+    QSqlQuery q(db);
+    if (!q.exec(QStringLiteral("SELECT COALESCE(MAX(version), 0) FROM schema_version")) ||
+        !q.next()) {
+        return -1;
+    }
+    return q.value(0).toInt();
+}
+
+bool migrate(QSqlDatabase& db) {
+    auto logger = schemaLogger();
+    if (!ensureVersionTable(db)) return false;
+
+    const int current = currentVersion(db);
+    if (current < 0) {
+        if (logger) logger->error("Cannot read schema version");
+        return false;
+    }
+    if (current > latestVersion()) {
+        if (logger) {
+            logger->warn("Database schema version {} is newer than supported version {}",
+                         current,
+                         latestVersion());
+        }
+        return true;
+    }
+
+    for (const Migration& migration : migrations()) {
+        if (migration.version <= current) continue;
+        if (!applyMigration(db, migration)) return false;
+    }
+    return true;
+}
+
+int importLegacyActions(QSqlDatabase& db) {
+    if (!tableExists(db, QStringLiteral("actions"))) return 0;
+
+    static const QStringList types{QStringLiteral("http"),
+                                   QStringLiteral("tcp"),
+                                   QStringLiteral("udp"),
+                                   QStringLiteral("serial")};
+    int imported = 0;
+    QSqlQuery q(db);
+    for (const QString& type : types) {
+        // OR IGNORE：按类型表中已有的同名动作较新，不用旧表覆盖
+        q.prepare(QStringLiteral("INSERT OR IGNORE INTO %1 (name, payload, created_at) "
+                                 "SELECT name, payload, datetime('now') FROM actions "
+                                 "WHERE lower(type) = ?")
+                      .arg(actionsTable(type)));
+        q.addBindValue(type);
+        if (!q.exec()) {
+            if (auto logger = schemaLogger()) {
+                logger->error("Failed to import legacy {} actions: {}",
+                              type.toStdString(),
+                              q.lastError().text().toStdString());
+            }
+            return -1;
+        }
+        imported += std::max(0, q.numRowsAffected());
+    }
+    return imported;
+}
+
+}  // namespace storage::schema
@@ -3,8 +3,11 @@
 #include <QtSql/QSqlDatabase>
 #include <QtSql/QSqlError>
 #include <QtSql/QSqlQuery>
+#include <algorithm>
 
 #include "dbmanager.h"
+#include "schema.h"
+#include "write_behind.h"
 // use config to store requested DB path
 #include "modules/Config/config.h"
 
@@ -21,113 +24,110 @@ QSqlDatabase& Storage::db() {
     return DbManager::instance().db();
 }
 
-static QString actionsTableForType(const QString& type) {
-    if (type.compare("http", Qt::CaseInsensitive) == 0) return QStringLiteral("http_actions");
-    if (type.compare("tcp", Qt::CaseInsensitive) == 0) return QStringLiteral("tcp_actions");
-    if (type.compare("udp", Qt::CaseInsensitive) == 0) return QStringLiteral("udp_actions");
-    if (type.compare("serial", Qt::CaseInsensitive) == 0) return QStringLiteral("serial_actions");
-    return QStringLiteral("actions");
-}
+// 表在 DbManager::init 时由 schema::migrate 创建；语句按 SQL 文本缓存在当前线程的连接上
 
 bool Storage::saveAction(const QString& type, const QString& name, const QByteArray& payload) {
+    // 未知类型没有对应的表，直接拒绝
+    const QString table = schema::actionsTable(type);
+    if (table.isEmpty()) return false;
     try {
-        QSqlDatabase& d = DbManager::instance().db();
-        QSqlQuery q(d);
-        QString tbl = actionsTableForType(type);
-        // create table if not exists
-        q.exec(QString("CREATE TABLE IF NOT EXISTS %1 (name TEXT PRIMARY KEY, payload BLOB, "
-                       "created_at TEXT)")
-                   .arg(tbl));
-        QSqlQuery q2(d);
-        q2.prepare(
+        const auto writeLock = DbManager::instance().writeLock();
+        QSqlQuery& q = DbManager::instance().prepared(
             QString(
                 "INSERT OR REPLACE INTO %1 (name,payload,created_at) VALUES (?,?,datetime('now'))")
-                .arg(tbl));
-        q2.addBindValue(name);
-        q2.addBindValue(payload);
-        if (!q2.exec()) { return false; }
-        return true;
+                .arg(table));
+        q.bindValue(0, name);
+        q.bindValue(1, payload);
+        return q.exec();
     } catch (...) { return false; }
 }
 
+std::future<bool> Storage::saveActionAsync(const QString& type,
+                                           const QString& name,
+                                           const QByteArray& payload) {
+    return WriteBehindQueue::instance().submit(
+        [type, name, payload](QSqlDatabase&) { return saveAction(type, name, payload); });
+}
+
 QVector<QPair<QString, QString>> Storage::loadActions(const QString& type) {
     QVector<QPair<QString, QString>> out;
+    const QString table = schema::actionsTable(type);
+    if (table.isEmpty()) return out;
     try {
-        QSqlDatabase& d = DbManager::instance().db();
-        QSqlQuery q(d);
-        QString tbl = actionsTableForType(type);
-        q.exec(
-            QString("SELECT name, created_at FROM %1 ORDER BY created_at DESC LIMIT 100").arg(tbl));
+        QSqlQuery& q = DbManager::instance().prepared(
+            QString("SELECT name, created_at FROM %1 ORDER BY created_at DESC LIMIT 100")
+                .arg(table));
+        if (!q.exec()) return out;
         while (q.next()) {
             QString name = q.value(0).toString();
             QString created = q.value(1).toString();
             out.append(qMakePair(name, created));
         }
+        q.finish();
     } catch (...) {}
     return out;
 }
 
 QByteArray Storage::loadActionPayload(const QString& type, const QString& name) {
+    const QString table = schema::actionsTable(type);
+    if (table.isEmpty()) return QByteArray();
     try {
-        QSqlDatabase& d = DbManager::instance().db();
-        QSqlQuery q(d);
-        QString tbl = actionsTableForType(type);
-        q.prepare(QString("SELECT payload FROM %1 WHERE name = ?").arg(tbl));
-        q.addBindValue(name);
+        QSqlQuery& q = DbManager::instance().prepared(
+            QString("SELECT payload FROM %1 WHERE name = ?").arg(table));
+        q.bindValue(0, name);
         if (!q.exec() || !q.next()) return QByteArray();
-        return q.value(0).toByteArray();
+        const QByteArray payload = q.value(0).toByteArray();
+        q.finish();
+        return payload;
     } catch (...) { return QByteArray(); }
 }
 
 int Storage::migrateOldActions() {
-    int migrated = 0;
+    // 启动时迁移 2 已导入过一次；这里补充导入之后写入旧表的记录
     try {
-        QSqlDatabase& d = DbManager::instance().db();
-        QSqlQuery q(d);
-        // Check if legacy table exists
-        q.exec("SELECT name FROM sqlite_master WHERE type='table' AND name='actions'");
-        if (!q.next()) return 0;
-        QSqlQuery q2(d);
-        q2.exec("SELECT name, type, payload FROM actions");
-        while (q2.next()) {
-            QString name = q2.value(0).toString();
-            QString type = q2.value(1).toString();
-            QByteArray payload = q2.value(2).toByteArray();
-            if (saveAction(type, name, payload)) ++migrated;
-        }
-    } catch (...) {}
-    return migrated;
+        const auto writeLock = DbManager::instance().writeLock();
+        return std::max(0, schema::importLegacyActions(DbManager::instance().db()));
+    } catch (...) { return 0; }
 }
 
 bool Storage::deleteAction(const QString& type, const QString& name) {
+    const QString table = schema::actionsTable(type);
+    if (table.isEmpty()) return false;
     try {
-        QSqlDatabase& d = DbManager::instance().db();
-        QSqlQuery q(d);
-        QString tbl = actionsTableForType(type);
-        q.prepare(QString("DELETE FROM %1 WHERE name = ?").arg(tbl));
-        q.addBindValue(name);
+        const auto writeLock = DbManager::instance().writeLock();
+        QSqlQuery& q = DbManager::instance().prepared(
+            QString("DELETE FROM %1 WHERE name = ?").arg(table));
+        q.bindValue(0, name);
         return q.exec();
     } catch (...) { return false; }
 }
 
+std::future<bool> Storage::deleteActionAsync(const QString& type, const QString& name) {
+    return WriteBehindQueue::instance().submit(
+        [type, name](QSqlDatabase&) { return deleteAction(type, name); });
+}
+
 bool Storage::renameAction(const QString& type, const QString& oldName, const QString& newName) {
     try {
-        QSqlDatabase& d = DbManager::instance().db();
+        // 读取、写入新名与删除旧名之间不允许其它写入插入
+        const auto writeLock = DbManager::instance().writeLock();
+        const QString tbl = schema::actionsTable(type);
+        if (tbl.isEmpty()) return false;
         // load payload
-        QSqlQuery q(d);
-        QString tbl = actionsTableForType(type);
-        q.prepare(QString("SELECT payload FROM %1 WHERE name = ?").arg(tbl));
-        q.addBindValue(oldName);
+        QSqlQuery& q = DbManager::instance().prepared(
+            QString("SELECT payload FROM %1 WHERE name = ?").arg(tbl));
+        q.bindValue(0, oldName);
         if (!q.exec() || !q.next()) return false;
-        QByteArray payload = q.value(0).toByteArray();
+        const QByteArray payload = q.value(0).toByteArray();
+        q.finish();
 
         // save under new name (INSERT OR REPLACE)
         if (!saveAction(type, newName, payload)) return false;
 
         // delete old
-        QSqlQuery q2(d);
-        q2.prepare(QString("DELETE FROM %1 WHERE name = ?").arg(tbl));
-        q2.addBindValue(oldName);
+        QSqlQuery& q2 =
+            DbManager::instance().prepared(QString("DELETE FROM %1 WHERE name = ?").arg(tbl));
+        q2.bindValue(0, oldName);
         q2.exec();
         return true;
     } catch (...) { return false; }
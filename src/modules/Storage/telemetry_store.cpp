@@ -0,0 +1,678 @@
+﻿#include "telemetry_store.h"
+
+#include <QDate>
+#include <QDateTime>
+#include <QDir>
+#include <QHash>
+#include <QStandardPaths>
+#include <QTimeZone>
+#include <QtSql/QSqlError>
+#include <QtSql/QSqlQuery>
+#include <algorithm>
+#include <cmath>
+#include <exception>
+#include <memory>
+
+#include "column_segment.h"
+#include "dbmanager.h"
+#include "logging.h"
+#include "modules/Config/config.h"
+#include "write_behind.h"
+
+namespace storage {
+
+namespace telemetry {
+
+namespace {
+
+constexpr qint64 kMinuteMs = 60 * 1000;
+constexpr qint64 kHourMs = 60 * kMinuteMs;
+constexpr qint64 kDayMs = 24 * kHourMs;
+// 多行 INSERT 每条语句的行数；4 个参数 x 128 行低于旧版 SQLite 999 个参数的上限
+constexpr int kRowsPerInsert = 128;
+// 段写线程最多积压的任务数；每个任务最多 segmentRows 个点，超过后 append 阻塞形成背压
+constexpr std::size_t kMaxPendingSegmentJobs = 4;
+
+std::shared_ptr<spdlog::logger> telemetryLogger() {
+    return logging::LoggerManager::instance().getLogger("Storage.Telemetry");
+}
+
+qint64 floorDiv(qint64 value, qint64 divisor) {
+    const qint64 q = value / divisor;
+    return (value % divisor != 0 && value < 0) ? q - 1 : q;
+}
+
+qint64 floorTo(qint64 value, qint64 step) {
+    return floorDiv(value, step) * step;
+}
+
+QDate utcDate(qint64 ms) {
+    return QDateTime::fromMSecsSinceEpoch(ms, QTimeZone::UTC).date();
+}
+
+qint64 startOfDayMs(const QDate& date) {
+    return QDateTime(date, QTime(0, 0), QTimeZone::UTC).toMSecsSinceEpoch();
+}
+
+/**
+ * @brief 一个分区表及其覆盖的时间范围 [startMs, endMs)
+ */
+struct Partition {
+    QString name;
+    TelemetryResolution resolution = TelemetryResolution::Raw;
+    qint64 startMs = 0;
+    qint64 endMs = 0;
+};
+
+Partition partitionFor(TelemetryResolution resolution, qint64 ms) {
+    const QDate date = utcDate(ms);
+    Partition p;
+    p.resolution = resolution;
+    if (resolution == TelemetryResolution::Hour) {
+        const QDate month(date.year(), date.month(), 1);
+        p.name = QStringLiteral("telemetry_1h_%1").arg(month.toString(QStringLiteral("yyyyMM")));
+        p.startMs = startOfDayMs(month);
+        p.endMs = startOfDayMs(month.addMonths(1));
+        return p;
+    }
+    const QString prefix = resolution == TelemetryResolution::Raw ? QStringLiteral("telemetry_raw_")
+                                                                  : QStringLiteral("telemetry_1m_");
+    p.name = prefix + date.toString(QStringLiteral("yyyyMMdd"));
+    p.startMs = startOfDayMs(date);
+    p.endMs = p.startMs + kDayMs;
+    return p;
+}
+
+bool exec(QSqlQuery& q, const QString& sql) {
+    if (q.exec(sql)) return true;
+    if (auto logger = telemetryLogger()) {
+        logger->error("Telemetry statement failed: {} ({})",
+                      sql.toStdString(),
+                      q.lastError().text().toStdString());
+    }
+    return false;
+}
+
+bool execPrepared(QSqlQuery& q) {
+    if (q.exec()) return true;
+    if (auto logger = telemetryLogger()) {
+        logger->error("Telemetry statement failed: {} ({})",
+                      q.lastQuery().toStdString(),
+                      q.lastError().text().toStdString());
+    }
+    return false;
+}
+
+bool prepare(QSqlQuery& q, const QString& sql) {
+    if (q.prepare(sql)) return true;
+    if (auto logger = telemetryLogger()) {
+        logger->error("Failed to prepare telemetry statement: {} ({})",
+                      sql.toStdString(),
+                      q.lastError().text().toStdString());
+    }
+    return false;
+}
+
+bool ensurePartition(QSqlDatabase& db, const Partition& p) {
+    QSqlQuery q(db);
+    if (p.resolution == TelemetryResolution::Raw) {
+        // 只追加的原始表；(device_id, metric, ts) 索引服务按设备的区间查询
+        if (!exec(q,
+                  QStringLiteral("CREATE TABLE IF NOT EXISTS %1 (device_id TEXT NOT NULL, "
+                                 "metric TEXT NOT NULL, ts INTEGER NOT NULL, value REAL NOT NULL)")
+                      .arg(p.name)) ||
+            !exec(q,
+                  QStringLiteral("CREATE INDEX IF NOT EXISTS idx_%1_series ON %1(device_id, "
+                                 "metric, ts)")
+                      .arg(p.name))) {
+            return false;
+        }
+    } else {
+        if (!exec(q,
+                  QStringLiteral("CREATE TABLE IF NOT EXISTS %1 (device_id TEXT NOT NULL, "
+                                 "metric TEXT NOT NULL, bucket INTEGER NOT NULL, "
+                                 "count INTEGER NOT NULL, sum REAL NOT NULL, min REAL NOT NULL, "
+                                 "max REAL NOT NULL, PRIMARY KEY(device_id, metric, bucket)) "
+                                 "WITHOUT ROWID")
+                      .arg(p.name))) {
+            return false;
+        }
+    }
+    q.prepare(QStringLiteral(
+        "INSERT OR IGNORE INTO telemetry_partitions(name, resolution, start_ms, end_ms) "
+        "VALUES(?, ?, ?, ?)"));
+    q.addBindValue(p.name);
+    q.addBindValue(static_cast<int>(p.resolution));
+    q.addBindValue(p.startMs);
+    q.addBindValue(p.endMs);
+    return execPrepared(q);
+}
+
+/**
+ * @brief 汇总桶的键
+ */
+struct RollupKey {
+    QString deviceId;
+    QString metric;
+    qint64 bucket = 0;
+
+    bool operator==(const RollupKey& other) const {
+        return bucket == other.bucket && deviceId == other.deviceId && metric == other.metric;
+    }
+};
+
+size_t qHash(const RollupKey& key, size_t seed = 0) {
+    return qHashMulti(seed, key.deviceId, key.metric, key.bucket);
+}
+
+/**
+ * @brief 一个汇总桶的累加值
+ */
+struct RollupValue {
+    qint64 count = 0;
+    double sum = 0.0;
+    double min = 0.0;
+    double max = 0.0;
+
+    void merge(qint64 n, double s, double lo, double hi) {
+        if (count == 0) {
+            min = lo;
+            max = hi;
+        } else {
+            min = std::min(min, lo);
+            max = std::max(max, hi);
+        }
+        count += n;
+        sum += s;
+    }
+};
+
+using Rollups = QHash<RollupKey, RollupValue>;
+
+bool insertRaw(QSqlDatabase& db, const QString& table, const QVector<const TelemetryPoint*>& rows) {
+    const auto statementFor = [&table](int count) {
+        QString sql = QStringLiteral("INSERT INTO %1 (device_id, metric, ts, value) VALUES ")
+                          .arg(table);
+        for (int i = 0; i < count; ++i) {
+            if (i > 0) sql += QLatin1Char(',');
+            sql += QStringLiteral("(?,?,?,?)");
+        }
+        return sql;
+    };
+
+    QSqlQuery full(db);
+    QSqlQuery tail(db);
+    bool fullPrepared = false;
+    for (int offset = 0; offset < rows.size(); offset += kRowsPerInsert) {
+        const int count = std::min<int>(kRowsPerInsert, rows.size() - offset);
+        QSqlQuery* q = &full;
+        if (count < kRowsPerInsert) {
+            // 只有最后一段可能不满
+            if (!prepare(tail, statementFor(count))) return false;
+            q = &tail;
+        } else if (!fullPrepared) {
+            if (!prepare(full, statementFor(count))) return false;
+            fullPrepared = true;
+        }
+        for (int i = 0; i < count; ++i) {
+            const TelemetryPoint& p = *rows[offset + i];
+            q->bindValue(i * 4, p.deviceId);
+            q->bindValue(i * 4 + 1, p.metric);
+            q->bindValue(i * 4 + 2, p.timestampMs);
+            q->bindValue(i * 4 + 3, p.value);
+        }
+        if (!execPrepared(*q)) return false;
+    }
+    return true;
+}
+
+bool upsertRollups(QSqlDatabase& db, TelemetryResolution resolution, const Rollups& rollups) {
+    QHash<QString, std::shared_ptr<QSqlQuery>> statements;
+    for (auto it = rollups.cbegin(); it != rollups.cend(); ++it) {
+        const QString table = partitionFor(resolution, it.key().bucket).name;
+        std::shared_ptr<QSqlQuery>& stmt = statements[table];
+        if (!stmt) {
+            stmt = std::make_shared<QSqlQuery>(db);
+            // 增量合并：同一桶的多批写入累加 count/sum，并合并 min/max
+            const QString sql = QStringLiteral(
+                                    "INSERT INTO %1 (device_id, metric, bucket, count, sum, min, "
+                                    "max) VALUES (?,?,?,?,?,?,?) ON CONFLICT(device_id, metric, "
+                                    "bucket) DO UPDATE SET count = count + excluded.count, "
+                                    "sum = sum + excluded.sum, min = MIN(min, excluded.min), "
+                                    "max = MAX(max, excluded.max)")
+                                    .arg(table);
+            if (!prepare(*stmt, sql)) return false;
+        }
+        const RollupValue& v = it.value();
+        stmt->bindValue(0, it.key().deviceId);
+        stmt->bindValue(1, it.key().metric);
+        stmt->bindValue(2, it.key().bucket);
+        stmt->bindValue(3, v.count);
+        stmt->bindValue(4, v.sum);
+        stmt->bindValue(5, v.min);
+        stmt->bindValue(6, v.max);
+        if (!execPrepared(*stmt)) return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+bool writeBatch(QSqlDatabase& db, const QVector<TelemetryPoint>& points) {
+    // 按 UTC 日序号分组，分区名只按不同的日期各计算一次
+    QHash<qint64, QVector<const TelemetryPoint*>> rawByDay;
+    Rollups minutes;
+    int skipped = 0;
+
+    for (const TelemetryPoint& p : points) {
+        if (p.deviceId.isEmpty() || p.metric.isEmpty() || !std::isfinite(p.value)) {
+            ++skipped;
+            continue;
+        }
+        rawByDay[floorDiv(p.timestampMs, kDayMs)].append(&p);
+        minutes[RollupKey{p.deviceId, p.metric, floorTo(p.timestampMs, kMinuteMs)}].merge(
+            1, p.value, p.value, p.value);
+    }
+
+    // 1h 汇总由本批的 1m 汇总折叠而来，避免再次遍历全部原始点
+    Rollups hours;
+    for (auto it = minutes.cbegin(); it != minutes.cend(); ++it) {
+        const RollupValue& v = it.value();
+        hours[RollupKey{it.key().deviceId, it.key().metric, floorTo(it.key().bucket, kHourMs)}]
+            .merge(v.count, v.sum, v.min, v.max);
+    }
+
+    QHash<QString, Partition> touched;
+    for (auto it = rawByDay.cbegin(); it != rawByDay.cend(); ++it) {
+        // 1m 汇总与原始数据使用相同的日分区
+        for (const auto resolution : {TelemetryResolution::Raw, TelemetryResolution::Minute}) {
+            const Partition p = partitionFor(resolution, it.key() * kDayMs);
+            touched.insert(p.name, p);
+        }
+    }
+    for (auto it = hours.cbegin(); it != hours.cend(); ++it) {
+        const Partition p = partitionFor(TelemetryResolution::Hour, it.key().bucket);
+        touched.insert(p.name, p);
+    }
+
+    if (skipped > 0) {
+        if (auto logger = telemetryLogger()) {
+            logger->warn("Skipped {} telemetry points without device/metric or finite value",
+                         skipped);
+        }
+    }
+
+    for (const Partition& p : touched) {
+        if (!ensurePartition(db, p)) return false;
+    }
+    for (auto it = rawByDay.cbegin(); it != rawByDay.cend(); ++it) {
+        const QString table = partitionFor(TelemetryResolution::Raw, it.key() * kDayMs).name;
+        if (!insertRaw(db, table, it.value())) return false;
+    }
+    return upsertRollups(db, TelemetryResolution::Minute, minutes) &&
+           upsertRollups(db, TelemetryResolution::Hour, hours);
+}
+
+QVector<TelemetrySample> query(QSqlDatabase& db,
+                               const QString& deviceId,
+                               const QString& metric,
+                               qint64 fromMs,
+                               qint64 toMs,
+                               TelemetryResolution resolution,
+                               int limit) {
+    QVector<TelemetrySample> out;
+    if (deviceId.isEmpty() || toMs < fromMs) return out;
+
+    const bool isRaw = resolution == TelemetryResolution::Raw;
+    // 汇总查询包含起点所在的桶
+    const qint64 from = isRaw ? fromMs
+                              : floorTo(fromMs,
+                                        resolution == TelemetryResolution::Minute ? kMinuteMs
+                                                                                  : kHourMs);
+
+    QSqlQuery tables(db);
+    tables.prepare(QStringLiteral(
+        "SELECT name FROM telemetry_partitions WHERE resolution = ? AND end_ms > ? AND "
+        "start_ms <= ? ORDER BY start_ms"));
+    tables.addBindValue(static_cast<int>(resolution));
+    tables.addBindValue(from);
+    tables.addBindValue(toMs);
+    if (!execPrepared(tables)) return out;
+    QStringList names;
+    while (tables.next()) names << tables.value(0).toString();
+
+    const QString columns = isRaw ? QStringLiteral("metric, ts, 1, value, value, value")
+                                  : QStringLiteral("metric, bucket, count, min, max, sum");
+    const QString timeColumn = isRaw ? QStringLiteral("ts") : QStringLiteral("bucket");
+    QSqlQuery q(db);
+    for (const QString& table : names) {
+        QString sql = QStringLiteral("SELECT %1 FROM %2 WHERE device_id = ? AND %3 BETWEEN ? AND ?")
+                          .arg(columns, table, timeColumn);
+        if (!metric.isEmpty()) sql += QStringLiteral(" AND metric = ?");
+        sql += QStringLiteral(" ORDER BY metric, %1").arg(timeColumn);
+        if (!prepare(q, sql)) return {};
+        q.addBindValue(deviceId);
+        q.addBindValue(from);
+        q.addBindValue(toMs);
+        if (!metric.isEmpty()) q.addBindValue(metric);
+        if (!execPrepared(q)) return {};
+        while (q.next()) {
+            TelemetrySample s;
+            s.metric = q.value(0).toString();
+            s.timestampMs = q.value(1).toLongLong();
+            s.count = q.value(2).toLongLong();
+            s.min = q.value(3).toDouble();
+            s.max = q.value(4).toDouble();
+            s.sum = q.value(5).toDouble();
+            out.append(s);
+        }
+        q.finish();
+        // 单一指标时分区按时间升序，结果已经有序，可以提前结束
+        if (!metric.isEmpty() && limit > 0 && out.size() >= limit) break;
+    }
+
+    // 多个分区各自按 (metric, 时间) 排序；稳定排序按 metric 归并后时间顺序保持不变
+    if (metric.isEmpty() && names.size() > 1) {
+        std::stable_sort(out.begin(), out.end(), [](const auto& a, const auto& b) {
+            return a.metric < b.metric;
+        });
+    }
+    if (limit > 0 && out.size() > limit) out.resize(limit);
+    return out;
+}
+
+int dropExpiredPartitions(QSqlDatabase& db, qint64 nowMs, const TelemetryOptions& options) {
+    const std::pair<TelemetryResolution, int> policies[] = {
+        {TelemetryResolution::Raw, options.rawRetentionDays},
+        {TelemetryResolution::Minute, options.minuteRetentionDays},
+        {TelemetryResolution::Hour, options.hourRetentionDays},
+    };
+
+    QStringList expired;
+    QSqlQuery q(db);
+    for (const auto& [resolution, days] : policies) {
+        // <= 0 表示永久保留
+        if (days <= 0) continue;
+        q.prepare(QStringLiteral(
+            "SELECT name FROM telemetry_partitions WHERE resolution = ? AND end_ms <= ?"));
+        q.addBindValue(static_cast<int>(resolution));
+        q.addBindValue(nowMs - static_cast<qint64>(days) * kDayMs);
+        if (!execPrepared(q)) return -1;
+        while (q.next()) expired << q.value(0).toString();
+    }
+
+    for (const QString& name : expired) {
+        if (!exec(q, QStringLiteral("DROP TABLE IF EXISTS %1").arg(name))) return -1;
+        q.prepare(QStringLiteral("DELETE FROM telemetry_partitions WHERE name = ?"));
+        q.addBindValue(name);
+        if (!execPrepared(q)) return -1;
+    }
+    if (!expired.isEmpty()) {
+        if (auto logger = telemetryLogger()) {
+            logger->info("Dropped {} expired telemetry partitions", expired.size());
+        }
+    }
+    return static_cast<int>(expired.size());
+}
+
+QStringList partitions(QSqlDatabase& db, TelemetryResolution resolution) {
+    QStringList names;
+    QSqlQuery q(db);
+    q.prepare(QStringLiteral(
+        "SELECT name FROM telemetry_partitions WHERE resolution = ? ORDER BY start_ms"));
+    q.addBindValue(static_cast<int>(resolution));
+    if (!execPrepared(q)) return names;
+    while (q.next()) names << q.value(0).toString();
+    return names;
+}
+
+}  // namespace telemetry
+
+TelemetryStore& TelemetryStore::instance() {
+    static TelemetryStore inst;
+    return inst;
+}
+
+TelemetryStore::TelemetryStore() {
+    // 列式段默认关闭：Storage/telemetrySegments 为 true 时才写，目录默认在用户数据目录下
+    const QString defaultDir =
+        QDir(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation))
+            .filePath(QStringLiteral("telemetry_segments"));
+    try {
+        auto& cfg = config::ConfigManager::instance();
+        const bool enabled = cfg.setOrDefault("Storage/telemetrySegments", false).toBool();
+        const QString dir = cfg.setOrDefault("Storage/telemetrySegmentDir", defaultDir).toString();
+        if (enabled) m_options.segmentDirectory = dir;
+    } catch (...) { m_options.segmentDirectory.clear(); }
+}
+
+TelemetryStore::~TelemetryStore() {
+    stopSegmentWriter();
+}
+
+std::future<bool> TelemetryStore::append(QVector<TelemetryPoint> points) {
+    if (points.isEmpty()) {
+        std::promise<bool> done;
+        done.set_value(true);
+        return done.get_future();
+    }
+    QString segmentRoot;
+    QVector<TelemetryPoint> segment;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        scheduleRetentionLocked();
+        if (!m_options.segmentDirectory.isEmpty()) {
+            m_segmentBuffer += points;
+            if (m_segmentBuffer.size() >= m_options.segmentRows) {
+                segmentRoot = m_options.segmentDirectory;
+                segment = takeSegmentBatchLocked();
+            }
+        }
+    }
+    if (!segment.isEmpty()) submitSegmentBatch(segmentRoot, std::move(segment));
+    return WriteBehindQueue::instance().submit(
+        [points = std::move(points)](QSqlDatabase& db) {
+            return telemetry::writeBatch(db, points);
+        });
+}
+
+void TelemetryStore::record(const TelemetryPoint& point) {
+    QVector<TelemetryPoint> batch;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_buffer.append(point);
+        if (m_buffer.size() < m_options.batchSize) return;
+        batch.swap(m_buffer);
+        m_buffer.reserve(m_options.batchSize);
+    }
+    append(std::move(batch));
+}
+
+bool TelemetryStore::flush(std::chrono::milliseconds timeout) {
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    QVector<TelemetryPoint> batch;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        batch.swap(m_buffer);
+    }
+    append(std::move(batch));
+    QString segmentRoot;
+    QVector<TelemetryPoint> segment;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        segmentRoot = m_options.segmentDirectory;
+        segment = takeSegmentBatchLocked();
+    }
+    if (!segment.isEmpty()) submitSegmentBatch(segmentRoot, std::move(segment));
+    const bool written = WriteBehindQueue::instance().flush(
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now()));
+    return flushSegments(deadline) && written;
+}
+
+QVector<TelemetrySample> TelemetryStore::query(const QString& deviceId,
+                                               const QString& metric,
+                                               qint64 fromMs,
+                                               qint64 toMs,
+                                               TelemetryResolution resolution,
+                                               int limit) {
+    try {
+        return telemetry::query(
+            DbManager::instance().db(), deviceId, metric, fromMs, toMs, resolution, limit);
+    } catch (const std::exception& e) {
+        if (auto logger = telemetry::telemetryLogger()) {
+            logger->warn("Telemetry query failed: {}", e.what());
+        }
+    }
+    return {};
+}
+
+int TelemetryStore::scanSegments(
+    const columnar::ScanPredicate& predicate,
+    unsigned columns,
+    const std::function<void(const columnar::ColumnRows& rows)>& visitor) {
+    const QString root = options().segmentDirectory;
+    if (root.isEmpty()) return -1;
+
+    int scanned = 0;
+    columnar::SegmentReader reader;
+    columnar::ColumnRows rows;
+    for (const QString& file : columnar::segmentFiles(root, predicate.fromMs, predicate.toMs)) {
+        // 损坏或正在被清理的段跳过，不影响其它段
+        if (!reader.open(file) || !reader.scan(predicate, columns, rows)) {
+            if (auto logger = telemetry::telemetryLogger()) {
+                logger->warn("Skipping telemetry segment: {}", reader.errorString().toStdString());
+            }
+            continue;
+        }
+        ++scanned;
+        if (rows.rows > 0) visitor(rows);
+    }
+    return scanned;
+}
+
+int TelemetryStore::applyRetention() {
+    const TelemetryOptions opts = options();
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    if (!opts.segmentDirectory.isEmpty() && opts.rawRetentionDays > 0) {
+        columnar::removeExpiredSegments(opts.segmentDirectory,
+                                        now - opts.rawRetentionDays * telemetry::kDayMs);
+    }
+    try {
+        const auto writeLock = DbManager::instance().writeLock();
+        return telemetry::dropExpiredPartitions(DbManager::instance().db(), now, opts);
+    } catch (const std::exception& e) {
+        if (auto logger = telemetry::telemetryLogger()) {
+            logger->warn("Telemetry retention failed: {}", e.what());
+        }
+    }
+    return -1;
+}
+
+void TelemetryStore::setOptions(const TelemetryOptions& options) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_options = options;
+    m_options.batchSize = std::max(1, m_options.batchSize);
+    m_options.segmentRows = std::max(1, m_options.segmentRows);
+}
+
+TelemetryOptions TelemetryStore::options() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_options;
+}
+
+void TelemetryStore::scheduleRetentionLocked() {
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    const qint64 day = telemetry::floorDiv(now, telemetry::kDayMs);
+    if (m_retentionDay == day) return;
+    m_retentionDay = day;
+    // 分区与写入走同一个写线程，不需要等待结果
+    WriteBehindQueue::instance().submit([now, options = m_options](QSqlDatabase& db) {
+        return telemetry::dropExpiredPartitions(db, now, options) >= 0;
+    });
+    // 列式段与原始数据使用相同的保留期，删除目录在段写线程上进行。这里持有 m_mutex，
+    // 不能在积压已满时阻塞，因此不经过 submitSegmentJob 的背压
+    if (m_options.segmentDirectory.isEmpty() || m_options.rawRetentionDays <= 0) return;
+    const QString root = m_options.segmentDirectory;
+    const qint64 cutoff = now - m_options.rawRetentionDays * telemetry::kDayMs;
+    std::lock_guard<std::mutex> lock(m_segmentMutex);
+    m_segmentJobs.push_back([root, cutoff]() { columnar::removeExpiredSegments(root, cutoff); });
+    if (!m_segmentWriter.joinable()) {
+        m_segmentStopping = false;
+        m_segmentWriter = std::thread(&TelemetryStore::segmentLoop, this);
+    }
+    m_segmentCv.notify_one();
+}
+
+QVector<TelemetryPoint> TelemetryStore::takeSegmentBatchLocked() {
+    QVector<TelemetryPoint> batch;
+    batch.swap(m_segmentBuffer);
+    return batch;
+}
+
+void TelemetryStore::submitSegmentBatch(const QString& root, QVector<TelemetryPoint> batch) {
+    submitSegmentJob([root, batch = std::move(batch)]() {
+        QString error;
+        if (columnar::writeDaySegments(root, batch, {}, &error)) return;
+        if (auto logger = telemetry::telemetryLogger()) {
+            logger->warn("Failed to write telemetry segment: {}", error.toStdString());
+        }
+    });
+}
+
+void TelemetryStore::submitSegmentJob(std::function<void()> job) {
+    std::unique_lock<std::mutex> lock(m_segmentMutex);
+    m_segmentDrainedCv.wait(lock, [this]() {
+        return m_segmentJobs.size() < telemetry::kMaxPendingSegmentJobs ||
+               !m_segmentWriter.joinable();
+    });
+    m_segmentJobs.push_back(std::move(job));
+    if (!m_segmentWriter.joinable()) {
+        m_segmentStopping = false;
+        m_segmentWriter = std::thread(&TelemetryStore::segmentLoop, this);
+    }
+    m_segmentCv.notify_one();
+}
+
+bool TelemetryStore::flushSegments(std::chrono::steady_clock::time_point deadline) {
+    std::unique_lock<std::mutex> lock(m_segmentMutex);
+    return m_segmentDrainedCv.wait_until(
+        lock, deadline, [this]() { return m_segmentJobs.empty() && !m_segmentBusy; });
+}
+
+void TelemetryStore::stopSegmentWriter() {
+    std::thread writer;
+    {
+        std::lock_guard<std::mutex> lock(m_segmentMutex);
+        if (!m_segmentWriter.joinable()) return;
+        m_segmentStopping = true;
+        writer = std::move(m_segmentWriter);
+    }
+    m_segmentCv.notify_all();
+    writer.join();
+}
+
+void TelemetryStore::segmentLoop() {
+    std::unique_lock<std::mutex> lock(m_segmentMutex);
+    while (true) {
+        m_segmentCv.wait(lock, [this]() { return m_segmentStopping || !m_segmentJobs.empty(); });
+        // 停止前写完已排队的段
+        if (m_segmentJobs.empty()) break;
+        std::function<void()> job = std::move(m_segmentJobs.front());
+        m_segmentJobs.pop_front();
+        m_segmentBusy = true;
+        lock.unlock();
+        try {
+            job();
+        } catch (const std::exception& e) {
+            if (auto logger = telemetry::telemetryLogger()) {
+                logger->warn("Telemetry segment job failed: {}", e.what());
+            }
+        }
+        lock.lock();
+        m_segmentBusy = false;
+        m_segmentDrainedCv.notify_all();
+    }
+}
+
+}  // namespace storage
@@ -0,0 +1,224 @@
+﻿#include "write_behind.h"
+
+#include <QtSql/QSqlError>
+#include <QtSql/QSqlQuery>
+#include <algorithm>
+#include <exception>
+
+#include "dbmanager.h"
+#include "logging.h"
+
+namespace storage {
+
+namespace {
+
+std::shared_ptr<spdlog::logger> writeBehindLogger() {
+    return logging::LoggerManager::instance().getLogger("Storage.WriteBehind");
+}
+
+bool runOp(const WriteBehindQueue::WriteOp& op, QSqlDatabase& db) {
+    if (!op) return false;
+    try {
+        return op(db);
+    } catch (const std::exception& e) {
+        if (auto logger = writeBehindLogger()) {
+            logger->warn("Write-behind operation threw: {}", e.what());
+        }
+    } catch (...) {
+        if (auto logger = writeBehindLogger()) {
+            logger->warn("Write-behind operation threw unknown exception");
+        }
+    }
+    return false;
+}
+
+// 写线程上为 true；写操作内部再次 submit 时不能等待自己腾出空位
+thread_local bool t_onWriterThread = false;
+
+}  // namespace
+
+WriteBehindQueue& WriteBehindQueue::instance() {
+    static WriteBehindQueue inst;
+    return inst;
+}
+
+WriteBehindQueue::~WriteBehindQueue() {
+    shutdown();
+}
+
+std::future<bool> WriteBehindQueue::submit(WriteOp op) {
+    Pending pending;
+    pending.op = std::move(op);
+    std::future<bool> future = pending.done.get_future();
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        const auto full = [this]() {
+            return static_cast<int>(m_pending.size()) >= m_options.capacity;
+        };
+        // 停止期间写线程可能已经排空队列退出，此时入队的写操作没有线程执行，也不能在 join
+        // 返回前启动新的写线程；写线程自身提交的写操作仍会在退出前排空
+        const auto rejectWhileStopping = [&]() {
+            if (!m_stopping || t_onWriterThread) return false;
+            ++m_stats.rejected;
+            pending.done.set_value(false);
+            if (auto logger = writeBehindLogger()) {
+                logger->warn("Write-behind queue shutting down, write rejected");
+            }
+            return true;
+        };
+        if (rejectWhileStopping()) return future;
+        if (full()) {
+            // 写线程等待自己取走一批会死锁，只能拒绝
+            if (t_onWriterThread) {
+                ++m_stats.rejected;
+                pending.done.set_value(false);
+                if (auto logger = writeBehindLogger()) {
+                    logger->warn("Write-behind queue full ({} pending), write rejected",
+                                 m_pending.size());
+                }
+                return future;
+            }
+            m_pendingCv.notify_one();
+            m_spaceCv.wait(lock, [this, &full]() { return m_stopping || !full(); });
+            if (rejectWhileStopping()) return future;
+        }
+        m_pending.push_back(std::move(pending));
+        ++m_stats.submitted;
+        m_stats.pending = m_pending.size();
+        if (!m_writer.joinable() && !m_stopping) {
+            m_writer = std::thread(&WriteBehindQueue::writerLoop, this);
+        }
+    }
+    m_pendingCv.notify_one();
+    return future;
+}
+
+bool WriteBehindQueue::flush(std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    return m_drainedCv.wait_for(
+        lock, timeout, [this]() { return m_pending.empty() && m_inFlight == 0; });
+}
+
+void WriteBehindQueue::shutdown() {
+    std::thread writer;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_writer.joinable()) return;
+        m_stopping = true;
+        writer = std::move(m_writer);
+    }
+    m_pendingCv.notify_all();
+    m_spaceCv.notify_all();
+    writer.join();
+    // join 返回后才允许 submit 重新启动写线程
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stopping = false;
+}
+
+void WriteBehindQueue::setOptions(const WriteBehindOptions& options) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_options = options;
+    m_options.capacity = std::max(1, m_options.capacity);
+    m_options.maxBatch = std::max(1, m_options.maxBatch);
+    m_options.commitDelay = std::max(std::chrono::milliseconds(0), m_options.commitDelay);
+    m_spaceCv.notify_all();
+}
+
+WriteBehindOptions WriteBehindQueue::options() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_options;
+}
+
+WriteBehindStats WriteBehindQueue::stats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+void WriteBehindQueue::writerLoop() {
+    t_onWriterThread = true;
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_pendingCv.wait(lock, [this]() { return m_stopping || !m_pending.empty(); });
+        // 停止时先把已提交的写操作全部落盘再退出
+        if (m_pending.empty()) return;
+
+        // 攒批：等待 commitDelay，期间凑满 maxBatch 或收到停止请求则提前提交
+        if (!m_stopping) {
+            m_pendingCv.wait_for(lock, m_options.commitDelay, [this]() {
+                return m_stopping || static_cast<int>(m_pending.size()) >= m_options.maxBatch;
+            });
+        }
+
+        const std::size_t count =
+            std::min(m_pending.size(), static_cast<std::size_t>(m_options.maxBatch));
+        std::vector<Pending> batch;
+        batch.reserve(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            batch.push_back(std::move(m_pending.front()));
+            m_pending.pop_front();
+        }
+        m_inFlight = batch.size();
+        m_stats.pending = m_pending.size();
+        m_spaceCv.notify_all();
+
+        lock.unlock();
+        const std::size_t succeeded = commitBatch(batch);
+        lock.lock();
+
+        m_inFlight = 0;
+        ++m_stats.batches;
+        m_stats.committed += succeeded;
+        m_stats.failed += batch.size() - succeeded;
+        m_drainedCv.notify_all();
+    }
+}
+
+std::size_t WriteBehindQueue::commitBatch(std::vector<Pending>& batch) {
+    std::vector<bool> results(batch.size(), false);
+    bool committed = false;
+    try {
+        QSqlDatabase& db = DbManager::instance().db();
+        const auto writeLock = DbManager::instance().writeLock();
+        if (db.transaction()) {
+            QSqlQuery savepoint(db);
+            for (std::size_t i = 0; i < batch.size(); ++i) {
+                savepoint.exec(QStringLiteral("SAVEPOINT write_behind"));
+                results[i] = runOp(batch[i].op, db);
+                // ROLLBACK TO 保留保存点本身，仍需 RELEASE 出栈
+                if (!results[i]) savepoint.exec(QStringLiteral("ROLLBACK TO write_behind"));
+                savepoint.exec(QStringLiteral("RELEASE write_behind"));
+            }
+            committed = db.commit();
+            if (!committed) {
+                if (auto logger = writeBehindLogger()) {
+                    logger->error("Write-behind commit of {} operations failed: {}",
+                                  batch.size(),
+                                  db.lastError().text().toStdString());
+                }
+                db.rollback();
+            }
+        } else {
+            // 无法开启事务（例如驱动不支持）时逐条自动提交
+            if (auto logger = writeBehindLogger()) {
+                logger->warn("Write-behind transaction unavailable, falling back to autocommit: {}",
+                             db.lastError().text().toStdString());
+            }
+            for (std::size_t i = 0; i < batch.size(); ++i) results[i] = runOp(batch[i].op, db);
+            committed = true;
+        }
+    } catch (const std::exception& e) {
+        if (auto logger = writeBehindLogger()) {
+            logger->error("Write-behind batch failed: {}", e.what());
+        }
+    }
+
+    std::size_t succeeded = 0;
+    for (std::size_t i = 0; i < batch.size(); ++i) {
+        const bool ok = committed && results[i];
+        if (ok) ++succeeded;
+        batch[i].done.set_value(ok);
+    }
+    return succeeded;
+}
+
+}  // namespace storage
@@ -1,6 +1,7 @@
 ﻿#include "widgets/facerecognitionwidget.h"
 
 #include <QAbstractItemView>
+#include <QApplication>
 #include <QCamera>
 #include <QCameraDevice>
 #include <QCheckBox>
@@ -28,6 +29,7 @@
 #include <QPen>
 #include <QPixmap>
 #include <QPlainTextEdit>
+#include <QPointer>
 #include <QPushButton>
 #include <QSize>
 #include <QSplitter>
@@ -40,6 +42,8 @@
 #include <QVBoxLayout>
 #include <QVideoFrame>
 #include <QVideoSink>
+#include <algorithm>
+#include <chrono>
 #include <cstddef>
 #include <filesystem>
 
@@ -47,6 +51,9 @@
 #include "modules/HumanRecognition/humanrecognition.h"
 
 namespace {
+/// 实时检测请求的截止时长；超过后帧已过时，不再检测
+constexpr std::chrono::milliseconds kLiveDetectDeadline{200};
+
 QString hrCodeToString(HumanRecognition::HRCode code) {
     using HumanRecognition::HRCode;
     switch (code) {
@@ -71,6 +78,10 @@ QString hrCodeToString(HumanRecognition::HRCode code) {
             return QCoreApplication::translate("FaceRecognitionWidget", "Person already exists");
         case HRCode::PersonNotFound:
             return QCoreApplication::translate("FaceRecognitionWidget", "Person not found");
+        case HRCode::DeadlineExceeded:
+            return QCoreApplication::translate("FaceRecognitionWidget", "Deadline exceeded");
+        case HRCode::QueueFull:
+            return QCoreApplication::translate("FaceRecognitionWidget", "Request queue full");
         case HRCode::UnknownError:
         default:
             return QCoreApplication::translate("FaceRecognitionWidget", "Unknown error");
@@ -250,6 +261,11 @@ FaceRecognitionWidget::FaceRecognitionWidget(QWidget* parent) : QWidget(parent)
         QCoreApplication::translate("FaceRecognitionWidget", "Auto-match"), leftPanel);
     autoMatchCheck_->setChecked(true);
     resultsHeader->addWidget(autoMatchCheck_);
+    liveDetectCheck_ = new QCheckBox(
+        QCoreApplication::translate("FaceRecognitionWidget", "Live detect"), leftPanel);
+    liveDetectCheck_->setToolTip(QCoreApplication::translate(
+        "FaceRecognitionWidget", "Detect faces on camera frames, skipping frames without motion"));
+    resultsHeader->addWidget(liveDetectCheck_);
     leftLayout->addLayout(resultsHeader);
 
     resultsList_ = new QListWidget(leftPanel);
@@ -355,6 +371,8 @@ FaceRecognitionWidget::FaceRecognitionWidget(QWidget* parent) : QWidget(parent)
             &QStandardItemModel::itemChanged,
             this,
             &FaceRecognitionWidget::onDatabaseItemChanged);
+    connect(
+        liveDetectCheck_, &QCheckBox::toggled, this, &FaceRecognitionWidget::onLiveDetectToggled);
 
     QString storedModelPath = config::ConfigManager::instance().getString(
         QStringLiteral("HumanRecognition/ModelFile"), QString());
@@ -561,7 +579,8 @@ void FaceRecognitionWidget::onDetectFaces() {
     }
 
     QVector<HumanRecognition::FaceBox> boxes;
-    const auto detectCode = hr.detect(currentImage_, opts, boxes);
+    HumanRecognition::FrameContextPtr frameContext;
+    const auto detectCode = hr.detect(currentImage_, opts, boxes, frameContext);
     if (detectCode != HumanRecognition::HRCode::Ok) {
         showError(QCoreApplication::translate("FaceRecognitionWidget", "Detection failed: %1")
                       .arg(hrCodeToString(detectCode)));
@@ -578,6 +597,7 @@ void FaceRecognitionWidget::onDetectFaces() {
     detections_.clear();
     resultsList_->clear();
     detections_.reserve(boxes.size());
+    lastFrameContext_ = frameContext;
 
     for (int i = 0; i < boxes.size(); ++i) {
         DetectionEntry entry;
@@ -737,6 +757,12 @@ void FaceRecognitionWidget::onCameraFrame(const QVideoFrame& frame) {
     lastCameraFrame_ = toDisplayImage(image);
     if (currentSource_ == FaceSourceMode::Camera) { currentImage_ = lastCameraFrame_; }
 
+    if (liveDetectCheck_->isChecked() && backendReady_) {
+        runLiveDetection(lastCameraFrame_);
+        updatePreview(lastCameraFrame_, liveBoxes_);
+        return;
+    }
+
     if (detections_.isEmpty()) {
         updatePreview(lastCameraFrame_);
     } else {
@@ -744,6 +770,120 @@ void FaceRecognitionWidget::onCameraFrame(const QVideoFrame& frame) {
     }
 }
 
+void FaceRecognitionWidget::onLiveDetectToggled(bool enabled) {
+    motionGate_.reset();
+    faceTracker_.reset();
+    ++liveTrackGeneration_;
+    liveBoxes_.clear();
+    if (enabled && !ensureBackendReady()) { liveDetectCheck_->setChecked(false); }
+}
+
+void FaceRecognitionWidget::runLiveDetection(const QImage& frame) {
+    // 上一帧仍在后台检测时直接丢弃本帧，避免请求堆积
+    if (liveRequestPending_) return;
+
+    const HumanRecognition::MotionGate::Result gate = motionGate_.process(frame);
+    // 静止帧沿用上一次的检测框
+    if (!gate.shouldDetect) return;
+
+    HumanRecognition::DetectOptions opts;
+    opts.detectLandmarks = false;
+    opts.minScore = 0.3f;
+    if (frame.width() > 1200 || frame.height() > 1200) { opts.resizeTo = QSize(960, 720); }
+    if (!gate.forced) opts.regionsOfInterest = gate.regions;
+
+    HumanRecognition::RequestOptions request;
+    request.priority = HumanRecognition::RequestPriority::Normal;
+    request.deadline = kLiveDetectDeadline;
+
+    liveRequestPending_ = true;
+    QPointer<FaceRecognitionWidget> guard(this);
+    HumanRecognition::HumanRecognition::instance().submitDetect(
+        frame, opts, request, [guard, frame, gate](HumanRecognition::DetectResponse response) {
+            // 回调在工作线程执行，切回主线程后再访问控件
+            QMetaObject::invokeMethod(
+                qApp,
+                [guard, frame, gate, response = std::move(response)]() {
+                    if (guard) guard->applyLiveDetection(frame, gate, response);
+                },
+                Qt::QueuedConnection);
+        });
+}
+
+void FaceRecognitionWidget::applyLiveDetection(const QImage& frame,
+                                               const HumanRecognition::MotionGate::Result& gate,
+                                               const HumanRecognition::DetectResponse& response) {
+    liveRequestPending_ = false;
+    if (!cameraActive_ || !liveDetectCheck_->isChecked()) return;
+    if (response.code != HumanRecognition::HRCode::Ok &&
+        response.code != HumanRecognition::HRCode::DetectFailed) {
+        return;
+    }
+
+    QVector<HumanRecognition::FaceBox> boxes = response.boxes;
+    if (!gate.forced) {
+        // 未扫描区域内的旧框仍然有效，只替换变化区域内的结果
+        for (const auto& previous : liveBoxes_) {
+            const bool scanned =
+                std::any_of(gate.regions.cbegin(), gate.regions.cend(), [&](const QRect& region) {
+                    return region.intersects(previous.rect);
+                });
+            if (!scanned) boxes.append(previous);
+        }
+    }
+
+    // 只对新轨迹或到达复核周期的轨迹提取特征并检索，其余沿用轨迹上的识别结果
+    faceTracker_.update(boxes);
+    liveBoxes_ = boxes;
+    updatePreview(lastCameraFrame_, liveBoxes_);
+    // 上一批识别仍在后台执行时不再追加，未完成的轨迹留到下一次检测
+    if (!autoMatchCheck_->isChecked() || liveMatchPending_) return;
+
+    QVector<HumanRecognition::FaceBox> pending;
+    for (const auto& box : boxes) {
+        if (faceTracker_.needsRecognition(box.trackId)) pending.append(box);
+    }
+    if (pending.isEmpty()) return;
+
+    HumanRecognition::RequestOptions request;
+    request.priority = HumanRecognition::RequestPriority::Normal;
+    request.deadline = kLiveDetectDeadline;
+
+    liveMatchPending_ = true;
+    QPointer<FaceRecognitionWidget> guard(this);
+    const quint64 generation = liveTrackGeneration_;
+    HumanRecognition::HumanRecognition::instance().submitMatchFaces(
+        response.context,
+        frame,
+        pending,
+        request,
+        [guard, generation](HumanRecognition::RecognizeResponse matched) {
+            QMetaObject::invokeMethod(
+                qApp,
+                [guard, generation, matched = std::move(matched)]() {
+                    if (guard) guard->applyLiveMatches(generation, matched);
+                },
+                Qt::QueuedConnection);
+        });
+}
+
+void FaceRecognitionWidget::applyLiveMatches(quint64 generation,
+                                             const HumanRecognition::RecognizeResponse& response) {
+    liveMatchPending_ = false;
+    // 轨迹已重置时编号可能被复用，旧结果不能写回
+    if (generation != liveTrackGeneration_) return;
+    if (response.code != HumanRecognition::HRCode::Ok) return;
+
+    for (const auto& result : response.results) {
+        // 特征提取失败的轨迹保持未识别，下一次检测时重试
+        if (!result.feat) continue;
+        faceTracker_.setRecognition(result.face.trackId, result.match);
+    }
+    if (cameraActive_ && liveDetectCheck_->isChecked()) {
+        updatePreview(lastCameraFrame_, liveBoxes_);
+    }
+}
+
 void FaceRecognitionWidget::onVideoFrame(const QVideoFrame& frame) {
     Q_UNUSED(frame);
 }
@@ -766,15 +906,17 @@ void FaceRecognitionWidget::onAnimatedFrame(int) {
 }
 
 bool FaceRecognitionWidget::ensureBackendReady(bool warnAboutModel) {
-    constexpr auto backendName = "opencv_dlib";
+    // 默认使用 opencv_dlib；以 HR_ENABLE_ONNXRUNTIME 构建时可配置为 onnx_cpu
+    const QString backendName = config::ConfigManager::instance().getString(
+        QStringLiteral("HumanRecognition/Backend"), QStringLiteral("opencv_dlib"));
     auto& hr = HumanRecognition::HumanRecognition::instance();
 
-    if (!hr.hasBackend() || hr.currentBackendName() != QString::fromLatin1(backendName)) {
-        auto code = hr.setBackend(QString::fromLatin1(backendName));
+    if (!hr.hasBackend() || hr.currentBackendName() != backendName) {
+        auto code = hr.setBackend(backendName);
         if (code != HumanRecognition::HRCode::Ok) {
             showError(QCoreApplication::translate("FaceRecognitionWidget",
                                                   "Failed to activate backend '%1': %2")
-                          .arg(QString::fromLatin1(backendName), hrCodeToString(code)));
+                          .arg(backendName, hrCodeToString(code)));
             backendReady_ = false;
             return false;
         }
@@ -857,6 +999,15 @@ void FaceRecognitionWidget::updatePreview(const QImage& image,
         painter.setPen(pen);
         for (const auto& box : boxes) {
             painter.drawRect(box.rect);
+            if (box.trackId >= 0) {
+                const auto* track = faceTracker_.track(box.trackId);
+                QString label = QStringLiteral("#%1").arg(box.trackId);
+                if (track && track->match.has_value()) {
+                    label = track->match->personName.isEmpty() ? track->match->personId
+                                                               : track->match->personName;
+                }
+                painter.drawText(box.rect.topLeft() - QPoint(0, 6), label);
+            }
             if (!box.landmarks.isEmpty()) {
                 QPen pointPen(QColor(16, 185, 129));
                 pointPen.setWidth(6);
@@ -916,6 +1067,7 @@ void FaceRecognitionWidget::resetDetections() {
     resultsList_->clear();
     selectedDetectionIndex_ = -1;
     lastBoxes_.clear();
+    lastFrameContext_.reset();
     enableRegistrationButtons(false);
     enableMatchButtons(false);
 }
@@ -973,6 +1125,10 @@ void FaceRecognitionWidget::stopCamera() {
     cameraSink_ = nullptr;
     cameraActive_ = false;
     lastCameraFrame_ = QImage();
+    motionGate_.reset();
+    faceTracker_.reset();
+    ++liveTrackGeneration_;
+    liveBoxes_.clear();
     ensureUiState();
 }
 
@@ -1026,7 +1182,8 @@ HumanRecognition::HRCode FaceRecognitionWidget::extractFeatureForBox(
     if (!ensureBackendReady()) return HumanRecognition::HRCode::UnknownError;
     auto& hr = HumanRecognition::HumanRecognition::instance();
     HumanRecognition::FaceFeature feature;
-    const auto code = hr.extractFeature(image, box, feature);
+    // 后端会校验上下文是否属于该图像，不匹配时自动走完整预处理
+    const auto code = hr.extractFeature(lastFrameContext_, image, box, feature);
     if (code == HumanRecognition::HRCode::Ok) { entry.feature = feature; }
     return code;
 }
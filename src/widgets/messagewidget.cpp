@@ -83,6 +83,8 @@ MessageWidget::MessageWidget(QWidget* parent) : QWidget(parent), ui(new Ui::Mess
     }
 
     // Ensure messages table exists (extra columns for visitor info)
+    // 建表与列迁移是写操作，与写线程等其它连接串行
+    auto writeLock = DbManager::instance().writeLock();
     QSqlQuery q(Storage::db());
     const QString createSql =
         "CREATE TABLE IF NOT EXISTS messages ("
@@ -122,6 +124,7 @@ MessageWidget::MessageWidget(QWidget* parent) : QWidget(parent), ui(new Ui::Mess
             }
         }
     }
+    writeLock.unlock();
 
     // Load existing messages into QListWidget; store DB id in UserRole
     const QString selectSql =
@@ -239,6 +242,8 @@ void MessageWidget::on_btnSendMessage_clicked() {
     if (ret != QMessageBox::Yes) return;
 
     const QString now = QDateTime::currentDateTime().toString(Qt::ISODate);
+    // 持有写锁直到读出 last_insert_rowid，避免其它连接的写入插在中间
+    auto writeLock = DbManager::instance().writeLock();
     QSqlQuery q(Storage::db());
     q.prepare(
         "INSERT INTO messages (visitor_name, visitor_phone, visitor_email, content, created_at) "
@@ -272,6 +277,7 @@ void MessageWidget::on_btnSendMessage_clicked() {
             if (q2.next()) id = q2.value(0).toInt();
         }
     }
+    writeLock.unlock();
     // Create a widget for the new message and insert into the list
     QWidget* w = new QWidget();
     w->setAutoFillBackground(true);
@@ -345,7 +351,12 @@ void MessageWidget::on_btnDeleteMessage_clicked() {
     QSqlQuery q(Storage::db());
     q.prepare("DELETE FROM messages WHERE id = :id");
     q.bindValue(":id", id);
-    if (!q.exec()) {
+    bool deleted = false;
+    {
+        const auto writeLock = DbManager::instance().writeLock();
+        deleted = q.exec();
+    }
+    if (!deleted) {
         spdlog::warn("Failed to delete message: {}", q.lastError().text().toStdString());
         QMessageBox::warning(this,
                              QCoreApplication::translate("MessageWidget", "Error"),
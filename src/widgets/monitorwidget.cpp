@@ -44,6 +44,7 @@
 #include "modules/Config/config.h"
 #include "modules/Connect/tcp_connect.h"
 #include "modules/DeviceGateway/device_gateway.h"
+#include "modules/Storage/dbmanager.h"
 #include "modules/Storage/storage.h"
 #include "spdlog/spdlog.h"
 #include "ui_monitorwidget.h"
@@ -621,6 +622,7 @@ void MonitorWidget::ensureActionsTable() {
     using namespace storage;
     try {
         if (!Storage::db().isOpen()) return;
+        const auto writeLock = DbManager::instance().writeLock();
         QSqlQuery q(Storage::db());
         // Create per-type actions tables so different action types can be stored separately
         q.exec(
@@ -644,6 +646,7 @@ int MonitorWidget::saveActionToDb(const QString& name,
     using namespace storage;
     try {
         if (!Storage::db().isOpen()) return -1;
+        const auto writeLock = DbManager::instance().writeLock();
         QSqlQuery q(Storage::db());
         q.prepare(
             "INSERT INTO actions (name, type, payload, created_at) VALUES (?, ?, ?, "
@@ -0,0 +1,216 @@
+#include <gtest/gtest.h>
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QSettings>
+#include <QTemporaryDir>
+#include <QThread>
+#include <atomic>
+#include <functional>
+#include <mutex>
+
+#include "modules/Config/config.h"
+
+namespace {
+
+using config::ConfigManager;
+using config::ConfigSnapshot;
+
+bool writeFile(const QString& path, const QByteArray& data) {
+    QFile f(path);
+    if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
+    return f.write(data) == data.size();
+}
+
+// 轮询等待条件成立；回调在热加载线程上执行，主线程不需要事件循环
+bool waitFor(const std::function<bool()>& condition, int timeoutMs = 5000) {
+    QElapsedTimer timer;
+    timer.start();
+    while (!condition()) {
+        if (timer.elapsed() > timeoutMs) return false;
+        QThread::msleep(10);
+    }
+    return true;
+}
+
+// 测试：快照的类型化读取与差异
+// 场景：两个快照，分别修改、删除、新增各一个键，并保留一个相同的键
+// 断言：缺失键返回默认值，数值字符串可按整型读取；diff 只包含变化的三个键且已排序
+TEST(ConfigSnapshotTest, TypedGettersAndDiff) {
+    const ConfigSnapshot before({{"Storage/driver", QString("QSQLITE")},
+                                 {"Storage/busyTimeoutMs", QString("5000")},
+                                 {"HumanRecognition/MatchThreshold", 0.6},
+                                 {"Connect/endpoint", QString("127.0.0.1:9000")}},
+                                1);
+    EXPECT_EQ(5000, before.getInt("Storage/busyTimeoutMs"));
+    EXPECT_DOUBLE_EQ(0.6, before.getDouble("HumanRecognition/MatchThreshold"));
+    EXPECT_EQ(QString("fallback"), before.getString("Missing/key", "fallback"));
+    EXPECT_TRUE(before.getBool("Missing/flag", true));
+
+    const ConfigSnapshot after({{"Storage/driver", QString("QSQLITE")},
+                                {"HumanRecognition/MatchThreshold", 0.45},
+                                {"Connect/endpoint", QString("127.0.0.1:9000")},
+                                {"Storage/journalMode", QString("WAL")}},
+                               2);
+    EXPECT_EQ(QStringList({"HumanRecognition/MatchThreshold",
+                           "Storage/busyTimeoutMs",
+                           "Storage/journalMode"}),
+              after.diff(before));
+    EXPECT_TRUE(after.diff(after).isEmpty());
+}
+
+// 测试：写入发布新快照并只通知匹配前缀的订阅者
+// 场景：INI 放在临时目录；订阅 "HumanRecognition" 与 "Storage"，持有写入前的快照后加载一段 JSON
+// 断言：读取立即看到新值；旧快照内容与版本不变；HumanRecognition 订阅者只收到变化的阈值键，
+//      Storage 订阅者没有被调用；再次加载相同内容不产生通知；取消订阅后不再收到回调
+TEST(ConfigManagerTest, PublishesSnapshotsAndNotifiesSubscribers) {
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    QSettings::setPath(QSettings::IniFormat, QSettings::UserScope, dir.path());
+    auto& cfg = ConfigManager::instance();
+    cfg.init("CrossControlTests", "ConfigSnapshotTests");
+    ASSERT_TRUE(cfg.loadFromJsonString(
+        R"({"HumanRecognition": {"MatchThreshold": 0.6, "RerankTopK": 8}})"));
+
+    QStringList recognitionKeys;
+    double seenThreshold = 0.0;
+    int storageCalls = 0;
+    const quint64 recognition = cfg.subscribe(
+        "HumanRecognition", [&](const ConfigSnapshot& snapshot, const QStringList& keys) {
+            recognitionKeys << keys;
+            seenThreshold = snapshot.getDouble("HumanRecognition/MatchThreshold");
+        });
+    const quint64 storage =
+        cfg.subscribe("Storage/", [&](const ConfigSnapshot&, const QStringList&) {
+            ++storageCalls;
+        });
+
+    const auto before = cfg.snapshot();
+    ASSERT_TRUE(cfg.loadFromJsonString(
+        R"({"HumanRecognition": {"MatchThreshold": 0.45, "RerankTopK": 8}})"));
+    EXPECT_DOUBLE_EQ(0.45, cfg.getValue("HumanRecognition/MatchThreshold").toDouble());
+    EXPECT_DOUBLE_EQ(0.6, before->getDouble("HumanRecognition/MatchThreshold"));
+    EXPECT_GT(cfg.snapshot()->version(), before->version());
+    EXPECT_EQ(QStringList({"HumanRecognition/MatchThreshold"}), recognitionKeys);
+    EXPECT_DOUBLE_EQ(0.45, seenThreshold);
+    EXPECT_EQ(0, storageCalls);
+
+    const quint64 version = cfg.snapshot()->version();
+    ASSERT_TRUE(cfg.loadFromJsonString(R"({"HumanRecognition": {"MatchThreshold": 0.45}})"));
+    EXPECT_EQ(version, cfg.snapshot()->version());
+    EXPECT_EQ(1, recognitionKeys.size());
+
+    cfg.unsubscribe(recognition);
+    cfg.unsubscribe(storage);
+    ASSERT_TRUE(cfg.loadFromJsonString(R"({"HumanRecognition": {"MatchThreshold": 0.5}})"));
+    EXPECT_EQ(1, recognitionKeys.size());
+}
+
+// 测试：在回调中取消自身订阅
+// 场景：一次性订阅者在首次回调里调用 unsubscribe，随后再写入两次
+// 断言：unsubscribe 不会等待自身而阻塞；回调只执行一次
+TEST(ConfigManagerTest, CallbackCanUnsubscribeItself) {
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    QSettings::setPath(QSettings::IniFormat, QSettings::UserScope, dir.path());
+    auto& cfg = ConfigManager::instance();
+    cfg.init("CrossControlTests", "ConfigSnapshotTests");
+
+    int calls = 0;
+    quint64 id = 0;
+    id = cfg.subscribe("Storage", [&](const ConfigSnapshot&, const QStringList&) {
+        ++calls;
+        cfg.unsubscribe(id);
+    });
+    cfg.setValue("Storage/busyTimeoutMs", 1000);
+    cfg.setValue("Storage/busyTimeoutMs", 2000);
+    cfg.setValue("Storage/cacheSizeKiB", 4096);
+    EXPECT_EQ(1, calls);
+}
+
+// 测试：从 INI 重新发布快照时，只有类型变化的值不算修改
+// 场景：setValue 写入整型值与另一个无关键，随后 remove 无关键（从 INI 重新读取全部键）
+// 断言：订阅者只收到被删除的键，整型键不会因为读回字符串而被误报；其值仍可按整型读取
+TEST(ConfigManagerTest, RepublishIgnoresTypeOnlyDifferences) {
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    QSettings::setPath(QSettings::IniFormat, QSettings::UserScope, dir.path());
+    auto& cfg = ConfigManager::instance();
+    cfg.init("CrossControlTests", "ConfigSnapshotTests");
+    cfg.setValue("Storage/busyTimeoutMs", 5000);
+    cfg.setValue("Storage/journalMode", QString("WAL"));
+
+    QStringList seen;
+    const quint64 id = cfg.subscribe(
+        "Storage", [&](const ConfigSnapshot&, const QStringList& keys) { seen << keys; });
+    cfg.remove("Storage/journalMode");
+    cfg.unsubscribe(id);
+
+    EXPECT_EQ(QStringList({"Storage/journalMode"}), seen);
+    EXPECT_EQ(5000, cfg.snapshot()->getInt("Storage/busyTimeoutMs"));
+}
+
+// 测试：热加载只应用文件中变化的键，文件无法解析时保持现有配置
+// 场景：临时目录中的配置文件先后被改成新阈值、不完整的 JSON、再改回合法内容并修改另一个键
+// 断言：第一次回调只包含阈值键且读取到新值；不完整的文件不触发回调、配置不变；
+//      文件恢复合法后只通知新修改的键；停止监视后 hotReloadEnabled 为 false
+TEST(ConfigManagerTest, HotReloadAppliesChangedKeysAndSkipsInvalidFiles) {
+    // 监视线程的事件循环需要应用对象
+    int argc = 1;
+    char arg0[] = "ConfigTests";
+    char* argv[] = {arg0, nullptr};
+    QCoreApplication app(argc, argv);
+
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    QSettings::setPath(QSettings::IniFormat, QSettings::UserScope, dir.path());
+    auto& cfg = ConfigManager::instance();
+    cfg.init("CrossControlTests", "ConfigSnapshotTests");
+
+    const QString path = dir.filePath("CrossControlConfig.json");
+    ASSERT_TRUE(writeFile(path, R"({"HotReload": {"Threshold": 0.6, "Mode": "a"}})"));
+    ASSERT_TRUE(cfg.loadFromJsonFile(path, false));
+
+    std::mutex mutex;
+    QList<QStringList> notifications;
+    const quint64 id =
+        cfg.subscribe("HotReload", [&](const ConfigSnapshot&, const QStringList& keys) {
+            std::lock_guard<std::mutex> lock(mutex);
+            notifications << keys;
+        });
+    const auto count = [&]() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return notifications.size();
+    };
+
+    ASSERT_TRUE(cfg.enableHotReload(path, 20));
+    EXPECT_TRUE(cfg.hotReloadEnabled());
+
+    ASSERT_TRUE(writeFile(path, R"({"HotReload": {"Threshold": 0.45, "Mode": "a"}})"));
+    ASSERT_TRUE(waitFor([&]() { return count() >= 1; }));
+    EXPECT_DOUBLE_EQ(0.45, cfg.getValue("HotReload/Threshold").toDouble());
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        EXPECT_EQ(QStringList({"HotReload/Threshold"}), notifications.at(0));
+    }
+
+    ASSERT_TRUE(writeFile(path, R"({"HotReload": {"Threshold": 0.1,)"));
+    QThread::msleep(300);
+    EXPECT_EQ(1, count());
+    EXPECT_DOUBLE_EQ(0.45, cfg.getValue("HotReload/Threshold").toDouble());
+
+    ASSERT_TRUE(writeFile(path, R"({"HotReload": {"Threshold": 0.45, "Mode": "b"}})"));
+    ASSERT_TRUE(waitFor([&]() { return count() >= 2; }));
+    EXPECT_EQ(QString("b"), cfg.getString("HotReload/Mode"));
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        EXPECT_EQ(QStringList({"HotReload/Mode"}), notifications.at(1));
+    }
+
+    cfg.disableHotReload();
+    EXPECT_FALSE(cfg.hotReloadEnabled());
+    cfg.unsubscribe(id);
+}
+
+}  // namespace
@@ -0,0 +1,187 @@
+#include <gtest/gtest.h>
+
+#include <QHash>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "modules/Connect/timer_wheel.h"
+
+namespace {
+
+using std::chrono::milliseconds;
+
+// 测试：定时器在各层之间下放后仍恰好在到期 tick 触发，取消的定时器不触发
+// 场景：3 位格子、3 层（最远 512 tick）的时间轮，随机调度 2000 个 1..3000 tick 的定时器并随机取消，
+//      逐 tick 推进
+// 断言：每个未取消的定时器只触发一次且触发时刻等于调度时刻 + 延迟；超出最高层范围的也不例外；
+//      取消成功的不触发；最后没有残留定时器
+TEST(TimerWheelTest, FiresAtDeadlineAcrossLevels) {
+    TimerWheelOptions options;
+    options.tick = milliseconds(1);
+    options.slotBits = 3;
+    options.levels = 3;
+    TimerWheel wheel(options);
+
+    std::mt19937 rng(7);
+    qint64 now = 0;
+    QHash<int, qint64> expected;
+    QHash<int, qint64> fired;
+    QHash<int, TimerId> ids;
+    int duplicates = 0;
+    for (int i = 0; i < 2000; ++i) {
+        const int step = static_cast<int>(rng() % 8);
+        for (int s = 0; s < step; ++s) {
+            ++now;
+            wheel.advance(milliseconds(1));
+        }
+        const qint64 delay = 1 + static_cast<qint64>(rng() % 3000);
+        expected.insert(i, now + delay);
+        ids.insert(i, wheel.schedule(milliseconds(delay), [&, i]() {
+            if (fired.contains(i)) ++duplicates;
+            fired.insert(i, now);
+        }));
+        if (rng() % 10 == 0) {
+            const int victim = static_cast<int>(rng() % (i + 1));
+            if (!fired.contains(victim) && wheel.cancel(ids.value(victim))) {
+                expected.remove(victim);
+            }
+        }
+    }
+    for (int s = 0; s < 3100; ++s) {
+        ++now;
+        wheel.advance(milliseconds(1));
+    }
+
+    EXPECT_EQ(0, duplicates);
+    EXPECT_EQ(expected.size(), fired.size());
+    for (auto it = expected.cbegin(); it != expected.cend(); ++it) {
+        ASSERT_TRUE(fired.contains(it.key())) << "timer " << it.key();
+        EXPECT_EQ(it.value(), fired.value(it.key())) << "timer " << it.key();
+    }
+    EXPECT_EQ(0u, wheel.pending());
+}
+
+// 测试：周期定时器与在回调中取消
+// 场景：100ms 周期定时器推进 1s 后取消再推进 1s；另一个周期定时器在第 3 次回调中取消自身
+// 断言：第一个触发 10 次且取消后不再触发；第二个恰好触发 3 次；失效标识的 cancel 返回 false
+TEST(TimerWheelTest, RepeatingTimersAndCancel) {
+    TimerWheel wheel;
+    int ticks = 0;
+    const TimerId keepalive = wheel.scheduleRepeating(milliseconds(100), [&]() { ++ticks; });
+    wheel.advance(milliseconds(1000));
+    EXPECT_EQ(10, ticks);
+    EXPECT_TRUE(wheel.cancel(keepalive));
+    EXPECT_FALSE(wheel.cancel(keepalive));
+    wheel.advance(milliseconds(1000));
+    EXPECT_EQ(10, ticks);
+
+    int retries = 0;
+    TimerId retry = 0;
+    retry = wheel.scheduleRepeating(milliseconds(50), [&]() {
+        if (++retries == 3) wheel.cancel(retry);
+    });
+    wheel.advance(milliseconds(1000));
+    EXPECT_EQ(3, retries);
+    EXPECT_EQ(0u, wheel.pending());
+}
+
+// 测试：驱动线程按真实时间触发，cancel 等待正在执行的回调结束
+// 场景：启动驱动线程，调度 30ms 定时器；再调度一个执行 100ms 的回调并在其执行期间取消
+// 断言：30ms 定时器在 1s 内触发且不早于 30ms；cancel 返回时回调已经结束
+TEST(TimerWheelTest, DrivingThreadFiresInRealTime) {
+    TimerWheel wheel;
+    wheel.start();
+
+    const auto begin = std::chrono::steady_clock::now();
+    std::atomic<qint64> elapsedMs{-1};
+    wheel.schedule(milliseconds(30), [&]() {
+        elapsedMs = std::chrono::duration_cast<milliseconds>(std::chrono::steady_clock::now() -
+                                                             begin)
+                        .count();
+    });
+    for (int i = 0; i < 100 && elapsedMs.load() < 0; ++i) {
+        std::this_thread::sleep_for(milliseconds(10));
+    }
+    EXPECT_GE(elapsedMs.load(), 30);
+
+    std::atomic<bool> entered{false};
+    std::atomic<bool> finished{false};
+    const TimerId slow = wheel.schedule(milliseconds(10), [&]() {
+        entered = true;
+        std::this_thread::sleep_for(milliseconds(100));
+        finished = true;
+    });
+    for (int i = 0; i < 100 && !entered.load(); ++i) std::this_thread::sleep_for(milliseconds(5));
+    ASSERT_TRUE(entered.load());
+    EXPECT_TRUE(wheel.cancel(slow));
+    EXPECT_TRUE(finished.load());
+    wheel.stop();
+}
+
+// 测试：驱动线程睡到远处的定时器时，新插入的近期定时器仍按真实时间触发
+// 场景：先调度 2 秒后的定时器让驱动线程长睡，300ms 后再调度 50ms 的定时器
+// 断言：近期定时器在插入后约 50ms 触发（不会因为 tick 落后而立刻触发，也不会等到远处的定时器）；
+//      远处的定时器此时尚未触发
+TEST(TimerWheelTest, DriverWakesForTimersInsertedWhileSleeping) {
+    TimerWheel wheel;
+    wheel.start();
+
+    std::atomic<bool> farFired{false};
+    wheel.schedule(milliseconds(2000), [&]() { farFired = true; });
+    std::this_thread::sleep_for(milliseconds(300));
+
+    const auto begin = std::chrono::steady_clock::now();
+    std::atomic<qint64> elapsedMs{-1};
+    wheel.schedule(milliseconds(50), [&]() {
+        elapsedMs = std::chrono::duration_cast<milliseconds>(std::chrono::steady_clock::now() -
+                                                             begin)
+                        .count();
+    });
+    for (int i = 0; i < 100 && elapsedMs.load() < 0; ++i) {
+        std::this_thread::sleep_for(milliseconds(10));
+    }
+    EXPECT_GE(elapsedMs.load(), 40);
+    EXPECT_LT(elapsedMs.load(), 1000);
+    EXPECT_FALSE(farFired.load());
+    wheel.stop();
+}
+
+// 测试：驱动线程模式下定时器不会早于 delay 触发
+// 场景：tick=10ms；在 tick 内的不同时刻依次调度 40 个 1~35ms 的定时器，记录调度前后的时间
+// 断言：全部触发；每个定时器从调度开始到触发的耗时都不小于各自的 delay
+TEST(TimerWheelTest, DrivingThreadNeverFiresBeforeDeadline) {
+    TimerWheel wheel;
+    wheel.start();
+
+    constexpr int kTimers = 40;
+    std::mt19937 rng(11);
+    std::uniform_int_distribution<int> delayMs(1, 35);
+    std::uniform_int_distribution<int> gapUs(0, 7000);
+    std::vector<qint64> delays(kTimers);
+    std::vector<std::atomic<qint64>> elapsedUs(kTimers);
+    for (int i = 0; i < kTimers; ++i) {
+        elapsedUs[i] = -1;
+        delays[i] = delayMs(rng);
+        const auto begin = std::chrono::steady_clock::now();
+        wheel.schedule(milliseconds(delays[i]), [&elapsedUs, i, begin]() {
+            elapsedUs[i] = std::chrono::duration_cast<std::chrono::microseconds>(
+                               std::chrono::steady_clock::now() - begin)
+                               .count();
+        });
+        std::this_thread::sleep_for(std::chrono::microseconds(gapUs(rng)));
+    }
+    for (int i = 0; i < 200 && wheel.pending() > 0; ++i) {
+        std::this_thread::sleep_for(milliseconds(10));
+    }
+    wheel.stop();
+
+    for (int i = 0; i < kTimers; ++i) {
+        ASSERT_GE(elapsedUs[i].load(), 0) << "timer " << i << " did not fire";
+        EXPECT_GE(elapsedUs[i].load(), delays[i] * 1000) << "timer " << i << " fired early";
+    }
+}
+
+}  // namespace
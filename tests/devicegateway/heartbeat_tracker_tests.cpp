@@ -0,0 +1,172 @@
+﻿#include <gtest/gtest.h>
+
+#include <QDateTime>
+#include <QSettings>
+#include <QTemporaryDir>
+#include <QtSql/QSqlQuery>
+#include <chrono>
+#include <memory>
+#include <utility>
+
+#include "modules/Config/config.h"
+#include "modules/Connect/timer_wheel.h"
+#include "modules/DeviceGateway/heartbeat_tracker.h"
+#include "modules/Storage/dbmanager.h"
+#include "modules/Storage/write_behind.h"
+
+namespace DeviceGateway::tests {
+
+namespace {
+
+using std::chrono::milliseconds;
+
+/**
+ * @brief devices 表在新的共享缓存内存库中；每个测试使用自己的、手动推进的时间轮
+ */
+class HeartbeatTrackerTest : public ::testing::Test {
+   protected:
+    static void SetUpTestSuite() {
+        s_dir = std::make_unique<QTemporaryDir>();
+        QSettings::setPath(QSettings::IniFormat, QSettings::UserScope, s_dir->path());
+        auto& cfg = config::ConfigManager::instance();
+        cfg.init("CrossControlTests", "HeartbeatTrackerTests");
+        ASSERT_TRUE(cfg.loadFromJsonString(R"({"Storage": {"database": ":memory:"}})"));
+    }
+
+    static void TearDownTestSuite() {
+        storage::WriteBehindQueue::instance().shutdown();
+        storage::DbManager::instance().close();
+        s_dir.reset();
+    }
+
+    void SetUp() override { ASSERT_TRUE(storage::DbManager::instance().init(true)); }
+
+    static bool insertDevice(const QString& id, const QString& status, qint64 lastSeen) {
+        auto& manager = storage::DbManager::instance();
+        const auto writeLock = manager.writeLock();
+        QSqlQuery q(manager.db());
+        q.prepare(QStringLiteral("INSERT INTO devices(id, status, last_seen) VALUES (?, ?, ?)"));
+        q.addBindValue(id);
+        q.addBindValue(status);
+        q.addBindValue(lastSeen);
+        return q.exec();
+    }
+
+    static std::pair<QString, qint64> storedDevice(const QString& id) {
+        QSqlQuery q(storage::DbManager::instance().db());
+        q.prepare(QStringLiteral("SELECT status, last_seen FROM devices WHERE id = ?"));
+        q.addBindValue(id);
+        if (!q.exec() || !q.next()) return {};
+        return {q.value(0).toString(), q.value(1).toLongLong()};
+    }
+
+    static std::unique_ptr<QTemporaryDir> s_dir;
+};
+
+std::unique_ptr<QTemporaryDir> HeartbeatTrackerTest::s_dir;
+
+}  // namespace
+
+// 测试：touch 更新 lastSeen 与在线状态并标记脏
+// 场景：注册设备后按句柄与按 id 各 touch 一次，其中一次时间戳更早；再注销并用旧句柄 touch
+// 断言：注册幂等；首次 touch 后为 Online，lastSeen 不回退；脏条目只取出一次；
+//      未注册的 id 返回 false；注销后旧句柄的 touch 被忽略
+TEST_F(HeartbeatTrackerTest, TouchMarksDeviceOnlineAndDirty) {
+    TimerWheel wheel;
+    HeartbeatTracker tracker({}, wheel);
+
+    const HeartbeatHandle h = tracker.registerDevice(QStringLiteral("dev1"));
+    ASSERT_TRUE(h.isValid());
+    EXPECT_EQ(h.slot, tracker.registerDevice(QStringLiteral("dev1")).slot);
+    EXPECT_EQ(DeviceLiveness::Unknown, tracker.state(QStringLiteral("dev1"))->liveness);
+    EXPECT_TRUE(tracker.takeDirty().isEmpty());
+
+    tracker.touch(h, 5000);
+    EXPECT_TRUE(tracker.touch(QStringLiteral("dev1"), 4000));
+    EXPECT_FALSE(tracker.touch(QStringLiteral("missing"), 4000));
+    const auto state = tracker.state(QStringLiteral("dev1"));
+    ASSERT_TRUE(state.has_value());
+    EXPECT_EQ(DeviceLiveness::Online, state->liveness);
+    EXPECT_EQ(5000, state->lastSeenMs);
+
+    const QVector<HeartbeatState> dirty = tracker.takeDirty();
+    ASSERT_EQ(1, dirty.size());
+    EXPECT_EQ(QStringLiteral("dev1"), dirty.front().id);
+    EXPECT_TRUE(tracker.takeDirty().isEmpty());
+
+    tracker.unregisterDevice(QStringLiteral("dev1"));
+    const HeartbeatHandle reused = tracker.registerDevice(QStringLiteral("dev2"));
+    EXPECT_EQ(h.slot, reused.slot);
+    tracker.touch(h, 9000);
+    EXPECT_EQ(DeviceLiveness::Unknown, tracker.state(QStringLiteral("dev2"))->liveness);
+    EXPECT_TRUE(tracker.takeDirty().isEmpty());
+}
+
+// 测试：超时未上报的设备在到期检查时转为离线，仍有心跳的设备保持在线
+// 场景：timeout=1s；fresh 以当前时间上报，stale 的最后一次上报在 5s 前；手动推进时间轮 1s
+// 断言：stale 变为 Offline 并重新标记为脏；fresh 的到期检查按最新 lastSeen 重排，仍为 Online
+TEST_F(HeartbeatTrackerTest, StaleDeviceGoesOfflineOnExpiry) {
+    TimerWheel wheel;
+    HeartbeatOptions options;
+    options.timeout = milliseconds(1000);
+    options.flushInterval = std::chrono::hours(1);
+    HeartbeatTracker tracker(options, wheel);
+    tracker.registerDevice(QStringLiteral("fresh"));
+    tracker.registerDevice(QStringLiteral("stale"));
+    tracker.start();
+
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    tracker.touch(QStringLiteral("fresh"), now);
+    tracker.touch(QStringLiteral("stale"), now - 5000);
+    EXPECT_EQ(2, tracker.takeDirty().size());
+
+    wheel.advance(milliseconds(1000));
+
+    EXPECT_EQ(DeviceLiveness::Online, tracker.state(QStringLiteral("fresh"))->liveness);
+    EXPECT_EQ(DeviceLiveness::Offline, tracker.state(QStringLiteral("stale"))->liveness);
+    const QVector<HeartbeatState> dirty = tracker.takeDirty();
+    ASSERT_EQ(1, dirty.size());
+    EXPECT_EQ(QStringLiteral("stale"), dirty.front().id);
+    EXPECT_EQ(DeviceLiveness::Offline, dirty.front().liveness);
+    tracker.stop();
+}
+
+// 测试：周期 flush 把脏条目批量写入 devices 表，只更新 status 与 last_seen
+// 场景：三台设备已持久化；flushInterval=500ms；online 以当前时间上报，offline 在 5s 前上报后超时，
+//      idle 没有上报；推进时间轮触发周期 flush 并等待写队列提交
+// 断言：online/offline 的 status 与 last_seen（秒）已更新；idle 保持原值；再次 flush 时没有脏条目
+TEST_F(HeartbeatTrackerTest, PeriodicFlushBatchesDirtyStatesIntoDevicesTable) {
+    ASSERT_TRUE(insertDevice(QStringLiteral("online"), QStringLiteral("offline"), 10));
+    ASSERT_TRUE(insertDevice(QStringLiteral("offline"), QStringLiteral("online"), 20));
+    ASSERT_TRUE(insertDevice(QStringLiteral("idle"), QStringLiteral("offline"), 30));
+
+    TimerWheel wheel;
+    HeartbeatOptions options;
+    options.timeout = milliseconds(1000);
+    options.flushInterval = milliseconds(500);
+    HeartbeatTracker tracker(options, wheel);
+    for (const char* id : {"online", "offline", "idle"}) {
+        ASSERT_TRUE(tracker.registerDevice(QString::fromLatin1(id)).isValid());
+    }
+    tracker.start();
+
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    const qint64 stale = now - 5000;
+    tracker.touch(QStringLiteral("online"), now);
+    tracker.touch(QStringLiteral("offline"), stale);
+    wheel.advance(milliseconds(500));
+    ASSERT_TRUE(storage::WriteBehindQueue::instance().flush());
+
+    EXPECT_EQ(std::make_pair(QStringLiteral("online"), now / 1000),
+              storedDevice(QStringLiteral("online")));
+    EXPECT_EQ(std::make_pair(QStringLiteral("offline"), stale / 1000),
+              storedDevice(QStringLiteral("offline")));
+    EXPECT_EQ(std::make_pair(QStringLiteral("offline"), qint64(30)),
+              storedDevice(QStringLiteral("idle")));
+    EXPECT_TRUE(tracker.takeDirty().isEmpty());
+    auto empty = tracker.flush();
+    EXPECT_TRUE(empty.get());
+    tracker.stop();
+}
+
+}  // namespace DeviceGateway::tests
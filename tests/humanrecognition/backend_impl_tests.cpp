@@ -2,11 +2,16 @@
 #include <dlib/image_transforms.h>
 #include <gtest/gtest.h>
 
+#include <QImage>
 #include <QJsonObject>
 #include <QString>
+#include <QStringList>
+#include <QVector>
 #include <filesystem>
+#include <mutex>
 #include <optional>
 #include <string>
+#include <vector>
 
 #include "modules/HumanRecognition/types.h"
 #include "src/modules/HumanRecognition/impl/opencv_dlib/internal/backend_impl.h"
@@ -48,6 +53,65 @@ class ImplAccessor {
         ::HumanRecognition::OpenCVDlibBackend::Impl impl;
         return impl.computeDistance(a, b);
     }
+
+    /// 以指定编码构建量化人员库后，依次应用单条增删，返回最终的人员库状态
+    struct GallerySync {
+        int rows = 0;
+        bool dirty = true;
+        QStringList ids;
+    };
+    static GallerySync applyIncremental(FeatureEncoding encoding,
+                                        const QVector<PersonInfo>& initial,
+                                        const QVector<PersonInfo>& upserts,
+                                        const QStringList& removals) {
+        ::HumanRecognition::OpenCVDlibBackend::Impl impl;
+        std::scoped_lock lock(impl.mutex);
+        impl.galleryEncoding = encoding;
+        for (const PersonInfo& person : initial) impl.persons.insert(person.id, person);
+        impl.galleryDirty = true;
+        impl.rebuildGalleryIfNeeded();
+        for (const PersonInfo& person : upserts) impl.applyPersonUpsert(person);
+        for (const QString& id : removals) impl.applyPersonRemoval(id);
+
+        GallerySync sync;
+        sync.dirty = impl.galleryDirty;
+        if (impl.gallery) {
+            sync.rows = impl.gallery->size();
+            for (auto it = impl.persons.cbegin(); it != impl.persons.cend(); ++it) {
+                if (impl.gallery->contains(it.key())) sync.ids.append(it.key());
+            }
+            sync.ids.sort();
+        }
+        return sync;
+    }
+
+    /// 以指定编码建库后的常驻特征情况，以及对外查询与检索的结果（无存储，重排只能用近似距离）
+    struct QuantizedResidency {
+        int residentFloats = 0;
+        HRCode personCode = HRCode::UnknownError;
+        PersonInfo person;
+        HRCode matchCode = HRCode::UnknownError;
+        RecognitionMatch match;
+    };
+    static QuantizedResidency inspectResidency(FeatureEncoding encoding,
+                                               const QVector<PersonInfo>& initial,
+                                               const FaceFeature& query) {
+        ::HumanRecognition::OpenCVDlibBackend::Impl impl;
+        QuantizedResidency out;
+        {
+            std::scoped_lock lock(impl.mutex);
+            impl.galleryEncoding = encoding;
+            for (const PersonInfo& person : initial) impl.persons.insert(person.id, person);
+            impl.galleryDirty = true;
+            impl.rebuildGalleryIfNeeded();
+            for (auto it = impl.persons.cbegin(); it != impl.persons.cend(); ++it) {
+                if (it.value().canonicalFeature.has_value()) ++out.residentFloats;
+            }
+        }
+        if (!initial.isEmpty()) out.personCode = impl.getPerson(initial.front().id, out.person);
+        out.matchCode = impl.findNearest(query, out.match);
+        return out;
+    }
 };
 
 }  // namespace HumanRecognition::test
@@ -243,4 +307,88 @@ TEST(OpenCVDlibBackendImplTest, ComputeDistanceWithRealModelOutput) {
     EXPECT_GT(diffDistance.value(), 0.05f);
 }
 
+// 测试：dlib 帧上下文记录源图像标识并按人脸框查找缓存的关键点
+// 场景：以 RGB888 图像构造上下文，缓存一个框对应的关键点
+// 断言：cacheKey/尺寸与源图像一致，原图视图零拷贝；命中框返回关键点，其他框返回空
+TEST(OpenCVDlibBackendImplTest, FrameContextCachesShapesPerBox) {
+    QImage image(64, 48, QImage::Format_RGB888);
+    image.fill(Qt::gray);
+    detail::DlibFrameContext context(image, detail::RgbImageView::fromQImage(image));
+
+    EXPECT_EQ(image.cacheKey(), context.sourceCacheKey());
+    EXPECT_EQ(image.size(), context.sourceSize());
+    EXPECT_TRUE(context.original.isZeroCopy());
+
+    const QRect box(10, 8, 20, 20);
+    std::vector<dlib::point> parts = {dlib::point(15, 15), dlib::point(25, 15)};
+    context.shapes.emplace_back(
+        box, dlib::full_object_detection(dlib::rectangle(10, 8, 29, 27), parts));
+
+    const dlib::full_object_detection* cached = context.shapeFor(box);
+    ASSERT_NE(nullptr, cached);
+    EXPECT_EQ(2u, cached->num_parts());
+    EXPECT_EQ(nullptr, context.shapeFor(QRect(0, 0, 20, 20)));
+}
+
+// 测试：单条注册/删除增量同步量化人员库，而不是标记整库重建
+// 场景：以 Int8 编码构建含 a、b 的人员库，随后新增 c、覆盖 a、新增维度不一致的 d、删除 b
+// 断言：人员库保持非脏状态；最终只包含 a 与 c，维度不一致的 d 不进入量化库
+TEST(OpenCVDlibBackendImplTest, IncrementalGallerySyncAvoidsRebuild) {
+    const auto makePerson = [](const QString& id, int dimension, float value) {
+        PersonInfo person;
+        person.id = id;
+        FaceFeature feature;
+        feature.values = QVector<float>(dimension, value);
+        feature.version = QStringLiteral("dlib_resnet_128");
+        person.canonicalFeature = feature;
+        return person;
+    };
+
+    const auto sync = test::ImplAccessor::applyIncremental(
+        FeatureEncoding::Int8,
+        {makePerson(QStringLiteral("a"), 128, 0.1f), makePerson(QStringLiteral("b"), 128, 0.2f)},
+        {makePerson(QStringLiteral("c"), 128, 0.3f),
+         makePerson(QStringLiteral("a"), 128, -0.1f),
+         makePerson(QStringLiteral("d"), 64, 0.4f)},
+        {QStringLiteral("b")});
+
+    EXPECT_FALSE(sync.dirty);
+    EXPECT_EQ(2, sync.rows);
+    EXPECT_EQ(QStringList({QStringLiteral("a"), QStringLiteral("c")}), sync.ids);
+}
+
+// 测试：量化编码下只有量化行常驻内存，对外查询返回反量化特征
+// 场景：以 Int8 编码构建含 a、b 的人员库（无存储）；查询 a，并以 a 的特征检索
+// 断言：persons 中不再保留 float 特征；getPerson 返回 128 维近似值，version 带 "@int8" 后缀；
+//      读不到人员表时按量化近似距离重排，仍命中 a 且距离接近 0
+TEST(OpenCVDlibBackendImplTest, QuantizedGalleryKeepsOnlyCodesResident) {
+    const auto makePerson = [](const QString& id, float value) {
+        PersonInfo person;
+        person.id = id;
+        FaceFeature feature;
+        feature.values = QVector<float>(128, value);
+        feature.version = QStringLiteral("dlib_resnet_128");
+        person.canonicalFeature = feature;
+        return person;
+    };
+    const PersonInfo a = makePerson(QStringLiteral("a"), 0.1f);
+
+    const auto state = test::ImplAccessor::inspectResidency(
+        FeatureEncoding::Int8,
+        {a, makePerson(QStringLiteral("b"), -0.1f)},
+        a.canonicalFeature.value());
+
+    EXPECT_EQ(0, state.residentFloats);
+    ASSERT_EQ(HRCode::Ok, state.personCode);
+    ASSERT_TRUE(state.person.canonicalFeature.has_value());
+    const FaceFeature& decoded = state.person.canonicalFeature.value();
+    EXPECT_EQ(QStringLiteral("dlib_resnet_128@int8"), decoded.version);
+    ASSERT_EQ(128, decoded.values.size());
+    for (float v : decoded.values) EXPECT_NEAR(0.1f, v, 1e-2f);
+
+    ASSERT_EQ(HRCode::Ok, state.matchCode);
+    EXPECT_EQ(QStringLiteral("a"), state.match.personId);
+    EXPECT_NEAR(0.0f, state.match.distance, 5e-2f);
+}
+
 }  // namespace HumanRecognition::tests
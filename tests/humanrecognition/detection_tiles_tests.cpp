@@ -0,0 +1,132 @@
+﻿#include <gtest/gtest.h>
+
+#include <QRect>
+#include <QSize>
+#include <QVector>
+#include <algorithm>
+#include <cmath>
+
+#include "src/modules/HumanRecognition/internal/detection_tiles.h"
+
+namespace HumanRecognition::tests {
+
+// 测试：分块覆盖整幅图像，且任意不超过 overlap 的人脸都完整落在某个分块内
+// 场景：3840x2160（4K）图像、16 个目标分块、160 像素重叠，逐一枚举 160x160 的候选框
+// 断言：分块数大于 1；每个候选框都被至少一个分块完全包含
+TEST(DetectionTilesTest, TilesContainEveryFaceUpToOverlap) {
+    const QSize imageSize(3840, 2160);
+    const int overlap = 160;
+    const QVector<QRect> tiles = detail::computeDetectionTiles(imageSize, 16, overlap);
+    ASSERT_GT(tiles.size(), 1);
+
+    const QRect bounds(QPoint(0, 0), imageSize);
+    for (const QRect& tile : tiles) {
+        EXPECT_TRUE(bounds.contains(tile));
+        EXPECT_GE(tile.width(), 2 * overlap);
+    }
+
+    for (int y = 0; y + overlap <= imageSize.height(); y += 37) {
+        for (int x = 0; x + overlap <= imageSize.width(); x += 37) {
+            const QRect face(x, y, overlap, overlap);
+            const bool covered = std::any_of(tiles.cbegin(), tiles.cend(), [&](const QRect& t) {
+                return t.contains(face);
+            });
+            ASSERT_TRUE(covered) << "face at " << x << "," << y;
+        }
+    }
+}
+
+// 测试：小图或单线程时不分块
+// 场景：400x300 图像（小于两倍重叠宽度的网格）以及 targetTiles=1
+// 断言：只返回覆盖整图的一块
+TEST(DetectionTilesTest, SmallImageUsesSingleTile) {
+    const auto small = detail::computeDetectionTiles(QSize(400, 300), 8, 160);
+    ASSERT_EQ(1, small.size());
+    EXPECT_EQ(QRect(0, 0, 400, 300), small.front());
+
+    const auto single = detail::computeDetectionTiles(QSize(1920, 1080), 1, 160);
+    ASSERT_EQ(1, single.size());
+    EXPECT_TRUE(detail::computeDetectionTiles(QSize(), 4, 160).isEmpty());
+}
+
+// 测试：根据最大人脸尺寸计算 HOG 金字塔层数
+// 场景：窗口 80 像素，层间缩放 5/6
+// 断言：不大于窗口时只需 1 层；更大的人脸层数单调增加且最高层可覆盖目标尺寸
+TEST(DetectionTilesTest, PyramidLevelsCoverMaxFace) {
+    const double scale = 5.0 / 6.0;
+    EXPECT_EQ(1u, detail::pyramidLevelsForMaxFace(60, 80, scale));
+    EXPECT_EQ(1u, detail::pyramidLevelsForMaxFace(80, 80, scale));
+
+    const unsigned long levels160 = detail::pyramidLevelsForMaxFace(160, 80, scale);
+    const unsigned long levels400 = detail::pyramidLevelsForMaxFace(400, 80, scale);
+    EXPECT_LT(levels160, levels400);
+    EXPECT_GE(80.0 / std::pow(scale, static_cast<double>(levels160 - 1)), 160.0);
+}
+
+// 测试：IoU 与非极大值抑制合并跨分块重复的检测框
+// 场景：同一人脸在两个分块中各被检测一次（轻微偏移），另有一个被大框包含的框和一个独立人脸
+// 断言：重复框与被包含框被抑制，保留置信度最高的框与独立人脸
+TEST(DetectionTilesTest, NonMaxSuppressionMergesDuplicates) {
+    EXPECT_DOUBLE_EQ(1.0, detail::intersectionOverUnion(QRect(0, 0, 10, 10), QRect(0, 0, 10, 10)));
+    EXPECT_DOUBLE_EQ(0.0, detail::intersectionOverUnion(QRect(0, 0, 10, 10), QRect(20, 0, 10, 10)));
+
+    QVector<detail::ScoredRect> boxes = {
+        {QRect(100, 100, 80, 80), 0.9},
+        {QRect(104, 102, 80, 80), 1.4},
+        {QRect(90, 90, 120, 120), 0.5},
+        {QRect(600, 300, 90, 90), 0.7},
+    };
+    const auto kept = detail::nonMaxSuppression(boxes, 0.4);
+    ASSERT_EQ(2, kept.size());
+    EXPECT_EQ(QRect(104, 102, 80, 80), kept[0].rect);
+    EXPECT_EQ(QRect(600, 300, 90, 90), kept[1].rect);
+}
+
+// 测试：相交矩形的传递合并
+// 场景：A 与 B 相交、B 与 C 相交但 A 与 C 不相交，另有一个独立矩形 D
+// 断言：A、B、C 合并为一个外接矩形，D 原样保留，结果两两不相交
+TEST(DetectionTilesTest, MergeOverlappingRectsMergesChains) {
+    const QVector<QRect> merged = detail::mergeOverlappingRects({
+        QRect(0, 0, 20, 20),
+        QRect(100, 0, 20, 20),
+        QRect(15, 0, 90, 10),
+        QRect(300, 300, 10, 10),
+    });
+    ASSERT_EQ(2, merged.size());
+    EXPECT_EQ(QRect(0, 0, 120, 20), merged[0]);
+    EXPECT_EQ(QRect(300, 300, 10, 10), merged[1]);
+}
+
+// 测试：感兴趣区域的外扩、补足、合并与整图回退
+// 场景：1280x720 图像中两个相邻的小区域、一个贴边的小区域、一个完全在图外的区域；以及覆盖大半画面的区域
+// 断言：相邻区域外扩后合并为一个；小区域边长补足到 minSide 且不越界；图外区域被丢弃；大区域退回整图
+TEST(DetectionTilesTest, PrepareDetectionRegionsExpandsAndMerges) {
+    const QSize imageSize(1280, 720);
+    const QRect bounds(QPoint(0, 0), imageSize);
+    const QVector<QRect> regions = {
+        QRect(300, 300, 40, 40),
+        QRect(360, 300, 40, 40),
+        QRect(1270, 710, 10, 10),
+        QRect(2000, 2000, 50, 50),
+    };
+    const QVector<QRect> prepared = detail::prepareDetectionRegions(regions, imageSize, 40, 160);
+    ASSERT_EQ(2, prepared.size());
+    for (const QRect& r : prepared) {
+        EXPECT_TRUE(bounds.contains(r));
+        EXPECT_GE(r.width(), 160);
+        EXPECT_GE(r.height(), 160);
+    }
+    EXPECT_TRUE(prepared[0].contains(QRect(300, 300, 100, 40)));
+    EXPECT_TRUE(prepared[1].contains(QRect(1270, 710, 10, 10)));
+    EXPECT_FALSE(prepared[0].intersects(prepared[1]));
+
+    const QVector<QRect> large =
+        detail::prepareDetectionRegions({QRect(0, 0, 1100, 600)}, imageSize, 40, 160);
+    ASSERT_EQ(1, large.size());
+    EXPECT_EQ(bounds, large.front());
+
+    EXPECT_TRUE(detail::prepareDetectionRegions({QRect(5000, 0, 10, 10)}, imageSize, 40, 160)
+                    .isEmpty());
+}
+
+}  // namespace HumanRecognition::tests
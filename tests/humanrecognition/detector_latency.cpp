@@ -0,0 +1,109 @@
+﻿// 对比 OpenCV+dlib 后端 HOG 与 DNN（YuNet）检测器在不同分辨率下的延迟（ms / 百万像素）。
+//
+// 用法：DetectorLatency <模型目录> [图片路径] [每个尺寸的迭代次数]
+// 模型目录需包含 dlib 关键点/特征模型；目录中存在 face_detection_yunet*.onnx 时才测试 DNN 检测器。
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QImage>
+#include <QJsonObject>
+#include <QStringList>
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+#include "modules/HumanRecognition/impl/opencv_dlib/backend.h"
+
+namespace {
+
+struct Sample {
+    int width = 0;
+    int height = 0;
+    double meanMs = 0.0;
+    int faces = 0;
+};
+
+std::vector<Sample> measure(HumanRecognition::OpenCVDlibBackend& backend,
+                            const QImage& source,
+                            const std::vector<int>& widths,
+                            int iterations) {
+    std::vector<Sample> samples;
+    HumanRecognition::DetectOptions opts;
+    opts.detectLandmarks = false;
+    for (int width : widths) {
+        const QImage image = source.scaledToWidth(width, Qt::SmoothTransformation)
+                                 .convertToFormat(QImage::Format_RGB888);
+        QVector<HumanRecognition::FaceBox> boxes;
+        backend.detect(image, opts, boxes);  // 预热：模型懒加载、线程池创建
+
+        QElapsedTimer timer;
+        timer.start();
+        for (int i = 0; i < iterations; ++i) backend.detect(image, opts, boxes);
+        const double meanMs = static_cast<double>(timer.nsecsElapsed()) / 1e6 / iterations;
+        samples.push_back(
+            Sample{image.width(), image.height(), meanMs, static_cast<int>(boxes.size())});
+    }
+    return samples;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    QCoreApplication app(argc, argv);
+    const QStringList args = app.arguments();
+    if (args.size() < 2) {
+        std::fprintf(stderr, "usage: DetectorLatency <model-dir> [image] [iterations]\n");
+        return 2;
+    }
+    const QString modelDir = args.at(1);
+#ifdef PROJECT_SOURCE_DIR
+    const QString imagePath = args.size() > 2 ? args.at(2)
+                                              : QStringLiteral(PROJECT_SOURCE_DIR
+                                                               "/tests/humanrecognition/test1.jpg");
+#else
+    const QString imagePath = args.size() > 2 ? args.at(2) : QString();
+#endif
+    const int iterations = args.size() > 3 ? std::max(1, args.at(3).toInt()) : 10;
+
+    const QImage source(imagePath);
+    if (source.isNull()) {
+        std::fprintf(stderr, "failed to load image: %s\n", qPrintable(imagePath));
+        return 1;
+    }
+
+    QStringList detectors{QStringLiteral("hog")};
+    if (!QDir(modelDir).entryList({QStringLiteral("face_detection_yunet*.onnx")}).isEmpty()) {
+        detectors << QStringLiteral("dnn");
+    } else {
+        std::printf("no face_detection_yunet*.onnx in %s, skipping dnn\n", qPrintable(modelDir));
+    }
+
+    const std::vector<int> widths{640, 1280, 1920, 2560, 3840};
+    std::printf("%-8s %12s %8s %12s %10s %6s\n", "detector", "size", "MP", "ms", "ms/MP", "faces");
+    for (const QString& detector : detectors) {
+        HumanRecognition::OpenCVDlibBackend backend;
+        QJsonObject config;
+        config.insert(QStringLiteral("detector"), detector);
+        config.insert(QStringLiteral("modelDirectory"), modelDir);
+        if (backend.initialize(config) != HumanRecognition::HRCode::Ok) {
+            std::fprintf(stderr,
+                         "failed to initialize backend with detector %s\n",
+                         qPrintable(detector));
+            return 1;
+        }
+        for (const Sample& s : measure(backend, source, widths, iterations)) {
+            const double mp = static_cast<double>(s.width) * s.height / 1e6;
+            std::printf("%-8s %5dx%-6d %8.2f %12.2f %10.2f %6d\n",
+                        qPrintable(detector),
+                        s.width,
+                        s.height,
+                        mp,
+                        s.meanMs,
+                        s.meanMs / mp,
+                        s.faces);
+        }
+        backend.shutdown();
+    }
+    return 0;
+}
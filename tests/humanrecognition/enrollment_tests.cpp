@@ -0,0 +1,85 @@
+﻿#include <gtest/gtest.h>
+
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+#include <vector>
+
+#include "src/modules/HumanRecognition/internal/enrollment.h"
+
+namespace HumanRecognition::tests {
+
+namespace {
+
+bool touch(const QString& path) {
+    QFile file(path);
+    return file.open(QIODevice::WriteOnly | QIODevice::Truncate);
+}
+
+}  // namespace
+
+// 测试：数据集扫描只收录一级子目录中的图片
+// 场景：alice 有 2 张图片（含大写扩展名）和 1 个文本文件，bob 有 1 张 png，empty 没有图片，
+//      根目录下还有一张不属于任何人员的图片
+// 断言：人员按目录名排序且跳过 empty；样本按人员聚集并指向正确的人员下标
+TEST(EnrollmentTest, ScanCollectsImagesPerPersonDirectory) {
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    QDir root(dir.path());
+    ASSERT_TRUE(root.mkdir(QStringLiteral("bob")));
+    ASSERT_TRUE(root.mkdir(QStringLiteral("alice")));
+    ASSERT_TRUE(root.mkdir(QStringLiteral("empty")));
+    ASSERT_TRUE(touch(root.filePath(QStringLiteral("alice/1.jpg"))));
+    ASSERT_TRUE(touch(root.filePath(QStringLiteral("alice/2.JPG"))));
+    ASSERT_TRUE(touch(root.filePath(QStringLiteral("alice/notes.txt"))));
+    ASSERT_TRUE(touch(root.filePath(QStringLiteral("bob/a.png"))));
+    ASSERT_TRUE(touch(root.filePath(QStringLiteral("stray.jpg"))));
+
+    const detail::EnrollmentDataset dataset = detail::scanEnrollmentDataset(dir.path());
+    ASSERT_EQ(2, dataset.personIds.size());
+    EXPECT_EQ(QStringLiteral("alice"), dataset.personIds[0]);
+    EXPECT_EQ(QStringLiteral("bob"), dataset.personIds[1]);
+    ASSERT_EQ(3, dataset.samples.size());
+    EXPECT_EQ(0, dataset.samples[0].person);
+    EXPECT_EQ(0, dataset.samples[1].person);
+    EXPECT_EQ(1, dataset.samples[2].person);
+    EXPECT_TRUE(dataset.samples[2].path.endsWith(QStringLiteral("bob/a.png")));
+
+    EXPECT_TRUE(detail::scanEnrollmentDataset(root.filePath(QStringLiteral("missing")))
+                    .samples.isEmpty());
+}
+
+// 测试：按人员累加特征、跨线程合并后求平均
+// 场景：两个累加器分别收到同一人员的特征，另有一条维度不一致的特征
+// 断言：合并后均值与范数正确；维度不一致的特征被拒绝；没有特征的人员返回空
+TEST(EnrollmentTest, AccumulatorAveragesAndMergesPerPerson) {
+    detail::FeatureAccumulator first(3);
+    detail::FeatureAccumulator second(3);
+    const std::vector<float> a{1.0f, 0.0f};
+    const std::vector<float> b{3.0f, 4.0f};
+    const std::vector<float> c{2.0f, 2.0f};
+    const std::vector<float> wrong{1.0f, 2.0f, 3.0f};
+
+    EXPECT_TRUE(first.add(0, a.data(), 2));
+    EXPECT_TRUE(second.add(0, b.data(), 2));
+    EXPECT_TRUE(second.add(1, c.data(), 2));
+    EXPECT_FALSE(second.add(1, wrong.data(), 3));
+    EXPECT_FALSE(second.add(5, c.data(), 2));
+
+    first.merge(second);
+    EXPECT_EQ(2, first.count(0));
+    EXPECT_EQ(1, first.count(1));
+    EXPECT_EQ(0, first.count(2));
+
+    const auto mean = first.mean(0, QStringLiteral("v1"));
+    ASSERT_TRUE(mean.has_value());
+    ASSERT_EQ(2, mean->values.size());
+    EXPECT_FLOAT_EQ(2.0f, mean->values[0]);
+    EXPECT_FLOAT_EQ(2.0f, mean->values[1]);
+    EXPECT_EQ(QStringLiteral("v1"), mean->version);
+    ASSERT_TRUE(mean->norm.has_value());
+    EXPECT_NEAR(2.8284271f, mean->norm.value(), 1e-5f);
+    EXPECT_FALSE(first.mean(2, QStringLiteral("v1")).has_value());
+}
+
+}  // namespace HumanRecognition::tests
@@ -0,0 +1,125 @@
+﻿#include <gtest/gtest.h>
+
+#include <QRect>
+#include <QVector>
+
+#include "modules/HumanRecognition/face_tracker.h"
+
+namespace HumanRecognition::tests {
+
+namespace {
+
+FaceBox makeBox(const QRect& rect) {
+    FaceBox box;
+    box.rect = rect;
+    box.score = 1.0f;
+    return box;
+}
+
+/// 模拟调用方：对需要识别的轨迹回填结果，返回本帧执行的识别次数
+int recognizePending(FaceTracker& tracker, const QVector<FaceBox>& boxes) {
+    int count = 0;
+    for (const FaceBox& box : boxes) {
+        if (!tracker.needsRecognition(box.trackId)) continue;
+        RecognitionMatch match;
+        match.personId = QStringLiteral("p%1").arg(box.trackId);
+        tracker.setRecognition(box.trackId, match);
+        ++count;
+    }
+    return count;
+}
+
+}  // namespace
+
+// 测试：匀速移动的人脸在整个序列中保持同一 trackId，且只识别一次
+// 场景：100x100 的人脸每帧向右移动 30 像素（帧间 IoU 约 0.54），共 30 帧
+// 断言：所有帧的 trackId 相同；识别只在首帧发生
+TEST(FaceTrackerTest, MovingFaceKeepsTrackId) {
+    FaceTracker tracker;
+    int firstId = -1;
+    int recognitions = 0;
+    for (int frame = 0; frame < 30; ++frame) {
+        QVector<FaceBox> boxes = {makeBox(QRect(50 + 30 * frame, 200, 100, 100))};
+        tracker.update(boxes);
+        ASSERT_GE(boxes[0].trackId, 1);
+        if (frame == 0) firstId = boxes[0].trackId;
+        EXPECT_EQ(firstId, boxes[0].trackId) << "frame " << frame;
+        recognitions += recognizePending(tracker, boxes);
+    }
+    EXPECT_EQ(1, recognitions);
+    EXPECT_EQ(1u, tracker.stats().tracksCreated);
+}
+
+// 测试：短暂漏检时沿预测位置保留轨迹，长时间丢失后删除
+// 场景：人脸移动 5 帧后漏检 3 帧，再在外推位置重新出现；随后消失超过 maxMissedFrames
+// 断言：重新出现时沿用原编号且无需再次识别；超时后轨迹被删除，再出现时分配新编号
+TEST(FaceTrackerTest, ShortGapsKeepTrackLongGapsDropIt) {
+    FaceTrackerOptions options;
+    options.maxMissedFrames = 5;
+    FaceTracker tracker(options);
+
+    int id = -1;
+    int x = 100;
+    for (int frame = 0; frame < 5; ++frame, x += 20) {
+        QVector<FaceBox> boxes = {makeBox(QRect(x, 100, 120, 120))};
+        tracker.update(boxes);
+        id = boxes[0].trackId;
+        recognizePending(tracker, boxes);
+    }
+    for (int frame = 0; frame < 3; ++frame, x += 20) {
+        QVector<FaceBox> none;
+        tracker.update(none);
+        ASSERT_NE(nullptr, tracker.track(id));
+    }
+    QVector<FaceBox> again = {makeBox(QRect(x, 100, 120, 120))};
+    tracker.update(again);
+    EXPECT_EQ(id, again[0].trackId);
+    EXPECT_FALSE(tracker.needsRecognition(id));
+
+    for (int frame = 0; frame <= options.maxMissedFrames; ++frame) {
+        QVector<FaceBox> none;
+        tracker.update(none);
+    }
+    EXPECT_EQ(nullptr, tracker.track(id));
+    EXPECT_TRUE(tracker.tracks().isEmpty());
+
+    QVector<FaceBox> fresh = {makeBox(QRect(x, 100, 120, 120))};
+    tracker.update(fresh);
+    EXPECT_NE(id, fresh[0].trackId);
+    EXPECT_TRUE(tracker.needsRecognition(fresh[0].trackId));
+}
+
+// 测试：多目标稳定跟踪时识别次数大幅下降，并按周期复核
+// 场景：3 张互不重叠的静止人脸连续 100 帧，reverifyEveryNFrames=40
+// 断言：每条轨迹识别 3 次（首帧 + 两次复核），总识别次数比逐帧识别少 10 倍以上
+TEST(FaceTrackerTest, SteadyStateCutsRecognitionsAndReverifies) {
+    FaceTrackerOptions options;
+    options.reverifyEveryNFrames = 40;
+    FaceTracker tracker(options);
+
+    const QVector<QRect> faces = {
+        QRect(50, 50, 100, 100), QRect(300, 60, 110, 110), QRect(600, 40, 90, 90)};
+    int recognitions = 0;
+    int detections = 0;
+    for (int frame = 0; frame < 100; ++frame) {
+        QVector<FaceBox> boxes;
+        for (const QRect& rect : faces) boxes.append(makeBox(rect));
+        tracker.update(boxes);
+        detections += boxes.size();
+        recognitions += recognizePending(tracker, boxes);
+    }
+    EXPECT_EQ(3, tracker.tracks().size());
+    EXPECT_EQ(9, recognitions);
+    EXPECT_GT(detections, 10 * recognitions);
+
+    const auto stats = tracker.stats();
+    EXPECT_EQ(100u, stats.framesProcessed);
+    EXPECT_EQ(9u, stats.recognitionsRequested);
+    EXPECT_EQ(291u, stats.recognitionsReused);
+    for (const FaceTrack& track : tracker.tracks()) {
+        ASSERT_TRUE(track.match.has_value());
+        EXPECT_EQ(QStringLiteral("p%1").arg(track.id), track.match->personId);
+    }
+}
+
+}  // namespace HumanRecognition::tests
@@ -0,0 +1,380 @@
+﻿// HumanRecognition 热路径基准：检测（分辨率与线程扩展）、特征提取、人员库检索（1k~1M）、
+// 特征序列化往返与量化库构建。
+//
+// 输出 JSON 供性能追踪使用：
+//   HumanRecognitionBench --benchmark_out=hr_bench.json --benchmark_out_format=json
+// 特征提取基准需要 dlib 模型，目录取自环境变量 HR_BENCH_MODEL_DIR，默认 resources/models；
+// 模型缺失时这些基准会以错误跳过，其余基准不受影响。
+
+#include <benchmark/benchmark.h>
+#include <dlib/image_processing/shape_predictor.h>
+
+#include <QCoreApplication>
+#include <QImage>
+#include <QString>
+#include <QVector>
+#include <cmath>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <string>
+
+#include "modules/HumanRecognition/types.h"
+#include "src/modules/HumanRecognition/impl/opencv_dlib/internal/backend_impl.h"
+#include "src/modules/HumanRecognition/internal/quantized_gallery.h"
+
+#ifndef PROJECT_SOURCE_DIR
+#define PROJECT_SOURCE_DIR "."
+#endif
+
+namespace HumanRecognition::test {
+
+/**
+ * @brief 基准用的 Impl 访问器：直接填充人员缓存与模型，绕开数据库与配置中心。
+ */
+class ImplAccessor {
+   public:
+    using Impl = ::HumanRecognition::OpenCVDlibBackend::Impl;
+
+    static std::unique_ptr<Impl> create() {
+        auto impl = std::make_unique<Impl>();
+        impl->logger.reset();  // 逐次调用的 info 日志会淹没测量结果
+        return impl;
+    }
+
+    static void setPersons(Impl& impl,
+                           const QHash<QString, PersonInfo>& persons,
+                           FeatureEncoding encoding) {
+        std::scoped_lock lock(impl.mutex);
+        impl.persons = persons;
+        impl.galleryEncoding = encoding;
+        impl.gallery.reset();
+        impl.galleryDirty = true;
+        impl.matchThreshold = 0.0;  // 不按阈值拒绝，保证每次都走完整的比对与重排
+    }
+
+    static bool loadModels(Impl& impl, const QString& directory, std::string& error) {
+        const auto files = impl.resolveModelFiles(QFileInfo(directory));
+        if (!QFileInfo::exists(files.shapePredictor) || !QFileInfo::exists(files.recognition)) {
+            error = "dlib models not found in " + directory.toStdString();
+            return false;
+        }
+        auto predictor = std::make_unique<dlib::shape_predictor>();
+        auto net = std::make_unique<detail::FaceNet>();
+        try {
+            dlib::deserialize(files.shapePredictor.toStdString()) >> *predictor;
+            dlib::deserialize(files.recognition.toStdString()) >> *net;
+        } catch (const std::exception& ex) {
+            error = ex.what();
+            return false;
+        }
+        std::scoped_lock lock(impl.mutex);
+        impl.shapePredictor = std::move(predictor);
+        impl.recognitionNet = std::move(net);
+        return true;
+    }
+
+    static QString serializeFeature(Impl& impl, const FaceFeature& feature) {
+        return impl.serializeFeature(feature);
+    }
+
+    static std::optional<FaceFeature> deserializeFeature(Impl& impl, const QString& json) {
+        return impl.deserializeFeature(json);
+    }
+};
+
+}  // namespace HumanRecognition::test
+
+namespace HumanRecognition::bench {
+
+namespace {
+
+using test::ImplAccessor;
+
+constexpr int kFeatureDim = 128;
+
+/**
+ * @brief 生成单位长度的随机特征（模拟 dlib 128 维输出）。
+ */
+FaceFeature randomFeature(std::mt19937& rng) {
+    std::normal_distribution<float> dist(0.0f, 1.0f);
+    FaceFeature feature;
+    feature.values.resize(kFeatureDim);
+    double sum = 0.0;
+    for (float& v : feature.values) {
+        v = dist(rng);
+        sum += static_cast<double>(v) * v;
+    }
+    const float inv = static_cast<float>(1.0 / std::sqrt(sum));
+    for (float& v : feature.values) v *= inv;
+    feature.version = QStringLiteral("dlib_resnet_128");
+    feature.norm = 1.0f;
+    return feature;
+}
+
+/**
+ * @brief 按规模缓存合成人员库，不同编码 / 线程数的基准复用同一份数据。
+ */
+const QHash<QString, PersonInfo>& syntheticPersons(int count) {
+    static std::mutex mutex;
+    static std::map<int, QHash<QString, PersonInfo>> cache;
+    std::scoped_lock lock(mutex);
+    auto it = cache.find(count);
+    if (it != cache.end()) return it->second;
+
+    std::mt19937 rng(static_cast<std::mt19937::result_type>(count));
+    QHash<QString, PersonInfo> persons;
+    persons.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        PersonInfo person;
+        person.id = QStringLiteral("p%1").arg(i);
+        person.name = person.id;
+        person.canonicalFeature = randomFeature(rng);
+        persons.insert(person.id, std::move(person));
+    }
+    return cache.emplace(count, std::move(persons)).first->second;
+}
+
+QImage benchImage(int width) {
+    static const QImage source(
+        QStringLiteral(PROJECT_SOURCE_DIR "/tests/humanrecognition/test1.jpg"));
+    if (source.isNull()) return {};
+    return source.scaledToWidth(width, Qt::SmoothTransformation)
+        .convertToFormat(QImage::Format_RGB888);
+}
+
+QString modelDirectory() {
+    const char* env = std::getenv("HR_BENCH_MODEL_DIR");
+    return env && *env ? QString::fromLocal8Bit(env)
+                       : QStringLiteral(PROJECT_SOURCE_DIR "/resources/models");
+}
+
+void setImageCounters(benchmark::State& state, const QImage& image) {
+    const double megapixels = static_cast<double>(image.width()) * image.height() / 1e6;
+    state.counters["MP"] = megapixels;
+    state.counters["MP/s"] = benchmark::Counter(
+        megapixels * static_cast<double>(state.iterations()), benchmark::Counter::kIsRate);
+}
+
+// ---- 检测 ---------------------------------------------------------------------------------
+
+/// 单线程 HOG 检测随图像宽度的变化
+void BM_Detect(benchmark::State& state) {
+    const QImage image = benchImage(static_cast<int>(state.range(0)));
+    if (image.isNull()) {
+        state.SkipWithError("test image not found");
+        return;
+    }
+    auto impl = ImplAccessor::create();
+    DetectOptions opts;
+    opts.detectLandmarks = false;
+    opts.threads = 1;
+    QVector<FaceBox> boxes;
+    for (auto _ : state) {
+        impl->detect(image, opts, boxes);
+        benchmark::DoNotOptimize(boxes.data());
+    }
+    state.counters["faces"] = static_cast<double>(boxes.size());
+    setImageCounters(state, image);
+}
+BENCHMARK(BM_Detect)
+    ->Arg(640)
+    ->Arg(1280)
+    ->Arg(1920)
+    ->Arg(2560)
+    ->Arg(3840)
+    ->Unit(benchmark::kMillisecond);
+
+/// 4K 图像上分块并行检测的线程扩展（DetectOptions::threads）
+void BM_DetectThreads(benchmark::State& state) {
+    const QImage image = benchImage(3840);
+    if (image.isNull()) {
+        state.SkipWithError("test image not found");
+        return;
+    }
+    auto impl = ImplAccessor::create();
+    DetectOptions opts;
+    opts.detectLandmarks = false;
+    opts.threads = static_cast<int>(state.range(0));
+    QVector<FaceBox> boxes;
+    for (auto _ : state) {
+        impl->detect(image, opts, boxes);
+        benchmark::DoNotOptimize(boxes.data());
+    }
+    setImageCounters(state, image);
+}
+BENCHMARK(BM_DetectThreads)
+    ->RangeMultiplier(2)
+    ->Range(1, 16)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+// ---- 特征提取 ------------------------------------------------------------------------------
+
+struct ExtractFixture {
+    std::unique_ptr<ImplAccessor::Impl> impl;
+    QImage image;
+    QVector<FaceBox> boxes;
+    FrameContextPtr context;
+    std::string error;
+};
+
+/// 加载一次模型并在测试图像上检测出人脸，供特征提取基准复用
+ExtractFixture& extractFixture() {
+    static ExtractFixture fixture = []() {
+        ExtractFixture f;
+        f.impl = ImplAccessor::create();
+        f.image = benchImage(1280);
+        if (f.image.isNull()) {
+            f.error = "test image not found";
+            return f;
+        }
+        if (!ImplAccessor::loadModels(*f.impl, modelDirectory(), f.error)) return f;
+        DetectOptions opts;
+        opts.detectLandmarks = true;
+        if (f.impl->detectWithContext(f.image, opts, f.boxes, f.context) != HRCode::Ok) {
+            f.error = "no face detected in test image";
+        }
+        return f;
+    }();
+    return fixture;
+}
+
+/// 无上下文：每次都转换图像并重新预测关键点
+void BM_ExtractFeature(benchmark::State& state) {
+    ExtractFixture& f = extractFixture();
+    if (!f.error.empty()) {
+        state.SkipWithError(f.error.c_str());
+        return;
+    }
+    FaceFeature feature;
+    for (auto _ : state) {
+        f.impl->extractFeature(f.image, f.boxes.front(), feature);
+        benchmark::DoNotOptimize(feature.values.data());
+    }
+}
+BENCHMARK(BM_ExtractFeature)->Unit(benchmark::kMillisecond);
+
+/// 复用检测阶段的帧上下文（RGB 视图与关键点）
+void BM_ExtractFeatureWithContext(benchmark::State& state) {
+    ExtractFixture& f = extractFixture();
+    if (!f.error.empty()) {
+        state.SkipWithError(f.error.c_str());
+        return;
+    }
+    FaceFeature feature;
+    for (auto _ : state) {
+        f.impl->extractFeatureWithContext(f.context, f.image, f.boxes.front(), feature);
+        benchmark::DoNotOptimize(feature.values.data());
+    }
+}
+BENCHMARK(BM_ExtractFeatureWithContext)->Unit(benchmark::kMillisecond);
+
+// ---- 人员库检索 ----------------------------------------------------------------------------
+
+/// findNearest 随人员库规模（1k~1M）与编码的变化；参数为 {人数, FeatureEncoding}。
+/// 100 万条合成人员约占用 1 GB 内存，可用 --benchmark_filter 排除
+void BM_FindNearest(benchmark::State& state) {
+    const int count = static_cast<int>(state.range(0));
+    const auto encoding = static_cast<FeatureEncoding>(state.range(1));
+    auto impl = ImplAccessor::create();
+    ImplAccessor::setPersons(*impl, syntheticPersons(count), encoding);
+
+    std::mt19937 rng(42);
+    const FaceFeature query = randomFeature(rng);
+    RecognitionMatch match;
+    impl->findNearest(query, match);  // 量化库在首次检索时构建，不计入测量
+    for (auto _ : state) {
+        impl->findNearest(query, match);
+        benchmark::DoNotOptimize(match.distance);
+    }
+    state.SetLabel(featureEncodingName(encoding).toStdString());
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_FindNearest)
+    ->ArgsProduct({benchmark::CreateRange(1'000, 1'000'000, 10),
+                   {static_cast<int>(FeatureEncoding::Float32),
+                    static_cast<int>(FeatureEncoding::Float16),
+                    static_cast<int>(FeatureEncoding::Int8)}})
+    ->Unit(benchmark::kMicrosecond);
+
+/// 多个调用方并发检索同一后端实例（10 万人，int8），观察互斥锁下的吞吐扩展
+void BM_FindNearestConcurrent(benchmark::State& state) {
+    static std::unique_ptr<ImplAccessor::Impl> shared = []() {
+        auto impl = ImplAccessor::create();
+        ImplAccessor::setPersons(*impl, syntheticPersons(100'000), FeatureEncoding::Int8);
+        return impl;
+    }();
+    std::mt19937 rng(static_cast<std::mt19937::result_type>(state.thread_index()));
+    const FaceFeature query = randomFeature(rng);
+    RecognitionMatch match;
+    for (auto _ : state) {
+        shared->findNearest(query, match);
+        benchmark::DoNotOptimize(match.distance);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FindNearestConcurrent)
+    ->ThreadRange(1, 16)
+    ->UseRealTime()
+    ->Unit(benchmark::kMicrosecond);
+
+// ---- 序列化与人员库加载 ---------------------------------------------------------------------
+
+/// 单个特征的 JSON 序列化往返（数据库存取的主要开销）
+void BM_FeatureSerializationRoundTrip(benchmark::State& state) {
+    auto impl = ImplAccessor::create();
+    std::mt19937 rng(7);
+    const FaceFeature feature = randomFeature(rng);
+    for (auto _ : state) {
+        const QString json = ImplAccessor::serializeFeature(*impl, feature);
+        auto restored = ImplAccessor::deserializeFeature(*impl, json);
+        benchmark::DoNotOptimize(restored);
+    }
+}
+BENCHMARK(BM_FeatureSerializationRoundTrip);
+
+/// 模拟启动时的人员库加载：反序列化 N 条特征并构建 int8 量化库
+void BM_GalleryLoad(benchmark::State& state) {
+    const int count = static_cast<int>(state.range(0));
+    auto impl = ImplAccessor::create();
+    QVector<QString> stored;
+    stored.reserve(count);
+    for (const PersonInfo& person : syntheticPersons(count)) {
+        stored.append(ImplAccessor::serializeFeature(*impl, *person.canonicalFeature));
+    }
+
+    for (auto _ : state) {
+        detail::QuantizedGallery gallery(FeatureEncoding::Int8);
+        gallery.reserve(count);
+        for (int i = 0; i < stored.size(); ++i) {
+            if (auto feature = ImplAccessor::deserializeFeature(*impl, stored[i])) {
+                gallery.upsert(QString::number(i), *feature);
+            }
+        }
+        const int rows = gallery.size();
+        benchmark::DoNotOptimize(rows);
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_GalleryLoad)
+    ->RangeMultiplier(10)
+    ->Range(1'000, 100'000)
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+
+}  // namespace HumanRecognition::bench
+
+int main(int argc, char** argv) {
+    // 图像解码依赖 Qt 插件，需要先创建应用对象
+    QCoreApplication app(argc, argv);
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,78 @@
+﻿#include <gtest/gtest.h>
+
+#include <QColor>
+#include <QImage>
+
+#include "src/modules/HumanRecognition/impl/opencv_dlib/internal/image_view.h"
+
+namespace HumanRecognition::tests {
+
+namespace {
+
+QImage makeTestImage(QImage::Format format) {
+    QImage image(7, 5, QImage::Format_RGB888);
+    for (int y = 0; y < image.height(); ++y) {
+        for (int x = 0; x < image.width(); ++x) {
+            image.setPixelColor(x, y, QColor(10 * x + 1, 20 * y + 2, 3 + x + y));
+        }
+    }
+    return format == QImage::Format_RGB888 ? image : image.convertToFormat(format);
+}
+
+}  // namespace
+
+// 测试：RGB888 输入直接共享 QImage 的像素缓冲
+// 场景：构造 7x5 的 RGB888 图像（宽度为奇数，行跨度含填充字节）
+// 断言：视图为零拷贝，cv::Mat 数据指针与行跨度均与 QImage 一致
+TEST(RgbImageViewTest, Rgb888IsZeroCopy) {
+    const QImage image = makeTestImage(QImage::Format_RGB888);
+    const auto view = detail::RgbImageView::fromQImage(image);
+
+    ASSERT_FALSE(view.isNull());
+    EXPECT_TRUE(view.isZeroCopy());
+    EXPECT_EQ(image.constBits(), view.mat().data);
+    EXPECT_EQ(static_cast<size_t>(image.bytesPerLine()), view.mat().step[0]);
+}
+
+// 测试：各常见格式转换后 dlib 视图中的像素与原图一致（无通道错位）
+// 场景：RGB888、RGB32、ARGB32、RGBA8888、BGR888 以及走 Qt 回退路径的预乘格式
+// 断言：每个像素的 R/G/B 与原始颜色相同
+TEST(RgbImageViewTest, ConvertedFormatsKeepChannelOrder) {
+    const QImage reference = makeTestImage(QImage::Format_RGB888);
+    for (QImage::Format format : {QImage::Format_RGB888,
+                                  QImage::Format_RGB32,
+                                  QImage::Format_ARGB32,
+                                  QImage::Format_RGBA8888,
+                                  QImage::Format_BGR888,
+                                  QImage::Format_ARGB32_Premultiplied}) {
+        const auto view = detail::RgbImageView::fromQImage(makeTestImage(format));
+        ASSERT_FALSE(view.isNull()) << static_cast<int>(format);
+        const auto pixels = view.dlibView();
+        ASSERT_EQ(reference.width(), pixels.nc());
+        ASSERT_EQ(reference.height(), pixels.nr());
+        for (int y = 0; y < reference.height(); ++y) {
+            for (int x = 0; x < reference.width(); ++x) {
+                const QColor expected = reference.pixelColor(x, y);
+                const dlib::rgb_pixel& actual = pixels[y][x];
+                EXPECT_EQ(expected.red(), actual.red) << static_cast<int>(format);
+                EXPECT_EQ(expected.green(), actual.green) << static_cast<int>(format);
+                EXPECT_EQ(expected.blue(), actual.blue) << static_cast<int>(format);
+            }
+        }
+    }
+}
+
+// 测试：空图像与缩放
+// 场景：空 QImage；以及将 7x5 图像缩放到 14x10
+// 断言：空输入得到空视图；缩放结果尺寸正确且不再引用原缓冲
+TEST(RgbImageViewTest, NullImageAndResize) {
+    EXPECT_TRUE(detail::RgbImageView::fromQImage(QImage()).isNull());
+
+    const auto view = detail::RgbImageView::fromQImage(makeTestImage(QImage::Format_RGB888));
+    const auto scaled = view.resized(cv::Size(14, 10));
+    EXPECT_EQ(14, scaled.width());
+    EXPECT_EQ(10, scaled.height());
+    EXPECT_FALSE(scaled.isZeroCopy());
+}
+
+}  // namespace HumanRecognition::tests
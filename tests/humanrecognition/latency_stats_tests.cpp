@@ -0,0 +1,79 @@
+﻿#include <gtest/gtest.h>
+
+#include <QJsonArray>
+#include <QJsonObject>
+
+#include "src/modules/HumanRecognition/internal/latency_stats.h"
+
+namespace HumanRecognition::tests {
+
+// 测试：直方图分位数插值与 JSON 导出
+// 场景：90 个 3ms 样本与 10 个 250ms 样本，随后清空
+// 断言：p50 落在 (2, 5] 桶内；p95 在 (200, 300] 桶内插值为 250；均值/最大值正确；
+//      分桶数为上界数 + 1 且最后一桶 le 为 null；清空后计数与分位数归零
+TEST(LatencyStatsTest, HistogramPercentilesAndJson) {
+    detail::LatencyHistogram histogram;
+    for (int i = 0; i < 90; ++i) histogram.record(3.0);
+    for (int i = 0; i < 10; ++i) histogram.record(250.0);
+
+    EXPECT_EQ(100u, histogram.count());
+    EXPECT_NEAR(27.7, histogram.meanMs(), 1e-6);
+    EXPECT_DOUBLE_EQ(250.0, histogram.maxMs());
+    EXPECT_GT(histogram.percentile(0.50), 2.0);
+    EXPECT_LE(histogram.percentile(0.50), 5.0);
+    EXPECT_NEAR(250.0, histogram.percentile(0.95), 1e-9);
+
+    const QJsonObject json = histogram.toJson();
+    EXPECT_EQ(100, json.value(QStringLiteral("count")).toInt());
+    const QJsonArray buckets = json.value(QStringLiteral("buckets")).toArray();
+    ASSERT_EQ(static_cast<int>(detail::LatencyHistogram::kBoundsMs.size()) + 1, buckets.size());
+    EXPECT_TRUE(buckets.last().toObject().value(QStringLiteral("le")).isNull());
+
+    histogram.reset();
+    EXPECT_EQ(0u, histogram.count());
+    EXPECT_DOUBLE_EQ(0.0, histogram.percentile(0.95));
+}
+
+// 测试：降级策略按剩余预算逐级选择档位
+// 场景：1920x1080 帧；先没有样本，再依次记录完整处理 200ms、缩小处理 60ms、跳过关键点 30ms
+// 断言：无截止时间或无样本时完整处理，预算耗尽时丢帧；缩小档位未有样本时借用完整档位的速率；
+//      各档位生成的检测参数正确（长边缩到 640，小图不缩放，NoLandmarks 关闭关键点）
+TEST(LatencyStatsTest, DegradationPolicyChoosesLevelByBudget) {
+    detail::DegradationPolicy policy;
+    const QSize frame(1920, 1080);
+    const DetectOptions opts;
+
+    EXPECT_EQ(DegradationLevel::None, policy.choose(std::nullopt, frame, opts));
+    EXPECT_EQ(DegradationLevel::None, policy.choose(50.0, frame, opts));
+    EXPECT_EQ(DegradationLevel::Skipped, policy.choose(0.0, frame, opts));
+
+    const DetectOptions downscaled = policy.apply(DegradationLevel::Downscaled, frame, opts);
+    EXPECT_EQ(QSize(640, 360), downscaled.resizeTo);
+    EXPECT_TRUE(downscaled.detectLandmarks);
+    const DetectOptions noLandmarks = policy.apply(DegradationLevel::NoLandmarks, frame, opts);
+    EXPECT_EQ(QSize(640, 360), noLandmarks.resizeTo);
+    EXPECT_FALSE(noLandmarks.detectLandmarks);
+    EXPECT_EQ(QSize(0, 0),
+              policy.apply(DegradationLevel::Downscaled, QSize(320, 240), opts).resizeTo);
+    DetectOptions widthOnly;
+    widthOnly.resizeTo = QSize(1280, 0);
+    EXPECT_EQ(QSize(640, 360),
+              policy.apply(DegradationLevel::Downscaled, frame, widthOnly).resizeTo);
+
+    policy.observe(DegradationLevel::None, frame, opts, 200.0);
+    EXPECT_NEAR(200.0, policy.estimateMs(DegradationLevel::None, frame, opts).value(), 1e-6);
+    EXPECT_NEAR(200.0 * 0.2304 / 2.0736,
+                policy.estimateMs(DegradationLevel::Downscaled, frame, opts).value(),
+                1e-6);
+    EXPECT_EQ(DegradationLevel::None, policy.choose(300.0, frame, opts));
+    EXPECT_EQ(DegradationLevel::Downscaled, policy.choose(100.0, frame, opts));
+
+    policy.observe(DegradationLevel::Downscaled, frame, downscaled, 60.0);
+    EXPECT_EQ(DegradationLevel::Downscaled, policy.choose(100.0, frame, opts));
+    EXPECT_EQ(DegradationLevel::Skipped, policy.choose(50.0, frame, opts));
+
+    policy.observe(DegradationLevel::NoLandmarks, frame, noLandmarks, 30.0);
+    EXPECT_EQ(DegradationLevel::NoLandmarks, policy.choose(50.0, frame, opts));
+}
+
+}  // namespace HumanRecognition::tests
@@ -0,0 +1,144 @@
+﻿#include <gtest/gtest.h>
+
+#include <QFile>
+#include <QTemporaryDir>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "src/modules/HumanRecognition/internal/model_cache.h"
+
+namespace HumanRecognition::tests {
+
+namespace {
+
+using detail::ModelCache;
+
+bool writeFile(const QString& path, const QByteArray& content) {
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
+    return file.write(content) == content.size();
+}
+
+/// 返回文件内容长度作为“模型”，并统计加载次数
+ModelCache::Loader countingLoader(std::atomic<int>& loads) {
+    return [&loads](const QString& path) -> ModelCache::Model {
+        ++loads;
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly)) return {};
+        return std::make_shared<const qint64>(file.size());
+    };
+}
+
+}  // namespace
+
+// 测试：同一文件的并发请求只加载一次
+// 场景：8 个线程同时以 Prefetch 方式请求同一模型文件并等待结果
+// 断言：加载函数只执行一次；所有线程拿到同一个实例；统计为 1 次加载、7 次命中
+TEST(ModelCacheTest, ConcurrentAcquireLoadsOnce) {
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    const QString path = dir.filePath(QStringLiteral("model.dat"));
+    ASSERT_TRUE(writeFile(path, "0123456789"));
+
+    ModelCache cache;
+    std::atomic<int> loads{0};
+    std::vector<std::shared_ptr<const qint64>> results(8);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 8; ++i) {
+        threads.emplace_back([&, i]() {
+            const auto handle = cache.acquire(path,
+                                              QStringLiteral("test"),
+                                              countingLoader(loads),
+                                              ModelCache::LoadMode::Prefetch);
+            results[static_cast<std::size_t>(i)] = ModelCache::get<qint64>(handle);
+        });
+    }
+    for (auto& thread : threads) thread.join();
+
+    EXPECT_EQ(1, loads.load());
+    ASSERT_TRUE(results.front());
+    EXPECT_EQ(10, *results.front());
+    for (const auto& result : results) EXPECT_EQ(results.front().get(), result.get());
+    const ModelCache::Stats stats = cache.stats();
+    EXPECT_EQ(1u, stats.loads);
+    EXPECT_EQ(7u, stats.hits);
+    EXPECT_EQ(1, stats.entries);
+}
+
+// 测试：Lazy 模式推迟加载，文件变更后重新加载
+// 场景：以 Lazy 方式请求后先不取结果，再取结果；随后改写文件内容（大小变化）并再次请求
+// 断言：首次 get() 之前不加载；文件变更后得到新实例，旧实例仍然有效
+TEST(ModelCacheTest, LazyLoadAndReloadOnFileChange) {
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    const QString path = dir.filePath(QStringLiteral("model.dat"));
+    ASSERT_TRUE(writeFile(path, "abc"));
+
+    ModelCache cache;
+    std::atomic<int> loads{0};
+    const auto lazy = cache.acquire(
+        path, QStringLiteral("test"), countingLoader(loads), ModelCache::LoadMode::Lazy);
+    EXPECT_EQ(0, loads.load());
+    const auto first = ModelCache::get<qint64>(lazy);
+    ASSERT_TRUE(first);
+    EXPECT_EQ(1, loads.load());
+    EXPECT_EQ(3, *first);
+
+    ASSERT_TRUE(writeFile(path, "abcdef"));
+    const auto second = ModelCache::get<qint64>(cache.acquire(
+        path, QStringLiteral("test"), countingLoader(loads), ModelCache::LoadMode::Lazy));
+    ASSERT_TRUE(second);
+    EXPECT_EQ(2, loads.load());
+    EXPECT_EQ(6, *second);
+    EXPECT_EQ(3, *first);
+
+    // 不存在的文件返回无效句柄
+    EXPECT_FALSE(cache
+                     .acquire(dir.filePath(QStringLiteral("missing.dat")),
+                              QStringLiteral("test"),
+                              countingLoader(loads),
+                              ModelCache::LoadMode::Lazy)
+                     .valid());
+}
+
+// 测试：加载失败不被缓存，未被引用的条目可以回收
+// 场景：第一次加载抛出异常，第二次正常；释放外部引用后调用 evictUnused()
+// 断言：失败后再次请求会重新加载并成功，failures 计数为 1；
+//      外部仍持有引用时条目保留，释放后被回收
+TEST(ModelCacheTest, FailedLoadIsRetriedAndUnusedEntriesEvicted) {
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    const QString path = dir.filePath(QStringLiteral("model.dat"));
+    ASSERT_TRUE(writeFile(path, "data"));
+
+    ModelCache cache;
+    int attempts = 0;
+    const ModelCache::Loader flaky = [&attempts](const QString&) -> ModelCache::Model {
+        if (++attempts == 1) throw std::runtime_error("corrupt model");
+        return std::make_shared<const int>(42);
+    };
+
+    const auto failed = ModelCache::get<int>(
+        cache.acquire(path, QStringLiteral("test"), flaky, ModelCache::LoadMode::Lazy));
+    EXPECT_FALSE(failed);
+    EXPECT_EQ(1u, cache.stats().failures);
+
+    auto model = ModelCache::get<int>(
+        cache.acquire(path, QStringLiteral("test"), flaky, ModelCache::LoadMode::Lazy));
+    ASSERT_TRUE(model);
+    EXPECT_EQ(42, *model);
+    EXPECT_EQ(2, attempts);
+
+    EXPECT_EQ(0, cache.evictUnused());
+    EXPECT_EQ(1, cache.stats().entries);
+    model.reset();
+    EXPECT_EQ(1, cache.evictUnused());
+    EXPECT_EQ(0, cache.stats().entries);
+}
+
+}  // namespace HumanRecognition::tests
@@ -0,0 +1,118 @@
+﻿#include <gtest/gtest.h>
+
+#include <QColor>
+#include <QImage>
+#include <QRect>
+
+#include "modules/HumanRecognition/motion_gate.h"
+
+namespace HumanRecognition::tests {
+
+namespace {
+
+QImage makeFrame(const QSize& size, const QRect& square = QRect()) {
+    QImage frame(size, QImage::Format_RGB888);
+    frame.fill(QColor(40, 40, 40));
+    for (int y = square.top(); square.isValid() && y <= square.bottom(); ++y) {
+        for (int x = square.left(); x <= square.right(); ++x) {
+            frame.setPixelColor(x, y, QColor(230, 230, 230));
+        }
+    }
+    return frame;
+}
+
+}  // namespace
+
+// 测试：首帧强制放行，之后的静止帧被跳过
+// 场景：连续输入三帧完全相同的 640x480 图像
+// 断言：首帧 forced 且区域为整帧；后两帧 shouldDetect 为 false，计数器同步更新
+TEST(MotionGateTest, StaticFramesAreSkipped) {
+    MotionGate gate;
+    const QImage frame = makeFrame(QSize(640, 480));
+
+    const auto first = gate.process(frame);
+    EXPECT_TRUE(first.shouldDetect);
+    EXPECT_TRUE(first.forced);
+    ASSERT_EQ(1, first.regions.size());
+    EXPECT_EQ(QRect(0, 0, 640, 480), first.regions.front());
+
+    for (int i = 0; i < 2; ++i) {
+        const auto result = gate.process(frame);
+        EXPECT_FALSE(result.shouldDetect);
+        EXPECT_FALSE(result.forced);
+        EXPECT_DOUBLE_EQ(0.0, result.changedRatio);
+        EXPECT_TRUE(result.regions.isEmpty());
+    }
+
+    const auto stats = gate.stats();
+    EXPECT_EQ(3u, stats.framesProcessed);
+    EXPECT_EQ(1u, stats.framesForced);
+    EXPECT_EQ(2u, stats.framesSkipped);
+    EXPECT_EQ(0u, stats.framesWithMotion);
+}
+
+// 测试：运动区域被定位并映射回原图坐标
+// 场景：背景建立后，在 640x480 画面右下方出现 80x80 的亮块
+// 断言：只输出一个区域，且该区域完整包含亮块、面积远小于整帧
+TEST(MotionGateTest, MotionRegionCoversChangedArea) {
+    MotionGate gate;
+    const QSize size(640, 480);
+    gate.process(makeFrame(size));
+
+    const QRect square(400, 300, 80, 80);
+    const auto result = gate.process(makeFrame(size, square));
+    ASSERT_TRUE(result.shouldDetect);
+    EXPECT_FALSE(result.forced);
+    EXPECT_GT(result.changedRatio, 0.0);
+    ASSERT_EQ(1, result.regions.size());
+
+    const QRect region = result.regions.front();
+    EXPECT_TRUE(region.contains(square)) << region.x() << "," << region.y() << " "
+                                         << region.width() << "x" << region.height();
+    EXPECT_LT(region.width() * region.height(), size.width() * size.height() / 4);
+    EXPECT_EQ(1u, gate.stats().framesWithMotion);
+}
+
+// 测试：周期强制放行与尺寸变化
+// 场景：forceEveryNFrames=3 时输入静止帧；随后切换分辨率
+// 断言：第 3 个后续帧被强制放行；分辨率变化的首帧同样强制放行并重建背景
+TEST(MotionGateTest, PeriodicAndResizeForcePass) {
+    MotionGateOptions options;
+    options.forceEveryNFrames = 3;
+    MotionGate gate(options);
+    const QImage frame = makeFrame(QSize(320, 240));
+
+    EXPECT_TRUE(gate.process(frame).forced);
+    EXPECT_FALSE(gate.process(frame).shouldDetect);
+    EXPECT_FALSE(gate.process(frame).shouldDetect);
+    const auto periodic = gate.process(frame);
+    EXPECT_TRUE(periodic.shouldDetect);
+    EXPECT_TRUE(periodic.forced);
+
+    const auto resized = gate.process(makeFrame(QSize(640, 360)));
+    EXPECT_TRUE(resized.forced);
+    ASSERT_EQ(1, resized.regions.size());
+    EXPECT_EQ(QRect(0, 0, 640, 360), resized.regions.front());
+    EXPECT_FALSE(gate.process(makeFrame(QSize(640, 360))).shouldDetect);
+}
+
+// 测试：灵敏度调节
+// 场景：背景建立后，画面整体亮度小幅变化（灰度 +15）
+// 断言：默认灵敏度（阈值 25）视为静止；最高灵敏度（阈值 5）判定为运动
+TEST(MotionGateTest, SensitivityControlsThreshold) {
+    const QSize size(320, 240);
+    QImage brighter(size, QImage::Format_RGB888);
+    brighter.fill(QColor(55, 55, 55));
+
+    MotionGate defaultGate;
+    defaultGate.process(makeFrame(size));
+    EXPECT_FALSE(defaultGate.process(brighter).shouldDetect);
+
+    MotionGate sensitiveGate;
+    sensitiveGate.setSensitivity(1.0);
+    EXPECT_EQ(5, sensitiveGate.options().pixelThreshold);
+    sensitiveGate.process(makeFrame(size));
+    EXPECT_TRUE(sensitiveGate.process(brighter).shouldDetect);
+}
+
+}  // namespace HumanRecognition::tests
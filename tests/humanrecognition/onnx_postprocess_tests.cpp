@@ -0,0 +1,73 @@
+﻿#include <gtest/gtest.h>
+
+#include <QPointF>
+#include <QSize>
+#include <QVector>
+#include <cmath>
+#include <vector>
+
+#include "src/modules/HumanRecognition/impl/onnx/internal/postprocess.h"
+
+namespace HumanRecognition::tests {
+
+// 测试：SCRFD 输出解码到原图坐标
+// 场景：32x32 输入、步长 8（4x4 网格、每格 2 个锚点），仅第 1 行第 2 列的第 2 个锚点超过阈值；
+//      输入相对原图缩放 0.5，且输入取自原图 (10, 20) 处的 ROI
+// 断言：只解码出一个框，框与关键点按步长、缩放和偏移还原到原图坐标
+TEST(OnnxPostprocessTest, DecodeScrfdMapsAnchorsToSource) {
+    constexpr int kAnchors = 4 * 4 * 2;
+    std::vector<float> scores(kAnchors, 0.1f);
+    std::vector<float> boxes(kAnchors * 4, 1.0f);
+    std::vector<float> landmarks(kAnchors * 10, 0.0f);
+    const int hit = (1 * 4 + 2) * 2 + 1;
+    scores[hit] = 0.9f;
+    landmarks[hit * 10 + 0] = 0.5f;   // 第 1 个关键点 x 偏移半个步长
+    landmarks[hit * 10 + 1] = -0.5f;  // 第 1 个关键点 y 偏移负半个步长
+
+    onnx::ScrfdBranch branch;
+    branch.stride = 8;
+    branch.scores = scores.data();
+    branch.boxes = boxes.data();
+    branch.landmarks = landmarks.data();
+
+    const QVector<FaceBox> faces =
+        onnx::decodeScrfd({branch}, QSize(32, 32), 2, 0.5f, 0.5, QPoint(10, 20));
+    ASSERT_EQ(1, faces.size());
+    // 锚点中心 (16, 8)，框为 (8, 0)-(24, 16)，还原：/0.5 + 偏移
+    EXPECT_EQ(QRect(26, 20, 32, 32), faces[0].rect);
+    EXPECT_FLOAT_EQ(0.9f, faces[0].score);
+    ASSERT_EQ(5, faces[0].landmarks.size());
+    EXPECT_DOUBLE_EQ(50.0, faces[0].landmarks[0].x());
+    EXPECT_DOUBLE_EQ(28.0, faces[0].landmarks[0].y());
+    EXPECT_DOUBLE_EQ(42.0, faces[0].landmarks[1].x());
+}
+
+// 测试：相似变换能还原已知的旋转 + 缩放 + 平移
+// 场景：把 ArcFace 模板点旋转 30°、放大 2 倍并平移 (15, -7) 得到源关键点
+// 断言：求出的变换把源关键点映射回模板，误差小于 1e-6
+TEST(OnnxPostprocessTest, SimilarityTransformRecoversAlignment) {
+    const double angle = 30.0 * 3.14159265358979323846 / 180.0;
+    const double c = 2.0 * std::cos(angle);
+    const double s = 2.0 * std::sin(angle);
+    QVector<QPointF> reference;
+    QVector<QPointF> source;
+    for (const auto& p : onnx::kArcFaceTemplate) {
+        reference.append(QPointF(p[0], p[1]));
+        source.append(QPointF(c * p[0] - s * p[1] + 15.0, s * p[0] + c * p[1] - 7.0));
+    }
+
+    double m[6];
+    ASSERT_TRUE(onnx::estimateSimilarityTransform(source, reference, m));
+    for (int i = 0; i < source.size(); ++i) {
+        const double x = m[0] * source[i].x() + m[1] * source[i].y() + m[2];
+        const double y = m[3] * source[i].x() + m[4] * source[i].y() + m[5];
+        EXPECT_NEAR(reference[i].x(), x, 1e-6);
+        EXPECT_NEAR(reference[i].y(), y, 1e-6);
+    }
+
+    // 所有点重合时无法确定缩放与旋转
+    const QVector<QPointF> degenerate(5, QPointF(3.0, 3.0));
+    EXPECT_FALSE(onnx::estimateSimilarityTransform(degenerate, reference, m));
+}
+
+}  // namespace HumanRecognition::tests
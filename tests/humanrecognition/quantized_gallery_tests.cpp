@@ -0,0 +1,184 @@
+﻿#include <gtest/gtest.h>
+
+#include <QString>
+#include <QVector>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "modules/HumanRecognition/types.h"
+#include "src/modules/HumanRecognition/internal/quantized_gallery.h"
+
+namespace HumanRecognition::tests {
+
+namespace {
+
+constexpr int kDimension = 128;
+
+/// 生成与 dlib ResNet 描述子量级相近（范数约 1）的随机特征
+FaceFeature randomFeature(std::mt19937& rng) {
+    std::normal_distribution<float> dist(0.0f, 0.09f);
+    FaceFeature feature;
+    feature.version = QStringLiteral("dlib_resnet_128");
+    feature.values.resize(kDimension);
+    for (float& v : feature.values) v = dist(rng);
+    return feature;
+}
+
+float exactDistance(const FaceFeature& a, const FaceFeature& b) {
+    float sum = 0.0f;
+    for (int i = 0; i < a.values.size(); ++i) {
+        const float diff = a.values[i] - b.values[i];
+        sum += diff * diff;
+    }
+    return std::sqrt(sum);
+}
+
+QString personIdFor(int index) { return QStringLiteral("person_%1").arg(index); }
+
+}  // namespace
+
+// 测试：fp16 转换对可精确表示的数值无损，对普通数值误差在半精度范围内
+// 场景：0、±1、2 的幂以及若干随机小数
+// 断言：精确值往返不变；其余值相对误差不超过 2^-11
+TEST(QuantizedGalleryTest, HalfConversionRoundTrip) {
+    for (float v : {0.0f, 1.0f, -1.0f, 0.5f, 2.0f, -0.25f, 1024.0f}) {
+        EXPECT_EQ(v, detail::halfToFloat(detail::floatToHalf(v)));
+    }
+    for (float v : {0.1f, -0.0375f, 0.333f, 3.14159f}) {
+        const float restored = detail::halfToFloat(detail::floatToHalf(v));
+        EXPECT_NEAR(v, restored, std::abs(v) / 2048.0f);
+    }
+}
+
+// 测试：int8 / fp16 近似距离与 float 精确距离的误差
+// 场景：500 条随机 128 维特征，50 条随机查询与全部行比较
+// 断言：int8 最大误差 < 0.02，fp16 最大误差 < 0.002（匹配阈值为 0.6）
+TEST(QuantizedGalleryTest, ApproximateDistanceErrorIsBounded) {
+    struct Case {
+        FeatureEncoding encoding;
+        float tolerance;
+    };
+    const Case cases[] = {{FeatureEncoding::Int8, 0.02f}, {FeatureEncoding::Float16, 0.002f}};
+    for (const Case& c : cases) {
+        std::mt19937 rng(7);
+        detail::QuantizedGallery gallery(c.encoding);
+        std::vector<FaceFeature> features;
+        for (int i = 0; i < 500; ++i) {
+            features.push_back(randomFeature(rng));
+            ASSERT_TRUE(gallery.upsert(personIdFor(i), features.back()));
+        }
+
+        float maxError = 0.0f;
+        for (int q = 0; q < 50; ++q) {
+            FaceFeature query = randomFeature(rng);
+            for (const auto& candidate : gallery.search(query, gallery.size())) {
+                const int index = candidate.personId.mid(7).toInt();
+                maxError = std::max(
+                    maxError,
+                    std::abs(candidate.approxDistance - exactDistance(query, features[index])));
+            }
+        }
+        EXPECT_LT(maxError, c.tolerance) << featureEncodingName(c.encoding).toStdString();
+    }
+}
+
+// 测试：粗排 topK 后使用 float 重排，top-1 与全量 float 扫描一致
+// 场景：2000 条随机特征，查询为库内特征叠加噪声，rerank topK=8
+// 断言：所有查询的重排结果与暴力搜索的最近邻相同
+TEST(QuantizedGalleryTest, RerankMatchesExactTopOne) {
+    for (FeatureEncoding encoding : {FeatureEncoding::Int8, FeatureEncoding::Float16}) {
+        std::mt19937 rng(11);
+        std::normal_distribution<float> noise(0.0f, 0.05f);
+        detail::QuantizedGallery gallery(encoding);
+        std::vector<FaceFeature> features;
+        for (int i = 0; i < 2000; ++i) {
+            features.push_back(randomFeature(rng));
+            gallery.upsert(personIdFor(i), features.back());
+        }
+
+        for (int q = 0; q < 100; ++q) {
+            FaceFeature query = features[static_cast<std::size_t>(q * 17)];
+            for (float& v : query.values) v += noise(rng);
+
+            int exactBest = -1;
+            float exactBestDistance = std::numeric_limits<float>::max();
+            for (int i = 0; i < static_cast<int>(features.size()); ++i) {
+                const float d = exactDistance(query, features[static_cast<std::size_t>(i)]);
+                if (d < exactBestDistance) {
+                    exactBestDistance = d;
+                    exactBest = i;
+                }
+            }
+
+            int rerankBest = -1;
+            float rerankBestDistance = std::numeric_limits<float>::max();
+            for (const auto& candidate : gallery.search(query, 8)) {
+                const int index = candidate.personId.mid(7).toInt();
+                const float d = exactDistance(query, features[static_cast<std::size_t>(index)]);
+                if (d < rerankBestDistance) {
+                    rerankBestDistance = d;
+                    rerankBest = index;
+                }
+            }
+            EXPECT_EQ(exactBest, rerankBest);
+        }
+    }
+}
+
+// 测试：删除与替换保持行索引一致，int8 内存约为 float 的四分之一
+// 场景：插入 3 条后删除中间一条、替换一条
+// 断言：剩余行可被检索与反量化；decode 的 version 带 @int8 后缀
+TEST(QuantizedGalleryTest, RemoveAndUpsertKeepRowsConsistent) {
+    std::mt19937 rng(3);
+    detail::QuantizedGallery gallery(FeatureEncoding::Int8);
+    const FaceFeature a = randomFeature(rng);
+    const FaceFeature b = randomFeature(rng);
+    const FaceFeature c = randomFeature(rng);
+    gallery.upsert(QStringLiteral("a"), a);
+    gallery.upsert(QStringLiteral("b"), b);
+    gallery.upsert(QStringLiteral("c"), c);
+    EXPECT_LE(gallery.memoryBytes(), 3 * (kDimension + 2 * sizeof(float)));
+
+    EXPECT_TRUE(gallery.remove(QStringLiteral("b")));
+    EXPECT_FALSE(gallery.remove(QStringLiteral("b")));
+    EXPECT_EQ(2, gallery.size());
+
+    const auto top = gallery.search(c, 1);
+    ASSERT_EQ(1, top.size());
+    EXPECT_EQ(QStringLiteral("c"), top.front().personId);
+
+    gallery.upsert(QStringLiteral("a"), b);
+    const auto decoded = gallery.decode(QStringLiteral("a"));
+    ASSERT_TRUE(decoded.has_value());
+    EXPECT_EQ(QStringLiteral("dlib_resnet_128@int8"), decoded->version);
+    EXPECT_LT(exactDistance(*decoded, b), 0.02f);
+
+    FaceFeature wrongSize;
+    wrongSize.values = {1.0f, 2.0f};
+    EXPECT_FALSE(gallery.upsert(QStringLiteral("d"), wrongSize));
+}
+
+// 测试：version 标签中的编码后缀解析
+// 场景：无后缀、@fp16、@int8 以及未知后缀
+// 断言：模型标识与编码被正确拆分，Float32 不追加后缀
+TEST(QuantizedGalleryTest, FeatureVersionEncodingTags) {
+    EXPECT_EQ(FeatureEncoding::Float32,
+              featureEncodingFromVersion(QStringLiteral("dlib_resnet_128")));
+    EXPECT_EQ(FeatureEncoding::Float16,
+              featureEncodingFromVersion(QStringLiteral("dlib_resnet_128@fp16")));
+    EXPECT_EQ(FeatureEncoding::Int8,
+              featureEncodingFromVersion(QStringLiteral("dlib_resnet_128@int8")));
+    EXPECT_EQ(FeatureEncoding::Float32, featureEncodingFromVersion(QStringLiteral("x@bogus")));
+    EXPECT_EQ(QStringLiteral("dlib_resnet_128"),
+              featureModelTag(QStringLiteral("dlib_resnet_128@int8")));
+    EXPECT_EQ(QStringLiteral("m"),
+              featureVersionWithEncoding(QStringLiteral("m@int8"), FeatureEncoding::Float32));
+    EXPECT_EQ(QStringLiteral("m@fp16"),
+              featureVersionWithEncoding(QStringLiteral("m"), FeatureEncoding::Float16));
+    EXPECT_FALSE(parseFeatureEncoding(QStringLiteral("int4")).has_value());
+}
+
+}  // namespace HumanRecognition::tests
@@ -0,0 +1,129 @@
+﻿#include <gtest/gtest.h>
+
+#include <QImage>
+#include <chrono>
+
+#include "src/modules/HumanRecognition/internal/recognition_cache.h"
+
+namespace HumanRecognition::tests {
+
+namespace {
+
+using detail::FrameHash;
+using detail::RecognitionCache;
+using namespace std::chrono_literals;
+
+/// 水平渐变叠加一个亮块，offset 控制亮块位置
+QImage makeFrame(int offset) {
+    QImage image(320, 240, QImage::Format_RGB888);
+    for (int y = 0; y < image.height(); ++y) {
+        for (int x = 0; x < image.width(); ++x) {
+            const bool block = x >= offset && x < offset + 60 && y >= 80 && y < 160;
+            const int value = block ? 250 : x * 200 / image.width();
+            image.setPixel(x, y, qRgb(value, value, value));
+        }
+    }
+    return image;
+}
+
+QVector<RecognitionResult> makeResults(const QString& personId) {
+    RecognitionResult result;
+    result.face.rect = QRect(10, 10, 50, 50);
+    RecognitionMatch match;
+    match.personId = personId;
+    result.match = match;
+    return {result};
+}
+
+}  // namespace
+
+// 测试：感知哈希对轻微噪声稳定、对内容变化敏感
+// 场景：同一帧、改动少量像素的帧、亮块移动后的帧、不同检测参数
+// 断言：前两者哈希相同；亮块移动后哈希不同；尺寸或检测参数不同则上下文指纹不同
+TEST(RecognitionCacheTest, FrameHashToleratesNoiseButNotContentChanges) {
+    const QImage frame = makeFrame(40);
+    QImage noisy = frame.copy();
+    for (int i = 0; i < 20; ++i) noisy.setPixel(i * 13 % 320, i * 7 % 240, qRgb(0, 0, 0));
+    const QImage moved = makeFrame(200);
+
+    EXPECT_EQ(0, FrameHash::compute(frame).distance(FrameHash::compute(frame.copy())));
+    EXPECT_EQ(0, FrameHash::compute(frame).distance(FrameHash::compute(noisy)));
+    EXPECT_GT(FrameHash::compute(frame).distance(FrameHash::compute(moved)), 8);
+
+    DetectOptions opts;
+    const auto key = RecognitionCache::makeKey(frame, opts);
+    EXPECT_EQ(key.context, RecognitionCache::makeKey(noisy, opts).context);
+    DetectOptions other = opts;
+    other.minFaceSize = 40;
+    EXPECT_NE(key.context, RecognitionCache::makeKey(frame, other).context);
+    EXPECT_NE(key.context, RecognitionCache::makeKey(frame.scaled(160, 120), opts).context);
+}
+
+// 测试：命中、TTL 过期、LRU 淘汰与失效
+// 场景：容量 2、TTL 100ms 的缓存依次写入三帧，并在不同时间点查找
+// 断言：最早的条目被淘汰；超过 TTL 的条目不再命中；invalidate 清空全部条目；统计数据一致
+TEST(RecognitionCacheTest, LruEvictionTtlAndInvalidation) {
+    RecognitionCacheOptions options;
+    options.capacity = 2;
+    options.ttl = 100ms;
+    RecognitionCache cache(options);
+    const DetectOptions opts;
+    const auto keyA = RecognitionCache::makeKey(makeFrame(0), opts);
+    const auto keyB = RecognitionCache::makeKey(makeFrame(100), opts);
+    const auto keyC = RecognitionCache::makeKey(makeFrame(200), opts);
+    const auto t0 = RecognitionCache::Clock::now();
+
+    cache.insert(keyA, HRCode::Ok, makeResults(QStringLiteral("a")), t0);
+    cache.insert(keyB, HRCode::DetectFailed, {}, t0);
+    HRCode code = HRCode::UnknownError;
+    QVector<RecognitionResult> results;
+    ASSERT_TRUE(cache.lookup(keyA, code, results, t0 + 10ms));  // A 变为最近使用
+    EXPECT_EQ(HRCode::Ok, code);
+    ASSERT_EQ(1, results.size());
+    EXPECT_EQ(QStringLiteral("a"), results.front().match->personId);
+
+    cache.insert(keyC, HRCode::Ok, makeResults(QStringLiteral("c")), t0 + 20ms);
+    EXPECT_FALSE(cache.lookup(keyB, code, results, t0 + 30ms));
+    EXPECT_TRUE(cache.lookup(keyC, code, results, t0 + 30ms));
+    EXPECT_FALSE(cache.lookup(keyA, code, results, t0 + 150ms));
+
+    cache.invalidate();
+    EXPECT_FALSE(cache.lookup(keyC, code, results, t0 + 40ms));
+
+    const RecognitionCacheStats stats = cache.stats();
+    EXPECT_EQ(2u, stats.hits);
+    EXPECT_EQ(3u, stats.misses);
+    EXPECT_EQ(1u, stats.evictions);
+    EXPECT_EQ(1u, stats.expirations);
+    EXPECT_EQ(1u, stats.invalidations);
+    EXPECT_EQ(0, stats.entries);
+}
+
+// 测试：近似匹配与关闭缓存
+// 场景：容量 8，maxHammingDistance 允许少量差异时查找一帧略有变化的图像；随后把容量设为 0
+// 断言：近似帧命中；关闭后既不命中也不写入
+TEST(RecognitionCacheTest, NearDuplicateMatchAndDisable) {
+    RecognitionCacheOptions options;
+    options.capacity = 8;
+    options.maxHammingDistance = 16;
+    RecognitionCache cache(options);
+    const DetectOptions opts;
+    const auto stored = RecognitionCache::makeKey(makeFrame(100), opts);
+    const auto shifted = RecognitionCache::makeKey(makeFrame(112), opts);
+    ASSERT_FALSE(stored.hash == shifted.hash);
+    ASSERT_LE(stored.hash.distance(shifted.hash), options.maxHammingDistance);
+
+    cache.insert(stored, HRCode::Ok, makeResults(QStringLiteral("p")));
+    HRCode code = HRCode::UnknownError;
+    QVector<RecognitionResult> results;
+    EXPECT_TRUE(cache.lookup(shifted, code, results));
+
+    options.capacity = 0;
+    cache.setOptions(options);
+    EXPECT_FALSE(cache.enabled());
+    cache.insert(stored, HRCode::Ok, makeResults(QStringLiteral("p")));
+    EXPECT_FALSE(cache.lookup(stored, code, results));
+    EXPECT_EQ(0, cache.stats().entries);
+}
+
+}  // namespace HumanRecognition::tests
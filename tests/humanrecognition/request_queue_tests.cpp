@@ -0,0 +1,166 @@
+﻿#include <gtest/gtest.h>
+
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "src/modules/HumanRecognition/internal/request_queue.h"
+
+namespace HumanRecognition::tests {
+
+namespace {
+
+using detail::RequestQueue;
+
+/// 占住唯一的工作线程，直到 release() 被调用
+struct WorkerBlocker {
+    std::promise<void> started;
+    std::promise<void> gate;
+    std::shared_future<void> released{gate.get_future().share()};
+
+    RequestQueue::Task task() {
+        RequestQueue::Task t;
+        t.priority = RequestPriority::Realtime;
+        t.run = [this](double) {
+            started.set_value();
+            released.wait();
+        };
+        return t;
+    }
+    void release() { gate.set_value(); }
+};
+
+}  // namespace
+
+// 测试：高优先级请求先执行，同优先级按提交顺序执行
+// 场景：单工作线程被占住后依次提交 Background、Normal、Realtime、Normal 四个请求
+// 断言：执行顺序为 Realtime、Normal(1)、Normal(2)、Background；每个请求都记录了排队时长
+TEST(RequestQueueTest, HigherPriorityRunsFirst) {
+    RequestQueueOptions options;
+    options.workers = 1;
+    WorkerBlocker blocker;  // 先于队列声明，保证队列析构（等待工作线程）时仍然有效
+    RequestQueue queue(options);
+
+    ASSERT_TRUE(queue.submit(blocker.task()));
+    blocker.started.get_future().wait();
+
+    std::mutex mutex;
+    std::vector<int> order;
+    std::vector<double> waits;
+    std::promise<void> allDone;
+    const auto submit = [&](RequestPriority priority, int tag) {
+        RequestQueue::Task task;
+        task.priority = priority;
+        task.run = [&, tag](double queueMs) {
+            std::lock_guard<std::mutex> lock(mutex);
+            order.push_back(tag);
+            waits.push_back(queueMs);
+            if (order.size() == 4) allDone.set_value();
+        };
+        return queue.submit(std::move(task));
+    };
+    EXPECT_TRUE(submit(RequestPriority::Background, 0));
+    EXPECT_TRUE(submit(RequestPriority::Normal, 1));
+    EXPECT_TRUE(submit(RequestPriority::Realtime, 2));
+    EXPECT_TRUE(submit(RequestPriority::Normal, 3));
+    EXPECT_EQ(4u, queue.stats().pending);
+
+    blocker.release();
+    ASSERT_EQ(std::future_status::ready,
+              allDone.get_future().wait_for(std::chrono::seconds(5)));
+    EXPECT_EQ((std::vector<int>{2, 1, 3, 0}), order);
+    for (double wait : waits) EXPECT_GE(wait, 0.0);
+}
+
+// 测试：队列满时按优先级拒绝或挤出
+// 场景：容量为 2，先放入两个 Background 请求，再提交 Background 与 Realtime 请求
+// 断言：新的 Background 被拒绝（QueueFull）；Realtime 挤出最后入队的 Background 请求
+TEST(RequestQueueTest, FullQueueRejectsOrEvictsLowerPriority) {
+    RequestQueueOptions options;
+    options.workers = 1;
+    options.capacity = 2;
+    WorkerBlocker blocker;
+    std::vector<std::pair<int, HRCode>> rejected;
+    RequestQueue queue(options);
+
+    ASSERT_TRUE(queue.submit(blocker.task()));
+    blocker.started.get_future().wait();
+
+    const auto makeTask = [&](RequestPriority priority, int tag) {
+        RequestQueue::Task task;
+        task.priority = priority;
+        task.run = [](double) {};
+        task.reject = [&rejected, tag](HRCode reason) { rejected.emplace_back(tag, reason); };
+        return task;
+    };
+    EXPECT_TRUE(queue.submit(makeTask(RequestPriority::Background, 0)));
+    EXPECT_TRUE(queue.submit(makeTask(RequestPriority::Background, 1)));
+    EXPECT_FALSE(queue.submit(makeTask(RequestPriority::Background, 2)));
+    EXPECT_TRUE(queue.submit(makeTask(RequestPriority::Realtime, 3)));
+
+    ASSERT_EQ(2u, rejected.size());
+    EXPECT_EQ(2, rejected[0].first);
+    EXPECT_EQ(HRCode::QueueFull, rejected[0].second);
+    EXPECT_EQ(1, rejected[1].first);
+    EXPECT_EQ(HRCode::QueueFull, rejected[1].second);
+    EXPECT_EQ(2u, queue.stats().rejected);
+    blocker.release();
+}
+
+// 测试：过期请求不再执行，析构时拒绝剩余请求
+// 场景：工作线程被占住期间提交一个 1ms 截止的请求和一个无截止的请求，等待过期后放行；
+//      再占住线程提交一个请求后直接销毁队列
+// 断言：过期请求以 DeadlineExceeded 结束且未执行；无截止请求正常执行；
+//      析构时剩余请求以 UnknownError 结束
+TEST(RequestQueueTest, ExpiredRequestsAreDropped) {
+    RequestQueueOptions options;
+    options.workers = 1;
+    std::promise<HRCode> expiredReason;
+    std::promise<void> liveRan;
+    bool expiredRan = false;
+    std::promise<HRCode> abandonedReason;
+    WorkerBlocker blocker;
+    WorkerBlocker second;
+    std::thread releaser;
+    {
+        RequestQueue queue(options);
+        ASSERT_TRUE(queue.submit(blocker.task()));
+        blocker.started.get_future().wait();
+
+        RequestQueue::Task stale;
+        stale.deadline = RequestQueue::Clock::now() + std::chrono::milliseconds(1);
+        stale.run = [&](double) { expiredRan = true; };
+        stale.reject = [&](HRCode reason) { expiredReason.set_value(reason); };
+        ASSERT_TRUE(queue.submit(std::move(stale)));
+
+        RequestQueue::Task live;
+        live.run = [&](double) { liveRan.set_value(); };
+        ASSERT_TRUE(queue.submit(std::move(live)));
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        blocker.release();
+        ASSERT_EQ(std::future_status::ready,
+                  liveRan.get_future().wait_for(std::chrono::seconds(5)));
+        EXPECT_EQ(HRCode::DeadlineExceeded, expiredReason.get_future().get());
+        EXPECT_FALSE(expiredRan);
+        EXPECT_EQ(1u, queue.stats().expired);
+
+        ASSERT_TRUE(queue.submit(second.task()));
+        second.started.get_future().wait();
+        RequestQueue::Task abandoned;
+        abandoned.run = [](double) {};
+        abandoned.reject = [&](HRCode reason) { abandonedReason.set_value(reason); };
+        ASSERT_TRUE(queue.submit(std::move(abandoned)));
+        // 稍后放行占位请求；队列析构时先取走排队中的请求，再等待工作线程退出
+        releaser = std::thread([&second]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            second.release();
+        });
+    }
+    releaser.join();
+    EXPECT_EQ(HRCode::UnknownError, abandonedReason.get_future().get());
+}
+
+}  // namespace HumanRecognition::tests
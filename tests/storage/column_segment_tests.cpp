@@ -0,0 +1,139 @@
+﻿#include <gtest/gtest.h>
+
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QTemporaryDir>
+#include <QTimeZone>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <tuple>
+
+#include "modules/Storage/column_segment.h"
+
+namespace storage::tests {
+
+namespace {
+
+const qint64 kBase =
+    QDateTime(QDate(2026, 10, 19), QTime(8, 0), QTimeZone::UTC).toMSecsSinceEpoch();
+
+QString deviceName(int i) {
+    return QStringLiteral("dev%1").arg(i, 3, 10, QLatin1Char('0'));
+}
+
+// devices 台设备 x metrics 项指标 x samples 个时间点，采样间隔 1 分钟
+QVector<TelemetryPoint> fleet(int devices, const QStringList& metrics, int samples) {
+    QVector<TelemetryPoint> points;
+    for (int t = 0; t < samples; ++t) {
+        for (int d = 0; d < devices; ++d) {
+            for (const QString& metric : metrics) {
+                points.append({deviceName(d), metric, kBase + t * 60000, d * 100.0 + t * 0.25});
+            }
+        }
+    }
+    return points;
+}
+
+}  // namespace
+
+// 测试：列式段写入后完整读回
+// 场景：3 台设备 x 2 项指标 x 500 个点（另含一个 NaN 点），每块 128 行
+// 断言：NaN 点被丢弃；全列扫描按 (metric, device, ts) 顺序逐位还原全部行；
+//      文件小于每行 8 字节（原始表示每行至少 16 字节）
+TEST(ColumnSegmentTest, RoundTripsAllColumns) {
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    QVector<TelemetryPoint> points = fleet(3, {"temp", "humidity"}, 500);
+    points.append({"dev000", "temp", kBase, std::numeric_limits<double>::quiet_NaN()});
+    const QString path = dir.filePath(QStringLiteral("a.ccseg"));
+    columnar::SegmentWriteOptions options;
+    options.rowsPerBlock = 128;
+    QString error;
+    ASSERT_TRUE(columnar::writeSegment(path, points, options, &error)) << error.toStdString();
+
+    columnar::SegmentReader reader;
+    ASSERT_TRUE(reader.open(path)) << reader.errorString().toStdString();
+    EXPECT_EQ(3000u, reader.rows());
+    EXPECT_EQ(24, reader.blocks());
+    EXPECT_LT(QFileInfo(path).size(), 3000 * 8);
+
+    columnar::ColumnRows rows;
+    ASSERT_TRUE(reader.scan({}, columnar::AllColumns, rows));
+    ASSERT_EQ(3000u, rows.rows);
+
+    points.removeLast();
+    std::sort(points.begin(), points.end(), [](const auto& a, const auto& b) {
+        return std::tie(a.metric, a.deviceId, a.timestampMs) <
+               std::tie(b.metric, b.deviceId, b.timestampMs);
+    });
+    for (std::size_t i = 0; i < rows.rows; ++i) {
+        const TelemetryPoint& expected = points[static_cast<qsizetype>(i)];
+        ASSERT_EQ(expected.deviceId, rows.devices[rows.deviceIds[i]]);
+        ASSERT_EQ(expected.metric, rows.metrics[rows.metricIds[i]]);
+        ASSERT_EQ(expected.timestampMs, rows.timestamps[i]);
+        ASSERT_EQ(expected.value, rows.values[i]);
+    }
+}
+
+// 测试：谓词经稀疏索引排除块，且只输出请求的列
+// 场景：100 台设备 x 2 项指标 x 60 分钟，每块 256 行；查询 2 台设备的 temp 在第 10~19 分钟的数值
+// 断言：命中 20 行且数值正确；只解码少数块；未请求的列为空；字典中不存在的指标不读取任何块
+TEST(ColumnSegmentTest, PredicatesPruneBlocksAndColumns) {
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    const QString path = dir.filePath(QStringLiteral("fleet.ccseg"));
+    columnar::SegmentWriteOptions options;
+    options.rowsPerBlock = 256;
+    ASSERT_TRUE(columnar::writeSegment(path, fleet(100, {"temp", "humidity"}, 60), options));
+
+    columnar::SegmentReader reader;
+    ASSERT_TRUE(reader.open(path));
+    columnar::ScanPredicate predicate;
+    predicate.metric = QStringLiteral("temp");
+    predicate.devices = QStringList{deviceName(10), deviceName(11)};
+    predicate.fromMs = kBase + 10 * 60000;
+    predicate.toMs = kBase + 19 * 60000;
+
+    columnar::ColumnRows rows;
+    columnar::ScanStats stats;
+    ASSERT_TRUE(reader.scan(predicate, columnar::ValueColumn, rows, &stats));
+    ASSERT_EQ(20u, rows.rows);
+    EXPECT_DOUBLE_EQ(1000.0 + 10 * 0.25, rows.values.front());
+    EXPECT_DOUBLE_EQ(1100.0 + 19 * 0.25, rows.values.back());
+    EXPECT_TRUE(rows.timestamps.empty());
+    EXPECT_TRUE(rows.deviceIds.empty());
+    EXPECT_EQ(reader.blocks(), stats.blocksTotal);
+    // 两台设备的行落在相邻两块内，另加 humidity/temp 交界的一块
+    EXPECT_LE(stats.blocksRead, 3);
+
+    predicate.metric = QStringLiteral("pressure");
+    ASSERT_TRUE(reader.scan(predicate, columnar::AllColumns, rows, &stats));
+    EXPECT_EQ(0u, rows.rows);
+    EXPECT_EQ(0, stats.blocksRead);
+}
+
+// 测试：按日期目录写段、按时间范围列出段并整目录清理
+// 场景：数据跨两个 UTC 日期写入
+// 断言：生成两个日期目录；范围查询只列出当天的段；清理截止到第二天 0 点时只删除第一天的目录
+TEST(ColumnSegmentTest, DayDirectoriesListAndExpire) {
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    const qint64 dayMs = 24 * 3600 * 1000;
+    ASSERT_TRUE(columnar::writeDaySegments(
+        dir.path(), {{"dev000", "temp", kBase - dayMs, 1.0}, {"dev000", "temp", kBase, 2.0}}));
+
+    EXPECT_EQ(QStringList({"20261018", "20261019"}),
+              QDir(dir.path()).entryList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name));
+    const QStringList today = columnar::segmentFiles(dir.path(), kBase - 1000, kBase + 1000);
+    ASSERT_EQ(1, today.size());
+    EXPECT_TRUE(today.front().contains(QStringLiteral("/20261019/")));
+    EXPECT_EQ(2, columnar::segmentFiles(dir.path(), kBase - dayMs, kBase).size());
+
+    const qint64 startOfToday = kBase - 8 * 3600 * 1000;
+    EXPECT_EQ(1, columnar::removeExpiredSegments(dir.path(), startOfToday));
+    EXPECT_EQ(1, columnar::segmentFiles(dir.path(), kBase - dayMs, kBase).size());
+}
+
+}  // namespace storage::tests
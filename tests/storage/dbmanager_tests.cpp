@@ -0,0 +1,193 @@
+﻿#include <gtest/gtest.h>
+
+#include <QSettings>
+#include <QTemporaryDir>
+#include <QtSql/QSqlDatabase>
+#include <QtSql/QSqlQuery>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "modules/Config/config.h"
+#include "modules/Storage/dbmanager.h"
+
+namespace storage::tests {
+
+namespace {
+
+int countRows(QSqlDatabase& db) {
+    QSqlQuery q(db);
+    if (!q.exec(QStringLiteral("SELECT COUNT(*) FROM pool_test")) || !q.next()) return -1;
+    return q.value(0).toInt();
+}
+
+bool insertRow(QSqlDatabase& db, int value) {
+    QSqlQuery q(db);
+    q.prepare(QStringLiteral("INSERT INTO pool_test(value) VALUES (?)"));
+    q.addBindValue(value);
+    return q.exec();
+}
+
+/**
+ * @brief DbManager 单例指向一个新的共享缓存内存库，每个测试重新 init(force)
+ */
+class DbManagerTest : public ::testing::Test {
+   protected:
+    static void SetUpTestSuite() {
+        s_dir = std::make_unique<QTemporaryDir>();
+        QSettings::setPath(QSettings::IniFormat, QSettings::UserScope, s_dir->path());
+        auto& cfg = config::ConfigManager::instance();
+        cfg.init("CrossControlTests", "DbManagerTests");
+        ASSERT_TRUE(cfg.loadFromJsonString(R"({"Storage": {"database": ":memory:"}})"));
+    }
+
+    static void TearDownTestSuite() {
+        DbManager::instance().close();
+        s_dir.reset();
+    }
+
+    void SetUp() override {
+        ASSERT_TRUE(DbManager::instance().init(true));
+        QSqlQuery ddl(DbManager::instance().db());
+        ASSERT_TRUE(ddl.exec(QStringLiteral(
+            "CREATE TABLE IF NOT EXISTS pool_test (id INTEGER PRIMARY KEY, value INTEGER)")));
+    }
+
+    static std::unique_ptr<QTemporaryDir> s_dir;
+};
+
+std::unique_ptr<QTemporaryDir> DbManagerTest::s_dir;
+
+}  // namespace
+
+// 测试：每个线程使用自己的连接，但看到同一个数据库
+// 场景：主线程写入一行；工作线程读取后再写入一行，然后退出
+// 断言：两个线程的连接名不同；工作线程读到主线程的数据，主线程读到工作线程的数据；
+//      工作线程退出后其连接已从 QSqlDatabase 中移除
+TEST_F(DbManagerTest, EachThreadHasItsOwnConnectionToTheSameDatabase) {
+    auto& manager = DbManager::instance();
+    {
+        const auto writeLock = manager.writeLock();
+        ASSERT_TRUE(insertRow(manager.db(), 1));
+    }
+    const QString mainName = manager.db().connectionName();
+
+    QString workerName;
+    int seenByWorker = -1;
+    bool workerInserted = false;
+    std::thread worker([&]() {
+        QSqlDatabase& db = manager.db();
+        workerName = db.connectionName();
+        seenByWorker = countRows(db);
+        const auto writeLock = manager.writeLock();
+        workerInserted = insertRow(db, 2);
+    });
+    worker.join();
+
+    EXPECT_FALSE(workerName.isEmpty());
+    EXPECT_NE(mainName, workerName);
+    EXPECT_EQ(1, seenByWorker);
+    EXPECT_TRUE(workerInserted);
+    EXPECT_EQ(2, countRows(manager.db()));
+    EXPECT_FALSE(QSqlDatabase::contains(workerName));
+    EXPECT_TRUE(QSqlDatabase::contains(mainName));
+}
+
+// 测试：多个线程在写锁下并发写入共享缓存内存库
+// 场景：4 个线程各自写入 100 行，每行单独持有 writeLock
+// 断言：没有任何一次写入失败（共享缓存下无锁写入会返回 SQLITE_LOCKED），总行数为 400
+TEST_F(DbManagerTest, ConcurrentWritersUnderWriteLockAllSucceed) {
+    auto& manager = DbManager::instance();
+    constexpr int kThreads = 4;
+    constexpr int kRowsPerThread = 100;
+    std::atomic<int> failures{0};
+    std::vector<std::thread> writers;
+    for (int t = 0; t < kThreads; ++t) {
+        writers.emplace_back([&, t]() {
+            for (int i = 0; i < kRowsPerThread; ++i) {
+                const auto writeLock = manager.writeLock();
+                if (!insertRow(manager.db(), t * kRowsPerThread + i)) ++failures;
+            }
+        });
+    }
+    for (auto& writer : writers) writer.join();
+
+    EXPECT_EQ(0, failures.load());
+    EXPECT_EQ(kThreads * kRowsPerThread, countRows(manager.db()));
+}
+
+// 测试：init(force) 使各线程已有的连接失效
+// 场景：记录当前线程的连接名后重新初始化
+// 断言：db() 返回新的连接，旧连接已被移除；新连接指向新的内存库，旧表不存在
+TEST_F(DbManagerTest, ForcedInitReopensThreadConnection) {
+    auto& manager = DbManager::instance();
+    const QString before = manager.db().connectionName();
+
+    ASSERT_TRUE(manager.init(true));
+    const QString after = manager.db().connectionName();
+
+    EXPECT_NE(before, after);
+    EXPECT_FALSE(QSqlDatabase::contains(before));
+    EXPECT_EQ(-1, countRows(manager.db()));
+}
+
+// 测试：预编译语句按线程缓存并复用
+// 场景：同一线程两次取同一条 SQL，中间重新绑定参数执行；另一线程取同一条 SQL
+// 断言：同一线程得到同一个语句对象且每次执行使用新绑定的参数；其它线程得到自己的语句对象
+TEST_F(DbManagerTest, PreparedStatementsAreReusedPerThread) {
+    auto& manager = DbManager::instance();
+    const QString insert = QStringLiteral("INSERT INTO pool_test(value) VALUES (?)");
+    const QString count = QStringLiteral("SELECT COUNT(*) FROM pool_test WHERE value = ?");
+
+    QSqlQuery* first = &manager.prepared(insert);
+    {
+        const auto writeLock = manager.writeLock();
+        first->bindValue(0, 7);
+        ASSERT_TRUE(first->exec());
+        QSqlQuery* second = &manager.prepared(insert);
+        EXPECT_EQ(first, second);
+        second->bindValue(0, 8);
+        ASSERT_TRUE(second->exec());
+    }
+    QSqlQuery& q = manager.prepared(count);
+    q.bindValue(0, 8);
+    ASSERT_TRUE(q.exec() && q.next());
+    EXPECT_EQ(1, q.value(0).toInt());
+    q.finish();
+
+    bool distinct = false;
+    std::thread worker([&]() { distinct = &manager.prepared(insert) != first; });
+    worker.join();
+    EXPECT_TRUE(distinct);
+}
+
+// 测试：连接代数变化后缓存的语句重新 prepare
+// 场景：在旧连接上缓存一条查询；init(force) 换到新的内存库后建表并写入 3 行，再取同一条 SQL
+// 断言：新取得的语句在新连接上执行成功并读到新库中的数据，而不是沿用已关闭连接上的旧语句
+TEST_F(DbManagerTest, PreparedStatementsAreRepreparedAfterGenerationBump) {
+    auto& manager = DbManager::instance();
+    const QString count = QStringLiteral("SELECT COUNT(*) FROM pool_test");
+    {
+        QSqlQuery& q = manager.prepared(count);
+        ASSERT_TRUE(q.exec() && q.next());
+        EXPECT_EQ(0, q.value(0).toInt());
+        q.finish();
+    }
+
+    ASSERT_TRUE(manager.init(true));
+    QSqlQuery ddl(manager.db());
+    ASSERT_TRUE(ddl.exec(QStringLiteral(
+        "CREATE TABLE pool_test (id INTEGER PRIMARY KEY, value INTEGER)")));
+    {
+        const auto writeLock = manager.writeLock();
+        for (int i = 0; i < 3; ++i) ASSERT_TRUE(insertRow(manager.db(), i));
+    }
+
+    QSqlQuery& q = manager.prepared(count);
+    ASSERT_TRUE(q.exec() && q.next());
+    EXPECT_EQ(3, q.value(0).toInt());
+    q.finish();
+}
+
+}  // namespace storage::tests
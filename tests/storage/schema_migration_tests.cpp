@@ -0,0 +1,128 @@
+﻿#include <gtest/gtest.h>
+
+#include <QUuid>
+#include <QtSql/QSqlDatabase>
+#include <QtSql/QSqlQuery>
+
+#include "modules/Storage/schema.h"
+
+namespace storage::tests {
+
+namespace {
+
+/**
+ * @brief 每个测试独占的内存 SQLite 连接
+ */
+class SchemaMigrationTest : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        m_name = QStringLiteral("schema_test_%1").arg(QUuid::createUuid().toString(QUuid::Id128));
+        m_db = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), m_name);
+        m_db.setDatabaseName(QStringLiteral(":memory:"));
+        ASSERT_TRUE(m_db.open());
+    }
+
+    void TearDown() override {
+        m_db.close();
+        m_db = QSqlDatabase();
+        QSqlDatabase::removeDatabase(m_name);
+    }
+
+    // EXPLAIN QUERY PLAN 各步骤的 detail 列拼接结果
+    QString queryPlan(const QString& sql) {
+        QSqlQuery q(m_db);
+        EXPECT_TRUE(q.exec(QStringLiteral("EXPLAIN QUERY PLAN ") + sql));
+        QStringList details;
+        while (q.next()) details << q.value(3).toString();
+        return details.join(QStringLiteral("; "));
+    }
+
+    QString m_name;
+    QSqlDatabase m_db;
+};
+
+}  // namespace
+
+// 测试：迁移按编号依次应用且可重复执行
+// 场景：空库执行 migrate 两次
+// 断言：版本达到最新且 schema_version 每个迁移恰好一行；第二次执行不重复记录
+TEST_F(SchemaMigrationTest, AppliesMigrationsOnce) {
+    EXPECT_EQ(0, schema::currentVersion(m_db));
+    ASSERT_TRUE(schema::migrate(m_db));
+    EXPECT_EQ(schema::latestVersion(), schema::currentVersion(m_db));
+    ASSERT_TRUE(schema::migrate(m_db));
+
+    QSqlQuery q(m_db);
+    ASSERT_TRUE(q.exec(QStringLiteral("SELECT COUNT(*) FROM schema_version")));
+    ASSERT_TRUE(q.next());
+    EXPECT_EQ(static_cast<int>(schema::migrations().size()), q.value(0).toInt());
+}
+
+// 测试：旧版 actions 表在迁移时导入按类型划分的表
+// 场景：旧表含 http / serial / 未知类型各一条，http_actions 已有同名较新记录
+// 断言：已有记录不被覆盖，serial 记录被导入，未知类型被跳过；再次导入不产生新记录
+TEST_F(SchemaMigrationTest, ImportsLegacyActionsWithoutOverwriting) {
+    QSqlQuery q(m_db);
+    ASSERT_TRUE(
+        q.exec(QStringLiteral("CREATE TABLE actions (name TEXT, type TEXT, payload BLOB)")));
+    ASSERT_TRUE(q.exec(QStringLiteral("INSERT INTO actions VALUES ('ping', 'HTTP', 'old'), "
+                                      "('open', 'serial', 'p'), ('misc', 'other', 'x')")));
+    ASSERT_TRUE(q.exec(QStringLiteral(
+        "CREATE TABLE http_actions (name TEXT PRIMARY KEY, payload BLOB, created_at TEXT)")));
+    ASSERT_TRUE(q.exec(QStringLiteral(
+        "INSERT INTO http_actions VALUES ('ping', 'new', datetime('now'))")));
+
+    ASSERT_TRUE(schema::migrate(m_db));
+
+    ASSERT_TRUE(q.exec(QStringLiteral("SELECT payload FROM http_actions WHERE name = 'ping'")));
+    ASSERT_TRUE(q.next());
+    EXPECT_EQ(QByteArray("new"), q.value(0).toByteArray());
+    ASSERT_TRUE(q.exec(QStringLiteral("SELECT COUNT(*) FROM serial_actions")));
+    ASSERT_TRUE(q.next());
+    EXPECT_EQ(1, q.value(0).toInt());
+    EXPECT_EQ(0, schema::importLegacyActions(m_db));
+}
+
+// 测试：动作类型到表名的映射
+// 场景：已知类型（大小写不敏感）与未知类型
+// 断言：已知类型映射到迁移创建的按类型表；未知类型返回空表名（调用方据此拒绝），不会落到
+//      迁移从未创建的 "actions" 表
+TEST(SchemaActionsTableTest, MapsKnownTypesAndRejectsUnknown) {
+    EXPECT_EQ(QStringLiteral("http_actions"), schema::actionsTable(QStringLiteral("HTTP")));
+    EXPECT_EQ(QStringLiteral("serial_actions"), schema::actionsTable(QStringLiteral("serial")));
+    for (const QString& type : {QStringLiteral("tcp"), QStringLiteral("udp")}) {
+        EXPECT_TRUE(schema::actionTables().contains(schema::actionsTable(type)));
+    }
+    EXPECT_TRUE(schema::actionsTable(QStringLiteral("mqtt")).isEmpty());
+    EXPECT_TRUE(schema::actionsTable(QString()).isEmpty());
+}
+
+// 测试：热点查询使用迁移创建的索引
+// 场景：迁移后对 loadActions 的排序查询，以及按分组/状态/最后在线时间过滤的设备查询
+//      执行 EXPLAIN QUERY PLAN
+// 断言：动作表沿 created_at 索引扫描且不再使用临时 B 树排序；设备查询命中对应索引
+TEST_F(SchemaMigrationTest, HotQueriesUseIndexes) {
+    ASSERT_TRUE(schema::migrate(m_db));
+
+    for (const QString& table : schema::actionTables()) {
+        const QString plan = queryPlan(
+            QStringLiteral("SELECT name, created_at FROM %1 ORDER BY created_at DESC LIMIT 100")
+                .arg(table));
+        EXPECT_TRUE(plan.contains(QStringLiteral("idx_%1_created_at").arg(table)))
+            << plan.toStdString();
+        EXPECT_FALSE(plan.contains(QStringLiteral("TEMP B-TREE"))) << plan.toStdString();
+    }
+
+    const QString byGroup =
+        queryPlan(QStringLiteral("SELECT id FROM devices WHERE group_name = 'a'"));
+    EXPECT_TRUE(byGroup.contains(QStringLiteral("idx_devices_group_name")))
+        << byGroup.toStdString();
+    const QString byStatus =
+        queryPlan(QStringLiteral("SELECT id FROM devices WHERE status = 'online'"));
+    EXPECT_TRUE(byStatus.contains(QStringLiteral("idx_devices_status"))) << byStatus.toStdString();
+    const QString stale =
+        queryPlan(QStringLiteral("SELECT id FROM devices WHERE last_seen < 1000"));
+    EXPECT_TRUE(stale.contains(QStringLiteral("idx_devices_last_seen"))) << stale.toStdString();
+}
+
+}  // namespace storage::tests
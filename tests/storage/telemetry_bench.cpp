@@ -0,0 +1,204 @@
+﻿// 遥测写入基准：SQLite 分区批量写入、列式段写入与 TelemetryStore 端到端摄入。
+// 目标是单进程持续摄入 ≥ 100k 点/秒，看 items_per_second 一列。
+//
+// 输出 JSON 供性能追踪使用：
+//   StorageBench --benchmark_out=storage_bench.json --benchmark_out_format=json
+
+#include <benchmark/benchmark.h>
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QSettings>
+#include <QTemporaryDir>
+#include <QTimeZone>
+#include <QUuid>
+#include <QtSql/QSqlDatabase>
+#include <algorithm>
+#include <memory>
+
+#include "modules/Config/config.h"
+#include "modules/Storage/column_segment.h"
+#include "modules/Storage/dbmanager.h"
+#include "modules/Storage/schema.h"
+#include "modules/Storage/telemetry_store.h"
+#include "modules/Storage/write_behind.h"
+
+namespace storage::bench {
+
+namespace {
+
+constexpr int kDevices = 1000;
+constexpr int kMetrics = 10;
+
+/// 合成数据：kDevices 台设备轮流上报 kMetrics 个指标，时间戳从 first 起每点递增 1ms
+QVector<TelemetryPoint> syntheticPoints(int count, qint64 first) {
+    static const QStringList devices = []() {
+        QStringList out;
+        for (int i = 0; i < kDevices; ++i) {
+            out << QStringLiteral("dev%1").arg(i, 4, 10, QChar('0'));
+        }
+        return out;
+    }();
+    static const QStringList metrics = []() {
+        QStringList out;
+        for (int i = 0; i < kMetrics; ++i) out << QStringLiteral("metric%1").arg(i);
+        return out;
+    }();
+    QVector<TelemetryPoint> points;
+    points.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        points.append({devices[i % kDevices],
+                       metrics[(i / kDevices) % kMetrics],
+                       first + i,
+                       20.0 + static_cast<double>(i % 97) * 0.25});
+    }
+    return points;
+}
+
+qint64 benchDayStartMs() {
+    return QDateTime(QDate(2026, 10, 19), QTime(0, 0), QTimeZone::UTC).toMSecsSinceEpoch();
+}
+
+/**
+ * @brief 基准共用的临时目录与 Storage 配置（文件数据库，WAL）
+ */
+class Environment {
+   public:
+    static Environment& instance() {
+        static Environment env;
+        return env;
+    }
+
+    bool ready() const { return m_ready; }
+    QString path(const QString& name) const { return m_dir.filePath(name); }
+
+   private:
+    Environment() {
+        if (!m_dir.isValid()) return;
+        QSettings::setPath(QSettings::IniFormat, QSettings::UserScope, m_dir.path());
+        auto& cfg = config::ConfigManager::instance();
+        cfg.init("CrossControlBench", "StorageBench");
+        const QString json = QStringLiteral(R"({"Storage": {"database": "%1"}})")
+                                 .arg(QDir::fromNativeSeparators(path("bench.db")));
+        m_ready = cfg.loadFromJsonString(json) && DbManager::instance().init(true);
+    }
+
+    QTemporaryDir m_dir;
+    bool m_ready = false;
+};
+
+// ---- SQLite 分区 -----------------------------------------------------------------------------
+
+/// 写线程上的一次组提交：一个事务内写入 N 个点并更新 1m/1h 汇总（内存库，不含磁盘开销）
+void BM_WriteBatch(benchmark::State& state) {
+    const int batch = static_cast<int>(state.range(0));
+    const QString name =
+        QStringLiteral("telemetry_bench_%1").arg(QUuid::createUuid().toString(QUuid::Id128));
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), name);
+        db.setDatabaseName(QStringLiteral(":memory:"));
+        if (!db.open() || !schema::migrate(db)) {
+            state.SkipWithError("cannot open in-memory telemetry database");
+            return;
+        }
+        qint64 first = benchDayStartMs();
+        for (auto _ : state) {
+            state.PauseTiming();
+            const QVector<TelemetryPoint> points = syntheticPoints(batch, first);
+            first += batch;
+            state.ResumeTiming();
+            db.transaction();
+            const bool ok = telemetry::writeBatch(db, points);
+            db.commit();
+            if (!ok) {
+                state.SkipWithError("writeBatch failed");
+                break;
+            }
+        }
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(name);
+    state.SetItemsProcessed(state.iterations() * batch);
+}
+BENCHMARK(BM_WriteBatch)->RangeMultiplier(4)->Range(256, 16384)->Unit(benchmark::kMillisecond);
+
+// ---- 列式段 ----------------------------------------------------------------------------------
+
+/// 段写线程上的一次写出：N 个点编码成一个列式段文件
+void BM_WriteDaySegments(benchmark::State& state) {
+    const int rows = static_cast<int>(state.range(0));
+    QTemporaryDir dir;
+    if (!dir.isValid()) {
+        state.SkipWithError("cannot create segment directory");
+        return;
+    }
+    const QVector<TelemetryPoint> points = syntheticPoints(rows, benchDayStartMs());
+    for (auto _ : state) {
+        QString error;
+        if (!columnar::writeDaySegments(dir.path(), points, {}, &error)) {
+            state.SkipWithError(error.toStdString().c_str());
+            break;
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * rows);
+}
+BENCHMARK(BM_WriteDaySegments)
+    ->RangeMultiplier(4)
+    ->Range(4096, 65536)
+    ->Unit(benchmark::kMillisecond);
+
+// ---- 端到端 ----------------------------------------------------------------------------------
+
+/// TelemetryStore::append 持续摄入 1 秒的数据量（默认 100k 点，按 4096 点一批）后 flush；
+/// 参数 1 为是否同时写列式段。实时计时包含写线程与段写线程的全部工作
+void BM_TelemetryStoreIngest(benchmark::State& state) {
+    const int points = static_cast<int>(state.range(0));
+    const bool segments = state.range(1) != 0;
+    auto& env = Environment::instance();
+    if (!env.ready()) {
+        state.SkipWithError("cannot initialize storage");
+        return;
+    }
+    auto& store = TelemetryStore::instance();
+    TelemetryOptions options = store.options();
+    options.segmentDirectory = segments ? env.path(QStringLiteral("segments")) : QString();
+    store.setOptions(options);
+
+    constexpr int kBatch = 4096;
+    qint64 first = benchDayStartMs();
+    for (auto _ : state) {
+        state.PauseTiming();
+        QVector<QVector<TelemetryPoint>> batches;
+        for (int offset = 0; offset < points; offset += kBatch) {
+            batches.append(syntheticPoints(std::min(kBatch, points - offset), first + offset));
+        }
+        first += points;
+        state.ResumeTiming();
+        for (auto& batch : batches) store.append(std::move(batch));
+        if (!store.flush(std::chrono::seconds(60))) {
+            state.SkipWithError("flush timed out");
+            break;
+        }
+    }
+    state.SetLabel(segments ? "sqlite+segments" : "sqlite");
+    state.SetItemsProcessed(state.iterations() * points);
+}
+BENCHMARK(BM_TelemetryStoreIngest)
+    ->ArgsProduct({{100'000}, {0, 1}})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+
+}  // namespace storage::bench
+
+int main(int argc, char** argv) {
+    QCoreApplication app(argc, argv);
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    storage::WriteBehindQueue::instance().shutdown();
+    return 0;
+}
@@ -0,0 +1,127 @@
+﻿#include <gtest/gtest.h>
+
+#include <QDateTime>
+#include <QTimeZone>
+#include <QUuid>
+#include <QtSql/QSqlDatabase>
+#include <limits>
+
+#include "modules/Storage/schema.h"
+#include "modules/Storage/telemetry_store.h"
+
+namespace storage::tests {
+
+namespace {
+
+constexpr qint64 kDayMs = 24 * 3600 * 1000;
+
+qint64 utcMs(int year, int month, int day, int hour = 0, int minute = 0, int second = 0) {
+    return QDateTime(QDate(year, month, day), QTime(hour, minute, second), QTimeZone::UTC)
+        .toMSecsSinceEpoch();
+}
+
+/**
+ * @brief 每个测试独占的内存 SQLite 连接，已执行全部迁移
+ */
+class TelemetryStoreTest : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        m_name =
+            QStringLiteral("telemetry_test_%1").arg(QUuid::createUuid().toString(QUuid::Id128));
+        m_db = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), m_name);
+        m_db.setDatabaseName(QStringLiteral(":memory:"));
+        ASSERT_TRUE(m_db.open());
+        ASSERT_TRUE(schema::migrate(m_db));
+    }
+
+    void TearDown() override {
+        m_db.close();
+        m_db = QSqlDatabase();
+        QSqlDatabase::removeDatabase(m_name);
+    }
+
+    QString m_name;
+    QSqlDatabase m_db;
+};
+
+}  // namespace
+
+// 测试：原始点按日分区写入，1m/1h 汇总跨批次增量合并
+// 场景：同一分钟内分两批写入 temp=1,3 与 temp=5，另写入 humidity 与前一日的一个点
+// 断言：原始查询按时间升序且跨两个日分区；1m/1h 汇总 count/min/max/avg 合并两批；
+//      不指定 metric 时按 metric 分组返回；无效点被跳过
+TEST_F(TelemetryStoreTest, WritesPartitionsAndIncrementalRollups) {
+    const qint64 base = utcMs(2026, 10, 19, 8, 30);
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    ASSERT_TRUE(telemetry::writeBatch(m_db,
+                                      {{"dev1", "temp", base, 1.0},
+                                       {"dev1", "temp", base + 1000, 3.0},
+                                       {"dev1", "humidity", base + 2000, 40.0},
+                                       {"dev1", "temp", base - 9 * 3600 * 1000, 7.0},
+                                       {"", "temp", base, 1.0},
+                                       {"dev1", "temp", base, nan}}));
+    ASSERT_TRUE(telemetry::writeBatch(m_db, {{"dev1", "temp", base + 30000, 5.0}}));
+
+    EXPECT_EQ(QStringList({"telemetry_raw_20261018", "telemetry_raw_20261019"}),
+              telemetry::partitions(m_db, TelemetryResolution::Raw));
+    EXPECT_EQ(QStringList({"telemetry_1h_202610"}),
+              telemetry::partitions(m_db, TelemetryResolution::Hour));
+
+    const auto raw = telemetry::query(
+        m_db, "dev1", "temp", base - kDayMs, base + 60000, TelemetryResolution::Raw);
+    ASSERT_EQ(4, raw.size());
+    EXPECT_DOUBLE_EQ(7.0, raw[0].sum);
+    EXPECT_EQ(base, raw[1].timestampMs);
+    EXPECT_DOUBLE_EQ(5.0, raw[3].sum);
+
+    const auto minutes = telemetry::query(
+        m_db, "dev1", "temp", base + 10000, base + 10000, TelemetryResolution::Minute);
+    ASSERT_EQ(1, minutes.size());
+    EXPECT_EQ(base, minutes[0].timestampMs);
+    EXPECT_EQ(3, minutes[0].count);
+    EXPECT_DOUBLE_EQ(1.0, minutes[0].min);
+    EXPECT_DOUBLE_EQ(5.0, minutes[0].max);
+    EXPECT_DOUBLE_EQ(3.0, minutes[0].avg());
+
+    const auto hours =
+        telemetry::query(m_db, "dev1", "temp", base, base, TelemetryResolution::Hour);
+    ASSERT_EQ(1, hours.size());
+    EXPECT_EQ(utcMs(2026, 10, 19, 8), hours[0].timestampMs);
+    EXPECT_EQ(3, hours[0].count);
+
+    const auto all = telemetry::query(
+        m_db, "dev1", QString(), base - kDayMs, base + 60000, TelemetryResolution::Raw, 2);
+    ASSERT_EQ(2, all.size());
+    EXPECT_EQ(QStringLiteral("humidity"), all[0].metric);
+    EXPECT_EQ(QStringLiteral("temp"), all[1].metric);
+    EXPECT_EQ(base - 9 * 3600 * 1000, all[1].timestampMs);
+}
+
+// 测试：保留期清理整体删除过期分区
+// 场景：分别在 10 天前与当天写入；原始数据保留 7 天，汇总保留 30 天
+// 断言：只删除 10 天前的原始分区；原始查询只剩当天数据；1m 汇总仍保留旧数据；
+//      再次清理不删除任何分区
+TEST_F(TelemetryStoreTest, RetentionDropsWholePartitions) {
+    const qint64 now = utcMs(2026, 10, 19, 12);
+    const qint64 old = now - 10 * kDayMs;
+    ASSERT_TRUE(
+        telemetry::writeBatch(m_db, {{"dev1", "temp", old, 1.0}, {"dev1", "temp", now, 2.0}}));
+
+    TelemetryOptions options;
+    options.rawRetentionDays = 7;
+    options.minuteRetentionDays = 30;
+    options.hourRetentionDays = 365;
+    EXPECT_EQ(1, telemetry::dropExpiredPartitions(m_db, now, options));
+    EXPECT_EQ(QStringList({"telemetry_raw_20261019"}),
+              telemetry::partitions(m_db, TelemetryResolution::Raw));
+
+    const auto raw =
+        telemetry::query(m_db, "dev1", "temp", old - 1000, now, TelemetryResolution::Raw);
+    ASSERT_EQ(1, raw.size());
+    EXPECT_EQ(now, raw[0].timestampMs);
+    EXPECT_EQ(2, telemetry::query(m_db, "dev1", "temp", old, now, TelemetryResolution::Minute)
+                     .size());
+    EXPECT_EQ(0, telemetry::dropExpiredPartitions(m_db, now, options));
+}
+
+}  // namespace storage::tests
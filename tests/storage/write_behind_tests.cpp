@@ -0,0 +1,276 @@
+﻿#include <gtest/gtest.h>
+
+#include <QSettings>
+#include <QTemporaryDir>
+#include <QtSql/QSqlDatabase>
+#include <QtSql/QSqlQuery>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "modules/Config/config.h"
+#include "modules/Storage/dbmanager.h"
+#include "modules/Storage/write_behind.h"
+
+namespace storage::tests {
+
+namespace {
+
+using std::chrono::milliseconds;
+
+bool insertValue(QSqlDatabase& db, int value) {
+    QSqlQuery q(db);
+    q.prepare(QStringLiteral("INSERT INTO write_behind_test(value) VALUES (?)"));
+    q.addBindValue(value);
+    return q.exec();
+}
+
+QList<int> storedValues() {
+    QList<int> values;
+    QSqlQuery q(DbManager::instance().db());
+    if (!q.exec(QStringLiteral("SELECT value FROM write_behind_test ORDER BY value"))) {
+        return values;
+    }
+    while (q.next()) values << q.value(0).toInt();
+    return values;
+}
+
+/**
+ * @brief 占住写线程的写操作：开始执行后置位 started，等到 release 后才返回
+ */
+class WriterGate {
+   public:
+    WriteBehindQueue::WriteOp op() {
+        return [this](QSqlDatabase&) {
+            m_started = true;
+            m_release.get_future().wait();
+            return true;
+        };
+    }
+
+    bool waitStarted() {
+        for (int i = 0; i < 500 && !m_started.load(); ++i) {
+            std::this_thread::sleep_for(milliseconds(2));
+        }
+        return m_started.load();
+    }
+
+    void release() { m_release.set_value(); }
+
+   private:
+    std::atomic<bool> m_started{false};
+    std::promise<void> m_release;
+};
+
+/**
+ * @brief 写队列写入新的共享缓存内存库；每个测试结束时恢复默认参数
+ */
+class WriteBehindTest : public ::testing::Test {
+   protected:
+    static void SetUpTestSuite() {
+        s_dir = std::make_unique<QTemporaryDir>();
+        QSettings::setPath(QSettings::IniFormat, QSettings::UserScope, s_dir->path());
+        auto& cfg = config::ConfigManager::instance();
+        cfg.init("CrossControlTests", "WriteBehindTests");
+        ASSERT_TRUE(cfg.loadFromJsonString(R"({"Storage": {"database": ":memory:"}})"));
+    }
+
+    static void TearDownTestSuite() {
+        WriteBehindQueue::instance().shutdown();
+        DbManager::instance().close();
+        s_dir.reset();
+    }
+
+    void SetUp() override {
+        ASSERT_TRUE(DbManager::instance().init(true));
+        QSqlQuery ddl(DbManager::instance().db());
+        ASSERT_TRUE(ddl.exec(QStringLiteral(
+            "CREATE TABLE write_behind_test (value INTEGER PRIMARY KEY)")));
+        m_before = WriteBehindQueue::instance().stats();
+    }
+
+    void TearDown() override {
+        auto& queue = WriteBehindQueue::instance();
+        EXPECT_TRUE(queue.flush());
+        queue.setOptions({});
+    }
+
+    WriteBehindStats m_before;
+    static std::unique_ptr<QTemporaryDir> s_dir;
+};
+
+std::unique_ptr<QTemporaryDir> WriteBehindTest::s_dir;
+
+}  // namespace
+
+// 测试：排队的写操作按 maxBatch 组成事务提交
+// 场景：maxBatch=16；先用一个阻塞的写操作占住写线程，期间提交 50 个插入，再放行
+// 断言：阻塞操作单独一批，50 个插入分成 16/16/16/2 四批；全部成功且数据可见
+TEST_F(WriteBehindTest, GroupsPendingWritesIntoBatches) {
+    auto& queue = WriteBehindQueue::instance();
+    WriteBehindOptions options;
+    options.maxBatch = 16;
+    options.commitDelay = milliseconds(0);
+    queue.setOptions(options);
+
+    WriterGate gate;
+    auto blocked = queue.submit(gate.op());
+    ASSERT_TRUE(gate.waitStarted());
+    std::vector<std::future<bool>> writes;
+    for (int i = 0; i < 50; ++i) {
+        writes.push_back(queue.submit([i](QSqlDatabase& db) { return insertValue(db, i); }));
+    }
+    EXPECT_EQ(50u, queue.stats().pending);
+    gate.release();
+
+    EXPECT_TRUE(blocked.get());
+    for (auto& write : writes) EXPECT_TRUE(write.get());
+    ASSERT_TRUE(queue.flush());
+    const WriteBehindStats after = queue.stats();
+    EXPECT_EQ(5u, after.batches - m_before.batches);
+    EXPECT_EQ(51u, after.committed - m_before.committed);
+    EXPECT_EQ(0u, after.failed - m_before.failed);
+    EXPECT_EQ(50, storedValues().size());
+}
+
+// 测试：同一批中失败的写操作只回滚它自己
+// 场景：三个写操作进入同一批；第二个先插入一行再返回 false，第三个插入与第二个相同的值
+// 断言：future 依次为 true/false/true；第二个操作的插入被回滚到保存点，第一、三个的数据保留
+TEST_F(WriteBehindTest, FailedWriteRollsBackToItsSavepoint) {
+    auto& queue = WriteBehindQueue::instance();
+    WriterGate gate;
+    auto blocked = queue.submit(gate.op());
+    ASSERT_TRUE(gate.waitStarted());
+
+    auto first = queue.submit([](QSqlDatabase& db) { return insertValue(db, 1); });
+    auto failing = queue.submit([](QSqlDatabase& db) {
+        insertValue(db, 2);
+        return false;
+    });
+    auto third = queue.submit([](QSqlDatabase& db) { return insertValue(db, 3); });
+    auto reuse = queue.submit([](QSqlDatabase& db) { return insertValue(db, 2); });
+    gate.release();
+
+    EXPECT_TRUE(blocked.get());
+    EXPECT_TRUE(first.get());
+    EXPECT_FALSE(failing.get());
+    EXPECT_TRUE(third.get());
+    // 回滚后值 2 没有残留，之后同批的插入不会因主键冲突失败
+    EXPECT_TRUE(reuse.get());
+    EXPECT_EQ(QList<int>({1, 2, 3}), storedValues());
+    EXPECT_EQ(1u, queue.stats().failed - m_before.failed);
+}
+
+// 测试：队列已满时提交方阻塞等待，而不是丢弃写入
+// 场景：capacity=4；写线程被占住时提交 4 个写操作填满队列，再在另一线程提交第 5 个
+// 断言：第 5 个 submit 在放行前不返回；放行后全部写入成功，没有写操作被拒绝
+TEST_F(WriteBehindTest, SubmitBlocksWhileQueueIsFull) {
+    auto& queue = WriteBehindQueue::instance();
+    WriteBehindOptions options;
+    options.capacity = 4;
+    options.maxBatch = 4;
+    options.commitDelay = milliseconds(0);
+    queue.setOptions(options);
+
+    WriterGate gate;
+    auto blocked = queue.submit(gate.op());
+    ASSERT_TRUE(gate.waitStarted());
+    std::vector<std::future<bool>> writes;
+    for (int i = 0; i < 4; ++i) {
+        writes.push_back(queue.submit([i](QSqlDatabase& db) { return insertValue(db, i); }));
+    }
+
+    std::atomic<bool> submitted{false};
+    std::future<bool> overflow;
+    std::thread producer([&]() {
+        overflow = queue.submit([](QSqlDatabase& db) { return insertValue(db, 4); });
+        submitted = true;
+    });
+    std::this_thread::sleep_for(milliseconds(100));
+    EXPECT_FALSE(submitted.load());
+
+    gate.release();
+    producer.join();
+    EXPECT_TRUE(submitted.load());
+    EXPECT_TRUE(blocked.get());
+    for (auto& write : writes) EXPECT_TRUE(write.get());
+    EXPECT_TRUE(overflow.get());
+    EXPECT_EQ(0u, queue.stats().rejected - m_before.rejected);
+    EXPECT_EQ(QList<int>({0, 1, 2, 3, 4}), storedValues());
+}
+
+// 测试：写线程自身在队列已满时提交会被拒绝，而不是等待自己
+// 场景：capacity=2；写线程上的操作等主线程填满队列后再提交一个写操作
+// 断言：内部提交的 future 立即为 false 并计入 rejected；外层操作与排队的写操作照常成功
+TEST_F(WriteBehindTest, WriterThreadSubmitIsRejectedWhenFull) {
+    auto& queue = WriteBehindQueue::instance();
+    WriteBehindOptions options;
+    options.capacity = 2;
+    options.commitDelay = milliseconds(0);
+    queue.setOptions(options);
+
+    std::atomic<bool> started{false};
+    std::promise<void> queueFull;
+    std::atomic<int> innerResult{-1};
+    auto outer = queue.submit([&](QSqlDatabase&) {
+        started = true;
+        queueFull.get_future().wait();
+        auto inner = queue.submit([](QSqlDatabase& db) { return insertValue(db, 99); });
+        innerResult = inner.get() ? 1 : 0;
+        return true;
+    });
+    for (int i = 0; i < 500 && !started.load(); ++i) std::this_thread::sleep_for(milliseconds(2));
+    ASSERT_TRUE(started.load());
+
+    auto a = queue.submit([](QSqlDatabase& db) { return insertValue(db, 1); });
+    auto b = queue.submit([](QSqlDatabase& db) { return insertValue(db, 2); });
+    queueFull.set_value();
+
+    EXPECT_TRUE(outer.get());
+    EXPECT_EQ(0, innerResult.load());
+    EXPECT_TRUE(a.get());
+    EXPECT_TRUE(b.get());
+    EXPECT_EQ(1u, queue.stats().rejected - m_before.rejected);
+    EXPECT_EQ(QList<int>({1, 2}), storedValues());
+}
+
+// 测试：shutdown 进行中的 submit 被拒绝，不会重启写线程导致 join 挂起
+// 场景：阻塞的写操作占住写线程，另一线程调用 shutdown；主线程反复提交直到被拒绝，再放行
+// 断言：停止期间的提交立即为 false 并计入 rejected；shutdown 正常返回，阻塞操作与
+//      停止前入队的写操作已提交；之后的 submit 重新启动写线程并成功提交
+TEST_F(WriteBehindTest, SubmitDuringShutdownIsRejected) {
+    auto& queue = WriteBehindQueue::instance();
+    WriterGate gate;
+    auto blocker = queue.submit(gate.op());
+    ASSERT_TRUE(gate.waitStarted());
+
+    std::thread stopper([&queue]() { queue.shutdown(); });
+    std::vector<std::future<bool>> accepted;
+    bool rejected = false;
+    for (int i = 0; i < 500 && !rejected; ++i) {
+        auto f = queue.submit([i](QSqlDatabase& db) { return insertValue(db, i); });
+        if (f.wait_for(milliseconds(0)) == std::future_status::ready) {
+            rejected = !f.get();
+        } else {
+            accepted.push_back(std::move(f));
+            std::this_thread::sleep_for(milliseconds(2));
+        }
+    }
+    gate.release();
+    stopper.join();
+
+    EXPECT_TRUE(rejected);
+    EXPECT_EQ(1u, queue.stats().rejected - m_before.rejected);
+    EXPECT_TRUE(blocker.get());
+    for (auto& f : accepted) EXPECT_TRUE(f.get());
+    EXPECT_EQ(static_cast<int>(accepted.size()), storedValues().size());
+
+    auto after = queue.submit([](QSqlDatabase& db) { return insertValue(db, 1000); });
+    EXPECT_TRUE(after.get());
+    EXPECT_TRUE(storedValues().contains(1000));
+}
+
+}  // namespace storage::tests